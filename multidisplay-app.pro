@@ -4,6 +4,16 @@ CONFIG   += ordered
 SUBDIRS  = libs/qwt-6.1.1 \
 	   src
 
+#headless log tool
+!android:!maemo5 {
+    SUBDIRS+=src/mdtool
+}
+
+#MD board emulator on a pseudo terminal
+linux:!android:!maemo5 {
+    SUBDIRS+=src/mdemu
+}
+
 lessThan(QT_MAJOR_VERSION, 5) {
     SUBDIRS+=libs/qextserialport
 }
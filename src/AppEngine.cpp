@@ -25,6 +25,7 @@
 #include <QMessageBox>
 #include <QDebug>
 #include <QSettings>
+#include <QTimer>
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QTableWidget>
@@ -54,8 +55,13 @@
 #include "mobile/MobileEvaluationDialog.h"
 #include "GearSettingsDialog.h"
 #include "AboutDialog.h"
+#include "MdAcqStatsDialog.h"
 #include "TransferFunction.h"
 #include "DigifantApplicationWindow.h"
+#include "data/MdRawCapture.h"
+#include "data/MdJournal.h"
+#include "data/MdSpillFile.h"
+#include "data/MdSessionFile.h"
 
 #include "ui_mobilemainwindow.h"
 #include "ui_MobileBoostPidWindow.h"
@@ -121,6 +127,7 @@ AppEngine::AppEngine() {
     v2SettingsDialog = new V2SettingsDialog(pcmw);
     gearSettingsDialog = new GearSettingsDialog(pcmw);
     aboutDialog = new AboutDialog(pcmw);
+    acqStatsDialog = new MdAcqStatsDialog(pcmw, mds->acquisitionStats());
     dfAppWin = new DigifantApplicationWindow (pcmw);
 
 #endif
@@ -222,7 +229,12 @@ AppEngine::AppEngine() {
 #if  !defined (Q_WS_MAEMO_5)  && !defined (Q_OS_ANDROID)
     connect (replay, SIGNAL(showStatusMessage(QString)), pcmw, SLOT(showStatusMessage(QString)), Qt::QueuedConnection );
 #endif
-    connect (replay, SIGNAL(visualizeDataRecord(MdDataRecord*,bool)), data, SLOT(visualizeDataRecord(MdDataRecord*,bool)), Qt::QueuedConnection );
+    connect (replay, SIGNAL(visualizeRow(int,bool)), data, SLOT(visualizeRow(int,bool)), Qt::QueuedConnection );
+
+    //crash safe journal of the live data
+    connect (mds, SIGNAL(portOpened()), data, SLOT(enableJournal()) );
+    connect (mds, SIGNAL(portClosed()), data, SLOT(disableJournal()) );
+    connect (qApp, SIGNAL(aboutToQuit()), data, SLOT(closeJournal()) );
 
 
 #if  defined (Q_WS_MAEMO_5)  || defined (Q_OS_ANDROID)
@@ -238,6 +250,9 @@ AppEngine::AppEngine() {
     directory = QDesktopServices::storageLocation (QDesktopServices::DocumentsLocation);
 #endif
 
+    //journals of sessions that were not saved, after the window is shown
+    QTimer::singleShot ( 0, this, SLOT(recoverJournals()) );
+
     //load TEST-DATA
 //    openData ("/home/bofh/dev/multidisplay/2/log/incoming/2014-05-21T2252-977Grad_AGT.mdv2");
 
@@ -269,6 +284,9 @@ void AppEngine::setupPC() {
     connect (pcmw->ui.action_Open, SIGNAL(triggered()), this, SLOT(openData() ) );
     connect (pcmw->ui.action_New, SIGNAL(triggered()), this, SLOT(clearData() ) );
     connect (pcmw->ui.action_Export_as_CSV, SIGNAL(triggered()), this, SLOT(saveDataAsCSV() ) );
+    connect (pcmw->ui.action_Raw_capture, SIGNAL(toggled(bool)), this, SLOT(toggleRawCapture(bool)) );
+    connect (pcmw->ui.action_Decode_raw_capture, SIGNAL(triggered()), this, SLOT(decodeRawCapture()) );
+    connect (pcmw->ui.action_Acquisition_statistics, SIGNAL(triggered()), acqStatsDialog, SLOT(show()) );
 
 
 //    connect (pcmw->ui.action_Enable_Zoom_Mode, SIGNAL(changed()), data, SLOT (toggleZoomMode() ) );
@@ -607,10 +625,10 @@ void AppEngine::show() {
 void AppEngine::saveData () {
 #if QT_VERSION >= 0x050000
     QString path =  QStandardPaths::standardLocations (QStandardPaths::DocumentsLocation)[0]
-            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + ".mdv2";
+            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + ".mdv3";
 #else
     QString path = QDesktopServices::storageLocation (QDesktopServices::DocumentsLocation)
-            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + ".mdv2";
+            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + ".mdv3";
 #endif
 
     data->saveData(path);
@@ -636,18 +654,96 @@ void AppEngine::saveDataAsCSV() {
         data->saveDataCSV(fn);
 }
 
+void AppEngine::toggleRawCapture ( bool on ) {
+    if ( !on ) {
+        mds->stopRawCapture();
+        return;
+    }
+#if QT_VERSION >= 0x050000
+    QString path =  QStandardPaths::standardLocations (QStandardPaths::DocumentsLocation)[0]
+            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + ".mdraw";
+#else
+    QString path = QDesktopServices::storageLocation (QDesktopServices::DocumentsLocation)
+            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + ".mdraw";
+#endif
+    QString fn = QFileDialog::getSaveFileName ( pcmw, QString("Select Filename"), path,
+                                                "MultiDisplay raw capture (*.mdraw)");
+    //capture/live_decode=false: capture only, the session is decoded afterwards
+    QSettings settings("MultiDisplay", "UI");
+    if ( fn == "" || !mds->startRawCapture ( fn, settings.value("capture/live_decode", QVariant(true)).toBool() ) )
+        pcmw->ui.action_Raw_capture->setChecked (false);
+}
+
+void AppEngine::decodeRawCapture () {
+    QString fn = QFileDialog::getOpenFileName ( pcmw, QString("Select Filename"), directory,
+                                                "MultiDisplay raw capture (*.mdraw)" );
+    if ( fn == "" )
+        return;
+    directory = QFileInfo(fn).path();
+    QString session = fn;
+    if ( session.endsWith (".mdraw") )
+        session.chop (6);
+    session += ".mdv3";
+
+    QString error;
+    QApplication::setOverrideCursor ( Qt::WaitCursor );
+    bool ok = MdRawCapture::decodeToSession ( fn, session, 0, &error );
+    QApplication::restoreOverrideCursor();
+    if ( !ok ) {
+        QMessageBox::warning ( pcmw, "Decode raw capture", "decoding " + fn + " failed: " + error );
+        return;
+    }
+    openData (session);
+}
+
+void AppEngine::recoverJournals () {
+    //the journal has the rows of a spill file too
+    MdSpillFile::removeStale ( MdJournal::directory() );
+    QDir jd ( MdJournal::directory() );
+    QStringList journals = jd.entryList ( QStringList() << "*.mdv3", QDir::Files, QDir::Time );
+    QString newest;
+    foreach ( QString j, journals ) {
+        QString fn = jd.filePath (j);
+        qint64 rows = 0;
+        QString error;
+        if ( !MdSessionFile::recover ( fn, &rows, &error ) ) {
+            qDebug() << "journal " << fn << " can not be recovered: " << error;
+            continue;
+        }
+        if ( rows == 0 ) {
+            QFile::remove (fn);
+            continue;
+        }
+        QString target = directory + QDir::separator() + "recovered-" + j;
+        QFile::remove (target);
+        if ( !QFile::rename ( fn, target ) )
+            continue;
+        qDebug() << "recovered " << rows << " rows of an unsaved log to " << target;
+        emit showStatusMessage ( "recovered unsaved log " + target );
+        if ( newest.isEmpty() )
+            newest = target;
+    }
+
+#if  !defined (Q_WS_MAEMO_5)  && !defined (Q_OS_ANDROID)
+    if ( !newest.isEmpty() && QMessageBox::question ( pcmw, "Recovered log",
+                                                      "The last log was not saved and has been recovered to\n" + newest + "\nOpen it?",
+                                                      QMessageBox::Yes | QMessageBox::No ) == QMessageBox::Yes )
+        openData (newest);
+#endif
+}
+
 void AppEngine::saveDataAs () {
 #if QT_VERSION >= 0x050000
     QString path =  QStandardPaths::standardLocations (QStandardPaths::DocumentsLocation)[0]
-            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + ".mdv2";
+            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + ".mdv3";
 #else
 
     QString path = QDesktopServices::storageLocation (QDesktopServices::DocumentsLocation)
-            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + ".mdv2";
+            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + ".mdv3";
 #endif
 
     QString fn = QFileDialog::getSaveFileName ( pcmw, QString("Select Filename"), path,
-                                                "mdv2 (*.mdv2)");
+                                                "mdv3 (*.mdv3)");
     if ( fn != "") {
         data->saveData(fn);
 #if  defined (Q_WS_MAEMO_5)  || defined (ANDROID)
@@ -662,7 +758,7 @@ void AppEngine::openData ( QString fn ) {
     if ( fn == "" ) {
         //, QString("~"), QString("*.mdd")
 //        QString path = QDesktopServices::storageLocation (QDesktopServices::DocumentsLocation);
-        fn = QFileDialog::getOpenFileName ( pcmw, QString("Select Filename"), directory, "mdv2 (*.mdv2)" );
+        fn = QFileDialog::getOpenFileName ( pcmw, QString("Select Filename"), directory, "MultiDisplay logs (*.mdv3 *.mdv2)" );
     }
 
     if ( fn != "") {
@@ -899,6 +995,15 @@ void AppEngine::replayData() {
 #endif
 //    replayThreadStopRequested = false;
 
+    //the replay thread reads the times from a source of its own: the store or the opened session
+    QString e;
+    MdChunkSource* src = data->threadSource (&e);
+    if ( !src ) {
+        emit showStatusMessage ( QString("replay failed: ") + e );
+        return;
+    }
+    replay->setSource (src);
+
     replayThread->start();
 
 #if defined Q_WS_MAEMO_5 and not defined Q_OS_ANDROID
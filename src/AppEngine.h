@@ -64,6 +64,7 @@ class Map16x1;
 class MobileEvaluationDialog;
 class GearSettingsDialog;
 class AboutDialog;
+class MdAcqStatsDialog;
 class DigifantApplicationWindow;
 class MobileGPS;
 class Accelerometer;
@@ -119,6 +120,12 @@ public slots:
     void saveDataAs ();
     void saveDataAsCSV();
     void openData ( QString fn="" );
+    //! start / stop capturing the raw serial frames to a mdraw file
+    void toggleRawCapture ( bool on );
+    //! decode a mdraw capture into a mdv3 session and open it
+    void decodeRawCapture ();
+    //! completes the journals of sessions that were not saved and offers to open them
+    void recoverJournals ();
     void clearData ();
 
     void changeSerialOptions();
@@ -163,6 +170,7 @@ private:
     V2SettingsDialog *v2SettingsDialog;
     GearSettingsDialog *gearSettingsDialog;
     AboutDialog *aboutDialog;
+    MdAcqStatsDialog *acqStatsDialog;
 
     MdAbstractCom *mdcom;
 
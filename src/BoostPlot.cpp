@@ -19,18 +19,29 @@
 
 
 #include "BoostPlot.h"
+#include "data/MdChunkSource.h"
+
 #include <QPen>
 #include <QColor>
 #include <qdebug.h>
 #include <qwt_legend.h>
 
+//! channel, factor and bit mask of the series, x is the time in ms
+static const struct {
+    int channel;
+    double factor;
+    quint32 mask;
+} curves[] = {
+    { MdChannel::Boost, 1, 0 }, { MdChannel::N75ReqBoost, 1, 0 }, { MdChannel::N75, 1, 0 },
+    { MdChannel::Throttle, 0.01, 0 }, { MdChannel::N75ReqBoostPwm, 1, 0 }, { MdChannel::Flags, 1, 2 }
+};
+
 BoostPidPlot::BoostPidPlot (QMainWindow* mw, QWidget *parent ) : MdPlot(mw, parent) {
-        boostData = new MdPlotData (0,50);
-        setPointData = new MdPlotData (0,50);
-        mapPwmData = new MdPlotData (0,50);
-        outputData = new MdPlotData (0,50);
-        throttleData = new MdPlotData (0,50);
-        aggData = new MdPlotData (0,50);
+        for ( int c = 0 ; c < CURVES ; c++ ) {
+            MdChannelSeries* d = new MdChannelSeries ( curves[c].channel, curves[c].factor, 1, 50 );
+            d->setMask ( curves[c].mask );
+            seriesData << d;
+        }
 
         setTitle (QString("Boost Plot"));
 
@@ -106,21 +117,25 @@ BoostPidPlot::~BoostPidPlot() {
 
 
 void BoostPidPlot::addRecord ( MdSensorRecord* r, bool doReplot ) {
-	boostData->append(r->getTime(), r->getBoost() );
-        setPointData->append (r->getTime(), r->getN75ReqBoost() );
-        outputData->append (r->getTime(), r->getN75() );
-	throttleData->append(r->getTime(), r->getThrottle()/100 );
-        mapPwmData->append(r->getTime(), r->getN75ReqBoostPWM() );
-        aggData->append(r->getTime(), (r->getFlags() & 2) );
-	if ( doReplot )
-		replot();
+    if ( r )
+        showRows ( seriesData[0]->firstRow(), seriesData[0]->rowCount() + 1, doReplot );
+}
+
+void BoostPidPlot::setSource ( MdChunkSource* src ) {
+    foreach ( MdChannelSeries* d, seriesData )
+        d->setSource (src);
+}
+
+void BoostPidPlot::showRows ( qint64 first, qint64 count, bool doReplot ) {
+    foreach ( MdChannelSeries* d, seriesData )
+        d->setRows (first, count);
+    if ( doReplot )
+        replot();
 }
 
 void BoostPidPlot::clear () {
-	boostData->clear();
-	setPointData->clear();
-	outputData->clear();
-	throttleData->clear();
+	foreach ( MdChannelSeries* d, seriesData )
+		d->clear();
 	replot();
 }
 
@@ -23,7 +23,7 @@
 #include "ui_multidisplayuimainwindow.h"
 
 #include "MdData.h"
-#include "MdPlotData.h"
+#include "MdChannelSeries.h"
 #include "MdPlot.h"
 
 #include <QWidget>
@@ -40,10 +40,15 @@ public:
     BoostPidPlot( QMainWindow* mw, QWidget *parent );
     virtual ~BoostPidPlot();
 
+    //! r is the next row of the source, it is shown with the rows before
     void addRecord ( MdSensorRecord* r, bool doReplot=true );
     void clear ();
+    void setSource ( MdChunkSource* src );
+    void showRows ( qint64 first, qint64 count, bool doReplot=true );
 
 private:
+    enum { CURVES = 6 };
+
     Ui::MultidisplayUIMainWindowClass *ui;
     QwtPlotCurve *boostCurve;
     QwtPlotCurve *setPointCurve;
@@ -54,12 +59,8 @@ private:
     //	QVector<double> xboost;
     //	QVector<double> yboost;
 
-    MdPlotData *boostData;
-    MdPlotData *setPointData;
-    MdPlotData *mapPwmData;
-    MdPlotData *outputData;
-    MdPlotData *throttleData;
-    MdPlotData *aggData;
+    //! boost, set point, output, throttle, map pwm, aggressive mode (see BoostPlot.cpp)
+    QList<MdChannelSeries*> seriesData;
 
     QHBoxLayout *myhorizontalLayout;
 };
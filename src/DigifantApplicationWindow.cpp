@@ -51,7 +51,7 @@ void DigifantApplicationWindow::visualize (MdDataRecord *d) {
             t.restart();
 
             lw->setValue(  d->getSensorR()->getLambda() );
-            QMap<QString, double> e = d->getSensorR()->getHighestEgt();
+            QMap<QString, double> e = d->getSensorR()->getHighestEgt ( AppEngine::getInstance()->numConnectedTypeK );
             egtw->setValue( e["temp"], (quint8) e["idx"]  );
 
 //            bexw->setValue( d );
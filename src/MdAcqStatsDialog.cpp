@@ -0,0 +1,85 @@
+#include "MdAcqStatsDialog.h"
+#include "ui_MdAcqStatsDialog.h"
+#include "com/MdAcqStats.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QTextStream>
+#include <QTimer>
+#if QT_VERSION >= 0x050000
+#include <QStandardPaths>
+#else
+#include <QDesktopServices>
+#endif
+
+MdAcqStatsDialog::MdAcqStatsDialog(QWidget *parent, MdAcqStats *stats) :
+    QDialog(parent),
+    ui(new Ui::MdAcqStatsDialog), stats(stats), rateFrames(0)
+{
+    ui->setupUi(this);
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval (REFRESH_MILLIS);
+    connect (refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+    connect (ui->resetButton, SIGNAL(clicked()), this, SLOT(resetStats()));
+    connect (ui->saveButton, SIGNAL(clicked()), this, SLOT(saveStats()));
+    connect (ui->buttonBox, SIGNAL(rejected()), this, SLOT(close()));
+}
+
+MdAcqStatsDialog::~MdAcqStatsDialog()
+{
+    delete ui;
+}
+
+void MdAcqStatsDialog::showEvent ( QShowEvent * event ) {
+    rateFrames = stats->frameCount();
+    rateTimer.start();
+    refresh();
+    refreshTimer->start();
+    QDialog::showEvent (event);
+}
+
+void MdAcqStatsDialog::hideEvent ( QHideEvent * event ) {
+    refreshTimer->stop();
+    QDialog::hideEvent (event);
+}
+
+void MdAcqStatsDialog::refresh() {
+    quint32 n = stats->frameCount();
+    double s = rateTimer.restart() / 1000.0;
+    //a reset in between gives a negative difference
+    double rate = ( s > 0 && n >= rateFrames ) ? ( n - rateFrames ) / s : 0;
+    rateFrames = n;
+    ui->rateLabel->setText ( QString("%1 frames/s").arg ( rate, 0, 'f', 1 ) );
+    ui->statsText->setPlainText ( stats->toText() );
+}
+
+void MdAcqStatsDialog::resetStats() {
+    stats->reset();
+    rateFrames = 0;
+    rateTimer.restart();
+    refresh();
+}
+
+void MdAcqStatsDialog::saveStats() {
+#if QT_VERSION >= 0x050000
+    QString path =  QStandardPaths::standardLocations (QStandardPaths::DocumentsLocation)[0]
+            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + "-acquisition.txt";
+#else
+    QString path = QDesktopServices::storageLocation (QDesktopServices::DocumentsLocation)
+            + QDir::separator() + QDateTime::currentDateTime ().toString("yyyy-MM-ddThhmm") + "-acquisition.txt";
+#endif
+    QString fn = QFileDialog::getSaveFileName ( this, QString("Select Filename"), path, "Text (*.txt)");
+    if ( fn == "" )
+        return;
+    QFile file (fn);
+    if ( !file.open ( QIODevice::WriteOnly | QIODevice::Text ) ) {
+        QMessageBox::warning ( this, "Acquisition statistics", "can't write " + fn + ": " + file.errorString() );
+        return;
+    }
+    QTextStream out (&file);
+    out << QDateTime::currentDateTime().toString (Qt::ISODate) << "\n" << stats->toText() << "\n";
+}
@@ -0,0 +1,46 @@
+#ifndef MDACQSTATSDIALOG_H
+#define MDACQSTATSDIALOG_H
+
+#include <QDialog>
+#include <QElapsedTimer>
+
+namespace Ui {
+    class MdAcqStatsDialog;
+}
+
+class MdAcqStats;
+class QTimer;
+
+/**
+  * live diagnostics of the acquisition thread: the text of MdAcqStats, refreshed every
+  * REFRESH_MILLIS while the dialog is visible, with the frame rate since the last refresh.
+  * can be saved to a text file.
+  */
+class MdAcqStatsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    enum { REFRESH_MILLIS = 1000 };
+
+    MdAcqStatsDialog(QWidget *parent, MdAcqStats *stats);
+    ~MdAcqStatsDialog();
+
+protected slots:
+    void refresh();
+    void resetStats();
+    void saveStats();
+
+protected:
+    virtual void showEvent ( QShowEvent * event );
+    virtual void hideEvent ( QHideEvent * event );
+
+private:
+    Ui::MdAcqStatsDialog *ui;
+    MdAcqStats *stats;
+    QTimer *refreshTimer;
+    QElapsedTimer rateTimer;
+    quint32 rateFrames;
+};
+
+#endif // MDACQSTATSDIALOG_H
@@ -0,0 +1,59 @@
+#include "MdChannelSeries.h"
+#include "data/MdTimeIndex.h"
+
+MdChannelSeries::MdChannelSeries ( int channel, double factor, double xFactor, int windowSize )
+    : MdPlotData (0, windowSize), id(channel), factor(factor), xFactor(xFactor), bits(0),
+      src(NULL), first(0), rows(0), cursor(NULL) {
+}
+
+void MdChannelSeries::setSource ( MdChunkSource* s ) {
+    src = s;
+    cursor = MdRowCursor (s);
+    first = 0;
+    rows = 0;
+    adjustWindow();
+}
+
+void MdChannelSeries::setRows ( qint64 f, qint64 count ) {
+    first = f;
+    rows = count;
+    adjustWindow();
+}
+
+void MdChannelSeries::clear () {
+    MdPlotData::clear();
+    first = 0;
+    rows = 0;
+}
+
+bool MdChannelSeries::interpolateSearch ( const double xval, iResult &res ) {
+    if ( reduced || !src || count() == 0 )
+        return MdPlotData::interpolateSearch (xval, res);
+    MdTimeIndex times (src);
+    qint64 r = qBound ( first, times.lowerBound ( xval / xFactor ), first + count() );
+    return interpolationResult ( r - first, xval, res );
+}
+
+int MdChannelSeries::count () const {
+    if ( reduced )
+        return MdPlotData::count();
+    if ( !src )
+        return 0;
+    //rows may have been removed from the source since setRows
+    return qMax ( (qint64) 0, qMin ( rows, src->rowCount() - first ) );
+}
+
+double MdChannelSeries::xAt ( int i ) const {
+    if ( reduced )
+        return MdPlotData::xAt (i);
+    return cursor.toDouble ( MdChannel::Time, first + i ) * xFactor;
+}
+
+double MdChannelSeries::yAt ( int i ) const {
+    if ( reduced )
+        return MdPlotData::yAt (i);
+    double v = cursor.toDouble ( id, first + i );
+    if ( bits )
+        v = (quint32) v & bits;
+    return v * factor;
+}
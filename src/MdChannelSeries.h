@@ -0,0 +1,53 @@
+#ifndef MDCHANNELSERIES_H
+#define MDCHANNELSERIES_H
+
+#include "MdPlotData.h"
+#include "data/MdChunkSource.h"
+
+/**
+ * plot samples read straight from the rows of a chunk source (the MdSessionStore
+ * or a lazily opened session): x is the time channel, y one channel, both scaled
+ * when a sample is drawn. nothing is copied, all curves of a log share its columns
+ * and every channel can be plotted.
+ *
+ * the samples are the rows first .. first + count - 1, the MdPlotData window selects
+ * a range of them -> only the drawn rows are read. a reduced series (setReduced) is
+ * drawn from the MdPlotData vectors until the next clear().
+ */
+class MdChannelSeries : public MdPlotData {
+public:
+    MdChannelSeries ( int channel, double factor = 1, double xFactor = 1, int windowSize = 100 );
+
+    int channel () const { return id; }
+    //! only these bits of the value are plotted (flags), 0: the whole value
+    void setMask ( quint32 mask ) { bits = mask; }
+
+    //! rows are read from src, NULL shows nothing. the series is emptied
+    void setSource ( MdChunkSource* src );
+    MdChunkSource* source () const { return src; }
+    //! shows count rows of the source starting at first
+    void setRows ( qint64 first, qint64 count );
+    qint64 firstRow () const { return first; }
+    qint64 rowCount () const { return rows; }
+
+    void clear ();
+    //! searches the time index of the source
+    bool interpolateSearch ( const double xval, iResult &res );
+
+protected:
+    int count () const;
+    double xAt ( int i ) const;
+    double yAt ( int i ) const;
+
+    int id;
+    double factor;
+    double xFactor;
+    quint32 bits;
+    MdChunkSource* src;
+    qint64 first;
+    qint64 rows;
+    //! sample() is const, the cursor only caches the chunk
+    mutable MdRowCursor cursor;
+};
+
+#endif // MDCHANNELSERIES_H
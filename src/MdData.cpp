@@ -29,6 +29,21 @@
 #include "Map16x1.h"
 #include "V2PowerDialog.h"
 #include "WotEventsDialog.h"
+#include "data/MdSessionFile.h"
+#include "data/MdSessionCache.h"
+#include "data/MdSessionStore.h"
+#include "data/MdRecordPool.h"
+#include "data/MdJournal.h"
+#include "data/MdSpillFile.h"
+#include "data/MdLoadJob.h"
+#include "data/MdLegacyIndex.h"
+#include "data/MdCsvExporter.h"
+#include "data/MdTimeIndex.h"
+#include "data/MdEventScan.h"
+#include "data/MdCheckJob.h"
+#include "data/MdSessionSnapshot.h"
+#include "data/MdGpsFix.h"
+#include "thread/jobrunnerthread.h"
 
 #include <qwt_plot.h>
 #include <qwt_plot_curve.h>
@@ -41,6 +56,9 @@
 #include <math.h>
 #include <QSplashScreen>
 #include <QProgressBar>
+#include <QProgressDialog>
+#include <QEventLoop>
+#include <QFileInfo>
 
 #if  defined (Q_WS_MAEMO_5)  || defined (ANDROID)
 #include "mobile/Accelerometer.h"
@@ -59,7 +77,10 @@ MaxDataSet::MaxDataSet () : p(NULL) {
 
 MdData::MdData (QMainWindow* mw_boost, QWidget* parent_boost, QMainWindow* mw_vis1, QWidget* parent_vis1,
                 QTableView* dataView)
-
+    : store(new MdSessionStore()), session(NULL), sessionPlotEnd(0), sessionWinSize(0),
+      sessionSelection(new MdSessionStore()),
+      journal(NULL), journalThread(NULL), journalFirstRow(0), journalEnabled(false),
+      spill(NULL), spillThread(NULL), liveWindowMillis(0), frameRows(true)
 {
     this->dataView = dataView;
     boostPidPlot = new BoostPidPlot ( mw_boost, parent_boost );
@@ -86,62 +107,10 @@ MdData::MdData (QMainWindow* mw_boost, QWidget* parent_boost, QMainWindow* mw_vi
 
     plotList.push_back ( (MdPlot*) boostPidPlot );
     plotList.push_back ( (MdPlot*) visPlot );
+    setPlotSource();
 
-    headerColNames.push_back("Time");
-    headerColNames.push_back("RPM");
-    headerColNames.push_back("Boost");
-    headerColNames.push_back("Throttle");
-    headerColNames.push_back("Lambda");
-    headerColNames.push_back("LMM");
-    headerColNames.push_back("CaseTemp");
-    headerColNames.push_back("AGT0");
-    headerColNames.push_back("AGT1");
-    headerColNames.push_back("AGT2");
-    headerColNames.push_back("AGT3");
-    headerColNames.push_back("AGT4");
-    headerColNames.push_back("AGT5");
-    headerColNames.push_back("AGT6");
-    headerColNames.push_back("AGT7");
-    headerColNames.push_back("Battery V");
-    headerColNames.push_back("VDO Pres1");
-    headerColNames.push_back("VDO Pres2");
-    headerColNames.push_back("VDO Pres3");
-    headerColNames.push_back("VDO Temp1");
-    headerColNames.push_back("VDO Temp2");
-    headerColNames.push_back("VDO Temp3");
-    headerColNames.push_back("Speed");
-    headerColNames.push_back("Gear");
-    headerColNames.push_back("N75 duty");
-    headerColNames.push_back("N75 Pid Bst");
-    headerColNames.push_back("N75 Map duty");
-    headerColNames.push_back("EFR speed");
-
-    //Digifant
-    headerColNames.push_back("DF Ignition");
-    headerColNames.push_back("DF Ign Retard");
-    headerColNames.push_back("DF Injection");
-    headerColNames.push_back("DF IAT");
-    headerColNames.push_back("DF ECT");
-    headerColNames.push_back("DF raw knock");
-    headerColNames.push_back("DF boost");
-    headerColNames.push_back("DF cold startup enrich");
-    headerColNames.push_back("DF warm startup enrich");
-    headerColNames.push_back("DF ect enrich");
-    headerColNames.push_back("DF iat enrich");
-    headerColNames.push_back("DF counter startup enrich");
-    headerColNames.push_back("DF voltage");
-    headerColNames.push_back("DF acc enrich");
-    headerColNames.push_back("DF ect inj addon");
-    headerColNames.push_back("DF Lambda Raw");
-    headerColNames.push_back("DF CO");
-    headerColNames.push_back("DF ISV");
-    headerColNames.push_back("DF LC flags");
-    headerColNames.push_back("Kline dbg");
-
-    headerColNames.push_back("GPS Coordinates");
-    headerColNames.push_back("GPS Speed");
-    headerColNames.push_back("GPs Altitude");
-    headerColNames.push_back("Acceleration");
+    for ( int i = 0 ; i < MdChannel::tableColumnCount() ; i++ )
+        headerColNames.push_back ( MdChannel::tableHeader (i) );
 
 //    rtvis = 0;
 
@@ -198,10 +167,17 @@ MdData::MdData (QMainWindow* mw_boost, QWidget* parent_boost, QMainWindow* mw_vi
 }
 
 MdData::~MdData() {
-    foreach ( MdDataRecord* r , dataList )
-        if (r)
-            delete (r);
-    dataList.clear();
+    closeJournal();
+    //the plots outlive the rows
+    foreach ( MdPlot* p, plotList )
+        p->setSource (NULL);
+    clearSessionSelection();
+    if ( session )
+        delete session;
+    delete sessionSelection;
+    store->clear();
+    stopSpill();
+    delete store;
 
     for ( uint8_t i = 0 ; i < MAXVALUES ; i++ )
         delete (maxValues[i]);
@@ -264,15 +240,16 @@ void MdData::tableDataView_customContextMenu( const QPoint& pos) {
 
     QItemSelectionModel *select = dataView->selectionModel();
 
-    dataViewContextMenuDelItemAction->setEnabled( select->hasSelection() );
-    dataViewContextMenuDigifantBoost2MdBoost->setEnabled( select->hasSelection() );
+    //sessions are read only
+    dataViewContextMenuDelItemAction->setEnabled( select->hasSelection() && !session );
+    dataViewContextMenuDigifantBoost2MdBoost->setEnabled( select->hasSelection() && !session );
 
     QAction *a = dataViewContextMenu->exec(dataView->viewport()->mapToGlobal(pos));
     if (a == dataViewContextMenuDelItemAction) {
 //        qDebug() << "MdData::tableDataView_customContextMenu del marked items";
 
 
-        int size = dataList.size();
+        int size = store->rowCount();
         //row has to be completely selected
         /*
         QModelIndexList sr = select->selectedRows(); // return selected row(s)
@@ -290,7 +267,7 @@ void MdData::tableDataView_customContextMenu( const QPoint& pos) {
 
     if (a == dataViewContextMenuDigifantBoost2MdBoost) {
         TransferFunction *tf = AppEngine::getInstance()->getDfBoostTransferFunction();
-        int size = dataList.size();
+        int size = store->rowCount();
         //row has to be completely selected
         /*
         QModelIndexList sr = select->selectedRows(); // return selected row(s)
@@ -304,10 +281,13 @@ void MdData::tableDataView_customContextMenu( const QPoint& pos) {
         //only 1 cell of a row has to be selected
         QList<int> dr = helperGetUniqueRows ( select );
         foreach (int i, dr) {
-            MdSensorRecord *record = dataList.at( size - i - 1)->getSensorR();
+            int row = size - i - 1;
+            quint8 raw = store->value<quint8> ( MdChannel::DfBoostRaw, row );
             //HACK set ambient pressure to 100kpa!
-            record->setBoost( qFloor ( ((tf->map(record->df_boost_raw) - 100) / 100) *100) / 100.0 );
+            store->setValue<double> ( MdChannel::Boost, row, qFloor ( ((tf->map(raw) - 100) / 100) *100) / 100.0 );
         }
+        journalFirstRow = -1;
+        legacySource.clear();
     }
 
     if ( a == dataViewContextMenuShowinVis1 ) {
@@ -337,7 +317,7 @@ void MdData::tableDataView_customContextMenu( const QPoint& pos) {
             }
             qSort (rows.begin(), rows.end());
             emit showRecordInVis1( rows.at ( rows.size()/2 ) );
-            qDebug() << "show in vis1 " << rows.at ( rows.size()/2 )  << " time=" << dataList.at(dataList.size() - rows.at ( rows.size()/2 ) - 1)->getSensorR()->getTime();
+            qDebug() << "show in vis1 " << rows.at ( rows.size()/2 )  << " time=" << record(size() - rows.at ( rows.size()/2 ) - 1)->getSensorR()->getTime();
         }
     }
     if ( a == dataViewContextMenuPowerPlot || a == dataViewContextMenuPowerPlotGPS ) {
@@ -347,24 +327,25 @@ void MdData::tableDataView_customContextMenu( const QPoint& pos) {
             //complete row is selected
             QModelIndexList sr = select->selectedRows();
             if ( ! sr.isEmpty() ) {
-                //row 0: newest record (top) = dataList.last() !
+                //row 0: newest record (top) = last store row !
                 foreach ( QModelIndex i , select->selectedRows() ) {
-                    rows.append( dataList.size() - i.row() - 1 );
+                    rows.append( size() - i.row() - 1 );
                 }
             } else {
                 //only 1 or more cells selected
                 //row 0: newest record (top)
                 QModelIndexList il = select->selectedIndexes();
                 foreach (QModelIndex i, il) {
-                    rows.append ( dataList.size() - i.row() - 1 );
+                    rows.append ( size() - i.row() - 1 );
                 }
             }
             if ( ! rows.isEmpty() ) {
                 qSort (rows.begin(), rows.end());
+                MdSessionStore* dl = recordsForRows (rows);
                 if ( a == dataViewContextMenuPowerPlotGPS )
-                    powerDialog->powerPlot()->setData (dataList, rows, true);
+                    powerDialog->powerPlot()->setData (dl, rows, true);
                 else
-                    powerDialog->powerPlot()->setData (dataList, rows, false);
+                    powerDialog->powerPlot()->setData (dl, rows, false);
                 powerDialog->show();
             }
         }
@@ -376,21 +357,21 @@ void MdData::tableDataView_customContextMenu( const QPoint& pos) {
             //complete row is selected
             QModelIndexList sr = select->selectedRows();
             if ( ! sr.isEmpty() ) {
-                //row 0: newest record (top) = dataList.last() !
+                //row 0: newest record (top) = last store row !
                 foreach ( QModelIndex i , select->selectedRows() ) {
-                    rows.append( dataList.size() - i.row() - 1);
+                    rows.append( size() - i.row() - 1);
                 }
             } else {
                 //only 1 or more cells selected
                 //row 0: newest record (top)
                 QModelIndexList il = select->selectedIndexes();
                 foreach (QModelIndex i, il) {
-                    rows.append ( dataList.size() - i.row() - 1);
+                    rows.append ( size() - i.row() - 1);
                 }
             }
             if ( ! rows.isEmpty() ) {
                 qSort (rows.begin(), rows.end());
-                QMap<qreal,SpeedData> time = powerDialog->powerPlot()->calculateTimeBetweenSpeeds (dataList, rows, 100, 200);
+                QMap<qreal,SpeedData> time = powerDialog->powerPlot()->calculateTimeBetweenSpeeds (recordsForRows (rows), rows, 100, 200);
                 qDebug() << "100-200km/h in " << QString::number(time[-1].time_s, 'f',2) << " msecs";
                 if ( time[-1].time_s > 0 ) {
                     QString s = "100-200 km/h in " + QString::number(time[-1].time_s, 'f', 2) + " secs (Geschwindigkeit aus GALA Signal von Tacho)";
@@ -417,21 +398,21 @@ void MdData::tableDataView_customContextMenu( const QPoint& pos) {
             //complete row is selected
             QModelIndexList sr = select->selectedRows();
             if ( ! sr.isEmpty() ) {
-                //row 0: newest record (top) = dataList.last() !
+                //row 0: newest record (top) = last store row !
                 foreach ( QModelIndex i , select->selectedRows() ) {
-                    rows.append( dataList.size() - i.row() - 1);
+                    rows.append( size() - i.row() - 1);
                 }
             } else {
                 //only 1 or more cells selected
                 //row 0: newest record (top)
                 QModelIndexList il = select->selectedIndexes();
                 foreach (QModelIndex i, il) {
-                    rows.append ( dataList.size() - i.row() - 1);
+                    rows.append ( size() - i.row() - 1);
                 }
             }
             if ( ! rows.isEmpty() ) {
                 qSort (rows.begin(), rows.end());
-                QMap<qreal,SpeedData> time = powerDialog->powerPlot()->calculateTimeBetweenSpeedsGPS (dataList, rows, 100, 200);
+                QMap<qreal,SpeedData> time = powerDialog->powerPlot()->calculateTimeBetweenSpeedsGPS (recordsForRows (rows), rows, 100, 200);
                 qDebug() << "100-200km/h in " << time[-1].time_s << " msecs";
                 if ( time[-1].time_s > 0 ) {
 
@@ -459,15 +440,19 @@ void MdData::tableDataView_customContextMenu( const QPoint& pos) {
 //        qDebug() << "dataList.size() - dr.begin() - 1, dataList.size() - dr.end() - 1);
 #if QT_VERSION >= 0x050000
         QString path = QStandardPaths::standardLocations (QStandardPaths::DocumentsLocation)[0]
-                + QDir::separator() + "selection.mdv2";
+                + QDir::separator() + "selection.mdv3";
 #else
         QString path = QDesktopServices::storageLocation (QDesktopServices::DocumentsLocation)
-                + QDir::separator() + "selection.mdv2";
+                + QDir::separator() + "selection.mdv3";
 #endif
 
+        QString filter = "mdv3 (*.mdv3)";
+        //the loaded legacy file can be sliced without converting it
+        if ( !legacySource.isEmpty() )
+            filter += ";;mdv2 (*.mdv2)";
         QString fn = QFileDialog::getSaveFileName ( NULL, QString("Select Filename"), path,
-                                                    "mdv2 (*.mdv2)");
-        saveData (fn, dataList.size() - dr.back() - 1, dataList.size() - dr.front() - 1);
+                                                    filter);
+        saveData (fn, size() - dr.back() - 1, size() - dr.front() - 1);
     }
 
     if ( a == dataViewContextMenuFindWotEvents ) {
@@ -490,153 +475,44 @@ void MdData::tableDataView_customContextMenu( const QPoint& pos) {
 }
 
 void MdData::showDataListIdx (int i) {
-    dataView->setCurrentIndex( createIndex( dataList.size() - i -1 , 0) );
+    dataView->setCurrentIndex( createIndex( size() - i -1 , 0) );
 
-    emit showRecordInVis1( dataList.size() - i - 1 );
+    emit showRecordInVis1( size() - i - 1 );
 }
 
 QModelIndex MdData::findRowForMillis (quint32 millis) {
-    int size = dataList.size();
-    if ( size == 0 )
+    //skip table of the chunk times + one chunk, also for sessions that are not decoded yet
+    MdTimeIndex times ( source() );
+    qint64 row = times.nearest (millis);
+    if ( row < 0 )
         return createIndex(0,0);
-//        return createIndex(0,0,0);
-
-    if ( millis > dataList.back()->getSensorR()->getTime() )
-        return createIndex( size, 0);
-
-
-    int lb = 0;
-    int rb = size;
-    int mi = size/2;
-    bool found = false;
-    int iterationen = 0;
-    while ( !found ) {
-        ++iterationen;
-//        qDebug() << "lb=" << lb << " mi=" << mi << " rb=" << rb << " search=" << millis << " curVal="
-//                 << dataList[mi]->getSensorR()->getTime() << " iteration " << iterationen;
-        if ( ( dataList[mi]->getSensorR()->getTime() == millis )
-//                || ( ( dataList[mi]->getSensorR()->getTime() > millis-10 ) &&
-//                    ( dataList[mi]->getSensorR()->getTime() < millis+10 ) )
-                || ( lb+1 == rb )
-                ) {
-            found = true;
-        }
-        else {
-            if ( dataList[mi]->getSensorR()->getTime() < millis ) {
-                lb = mi;
-                mi = lb + (rb-lb)/2;
-            }
-            if ( dataList[mi]->getSensorR()->getTime() > millis ) {
-                rb = mi;
-                mi = lb + (rb-lb)/2;
-            }
-        }
-    }
-    qDebug() << "findRowForMillis " << millis << " index=" << mi << " " << dataList[mi]->getSensorR()->getTime();
-    return createIndex( size-mi, 0);
+    return createIndex( source()->rowCount() - 1 - row, 0);
 }
 
 int MdData::getLastTime () {
-    if ( dataList.isEmpty() )
+    if ( session )
+        return session->chunkCount() ? session->chunkInfo( session->chunkCount() - 1 ).timeEnd : 0;
+    if ( store->isEmpty() )
         return 0;
-    return dataList.back()->getSensorR()->getTime();
+    return store->value<qint32> ( MdChannel::Time, store->rowCount() - 1 );
 }
 
 void MdData::findWot () {
-    QList <int> wotIdxL;
-    #define STATE_NO_WOT 1
-    #define STATE_WOT_START 2
-    #define STATE_WOT_FOUND 3
-    quint8 state = STATE_NO_WOT;
-    int wot_start_time = 0;
-    int wot_end_time = 0;
-    int wot_start_idx = 0;
-
-    for ( int i = 0 ; i < dataList.size() ; i++ ) {
-        switch ( state ) {
-            case STATE_NO_WOT:
-            if ( dataList[i]->getSensorR()->getThrottle() >= 80 ) {
-                if ( wot_end_time + 2000 > dataList[i]->getSensorR()->getTime() ) {
-                    //delta between two WOT events too small -> discard the 2. wot event
-                    //we have just a gear change here!
-                   state = STATE_WOT_FOUND;
-                } else {
-                    state = STATE_WOT_START;
-                    wot_start_time = dataList[i]->getSensorR()->getTime();
-                    wot_start_idx = i;
-                }
-            }
-            break;
-            case STATE_WOT_START:
-            if ( dataList[i]->getSensorR()->getThrottle() < 80 )
-                state = STATE_NO_WOT;
-            else {
-                if ( wot_start_time + 2000 < dataList[i]->getSensorR()->getTime()  ) {
-                    //2 secs wot
-                    state = STATE_WOT_FOUND;
-                    wotIdxL.append(wot_start_idx);
-                }
-            }
-            break;
-            case STATE_WOT_FOUND:
-            if ( dataList[i]->getSensorR()->getThrottle() < 80 ) {
-                state = STATE_NO_WOT;
-                wot_end_time = dataList[i]->getSensorR()->getTime();
-            }
-            break;
-        }
-    }
+    QList<int> wotIdxL = MdEventScan::wot ( source() );
 
     foreach ( int i, wotIdxL ) {
-        qDebug() << "WOT event @ " << dataList[i]->getSensorR()->getTime() << " RPM=" << dataList[i]->getSensorR()->getRpm() << " bosot=" << dataList[i]->getSensorR()->getBoost();
+        qDebug() << "WOT event @ " << record(i)->getSensorR()->getTime() << " RPM=" << record(i)->getSensorR()->getRpm() << " bosot=" << record(i)->getSensorR()->getBoost();
     }
     wotEventsDialog->show( wotIdxL );
 }
 
 QList<int> MdData::findKnock(bool showWindow) {
-    QList <int> knockIdxL;
-    #define STATE_NO_KNOCK 1
-    #define STATE_KNOCK 2
-    #define STATE_KNOCK_FOUND 3
-    quint8 state = STATE_NO_KNOCK;
-    int knock_start_time = 0;
-    int knock_end_time = 0;
-    int knock_idx = 0;
-    const qreal knock_threshold = 4;
-    qreal knock_max = 0;
-
-    for ( int i = 0 ; i < dataList.size() ; i++ ) {
-        switch ( state ) {
-            case STATE_NO_KNOCK:
-            if ( dataList[i]->getSensorR()->df_ignition_total_retard >= knock_threshold ) {
-                state = STATE_KNOCK;
-                knock_start_time = dataList[i]->getSensorR()->getTime();
-                knock_idx = i;
-                knock_max = dataList[i]->getSensorR()->df_ignition_total_retard;
-            }
-            break;
-            case STATE_KNOCK:
-            if ( dataList[i]->getSensorR()->df_ignition_total_retard < knock_threshold ) {
-                state = STATE_KNOCK_FOUND;
-
-            } else {
-                if ( knock_max < dataList[i]->getSensorR()->df_ignition_total_retard ) {
-                    knock_max = dataList[i]->getSensorR()->df_ignition_total_retard;
-                    knock_idx = i;
-                }
-            }
-            break;
-            case STATE_KNOCK_FOUND:
-            knockIdxL.append(knock_idx);
-            state = STATE_NO_KNOCK;
-            break;
-        }
-    }
+    QList<int> knockIdxL = MdEventScan::knock ( source() );
 
     foreach ( int i, knockIdxL ) {
-        qDebug() << "Knock event @ " << dataList[i]->getSensorR()->getTime()
-                 << " RPM=" << dataList[i]->getSensorR()->getRpm() << " boost="
-                 << dataList[i]->getSensorR()->getBoost();
+        qDebug() << "Knock event @ " << record(i)->getSensorR()->getTime()
+                 << " RPM=" << record(i)->getSensorR()->getRpm() << " boost="
+                 << record(i)->getSensorR()->getBoost();
     }
 
     if ( showWindow )
@@ -646,50 +522,13 @@ QList<int> MdData::findKnock(bool showWindow) {
 }
 
 QList<int> MdData::findHighEGT ( bool showWindow ) {
-    QList <int> egtIdxL;
-    #define STATE_LO 1
-    #define STATE_HIGH 2
-    #define STATE_HIGH_FOUND 3
-    quint8 state = STATE_LO;
-    int egt_time = 0;
-    int egt_start_time = 0;
-    int egt_idx = 0;
-    const qreal egt_threshold = 950;
-    qreal egt_max = 0;
-
-    for ( int i = 0 ; i < dataList.size() ; i++ ) {
-        switch ( state ) {
-            case STATE_LO:
-            if ( dataList[i]->getSensorR()->getHighestEgt()["temp"] >= egt_threshold ) {
-                state = STATE_HIGH;
-                egt_start_time = dataList[i]->getSensorR()->getTime();
-                egt_idx = i;
-                egt_max = dataList[i]->getSensorR()->getHighestEgt()["temp"];
-            }
-            break;
-            case STATE_HIGH:
-            if ( dataList[i]->getSensorR()->getHighestEgt()["temp"] < egt_threshold ) {
-                state = STATE_HIGH_FOUND;
-
-            } else {
-                if ( egt_max < dataList[i]->getSensorR()->getHighestEgt()["temp"] ) {
-                    egt_max = dataList[i]->getSensorR()->getHighestEgt()["temp"];
-                    egt_idx = i;
-                }
-            }
-            break;
-            case STATE_HIGH_FOUND:
-            egtIdxL.append(egt_idx);
-            state = STATE_LO;
-            break;
-        }
-    }
+    QList<int> egtIdxL = MdEventScan::highEgt ( source(), AppEngine::getInstance()->numConnectedTypeK );
 
     foreach ( int i, egtIdxL ) {
-        qDebug() << "High EGT event @ " << dataList[i]->getSensorR()->getTime() << " RPM="
-                 << dataList[i]->getSensorR()->getRpm() << " boost=" << dataList[i]->getSensorR()->getBoost()
-                 << " EGT=" << dataList[i]->getSensorR()->getHighestEgt()["temp"]
-                 << " ("<< dataList[i]->getSensorR()->getHighestEgt()["idx"] << ")";
+        qDebug() << "High EGT event @ " << record(i)->getSensorR()->getTime() << " RPM="
+                 << record(i)->getSensorR()->getRpm() << " boost=" << record(i)->getSensorR()->getBoost()
+                 << " EGT=" << record(i)->getSensorR()->getHighestEgt ( AppEngine::getInstance()->numConnectedTypeK )["temp"]
+                 << " ("<< record(i)->getSensorR()->getHighestEgt ( AppEngine::getInstance()->numConnectedTypeK )["idx"] << ")";
     }
     if ( showWindow )
         wotEventsDialog->showEGT ( egtIdxL );
@@ -698,51 +537,14 @@ QList<int> MdData::findHighEGT ( bool showWindow ) {
 }
 
 QList<int> MdData::findInjectorHighDC ( bool showWindow ) {
-    QList <int> dcIdxL;
-    #define STATE_LO 1
-    #define STATE_HIGH 2
-    #define STATE_HIGH_FOUND 3
-    quint8 state = STATE_LO;
-    int time = 0;
-    int start_time = 0;
-    int idx = 0;
-    const qreal dc_threshold = 90;
-    qreal max = 0;
-
-    for ( int i = 0 ; i < dataList.size() ; i++ ) {
-        switch ( state ) {
-            case STATE_LO:
-            if ( dataList[i]->getSensorR()->df_inj_duty >= dc_threshold ) {
-                state = STATE_HIGH;
-                start_time = dataList[i]->getSensorR()->getTime();
-                idx = i;
-                max = dataList[i]->getSensorR()->df_inj_duty;
-            }
-            break;
-            case STATE_HIGH:
-            if ( dataList[i]->getSensorR()->df_inj_duty < dc_threshold ) {
-                state = STATE_HIGH_FOUND;
-
-            } else {
-                if ( max < dataList[i]->getSensorR()->df_inj_duty ) {
-                    max = dataList[i]->getSensorR()->df_inj_duty;
-                    idx = i;
-                }
-            }
-            break;
-            case STATE_HIGH_FOUND:
-            dcIdxL.append(idx);
-            state = STATE_LO;
-            break;
-        }
-    }
+    QList<int> dcIdxL = MdEventScan::injectorHighDc ( source() );
 
     foreach ( int i, dcIdxL ) {
-        qDebug() << "High injector duty event " << dataList[i]->getSensorR()->df_inj_duty
-                 << " @ " << dataList[i]->getSensorR()->getTime() << " RPM="
-                 << dataList[i]->getSensorR()->getRpm() << " boost=" << dataList[i]->getSensorR()->getBoost()
-                 << " EGT=" << dataList[i]->getSensorR()->getHighestEgt()["temp"]
-                 << " ("<< dataList[i]->getSensorR()->getHighestEgt()["idx"] << ")";
+        qDebug() << "High injector duty event " << record(i)->getSensorR()->df_inj_duty
+                 << " @ " << record(i)->getSensorR()->getTime() << " RPM="
+                 << record(i)->getSensorR()->getRpm() << " boost=" << record(i)->getSensorR()->getBoost()
+                 << " EGT=" << record(i)->getSensorR()->getHighestEgt ( AppEngine::getInstance()->numConnectedTypeK )["temp"]
+                 << " ("<< record(i)->getSensorR()->getHighestEgt ( AppEngine::getInstance()->numConnectedTypeK )["idx"] << ")";
     }
 //    if ( showWindow )
 //        wotEventsDialog->show ( lcIdxL );
@@ -752,46 +554,10 @@ QList<int> MdData::findInjectorHighDC ( bool showWindow ) {
 
 
 QList<int> MdData::findLc ( bool showWindow ) {
-    QList <int> lcIdxL;
-    #define STATE_NO_LC 1
-    #define STATE_LC_START 2
-    #define STATE_LC_FOUND 3
-    quint8 state = STATE_NO_LC;
-    int lc_start_time = 0;
-    int lc_end_time = 0;
-    int lc_start_idx = 0;
-
-    for ( int i = 0 ; i < dataList.size() ; i++ ) {
-        switch ( state ) {
-            case STATE_NO_LC:
-            if ( (dataList.at(i)->getSensorR()->df_lc_flags & 3) == 1 ) {
-                state = STATE_LC_START;
-                lc_start_time = dataList[i]->getSensorR()->getTime();
-                lc_start_idx = i;
-            }
-            break;
-            case STATE_LC_START:
-            if (  ((dataList.at(i)->getSensorR()->df_lc_flags & 3) == 1) )
-                state = STATE_NO_LC;
-            else {
-                if ( lc_start_time + 1000 < dataList[i]->getSensorR()->getTime()  ) {
-                    //2 secs lc
-                    state = STATE_LC_FOUND;
-                    lcIdxL.append(lc_start_idx);
-                }
-            }
-            break;
-            case STATE_LC_FOUND:
-            if ( (dataList.at(i)->getSensorR()->df_lc_flags & 3) == 0 ) {
-                state = STATE_NO_LC;
-                lc_end_time = dataList[i]->getSensorR()->getTime();
-            }
-            break;
-        }
-    }
+    QList<int> lcIdxL = MdEventScan::lc ( source() );
 
     foreach ( int i, lcIdxL ) {
-        qDebug() << "LC event @ " << dataList[i]->getSensorR()->getTime() << " RPM=" << dataList[i]->getSensorR()->getRpm() << " boost=" << dataList[i]->getSensorR()->getBoost();
+        qDebug() << "LC event @ " << record(i)->getSensorR()->getTime() << " RPM=" << record(i)->getSensorR()->getRpm() << " boost=" << record(i)->getSensorR()->getBoost();
     }
     if ( showWindow )
             wotEventsDialog->show(lcIdxL);
@@ -800,7 +566,13 @@ QList<int> MdData::findLc ( bool showWindow ) {
 
 
 void MdData::checkData () {
-
+    //the detectors scan a source of their own in a job thread, the log keeps growing meanwhile
+    QString e;
+    MdChunkSource* src = threadSource (&e);
+    if ( !src ) {
+        QMessageBox::critical  ( NULL, QString("check failed"), e );
+        return;
+    }
 
     splash->show();
     splashLabel->setText("Analyzing data...");
@@ -810,10 +582,19 @@ void MdData::checkData () {
 
     progressBar->setMaximum(3);
     progressBar->setValue(0);
-    QCoreApplication::processEvents();
+
+    MdCheckJob* job = new MdCheckJob ( src, AppEngine::getInstance()->numConnectedTypeK );
+    JobRunnerThread* jobThread = new JobRunnerThread (NULL, job);
+    QEventLoop loop;
+    connect ( job, SIGNAL(progress(int)), progressBar, SLOT(setValue(int)) );
+    connect ( job, SIGNAL(jobFinished()), &loop, SLOT(quit()) );
+    jobThread->start();
+    loop.exec();
+    jobThread->quit();
+    delete jobThread;
 
     //egt
-    QList<int> egtL = findHighEGT( false );
+    QList<int> egtL = job->egtRows();
     QList<QVariant> egtVL;
     foreach ( int i, egtL ) {
         egtVL.append( QVariant(i));
@@ -825,11 +606,9 @@ void MdData::checkData () {
     edm["data"] = egtVL;
     edm["icon"] = QVariant("dialog-warning");
     p["EGT"] = edm;
-    progressBar->setValue(1);
-    QCoreApplication::processEvents();
 
     //knock
-    QList<int> knockL = findKnock( false );
+    QList<int> knockL = job->knockRows();
     QList<QVariant> knockVL;
     foreach ( int i, knockL ) {
         knockVL.append( QVariant(i));
@@ -840,23 +619,20 @@ void MdData::checkData () {
     km["data"] = knockVL;
     km["icon"] = QVariant("dialog-information");
     p["Knock"] = km;
-    progressBar->setValue(2);
-    QCoreApplication::processEvents();
 
-    QList<int> dcL = findInjectorHighDC( false );
+    QList<int> dcL = job->injectorDcRows();
     QList<QVariant> dcVL;
     foreach ( int i, dcL ) {
         dcVL.append( QVariant(i));
     }
     eventCount += dcL.size();
+    delete job;
 
     QMap<QString,QVariant> dcm;
 
     dcm["data"] = dcVL;
     dcm["icon"] = QVariant("dialog-warning");
     p["Inj duty cycle"] = dcm;
-    progressBar->setValue(3);
-    QCoreApplication::processEvents();
 
     if ( eventCount > 0 )
         wotEventsDialog->show ( p );
@@ -891,148 +667,146 @@ void MdData::saveData () {
         saveData ("/tmp/test");
 }
 
-bool MdData::saveDataCSV ( const QString& filename ) {
-        QFile file (filename);
-        if ( !file.open (QIODevice::WriteOnly | QIODevice::Truncate) )
-                return false;
-        QTextStream ts (&file);
-
-        //Header
-        bool first = true;
-        foreach (QString col, headerColNames) {
-            if ( first ) {
-                ts << col;
-                first = false;
-            } else
-                ts << "\t" << col;
-        }
-        ts << "\n";
-
-
-        for ( int r = 0 ; r < rowCount() ; ++r ) {
-            first = true;
-            for ( int c = 0 ; c < columnCount() ; ++c ) {
-                if ( first ) {
-                    ts << data(QAbstractItemModel::createIndex(r,c)).toString();
-                    first = false;
-                } else
-                    ts << "\t" << data(QAbstractItemModel::createIndex(r,c)).toString();
-            }
-            ts << "\n";
+bool MdData::saveDataCSV ( const QString& filename, const QList<int>& channels, qint32 from, qint32 to ) {
+        //straight from the channel values, the model display path is far too slow for big logs
+        MdCsvExporter exporter;
+        exporter.setChannels (channels);
+        exporter.setTimeRange (from, to);
+        bool ok = session ? exporter.exportSession ( session->fileName(), filename )
+                          : exporter.exportStore ( *store, filename );
+        if ( !ok ) {
+            emit showStatusMessage ("CSV export to " + filename + " failed: " + exporter.errorString() );
+            return false;
         }
-
-        file.close();
-        emit showStatusMessage ("CSV data exported to File " + filename);
+        emit showStatusMessage ("CSV data exported to File " + filename + " (" + QString::number(exporter.rowsWritten()) + " rows)");
         return true;
 }
 
 bool MdData::saveData ( const QString& filename, int begin, int end ) {
-        QFile file (filename);
-        if ( !file.open (QIODevice::WriteOnly | QIODevice::Truncate) )
-                return false;
-        QDataStream ds (&file);
-        ds.setVersion(QDataStream::Qt_4_6);
-        ds << MAGICNUMBER;
-        ds << VERSION4;
-
-        int l = 0;
+        if ( begin == 0 && end == 0 && journal && journalFirstRow == 0
+             && journal->dropped() == 0 && (int) journal->appended() == size() ) {
+            //the journal holds exactly the live data -> finish it instead of writing everything again
+            int rows = size();
+            if ( stopJournal (filename) ) {
+                emit showStatusMessage ("Data saved to File " + filename + " (" + QString::number(rows) + " rows)");
+                return true;
+            }
+        }
         if ( begin == 0 && end == 0 ) {
-            foreach ( MdDataRecord* dr, dataList ) {
-                    ds << dr;
-                    ++l;
+            end = size() - 1;
+        } else if ( !( begin < (size()-1) && (end <= size()-1) ) ) {
+            qDebug() << "saveData out of bounds begin=" << begin << " end=" << end;
+            return false;
+        }
+
+        if ( !legacySource.isEmpty() && QFileInfo(filename).suffix() == "mdv2" ) {
+            //cut the records out of the loaded file, nothing outside of the slice gets decoded
+            MdLegacyIndex index;
+            QString err;
+            if ( !index.open (legacySource) || index.rowCount() != size() )
+                err = "no valid index of " + legacySource;
+            else if ( index.slice (filename, begin, end, &err) ) {
+                emit showStatusMessage ("Data saved to File " + filename + " (" + QString::number(end - begin + 1) + " rows)");
+                return true;
             }
-        } else {
-            if ( begin < (dataList.size()-1) && (end <= dataList.size()-1) ) {
-                //save only selected rows
-                for ( int i=begin; i<= end ; i++ ) {
-                    ds << dataList[i];
-                }
-            } else {
-                qDebug() << "saveData out of bounds begin=" << begin << " end=" << end;
+            emit showStatusMessage ("Saving " + filename + " failed: " + err );
+            return false;
+        }
+
+        MdSessionWriter w (filename);
+        if ( !w.open() )
+                return false;
+        //the rows are chunked already, only the ends of the range are cut
+        MdChunkSource* src = source();
+        MdSessionColumns part;
+        bool ok = true;
+        for ( int ci = src->chunkForRow (begin) ; ok && ci >= 0 && ci < src->chunkCount() ; ci++ ) {
+            const MdSessionColumns* c = src->chunk (ci);
+            qint64 first = src->chunkFirstRow (ci);
+            if ( !c || first > end )
+                break;
+            int from = qMax ( (qint64) begin, first ) - first;
+            int to = qMin ( (qint64) end, first + c->rowCount() - 1 ) - first;
+            if ( from == 0 && to == c->rowCount() - 1 )
+                ok = w.appendChunk (*c);
+            else {
+                part.clear();
+                part.appendRows ( *c, from, to - from + 1 );
+                ok = w.appendChunk (part);
             }
         }
-        file.close();
-        emit showStatusMessage ("Data saved to File " + filename + " (" + QString::number(l) + " rows)");
+        if ( !w.close() || !ok ) {
+            emit showStatusMessage ("Saving " + filename + " failed: " + w.errorString() );
+            return false;
+        }
+        emit showStatusMessage ("Data saved to File " + filename + " (" + QString::number(w.rowCount()) + " rows)");
         return true;
 }
 
 bool MdData::loadData ( const QString& filename ) {
 	clearData ();
 
-	QFile file (filename);
-		if ( !file.open (QIODevice::ReadOnly) )
-			return false;
-	QDataStream ds (&file);
-	ds.setVersion(QDataStream::Qt_4_6);
-	quint32 magic, version;
-	ds >> magic;
-	ds >> version;
-
     int l = 0;
-	MdDataRecord* r = NULL;
-        Map16x1_Voltage vmap;
-
-        switch ( version ) {
-        case CVERSION1:
-            while ( !ds.atEnd() ) {
-                compatibility::MdDataRecordV1* rc = new compatibility::MdDataRecordV1();
-                ds >> rc;
-                r = rc;
-                if ( r ) {
-                    addDataRecord(r,false);
-                    ++l;
-                }
-            }
-            break;
-        case CVERSION3:
-            qDebug ("CVERSION3");
-            while ( !ds.atEnd() ) {
-                compatibility::MdDataRecordV2* rc = new compatibility::MdDataRecordV2();
-                ds >> rc;
-                r = rc;
-                r->getSensorR()->df_voltage = vmap.mapValue(r->getSensorR()->df_voltage_raw);
-                if ( r ) {
-                    addDataRecord(r,false);
-                    ++l;
-                }
-            }
-            break;
-        case VERSION4:
-            qDebug ("VERSION4");
-            while ( !ds.atEnd() ) {
-                r = new MdDataRecord();
-                ds >> r;
-                if ( r ) {
-                    addDataRecord(r,false);
-                    ++l;
-                }
-            }
-            break;
-        default:
-            QMessageBox::critical  ( NULL, QString("wrong file version"),
-                                     QString("load of incompatible file version ")  + QString::number(version) + QString(" attempted!") );
+    quint32 version = MdSessionFile::probeVersion (filename);
+
+    if ( version == VERSION5 ) {
+        //lazy: only header + chunk directory are read here, rows get decoded when they are shown
+        MdSessionCache* s = new MdSessionCache (filename);
+        if ( !s->open() ) {
+            QMessageBox::critical  ( NULL, QString("load failed"), s->errorString() );
+            delete s;
             return false;
         }
+        beginResetModel();
+        session = s;
+        endResetModel();
+        setPlotSource();
+        l = session->rowCount();
+        showSessionRows ( l - 1 );
+    } else {
+        //CVERSION1, CVERSION3, VERSION4
+        //decoded in a job thread, the GUI keeps running in the local event loop
+        MdLoadJob* job = new MdLoadJob (filename);
+        JobRunnerThread* jobThread = new JobRunnerThread (NULL, job);
+        QProgressDialog progress ( "Loading " + QFileInfo(filename).fileName() + "...", "Cancel", 0, 100, dataView );
+        progress.setWindowModality (Qt::WindowModal);
+        progress.setMinimumDuration (500);
+        QEventLoop loop;
+        connect ( job, SIGNAL(progress(int)), &progress, SLOT(setValue(int)) );
+        connect ( &progress, SIGNAL(canceled()), job, SLOT(cancel()), Qt::DirectConnection );
+        connect ( job, SIGNAL(jobFinished()), &loop, SLOT(quit()) );
+        jobThread->start();
+        loop.exec();
+        jobThread->quit();
+        delete jobThread;
+        progress.reset();
+
+        bool ok = job->isOk() && !job->isCancelled();
+        if ( !job->isOk() )
+            QMessageBox::critical  ( NULL, QString("wrong file version"), job->errorString() );
+        else if ( job->isCancelled() )
+            emit showStatusMessage ("Loading of " + filename + " cancelled");
+        else {
+            MdSessionStore* rows = job->takeStore();
+            l = rows->rowCount();
+            if ( l > 0 ) {
+                beginInsertRows ( QModelIndex(), 0, l - 1 );
+                delete store;
+                store = rows;
+                setPlotSource();
+                endInsertRows ();
+                legacySource = filename;
+                foreach ( MdPlot* p, plotList )
+                    p->showRows ( 0, l, false );
+                emit rtNewDataRecord ( store->record (l - 1) );
+            } else
+                delete rows;
+        }
+        delete job;
+        if ( !ok )
+            return false;
+    }
 
-
-//	while ( !ds.atEnd() ) {
-//		if ( version == VERSION ) {
-//			r = new MdDataRecord();
-//			ds >> r;
-//		} else if ( version == CVERSION1 ) {
-//			compatibility::MdDataRecordV1* rc = new compatibility::MdDataRecordV1();
-//			ds >> rc;
-//			r = rc;
-//		} else {
-//			QMessageBox::critical  ( NULL, QString("wrong file version"),
-//                                                 QString("load of incompatible file version ")  + QString::number(version) + QString(" attempted!") );
-//			return false;
-//		}
-//		if ( r ) {
-//			addDataRecord (r, false);
-//		}
-//	}
-	file.close();
 	replot();
 
     emit showStatusMessage ("Data loaded from File " + filename + " (" + QString::number(l) + " rows)");
@@ -1041,7 +815,9 @@ bool MdData::loadData ( const QString& filename ) {
     //disabled on mobile
     ;
 #else
-    checkData();
+    //a full scan would decode the whole session, use the "check" context menu entry instead
+    if ( !session )
+        checkData();
     dataView->resizeColumnsToContents();
 #endif
 
@@ -1053,22 +829,57 @@ void MdData::clearData () {
 		p->clear();
 	}
 
-    beginRemoveRows( QModelIndex(), 0, dataList.size()-1 );
-	foreach ( MdDataRecord* r , dataList )
-			delete (r);
-	dataList.clear();
-    endRemoveRows();
-}
+    //the data is dropped on purpose, so is its journal
+    if ( journal )
+        stopJournal ( QString(), true );
+
+    clearSessionSelection();
+    if ( session ) {
+        beginResetModel();
+        delete session;
+        session = NULL;
+        endResetModel();
+        setPlotSource();
+    }
 
-void MdData::addDataRecord (MdDataRecord *nr, bool doReplot) {
-	insertRows(dataList.size(), 1, QModelIndex());
-	dataList.push_back(nr);
+    beginRemoveRows( QModelIndex(), 0, store->rowCount()-1 );
+    store->clear();
+    endRemoveRows();
+    stopSpill();
+    legacySource.clear();
+}
+
+void MdData::addDataRecord (MdDataRecord *nr, bool doReplot, const quint8* frame, int frameVersion) {
+    //new data starts a new log, a loaded session is read only
+    if ( session )
+        clearData();
+    legacySource.clear();
+    if ( store->isEmpty() ) {
+        if ( !spill )
+            startSpill();
+        QSettings settings("MultiDisplay", "UI");
+        frameRows = settings.value("live/frame_rows", QVariant(true)).toBool();
+        store->setTypeK ( AppEngine::getInstance()->numConnectedTypeK );
+    }
+	insertRows(store->rowCount(), 1, QModelIndex());
+    if ( journalEnabled && !journal ) {
+        journalFirstRow = store->rowCount();
+        startJournal();
+    }
+    if ( frame && frameRows )
+        store->appendFrame ( frame, frameVersion, nr );
+    else
+        store->append (nr);
+    if ( journal )
+        journal->append (nr);
     if ( dataView ) {
 //        dataView->resizeRowsToContents();
 //        dataView->resizeColumnsToContents();
         ;
     }
 	visualizeDataRecord(nr, doReplot);
+    //the store has its own copy, the receivers of rtNewDataRecord are done with it
+    MdRecordPool::instance()->release (nr);
 }
 
 void MdData::checkMaxValues (MdDataRecord* nr) {
@@ -1084,7 +895,7 @@ void MdData::clearPlots() {
 
 int MdData::rowCount(const QModelIndex & parent) const {
 	Q_UNUSED(parent);
-	return dataList.size();
+    return source()->rowCount();
 }
 int MdData::columnCount(const QModelIndex & parent) const {
 	Q_UNUSED(parent);
@@ -1110,32 +921,38 @@ QVariant MdData::data(const QModelIndex & index, int role) const {
     if (!index.isValid())
         return QVariant();
 
-    if (index.row() >= (int) dataList.size())
+    if (index.row() >= rowCount())
         return QVariant();
 
+    //the channel behind the column, values are read typed from the columns of the row
+    const int ch = MdChannel::tableColumn (index.column()).channel;
+    MdRowCursor rc (source());
+
     if ( role == Qt::ToolTipRole ){
-        int r = dataList.size() - index.row() - 1;
+        int r = rowCount() - index.row() - 1;
         qDebug() << "toolTip col=" << index.column() << " row=" << index.row();
-        switch (index.column()) {
-            case 29: if ( dataList.at(r)->getColumn(index.column()).toDouble() > 0 ) {
+        switch (ch) {
+            case MdChannel::DfIgnitionTotalRetard: {
                 //knock
-                QString tip = "cyl retard: " + QString::number( dataList.at(r)->getSensorR()->df_cyl1_knock_retard * 0.351563, 'f', 1) + "|"
-                        + QString::number( dataList.at(r)->getSensorR()->df_cyl2_knock_retard * 0.351563, 'f', 1) + "|"
-                        + QString::number( dataList.at(r)->getSensorR()->df_cyl3_knock_retard * 0.351563, 'f', 1) + "|"
-                        + QString::number( dataList.at(r)->getSensorR()->df_cyl4_knock_retard * 0.351563, 'f', 1);
+                if ( rc.get<MdChannel::DfIgnitionTotalRetard> (r) <= 0 )
+                    break;
+                QString tip = "cyl retard: " + QString::number( rc.physical (MdChannel::DfCyl1KnockRetard, r), 'f', 1) + "|"
+                        + QString::number( rc.physical (MdChannel::DfCyl2KnockRetard, r), 'f', 1) + "|"
+                        + QString::number( rc.physical (MdChannel::DfCyl3KnockRetard, r), 'f', 1) + "|"
+                        + QString::number( rc.physical (MdChannel::DfCyl4KnockRetard, r), 'f', 1);
                 tip += "\n";
-                tip += "decay: " + QString::number( dataList.at(r)->getSensorR()->df_cyl1_knock_decay ) + "|"
-                        + QString::number( dataList.at(r)->getSensorR()->df_cyl2_knock_decay ) + "|"
-                        + QString::number( dataList.at(r)->getSensorR()->df_cyl3_knock_decay ) + "|"
-                        + QString::number( dataList.at(r)->getSensorR()->df_cyl4_knock_decay );
+                tip += "decay: " + QString::number( rc.get<MdChannel::DfCyl1KnockDecay> (r) ) + "|"
+                        + QString::number( rc.get<MdChannel::DfCyl2KnockDecay> (r) ) + "|"
+                        + QString::number( rc.get<MdChannel::DfCyl3KnockDecay> (r) ) + "|"
+                        + QString::number( rc.get<MdChannel::DfCyl4KnockDecay> (r) );
 
                 return QVariant(tip);
             }
-            case 0: {
+            case MdChannel::Time: {
                 //time
                 if ( index.row() > 1 ) {
-                    MdDataRecord *cur = dataList.at(r);
-                    MdDataRecord *last = dataList.at(r-1);
+                    MdDataRecord *cur = record(r);
+                    MdDataRecord *last = record(r-1);
                     //use gps data?
                     qreal start_velocity = last->getSensorR()->getSpeed();
                     qreal end_velocity = cur->getSensorR()->getSpeed();
@@ -1202,28 +1019,27 @@ QVariant MdData::data(const QModelIndex & index, int role) const {
                 break;
             }
 
-            case 1: {
-                //RPM
-                QString s = QString::number (dataList.at(r)->getSensorR()->df_rpm_delta_hall);
+            case MdChannel::Rpm: {
+                QString s = QString::number ( rc.get<MdChannel::DfRpmDeltaHall> (r) );
                 return QVariant ( s );
             }
             //DF lambda debug
-            case 43:  {
+            case MdChannel::DfLambda:  {
             /*
               df_cyl4_knock_decay = b_58_oxs_pause
               df_col
               */
-                QString res = "Lambda = " + QString::number( dataList.at(r)->getSensorR()->getLambda(), 'f', 2 ) + "\n";
-                res += "oxs_pause = " + QString::number( dataList.at(r)->getSensorR()->df_cyl4_knock_decay ) + "\n";
-                res += "oxs_P_timer " + QString::number( (qint8) dataList.at(r)->getSensorR()->df_cold_startup_enrichment)  + "\n";
-                res += "oxs_I_timer " + QString::number( (qint8) dataList.at(r)->getSensorR()->df_warm_startup_enrichment)  + "\n";
-                quint16 oxs_i_comp = (dataList.at(r)->getSensorR()->df_ect_enrichment << 8) + dataList.at(r)->getSensorR()->df_ect_injection_addon;
-                res += "oxs P = " + QString::number( (qint8) dataList.at(r)->getSensorR()->df_cyl2_knock_decay )  + "\n";
-                res += "oxs I = " + QString::number( (qint8) dataList.at(r)->getSensorR()->df_cyl3_knock_decay )  + "\n";
+                QString res = "Lambda = " + QString::number( record(r)->getSensorR()->getLambda(), 'f', 2 ) + "\n";
+                res += "oxs_pause = " + QString::number( record(r)->getSensorR()->df_cyl4_knock_decay ) + "\n";
+                res += "oxs_P_timer " + QString::number( (qint8) record(r)->getSensorR()->df_cold_startup_enrichment)  + "\n";
+                res += "oxs_I_timer " + QString::number( (qint8) record(r)->getSensorR()->df_warm_startup_enrichment)  + "\n";
+                quint16 oxs_i_comp = (record(r)->getSensorR()->df_ect_enrichment << 8) + record(r)->getSensorR()->df_ect_injection_addon;
+                res += "oxs P = " + QString::number( (qint8) record(r)->getSensorR()->df_cyl2_knock_decay )  + "\n";
+                res += "oxs I = " + QString::number( (qint8) record(r)->getSensorR()->df_cyl3_knock_decay )  + "\n";
                 res += "oxs I comp = " + QString::number( (qint16) oxs_i_comp )  + "\n";
 
                 res += "Flags = ";
-                quint8 oxs_state = (dataList.at(r)->getSensorR()->df_flags & 0x60) >> 5;
+                quint8 oxs_state = (record(r)->getSensorR()->df_flags & 0x60) >> 5;
                 QString oxs_state_str = QString::number( oxs_state ) + " | ";
                 if ( oxs_state == 0)
                     oxs_state_str += "LEAN";
@@ -1232,7 +1048,7 @@ QVariant MdData::data(const QModelIndex & index, int role) const {
                 if ( oxs_state == 3)
                     oxs_state_str += "STOICH";
                 res += oxs_state_str;
-                if ( ((dataList.at(r)->getSensorR()->df_flags) & 0x2) == 2 )
+                if ( ((record(r)->getSensorR()->df_flags) & 0x2) == 2 )
                     res += " | 2";
                 else
                     res += " | !2";
@@ -1248,167 +1064,145 @@ QVariant MdData::data(const QModelIndex & index, int role) const {
         return QVariant();
     }
     if (role == Qt::DisplayRole) {
-    	int r = dataList.size() - index.row() - 1;
+    	int r = rowCount() - index.row() - 1;
 
         if (r < 0)
             return QVariant();
 
-        //Time
-        if ( index.column() == 0 ) {
+        switch ( ch ) {
+        case MdChannel::Time: {
             QTime t = QTime(0, 0, 0, 0);
-            t = t.addMSecs( dataList.at(r)->getColumn(index.column()).toInt() );
+            t = t.addMSecs( rc.get<MdChannel::Time> (r) );
             return QVariant (t.toString("hh:mm:ss.zzz"));
         }
-        //Throttle
-        if ( index.column() == 3 ) {
-            QString res = dataList.at(r)->getColumn(index.column()).toString() + " | ";
-//            QString res = QString::number(dataList.at(r)->getSensorR()->df_cyl1_knock_decay) + " | ";
-            if ( dataList.at(r)->getSensorR()->df_flags & 8 )
+        case MdChannel::Throttle: {
+            QString res = QString::number ( rc.get<MdChannel::Throttle> (r) ) + " | ";
+            if ( rc.get<MdChannel::DfFlags> (r) & 8 )
                 res += "WOT";
-            else if ( dataList.at(r)->getSensorR()->df_flags & 0x10 )
+            else if ( rc.get<MdChannel::DfFlags> (r) & 0x10 )
                 res += "Idle";
             return QVariant(res);
         }
-        //speed
-        if ( index.column() == 22 ) {
-            QString res = dataList.at(r)->getColumn(index.column()).toString();
+        case MdChannel::Speed: {
+            QString res = QString::number ( rc.get<MdChannel::Speed> (r) );
             //compute delta
-            int last = dataList.size() - index.row() - 2;
+            int last = r - 1;
             if (  last >= 0 ) {
-                double speedDelta = dataList.at(r)->getSensorR()->getSpeed() - dataList.at(last)->getSensorR()->getSpeed();
+                double speedDelta = rc.get<MdChannel::Speed> (r) - rc.get<MdChannel::Speed> (last);
                 res += " (" + QString::number(speedDelta, 'f', 1) + ")";
+                double gpsSpeed = rc.get<MdChannel::GpsGroundSpeed> (r);
+                double gpsSpeedDelta = gpsSpeed - rc.get<MdChannel::GpsGroundSpeed> (last);
+                res += " ( " +  QString::number(gpsSpeed) + "/" + QString::number(gpsSpeedDelta, 'f', 1) + " / "  + QString::number( rc.get<MdChannel::GpsUpdateCount> (r) ) + " GPS)";
             }
-            if (  last >= 0 ) {
-                double gpsSpeedDelta = dataList.at(r)->getMobileR()->gpsGroundSpeed - dataList.at(last)->getMobileR()->gpsGroundSpeed;
-                res += " ( " +  QString::number(dataList.at(r)->getMobileR()->gpsGroundSpeed) + "/" + QString::number(gpsSpeedDelta, 'f', 1) + " / "  + QString::number(dataList.at(r)->getMobileR()->gpsUpdateCount) + " GPS)";
-            }
-
             return QVariant(res);
         }
         //df injection time
-        if ( index.column() == 30 ) {
-            qreal df_inj_time_ms = dataList.at(r)->getColumn(index.column()).toDouble() / 1000.0;
-
-            QString res = QString::number( df_inj_time_ms, 'f', 1 ) + " ms ";
-            res += QString::number( dataList.at(r)->getSensorR()->df_inj_duty, 'f', 1 ) + "%";
+        case MdChannel::DfInjTime: {
+            QString res = QString::number( rc.physical (MdChannel::DfInjTime, r), 'f', 1 ) + " ms ";
+            res += QString::number( MdEventScan::injectorDuty (rc, r), 'f', 1 ) + "%";
             return QVariant(res);
         }
-        //DF lambda
-        if ( index.column() == 43 ) {
-            QString res = dataList.at(r)->getColumn(index.column()).toString();
-            res += " " + QString::number( (qint8) dataList.at(r)->getSensorR()->df_cyl2_knock_decay );
-            res += " " + QString::number( (qint8) dataList.at(r)->getSensorR()->df_cyl3_knock_decay );
+        case MdChannel::DfLambda: {
+            QString res = QString::number ( rc.get<MdChannel::DfLambda> (r) );
+            res += " " + QString::number( (qint8) rc.get<MdChannel::DfCyl2KnockDecay> (r) );
+            res += " " + QString::number( (qint8) rc.get<MdChannel::DfCyl3KnockDecay> (r) );
             return QVariant(res);
         }
-        //LC Flags
-        if ( index.column() == 46 ) {
-            QString res = dataList.at(r)->getColumn(index.column()).toString();
-            if ( dataList.at(r)->getSensorR()->df_lc_flags & 32 )
+        case MdChannel::DfLcFlags: {
+            quint8 lc = rc.get<MdChannel::DfLcFlags> (r);
+            QString res = QString::number (lc);
+            if ( lc & 32 )
                 res += " | C";
 
-            if ( (dataList.at(r)->getSensorR()->df_lc_flags & 3) == 3)
+            if ( (lc & 3) == 3)
                 res += " | sWait";
             else {
-                if ( dataList.at(r)->getSensorR()->df_lc_flags & 1)
+                if ( lc & 1)
                     res += " | LC";
-                else if ( dataList.at(r)->getSensorR()->df_lc_flags & 4)
+                else if ( lc & 4)
                         res += " | WOTs";
             }
 
-            if ( dataList.at(r)->getSensorR()->df_lc_flags & 16 )
+            if ( lc & 16 )
                 res += " | K_off";
             return QVariant(res);
         }
-        //RPM test
-//        if ( index.column() == 1 ) {
-//            return dataList.at(r)->getColumn(index.column()).toString() + " | " + QString::number( rpmMap->mapValue( dataList.at(r)->getSensorR()->df_rpm_map ) );
-//        }
-        //VDO pressure mbar to bar
-        if ( index.column() == 16 || index.column() == 17 || index.column() == 18 ) {
-            return QVariant (dataList.at(r)->getColumn(index.column()).toDouble() / 1000);
-        }
-        //VDO temp
-//        if ( index.column() == 19 || index.column() == 20 || index.column() == 21 ) {
-//            return QVariant (dataList.at(r)->getColumn(index.column())) ;
-//        }
-
-        //DF ISV
-        if ( index.column() == 45 ) {
-            return QVariant (( 0x1a93 - ( (( isvMap->mapValue( dataList.at(r)->getColumn(index.column()).toInt() ) * 0xC7 ) / 16 ) + 0xA60 ) ) / 2 );
+        case MdChannel::DfIsv:
+            return QVariant (( 0x1a93 - ( (( isvMap->mapValue( rc.get<MdChannel::DfIsv> (r) ) * 0xC7 ) / 16 ) + 0xA60 ) ) / 2 );
+        case MdChannel::DfKlineFreq:
+            return QVariant ( QString::number( rc.get<MdChannel::DfKlineFreq> (r) ) + " / " + QString::number( rc.get<MdChannel::DfKlineFramenum> (r) ) );
+        case MdChannel::GpsLatitude:
+            //formatted when shown, the rows only hold the numbers
+            if ( rc.get<MdChannel::GpsTimestamp> (r) < 0 )
+                return QVariant();
+            return QVariant ( MdGpsFix::coordinateString ( rc.get<MdChannel::GpsLatitude> (r), rc.get<MdChannel::GpsLongitude> (r) ) );
+        case MdChannel::AccX:
+            return QVariant ( QString::number( rc.get<MdChannel::AccX> (r), 'f', 2 ) + " | "
+                              + QString::number( rc.get<MdChannel::AccY> (r), 'f', 2 ) + " | "
+                              + QString::number( rc.get<MdChannel::AccZ> (r), 'f', 2 ) );
         }
-        return dataList.at(r)->getColumn(index.column());
+        //stored value * scale of the channel (VDO pressure mbar -> bar, ..)
+        return QVariant ( rc.physical (ch, r) );
     }
 
     if (role == Qt::BackgroundColorRole) {
-        int r = dataList.size() - index.row() - 1;
-        switch ( index.column() ) {
-            case 3:
-            case 0: //time. mark it cyan to indicate throttle > 80%
-                    if ( dataList.at(r)->getColumn(3).toInt() > 80 )
+        int r = rowCount() - index.row() - 1;
+        switch ( ch ) {
+            case MdChannel::Throttle:
+            case MdChannel::Time: //time. mark it cyan to indicate throttle > 80%
+                    if ( rc.get<MdChannel::Throttle> (r) > 80 )
                         return QColor(Qt::cyan);
                     break;
-            case 1:
-                if ( index.column() == 1 ) {
-                    //RPM
-                    if ( dataList.at(r)->getSensorR()->df_flags & 8 ) {
+            case MdChannel::Rpm:
+                    if ( rc.get<MdChannel::DfFlags> (r) & 8 ) {
                         if ( r > 1 )
-                            if ( dataList.at(r-1)->getSensorR()->getRpm() >  dataList.at(r)->getSensorR()->getRpm() )
+                            if ( rc.get<MdChannel::Rpm> (r-1) > rc.get<MdChannel::Rpm> (r) )
                                 //should not happen on wot
                                 return QColor(Qt::red);
                     }
-                }
-                break;
-            case 4: //Lambda
-                    return lambdaBlend->overblend3( dataList.at(r)->getSensorR()->getLambda() );
                     break;
-                //EGT
-            case 7:
-            case 8:
-            case 9:
-            case 10:
-            case 11:
-            case 12:
-            case 13:
-            case 14:
-                        if ( dataList.at(r)->getColumn(index.column()).toDouble() == 0 )
-                            return QColor(Qt::white);
-                        if ( dataList.at(r)->getColumn(index.column()).toDouble() > 1600 )
-                            return QColor(Qt::white);
-                        return egtBlend->overblend3( dataList.at(r)->getColumn(index.column()).toDouble() );
-                        break;
-            case 27: //efr speed
-                        return efrBlend->overblend3( dataList.at(r)->getColumn(index.column()).toDouble() );
-                        break;
-            case 2: //boost
-                        return boostBlend->overblend3( dataList.at(r)->getColumn(index.column()).toDouble() );
-                        break;
-            case 29: //knock retard
-                        return knockBlend->overblend3( dataList.at(r)->getColumn(index.column()).toDouble() );
-                        break;
-            case 30: //df injection
-                    return injectorDutyBlend ->overblend3( dataList.at(r)->getSensorR()->df_inj_duty );
+            case MdChannel::Lambda:
+            case MdChannel::DfLambda:
+                    return lambdaBlend->overblend3( rc.get<MdChannel::Lambda> (r) );
+            case MdChannel::Egt0:
+            case MdChannel::Egt1:
+            case MdChannel::Egt2:
+            case MdChannel::Egt3:
+            case MdChannel::Egt4:
+            case MdChannel::Egt5:
+            case MdChannel::Egt6:
+            case MdChannel::Egt7: {
+                    double egt = rc.value<double> (ch, r);
+                    if ( egt == 0 || egt > 1600 )
+                        return QColor(Qt::white);
+                    return egtBlend->overblend3( egt );
+            }
+            case MdChannel::EfrSpeed:
+                    return efrBlend->overblend3( rc.get<MdChannel::EfrSpeed> (r) );
+            case MdChannel::Boost:
+                    return boostBlend->overblend3( rc.get<MdChannel::Boost> (r) );
+            case MdChannel::DfIgnitionTotalRetard:
+                    return knockBlend->overblend3( rc.get<MdChannel::DfIgnitionTotalRetard> (r) );
+            case MdChannel::DfInjTime:
+                    return injectorDutyBlend->overblend3( MdEventScan::injectorDuty (rc, r) );
+            case MdChannel::DfKnockRaw:
+                    return rawKnockBlend->overblend3( rc.get<MdChannel::DfKnockRaw> (r) );
+            case MdChannel::DfVoltage:
+            case MdChannel::Batcur: {
+                    double v = rc.value<double> (ch, r);
+                    if ( v < 8 )
+                        return QColor(Qt::white);
+                    return voltageBlend->overblend3( v );
+            }
+            case MdChannel::DfIat:
+                    return iatBlend->overblend3( rc.get<MdChannel::DfIat> (r) );
+            //GPS check if valid
+            case MdChannel::GpsLatitude:
+            case MdChannel::GpsGroundSpeed:
+            case MdChannel::GpsAltitude:
+                    if ( !rc.get<MdChannel::GpsValid> (r) )
+                        return QColor(Qt::red);
                     break;
-            case 33: //raw knock
-                        return rawKnockBlend->overblend3( dataList.at(r)->getColumn(index.column()).toDouble() );
-            case 40: //df voltage
-            case 15: //md voltage
-                        if ( dataList.at(r)->getColumn(index.column()).toDouble() < 8 )
-                            return QColor(Qt::white);
-                        return voltageBlend->overblend3( dataList.at(r)->getColumn(index.column()).toDouble() );
-                        break;
-            case 31: //df iat
-                        return iatBlend->overblend3( dataList.at(r)->getColumn(index.column()).toDouble() );
-                        break;
-                        //GPS check if valid
-            case 43: //df lambda
-                        return lambdaBlend->overblend3( dataList.at(r)->getSensorR()->getLambda() );
-                        break;
-            case 48:
-            case 49:
-            case 50:
-                if ( dataList.at(r)->getMobileR()->gpsValid == false )
-                    return QColor(Qt::red);
-                break;
         }
     }
 
@@ -1425,15 +1219,99 @@ bool MdData::insertRows(int position, int rows, const QModelIndex &parent) {
 
 
 bool MdData::removeRows ( int row, int count, const QModelIndex & parent ) {
-//    qDebug() << "MdData::removeRows row=" << row << " count=" << count << " dataList.size())=" << dataList.size() ;
+//    qDebug() << "MdData::removeRows row=" << row << " count=" << count << " store->rowCount()=" << store->rowCount() ;
     Q_UNUSED(parent);
     beginRemoveRows(QModelIndex(), row, row + count -1 );
-    for ( int i = row-1 ; i < row + count - 1 ; i++ )
-        dataList.removeAt(i);
+    store->removeRows ( row - 1, count );
     endRemoveRows();
+    //the journal still has the removed rows
+    journalFirstRow = -1;
+    legacySource.clear();
     return true;
 }
 
+void MdData::enableJournal () {
+    QSettings settings("MultiDisplay", "UI");
+    journalEnabled = settings.value("journal/enabled", QVariant(true)).toBool();
+}
+
+void MdData::disableJournal () {
+    //a running journal goes on until the data is saved or cleared
+    journalEnabled = false;
+}
+
+void MdData::closeJournal () {
+    if ( journal )
+        stopJournal ( QString() );
+}
+
+void MdData::startJournal () {
+    QSettings settings("MultiDisplay", "UI");
+    journal = new MdJournal ( MdJournal::newFileName(),
+                              settings.value("journal/sync_ms", QVariant(MdJournal::DEFAULT_SYNC_MILLIS)).toInt() );
+    journalThread = new JobRunnerThread ( this, journal );
+    journalThread->start();
+    qDebug() << "journal " << journal->fileName() << " first row " << journalFirstRow;
+}
+
+bool MdData::stopJournal ( const QString& target, bool discard ) {
+    if ( !journal )
+        return false;
+    //the job thread only has to write the last few records and the chunk directory
+    if ( discard )
+        QMetaObject::invokeMethod ( journal, "discard", Qt::BlockingQueuedConnection );
+    else
+        QMetaObject::invokeMethod ( journal, "finish", Qt::BlockingQueuedConnection, Q_ARG(QString, target) );
+    bool ok = journal->isOk();
+    if ( !ok )
+        qDebug() << "journal " << journal->fileName() << ": " << journal->errorString();
+    journalThread->quit();
+    delete journal;
+    delete journalThread;
+    journal = NULL;
+    journalThread = NULL;
+    return ok;
+}
+
+void MdData::startSpill () {
+    QSettings settings("MultiDisplay", "UI");
+#if  defined (Q_WS_MAEMO_5)  || defined (ANDROID)
+    int defaultMinutes = 30;
+#else
+    int defaultMinutes = 0;
+#endif
+    int minutes = settings.value("live/window_minutes", QVariant(defaultMinutes)).toInt();
+    if ( minutes <= 0 )
+        return;
+    liveWindowMillis = minutes * 60000;
+    //next to the journal, which is on storage and not in a small tmpfs
+    spill = new MdSpillFile ( MdSpillFile::newFileName ( MdJournal::directory() ) );
+    spillThread = new JobRunnerThread ( this, spill );
+    spillThread->start();
+    store->setSpill ( spill, liveWindowMillis );
+    qDebug() << "live window " << minutes << " min, spilling to " << spill->fileName();
+}
+
+void MdData::stopSpill () {
+    if ( !spill )
+        return;
+    //the job thread drops the queued chunks and removes the file, then the store may free them
+    QMetaObject::invokeMethod ( spill, "stop", Qt::BlockingQueuedConnection );
+    spillThread->quit();
+    store->setSpill ( NULL, 0 );
+    delete spill;
+    delete spillThread;
+    spill = NULL;
+    spillThread = NULL;
+}
+
+void MdData::visualizeRow (int i, bool doReplot) {
+    //the replayed rows are the rows of source(), see AppEngine::replayData
+    MdDataRecord* r = record(i);
+    if ( r )
+        visualizeDataRecord ( r, doReplot );
+}
+
 void MdData::visualizeDataRecord (MdDataRecord* nr, bool doReplot) {
     if ( nr->getSensorR() != NULL ) {
         boostPidPlot->addRecord(nr->getSensorR(), doReplot );
@@ -1451,12 +1329,85 @@ void MdData::visualizeDataRecord (MdDataRecord* nr, bool doReplot) {
 //	}
 }
 
-QList<MdDataRecord*> & MdData::getData() {
-	return dataList;
+void MdData::setPlotSource () {
+    foreach ( MdPlot* p, plotList )
+        p->setSource ( source() );
+}
+
+MdSessionStore* MdData::getStore() {
+	return store;
+}
+
+MdChunkSource* MdData::source () const {
+    if ( session )
+        return session;
+    return store;
+}
+
+MdChunkSource* MdData::threadSource ( QString* error ) {
+    if ( !session )
+        return store->snapshot();
+    //the cache of the GUI thread is not shared, a second one reads the same file
+    MdSessionCache* c = new MdSessionCache ( session->fileName() );
+    if ( !c->open() ) {
+        if ( error )
+            *error = c->errorString();
+        delete c;
+        return NULL;
+    }
+    return c;
 }
 
 int MdData::size() {
-	return dataList.size();
+    return source()->rowCount();
+}
+
+MdDataRecord* MdData::record ( int i ) const {
+    return source()->record(i);
+}
+
+void MdData::showSessionRows ( qint64 end ) {
+    if ( !session || session->rowCount() == 0 )
+        return;
+    if ( end >= session->rowCount() )
+        end = session->rowCount() - 1;
+    if ( end < 0 )
+        end = 0;
+    qint64 begin = qMax ( (qint64) 0, end - SESSION_PLOT_ROWS + 1 );
+
+    //the plots only hold a slice of the session, the slice is moved with the window mark
+    clearPlots();
+    //a wide window costs the same as a narrow one if it can be drawn from the pyramid
+    qint64 winBegin = qMax ( (qint64) 0, end - qMax ( (qint64) sessionWinSize, (qint64) SESSION_PLOT_ROWS ) + 1 );
+    bool visLod = visPlot->showSessionLod ( session, winBegin, end );
+    //only the rows in the plot windows get decoded when they are drawn
+    boostPidPlot->showRows ( begin, end - begin + 1, false );
+    if ( !visLod )
+        visPlot->showRows ( begin, end - begin + 1, false );
+    sessionPlotEnd = end;
+}
+
+void MdData::clearSessionSelection () {
+    sessionSelection->clear();
+}
+
+MdSessionStore* MdData::recordsForRows ( QList<int>& rows ) {
+    if ( !session || rows.isEmpty() )
+        return store;
+
+    //copy the selected rows, the cached chunks may be evicted while the dialogs are open
+    clearSessionSelection();
+    QList<int> mapped;
+    foreach ( int i, rows ) {
+        int ci = session->chunkForRow(i);
+        const MdSessionColumns* c = session->chunk(ci);
+        if ( !c )
+            continue;
+        mapped.append ( sessionSelection->rowCount() );
+        sessionSelection->append ( *c, i - session->chunkFirstRow(ci), 1 );
+    }
+    rows = mapped;
+    return sessionSelection;
 }
 
 void MdData::replot() {
@@ -1470,13 +1421,22 @@ VisualizationPlot* MdData::getVisPlot() {
 }
 
 int MdData::changeDataWinMarkToDisplayRecord (const int &element, const int &maxMark) {
-    double recordsPerMark = round ( (double) dataList.size() / (double) maxMark );
+    double recordsPerMark = round ( (double) size() / (double) maxMark );
     int nm = (int) ceil ( element / recordsPerMark);
     changeDataWinMark(nm, maxMark);
     return nm;
 }
 
 void MdData::changeDataWinMarkMicroRelative (const int &quotient, const bool &left, const int &maxMark) {
+    if ( session ) {
+        qint64 step = ( round ( (double) session->rowCount() / (double) maxMark) ) / quotient;
+        showSessionRows ( left ? sessionPlotEnd - step : sessionPlotEnd + step );
+        foreach ( MdPlot* p, plotList ) {
+            p->setWinMark(0, maxMark);
+            p->replot();
+        }
+        return;
+    }
 	foreach ( MdPlot* p, plotList ) {
 		p->setWinMarkMicroRelative(quotient, left, maxMark);
 		p->replot();
@@ -1485,6 +1445,16 @@ void MdData::changeDataWinMarkMicroRelative (const int &quotient, const bool &le
 
 void MdData::changeDataWinMark (const int &nm, const int &maxMark) {
 //        qDebug() << "changeDataWinMark new value=" << nm << " maxMark=" << maxMark;
+    if ( session ) {
+        //same mapping as MdPlotData::setWinMark: 0 is the newest record
+        qint64 mark = round ( (double) session->rowCount() / (double) maxMark ) * nm;
+        showSessionRows ( session->rowCount() - 1 - mark );
+        foreach ( MdPlot* p, plotList ) {
+            p->setWinMark(0, maxMark);
+            p->replot();
+        }
+        return;
+    }
 	foreach ( MdPlot* p, plotList ) {
 		p->setWinMark(nm ,maxMark);
 		p->replot();
@@ -1492,6 +1462,11 @@ void MdData::changeDataWinMark (const int &nm, const int &maxMark) {
 }
 void MdData::changeDataWinSize (const int &ns) {
 //	qDebug() << "changeDataWinSize new value=" << ns;
+    sessionWinSize = ns;
+    //every curve reads the window, its chunks have to stay decoded
+    store->setReadWindow (ns);
+    if ( session )
+        showSessionRows ( sessionPlotEnd );
 	foreach ( MdPlot* p, plotList ) {
 		p->setWinSize(ns);
 		p->replot();
@@ -1502,657 +1477,3 @@ void MdData::changeDataWinSize (const int &ns) {
 void MdData::toggleZoomMode() {
 	visPlot->toggleZoomMode();
 }
-
-
-
-
-MdSensorRecord::MdSensorRecord() {
-    efr_speed = 0;
-    knock = 0;
-    df_kline_framenum = 255;
-    df_kline_freq = 0;
-}
-
-MdSensorRecord::MdSensorRecord ( int time, int rpm, int throttle, double boost, double lambda, double lmm,
-                 double casetemp, double agt0, double agt1, double agt2, double agt3, double agt4,
-                 double agt5, double agt6, double agt7, double batcur,
-                 double VDOPres1, double VDOPres2, double VDOPres3,
-                 double VDOTemp1, double VDOTemp2, double VDOTemp3,
-                 double speed, int gear, int n75, double n75_req_boost, quint8 n75_req_boost_pwm, quint8 flags,
-                 double efr_speed,
-                 quint8 df_boost_raw, quint8 df_lambda, quint8 df_knock_raw, quint8 df_ect_raw, quint8 df_iat_raw,
-                 quint8 df_co_poti, quint8 df_flags, quint8 df_ign,
-                 quint8 df_cyl1_knock_retard, quint8 df_cyl1_knock_decay, quint8 df_cyl2_knock_retard,
-                 quint8 df_cyl2_knock_decay, quint8 df_cyl3_knock_retard, quint8 df_cyl3_knock_decay, quint8 df_cyl4_knock_retard,
-                 quint8 df_cyl4_knock_decay, quint8 df_voltage_raw, quint16 df_inj_time,
-                 quint8 df_cold_startup_enrichment, quint8 df_warm_startup_enrichment, quint8 df_ect_startup_enrichment,
-                 quint8 df_acceleration_enrichment, quint8 df_counter_startup_enrichment, quint8 df_iat_startup_enrichment,
-                 quint8 df_ignition_addon_counter, quint8 df_igniton_addon, quint8 df_ect_injection_addon,
-                 quint16 df_rpm_delta_hall, quint8 df_isv, quint8 df_lc_flags,
-                 double df_ignition_total_retard, double df_ect, double df_iat, double df_ignition, double df_voltage,
-                 quint16 knock, quint16 df_kline_freq, quint8 df_kline_framenum
-                 ) :
-          time(time), rpm(rpm), throttle(throttle), boost(boost), lambda(lambda), lmm(lmm), casetemp(casetemp),
-          batcur(batcur), VDOPres1(VDOPres1), VDOPres2(VDOPres2), VDOPres3(VDOPres3), VDOTemp1(VDOTemp1), VDOTemp2(VDOTemp2), VDOTemp3(VDOTemp3),
-          speed (speed), gear(gear), n75(n75), n75_req_boost(n75_req_boost), n75_req_boost_pwm(n75_req_boost_pwm), flags(flags),
-          efr_speed(efr_speed),
-          df_boost_raw(df_boost_raw), df_lambda(df_lambda), df_knock_raw(df_knock_raw), df_ect_raw(df_ect), df_iat_raw(df_iat), df_co_poti(df_co_poti), df_flags(df_flags), df_ign(df_ign),
-          df_cyl1_knock_retard(df_cyl1_knock_retard), df_cyl1_knock_decay(df_cyl1_knock_decay), df_cyl2_knock_retard(df_cyl2_knock_retard), df_cyl2_knock_decay(df_cyl2_knock_decay),
-          df_cyl3_knock_retard(df_cyl3_knock_retard), df_cyl3_knock_decay(df_cyl3_knock_decay), df_cyl4_knock_retard(df_cyl4_knock_retard), df_cyl4_knock_decay(df_cyl4_knock_decay),
-          df_voltage_raw(df_voltage_raw), df_inj_time(df_inj_time), df_cold_startup_enrichment(df_cold_startup_enrichment), df_warm_startup_enrichment(df_warm_startup_enrichment),
-          df_ect_enrichment(df_ect_startup_enrichment), df_acceleration_enrichment(df_acceleration_enrichment), df_counter_startup_enrichment(df_counter_startup_enrichment), df_iat_enrichment(df_iat_startup_enrichment),
-          df_ignition_addon_counter(df_ignition_addon_counter), df_igniton_addon(df_igniton_addon), df_ect_injection_addon(df_ect_injection_addon),
-          df_rpm_delta_hall(df_rpm_delta_hall),  df_isv(df_isv), df_lc_flags(df_lc_flags),
-          df_ignition_total_retard(df_ignition_total_retard), df_ect(df_ect), df_iat(df_iat), df_ignition(df_ignition), df_voltage(df_voltage),
-          knock (knock), df_kline_freq(df_kline_freq), df_kline_framenum(df_kline_framenum)
-
-{
-    egt[0]=agt0;
-    egt[1]=agt1;
-    egt[2]=agt2;
-    egt[3]=agt3;
-    egt[4]=agt4;
-    egt[5]=agt5;
-    egt[6]=agt6;
-    egt[7]=agt7;
-    df_inj_duty = 2* (( (df_inj_time / 1000.0) * rpm)/1200.0);
-}
-
-MdSensorRecord::MdSensorRecord ( const MdSensorRecord& d ) {
-    time = d.time;
-    rpm = d.rpm;
-    throttle = d.throttle;
-    boost = d.boost;
-    lambda = d.lambda;
-    lmm = d.lmm;
-    casetemp = d.casetemp;
-    egt[0] = d.egt[0];
-    egt[1] = d.egt[1];
-    egt[2] = d.egt[2];
-    egt[3] = d.egt[3];
-    egt[4] = d.egt[4];
-    egt[5] = d.egt[5];
-    egt[6] = d.egt[6];
-    egt[7] = d.egt[7];
-    batcur = d.batcur;
-    VDOPres1 = d.VDOPres1;
-    VDOPres2 = d.VDOPres2;
-    VDOPres3 = d.VDOPres3;
-    VDOTemp1 = d.VDOTemp1;
-    VDOTemp2 = d.VDOTemp2;
-    VDOTemp3 = d.VDOTemp3;
-    speed = d.speed;
-    gear = d.gear;
-    n75 = d.n75;
-    n75_req_boost = d.n75_req_boost;
-    n75_req_boost_pwm = d.n75_req_boost_pwm;
-    flags = d.flags;
-    efr_speed = d.efr_speed;
-    df_boost_raw = d.df_boost_raw;
-    df_lambda = d.df_lambda;
-    df_knock_raw = d.df_knock_raw;
-    df_ect_raw = d.df_ect_raw;
-    df_iat_raw = d.df_iat_raw;
-    df_co_poti = d.df_co_poti;
-    df_flags = d.df_flags;
-    df_ign = d.df_ign;
-    df_cyl1_knock_retard = d.df_cyl1_knock_retard;
-    df_cyl1_knock_decay = d.df_cyl1_knock_decay;
-    df_cyl2_knock_retard = d.df_cyl2_knock_retard;
-    df_cyl2_knock_decay = d.df_cyl2_knock_decay;
-    df_cyl3_knock_retard = d.df_cyl3_knock_retard;
-    df_cyl3_knock_decay = d.df_cyl3_knock_decay;
-    df_cyl4_knock_retard = d.df_cyl4_knock_retard;
-    df_cyl4_knock_decay = d.df_cyl4_knock_decay;
-    df_voltage_raw = d.df_voltage_raw;
-    df_inj_time = d.df_inj_time;
-    df_cold_startup_enrichment = d.df_cold_startup_enrichment;
-    df_warm_startup_enrichment = d.df_warm_startup_enrichment;
-    df_ect_enrichment = d.df_ect_enrichment;
-    df_acceleration_enrichment = d.df_acceleration_enrichment;
-    df_counter_startup_enrichment = d.df_counter_startup_enrichment;
-    df_iat_enrichment = d.df_iat_enrichment;
-    df_ignition_addon_counter = d.df_ignition_addon_counter;
-    df_igniton_addon = d.df_igniton_addon;
-    df_ect_injection_addon = d.df_ect_injection_addon;
-    df_rpm_delta_hall = d.df_rpm_delta_hall;
-    df_isv = d.df_isv;
-    df_lc_flags = d.df_lc_flags;
-    df_ignition_total_retard = d.df_ignition_total_retard;
-    df_ect = d.df_ect;
-    df_iat = d.df_iat;
-    df_ignition = d.df_ignition;
-    knock = d.knock;
-    df_kline_freq = d.df_kline_freq;
-    df_kline_framenum = d.df_kline_framenum;
-
-    //some computations
-    df_inj_duty = 2* (( (df_inj_time / 1000.0) * rpm)/1200.0);
-}
-
-MdSensorRecord::~MdSensorRecord() {
-}
-
-QDataStream& operator<< (QDataStream& s, MdSensorRecord *r) {
-    s << r->time;
-    s << r->rpm;
-    s << r->throttle;
-    s << r->boost;
-    s << r->lambda;
-    s << r->lmm;
-    s << r->casetemp;
-    s << r->egt[0];
-    s << r->egt[1];
-    s << r->egt[2];
-    s << r->egt[3];
-    s << r->egt[4];
-    s << r->egt[5];
-    s << r->egt[6];
-    s << r->egt[7];
-    s << r->batcur;
-    s << r->VDOPres1;
-    s << r->VDOPres2;
-    s << r->VDOPres3;
-    s << r->VDOTemp1;
-    s << r->VDOTemp2;
-    s << r->VDOTemp3;
-    s << r->speed;
-    s << r->gear;
-    s << r->n75;
-    s << r->n75_req_boost;
-    s << r->n75_req_boost_pwm;
-    s << r->flags;
-    s << r->efr_speed;
-
-    s << r->df_boost_raw;
-    s << r->df_lambda;
-    s << r->df_knock_raw;
-    s << r->df_ect_raw;
-    s << r->df_iat_raw;
-    s << r->df_co_poti;
-    s << r->df_flags;
-    s << r->df_ign;
-    s << r->df_cyl1_knock_retard;
-    s << r->df_cyl1_knock_decay;
-    s << r->df_cyl2_knock_retard;
-    s << r->df_cyl2_knock_decay;
-    s << r->df_cyl3_knock_retard;
-    s << r->df_cyl3_knock_decay;
-    s << r->df_cyl4_knock_retard;
-    s << r->df_cyl4_knock_decay;
-    s << r->df_voltage_raw;
-    s << r->df_inj_time;
-    s << r->df_cold_startup_enrichment;
-    s << r->df_warm_startup_enrichment;
-    s << r->df_ect_enrichment;
-    s << r->df_acceleration_enrichment;
-    s << r->df_counter_startup_enrichment;
-    s << r->df_iat_enrichment;
-    s << r->df_ignition_addon_counter;
-    s << r->df_igniton_addon;
-    s << r->df_ect_injection_addon;
-    s << r->df_rpm_delta_hall;
-    s << r->df_isv;
-    s << r->df_lc_flags;
-
-    s << r->df_ignition_total_retard;
-    s << r->df_ect;
-    s << r->df_iat;
-    s << r->df_ignition;
-    s << r->df_voltage;
-
-    s << r->knock;
-    s << r->df_kline_freq;
-    s << r->df_kline_framenum;
-
-    return s;
-}
-QDataStream& operator>> (QDataStream& s, MdSensorRecord *r) {
-    s >> r->time;
-    s >> r->rpm;
-    s >> r->throttle;
-    s >> r->boost;
-    s >> r->lambda;
-    s >> r->lmm;
-    s >> r->casetemp;
-    s >> r->egt[0];
-    s >> r->egt[1];
-    s >> r->egt[2];
-    s >> r->egt[3];
-    s >> r->egt[4];
-    s >> r->egt[5];
-    s >> r->egt[6];
-    s >> r->egt[7];
-    s >> r->batcur;
-    s >> r->VDOPres1;
-    s >> r->VDOPres2;
-    s >> r->VDOPres3;
-    s >> r->VDOTemp1;
-    s >> r->VDOTemp2;
-    s >> r->VDOTemp3;
-    s >> r->speed;
-    s >> r->gear;
-    s >> r->n75;
-    s >> r->n75_req_boost;
-    s >> r->n75_req_boost_pwm;
-    s >> r->flags;
-    s >> r->efr_speed;
-
-    s >> r->df_boost_raw;
-    s >> r->df_lambda;
-    s >> r->df_knock_raw;
-    s >> r->df_ect_raw;
-    s >> r->df_iat_raw;
-    s >> r->df_co_poti;
-    s >> r->df_flags;
-    s >> r->df_ign;
-    s >> r->df_cyl1_knock_retard;
-    s >> r->df_cyl1_knock_decay;
-    s >> r->df_cyl2_knock_retard;
-    s >> r->df_cyl2_knock_decay;
-    s >> r->df_cyl3_knock_retard;
-    s >> r->df_cyl3_knock_decay;
-    s >> r->df_cyl4_knock_retard;
-    s >> r->df_cyl4_knock_decay;
-    s >> r->df_voltage_raw;
-    s >> r->df_inj_time;
-    s >> r->df_cold_startup_enrichment;
-    s >> r->df_warm_startup_enrichment;
-    s >> r->df_ect_enrichment;
-    s >> r->df_acceleration_enrichment;
-    s >> r->df_counter_startup_enrichment;
-    s >> r->df_iat_enrichment;
-    s >> r->df_ignition_addon_counter;
-    s >> r->df_igniton_addon;
-    s >> r->df_ect_injection_addon;
-    s >> r->df_rpm_delta_hall;
-    s >> r->df_isv;
-    s >> r->df_lc_flags;
-
-    s >> r->df_ignition_total_retard;
-    s >> r->df_ect;
-    s >> r->df_iat;
-    s >> r->df_ignition;
-    s >> r->df_voltage;
-
-    s >> r->knock;
-    s >> r->df_kline_freq;
-    s >> r->df_kline_framenum;
-
-    //some computations
-    r->df_inj_duty = 2* (( (r->df_inj_time / 1000.0) * r->rpm)/1200.0);
-
-    return s;
-}
-
-double MdSensorRecord::getSpeed() const {
-        return speed;
-}
-int MdSensorRecord::getGear() const {
-        return gear;
-}
-int MdSensorRecord::getN75() const {
-        return n75;
-}
-double MdSensorRecord::getN75ReqBoost() {
-    return n75_req_boost;
-}
-quint8 MdSensorRecord::getN75ReqBoostPWM() {
-    return n75_req_boost_pwm;
-}
-quint8 MdSensorRecord::getFlags() {
-    return flags;
-}
-
-double MdSensorRecord::getVDOTemp1() const {
-    return VDOTemp1;
-}
-double MdSensorRecord::getVDOTemp2() const {
-	return VDOTemp2;
-}
-double MdSensorRecord::getVDOTemp3() const {
-	return VDOTemp3;
-}
-double MdSensorRecord::getVDOPres1() const {
-	return VDOPres1;
-}
-double MdSensorRecord::getVDOPres2() const {
-	return VDOPres2;
-}
-double MdSensorRecord::getVDOPres3() const {
-	return VDOPres3;
-}
-
-double MdSensorRecord::getEgt0() const {
-    return egt[0];
-}
-double MdSensorRecord::getEgt1() const {
-    return egt[1];
-}
-double MdSensorRecord::getEgt2() const {
-    return egt[2];
-}
-double MdSensorRecord::getEgt3() const {
-    return egt[3];
-}
-double MdSensorRecord::getEgt4() const {
-    return egt[4];
-}
-double MdSensorRecord::getEgt5() const {
-    return egt[5];
-}
-double MdSensorRecord::getEgt6() const {
-    return egt[6];
-}
-double MdSensorRecord::getEgt7() const {
-    return egt[7];
-}
-
-QMap<QString, double> MdSensorRecord::getHighestEgt() const {
-    QMap<QString, double> r;
-    double hv = -1;
-    quint8 idx = 0;
-    for ( int i = 0 ; i < AppEngine::getInstance()->numConnectedTypeK ; i++ ) {
-        if ( egt[i] > hv ) {
-            hv = egt[i];
-            idx = i;
-        }
-    }
-    r["temp"] = hv;
-    r["idx"] = idx;
-    return r;
-}
-
-double MdSensorRecord::getBatcur() const {
-    return batcur;
-}
-
-double MdSensorRecord::getBoost() const {
-    return boost;
-}
-
-double MdSensorRecord::getCasetemp() const {
-    return casetemp;
-}
-
-double MdSensorRecord::getLambda() const {
-    return lambda;
-}
-
-double MdSensorRecord::getLmm() const {
-    return lmm;
-}
-
-int MdSensorRecord::getRpm() const {
-    return rpm;
-}
-
-int MdSensorRecord:: getThrottle() const {
-    return throttle;
-}
-
-int MdSensorRecord::getTime() const {
-    return time;
-}
-
-void MdSensorRecord::setEgt0(double agt0) {
-    this->egt[0] = agt0;
-}
-
-void MdSensorRecord::setEgt1(double agt1) {
-    this->egt[1] = agt1;
-}
-void MdSensorRecord::setEgt2(double agt) {
-    this->egt[2] = agt;
-}
-void MdSensorRecord::setEgt3(double agt) {
-    this->egt[3] = agt;
-}
-void MdSensorRecord::setEgt4(double agt) {
-    this->egt[4] = agt;
-}
-void MdSensorRecord::setEgt5(double agt) {
-    this->egt[5] = agt;
-}
-void MdSensorRecord::setEgt6(double agt) {
-    this->egt[6] = agt;
-}
-void MdSensorRecord::setEgt7(double agt) {
-    this->egt[7] = agt;
-}
-
-void MdSensorRecord::setBatcur(double batcur) {
-    this->batcur = batcur;
-}
-
-void MdSensorRecord::setBoost(double boost) {
-    this->boost = boost;
-}
-
-void MdSensorRecord::setCasetemp(double casetemp) {
-    this->casetemp = casetemp;
-}
-
-void MdSensorRecord::setLambda(double lambda) {
-    this->lambda = lambda;
-}
-
-void MdSensorRecord::setLmm(double lmm) {
-    this->lmm = lmm;
-}
-
-void MdSensorRecord::setRpm(int rpm) {
-    this->rpm = rpm;
-}
-
-void MdSensorRecord::setThrottle(int throttle) {
-    this->throttle = throttle;
-}
-
-void MdSensorRecord::setTime(int time) {
-    this->time = time;
-}
-
-void MdSensorRecord::setSpeed(int s) {
-    this->speed = s;
-}
-void MdSensorRecord::setGear(int g) {
-    this->gear = g;
-}
-void MdSensorRecord::setN75(int n) {
-    this->n75 = n;
-}
-void MdSensorRecord::setN75ReqBoost (double b) {
-    this->n75_req_boost = b;
-}
-void MdSensorRecord::setN75ReqBoostPWM (quint8 p) {
-    this->n75_req_boost_pwm = p;
-}
-void MdSensorRecord::setFlags (quint8 f) {
-    this->flags = f;
-}
-
-
-QVariant MdSensorRecord::getColumn ( const int & column ) {
-	switch ( column ) {
-        case 0:
-            return time;
-        case 1:
-            return rpm;
-        case 2:
-            return boost;
-        case 3:
-            return throttle;
-        case 4:
-            return lambda;
-        case 5:
-            return lmm;
-        case 6:
-            return casetemp;
-        case 7:
-            return egt[0];
-        case 8:
-            return egt[1];
-        case 9:
-            return egt[2];
-        case 10:
-            return egt[3];
-        case 11:
-            return egt[4];
-        case 12:
-            return egt[5];
-        case 13:
-            return egt[6];
-        case 14:
-            return egt[7];
-        case 15:
-            return batcur;
-        case 16:
-            return VDOPres1;
-        case 17:
-            return VDOPres2;
-        case 18:
-            return VDOPres3;
-        case 19:
-            return VDOTemp1;
-        case 20:
-            return VDOTemp2;
-        case 21:
-            return VDOTemp3;
-        case 22:
-            return speed;
-        case 23:
-            return gear;
-        case 24:
-            return n75;
-        case 25:
-            return n75_req_boost;
-        case 26:
-            return n75_req_boost_pwm;
-        case 27:
-            return efr_speed;
-        case 28:
-            return df_ignition;
-        case 29:
-            return df_ignition_total_retard;
-        case 30:
-            return df_inj_time;
-        case 31:
-            return df_iat;
-        case 32:
-            return df_ect;
-        case 33:
-            return df_knock_raw ;
-        case 34:
-        // makes 0-250kpa
-        //    return (((5.0*(df_boost_raw/255.0))+0.2 ) / 0.02 ) ;
-            return df_boost_raw;
-        case 35:
-            return df_cold_startup_enrichment;
-        case 36:
-            return df_warm_startup_enrichment;
-        case 37:
-            return df_ect_enrichment;
-        case 38:
-            return df_iat_enrichment;
-        case 39:
-            return df_counter_startup_enrichment;
-        case 40:
-            return df_voltage;
-        case 41:
-            return df_acceleration_enrichment;
-        case 42:
-            return df_ect_injection_addon;
-        case 43:
-            return df_lambda;
-        case 44:
-            return df_co_poti;
-        case 45:
-            return df_isv;
-        case 46:
-            return df_lc_flags;
-        case 47:
-            return QString::number(df_kline_freq) + " / " + QString::number(df_kline_framenum);
-        //>=48 is data from smartphone in MobileSensorData
-
-        }
-	return QVariant();
-}
-
-
-MdDataRecord::MdDataRecord ( ) {
-	sensorR = new MdSensorRecord();
-    mobileR = new MobileSensorRecord();
-}
-MdDataRecord::MdDataRecord(MdSensorRecord *sr) : sensorR(sr)  {
-    mobileR = new MobileSensorRecord();
-
-#if defined ( Q_WS_MAEMO_5 )
-    Accelerometer* a = AppEngine::getInstance()->getAccelerometer();
-    MobileGPS* g = AppEngine::getInstance()->getGps();
-
-    if ( a ) {
-        mobileR->accX = a->x;
-        mobileR->accY = a->y;
-        mobileR->accZ = a->z;
-    }
-
-    if ( g ) {
-        mobileR->mdTimestamp = sr->getTime();
-        mobileR->gpsTimestamp = g->lastPos().timestamp();
-        mobileR->gpsCoordinateString = g->lastPos().coordinate().toString();
-        mobileR->gpsAltitude = g->lastPos().coordinate().altitude();
-        mobileR->gpsGroundSpeed = g->lastPos().attribute(QGeoPositionInfo::GroundSpeed);
-        mobileR->gpsDirection = g->lastPos().attribute(QGeoPositionInfo::Direction);
-        mobileR->gpsHorizontalAccuracy = g->lastPos().attribute(QGeoPositionInfo::HorizontalAccuracy);
-        mobileR->gpsVerticalAccuracy = g->lastPos().attribute(QGeoPositionInfo::VerticalAccuracy);
-        mobileR->gpsUpdateCount = g->updateCount();
-        mobileR->gpsValid = g->lastPos().isValid();
-        mobileR->millisElapsedSinceLastMdFrame = g->elapsedSinceLastMdFrame;
-    }
-#endif
-}
-
-MdDataRecord::~MdDataRecord ( ) {
-	if ( sensorR )
-		delete (sensorR);
-    if ( mobileR )
-        delete (mobileR);
-}
-
-MdSensorRecord* MdDataRecord::getSensorR() const {
-    return sensorR;
-}
-
-void MdDataRecord::setSensorR(MdSensorRecord *sensorR) {
-    this->sensorR = sensorR;
-}
-
-QVariant MdDataRecord::getColumn ( const int & column ) {
-    // colum count!
-    if ( column >= 0 && column <= 47 ) {
-        if ( sensorR )
-            return sensorR->getColumn ( column );
-    } else {
-        if ( mobileR )
-            return mobileR->getColumn (column);
-    }
-    return QVariant();
-}
-
-
-QDataStream& operator<< (QDataStream& s, MdDataRecord *d) {
-	s << d->sensorR;
-    s << d->mobileR;
-	return s;
-}
-QDataStream& operator>> (QDataStream& s, MdDataRecord *d) {
-	s >> d->sensorR;
-    //hack to be able to import old saved files which stored empty MdBoostPidRecords!
-//    MdBoostPidRecord *t = new MdBoostPidRecord ();
-//    s >> t;
-//    delete (t);
-    s >> d->mobileR;
-	return s;
-}
-
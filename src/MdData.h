@@ -20,13 +20,11 @@
 #ifndef MDDATA_H_
 #define MDDATA_H_
 
-#define MAX_ATTACHED_TYPK 8
-
 #include "ui_multidisplayuimainwindow.h"
 #include "ColorOverBlend.h"
 #include "Map16x1.h"
 #include "DataTableConfigDialog.h"
-#include "mobile/MobileSensorRecord.h"
+#include "MdDataRecord.h"
 
 #include <list>
 
@@ -64,198 +62,12 @@ class QTimer;
 class MaxDataSet;
 class V2PowerDialog;
 class WotEventsDialog;
-
-
-/**
-  * TODO:
-  * add mapped battery voltage
-  * add external knock
-  * add reserved bytes
-  */
-class MdSensorRecord {
-    friend QDataStream& operator<< (QDataStream& s, MdSensorRecord *r);
-    friend QDataStream& operator>> (QDataStream& s, MdSensorRecord *r);
-
-
-public:
-    MdSensorRecord ();
-    MdSensorRecord ( int time, int rpm, int throttle, double boost, double lambda, double lmm,
-                     double casetemp, double agt0, double agt1, double agt2, double agt3, double agt4,
-                     double agt5, double agt6, double agt7, double batcur,
-                     double VDOPres1, double VDOPres2, double VDOPres3,
-                     double VDOTemp1, double VDOTemp2, double VDOTemp3,
-                     double speed, int gear, int n75, double n75_req_boost, quint8 n75_req_boost_pwm, quint8 flags,
-                     double efr_speed,
-                     quint8 df_boost_raw, quint8 df_lambda, quint8 df_knock_raw, quint8 df_ect_raw, quint8 df_iat_raw,
-                     quint8 df_co_poti, quint8 df_flags, quint8 df_ign,
-                     quint8 df_cyl1_knock_retard, quint8 df_cyl1_knock_decay, quint8 df_cyl2_knock_retard,
-                     quint8 df_cyl2_knock_decay, quint8 df_cyl3_knock_retard, quint8 df_cyl3_knock_decay, quint8 df_cyl4_knock_retard,
-                     quint8 df_cyl4_knock_decay, quint8 df_voltage_raw, quint16 df_inj_time,
-                     quint8 df_cold_startup_enrichment, quint8 df_warm_startup_enrichment, quint8 df_ect_enrichment,
-                     quint8 df_acceleration_enrichment, quint8 df_counter_startup_enrichment, quint8 df_iat_enrichment,
-                     quint8 df_ignition_addon_counter, quint8 df_igniton_addon, quint8 df_ect_injection_addon, quint16 df_rpm_delta_hall,
-                     quint8 df_isv, quint8 df_lc_flags,
-                     double df_ignition_total_retard, double df_ect, double df_iat, double df_ignition, double df_voltage,
-                     quint16 knock, quint16 df_kline_freq, quint8 df_kline_framenum
-                     );
-    MdSensorRecord ( const MdSensorRecord& d );
-    virtual ~MdSensorRecord();
-
-    double getVDOTemp1() const;
-    double getVDOTemp2() const;
-    double getVDOTemp3() const;
-    double getVDOPres1() const;
-    double getVDOPres2() const;
-    double getVDOPres3() const;
-    double getEgt0() const;
-    double getEgt1() const;
-    double getEgt2() const;
-    double getEgt3() const;
-    double getEgt4() const;
-    double getEgt5() const;
-    double getEgt6() const;
-    double getEgt7() const;
-    //! returns the highest egt value (key name temp) and the idx of the typK (key name idx)
-    QMap<QString, double> getHighestEgt() const;
-    double getBatcur() const;
-    double getBoost() const;
-    double getCasetemp() const;
-    double getLambda() const;
-    double getLmm() const;
-    int getRpm() const;
-    int getThrottle() const;
-    int getTime() const;
-    double getSpeed() const;
-    int getGear() const;
-    int getN75() const;
-    double getN75ReqBoost();
-    quint8 getN75ReqBoostPWM();
-    quint8 getFlags();
-    void setEgt0(double agt);
-    void setEgt1(double agt);
-    void setEgt2(double agt);
-    void setEgt3(double agt);
-    void setEgt4(double agt);
-    void setEgt5(double agt);
-    void setEgt6(double agt);
-    void setEgt7(double agt);
-    void setBatcur(double batcur);
-    void setBoost(double boost);
-    void setCasetemp(double casetemp);
-    void setLambda(double lambda);
-    void setLmm(double lmm);
-    void setRpm(int rpm);
-    void setThrottle(int throttle);
-    void setTime(int time);
-    void setSpeed (int speed);
-    void setGear (int g);
-    void setN75 (int n);
-    void setN75ReqBoost (double b);
-    void setN75ReqBoostPWM (quint8 p);
-    void setFlags (quint8 f);
-
-    QVariant getColumn ( const int & column );
-
-protected:
-    int time;
-    int rpm;
-    int throttle;
-    double boost;
-    double lambda;
-    double lmm;
-    double casetemp;
-    double egt[MAX_ATTACHED_TYPK];
-    double batcur;
-    double VDOPres1;
-    double VDOPres2;
-    double VDOPres3;
-    double VDOTemp1;
-    double VDOTemp2;
-    double VDOTemp3;
-    double speed;
-    int gear;
-    int n75;
-    double n75_req_boost;
-    quint8 n75_req_boost_pwm;
-    quint8 flags;
-
-public:
-    double efr_speed;
-    quint16 df_kline_freq;
-    quint8 df_kline_framenum;
-
-    //HACK: make it public to save time
-    //ECU raw Data from Digifant I
-    quint8 df_boost_raw;
-    quint8 df_lambda;
-    quint8 df_knock_raw;
-    quint8 df_ect_raw;
-    quint8 df_iat_raw;
-    quint8 df_co_poti;
-    quint8 df_flags;
-    quint8 df_ign;
-    quint8 df_cyl1_knock_retard;
-    quint8 df_cyl1_knock_decay;
-    quint8 df_cyl2_knock_retard;
-    quint8 df_cyl2_knock_decay;
-    quint8 df_cyl3_knock_retard;
-    quint8 df_cyl3_knock_decay;
-    quint8 df_cyl4_knock_retard;
-    quint8 df_cyl4_knock_decay;
-    quint8 df_voltage_raw;
-    quint16 df_inj_time;
-    quint8 df_cold_startup_enrichment;
-    quint8 df_warm_startup_enrichment;
-    quint8 df_ect_enrichment;
-    quint8 df_acceleration_enrichment;
-    quint8 df_counter_startup_enrichment;
-    quint8 df_iat_enrichment;
-    quint8 df_ignition_addon_counter;
-    quint8 df_igniton_addon;
-    quint8 df_ect_injection_addon;
-    quint16 df_rpm_delta_hall;
-    quint8 df_isv;
-    quint8 df_lc_flags;
-
-    //mapped DF1 data
-    double df_ignition_total_retard;
-    double df_ect;
-    double df_iat;
-    double df_ignition;
-    double df_voltage;
-    double df_inj_duty;
-
-    //additional for phormula knock tool
-    quint16 knock;
-};
-
-QDataStream& operator<< (QDataStream& s, MdSensorRecord *r);
-QDataStream& operator>> (QDataStream& s, MdSensorRecord *r);
-
-
-class MdDataRecord {
-    friend QDataStream& operator<< (QDataStream& s, MdDataRecord *d);
-    friend QDataStream& operator>> (QDataStream& s, MdDataRecord *d);
-
-public:
-    MdDataRecord ( );
-    MdDataRecord ( MdSensorRecord *sr );
-    virtual ~MdDataRecord ( );
-
-    MobileSensorRecord *getMobileR() const { return mobileR; };
-    void setMobileR(MobileSensorRecord *mobileR) { if (mobileR) delete (mobileR); this->mobileR = mobileR; };
-
-    MdSensorRecord *getSensorR() const;
-    void setSensorR(MdSensorRecord *sensorR);
-
-    QVariant getColumn ( const int & column );
-
-protected:
-    MdSensorRecord *sensorR;
-    MobileSensorRecord *mobileR;
-};
-QDataStream& operator<< (QDataStream& s, MdDataRecord *d);
-QDataStream& operator>> (QDataStream& s, MdDataRecord *d);
+class MdSessionCache;
+class MdSessionStore;
+class MdChunkSource;
+class MdJournal;
+class MdSpillFile;
+class JobRunnerThread;
 
 
 //class RealTimeVis;
@@ -268,16 +80,31 @@ public:
             QTableView* dataView=NULL);
     virtual ~MdData();
 
-    void addDataRecord (MdDataRecord* nr, bool doReplot=true);
+    /**
+      * nr is copied into the store and goes back to MdRecordPool (or is deleted) after it was shown.
+      * frame: the MD2 frame nr was decoded from by a MdMd2Decoder of frameVersion,
+      * stored instead of the decoded channels (setting live/frame_rows)
+      */
+    void addDataRecord (MdDataRecord* nr, bool doReplot=true, const quint8* frame=NULL, int frameVersion=0);
     void checkMaxValues (MdDataRecord* nr);
 
-    //! attention, sensor or pid object can be NULL!
-    QList<MdDataRecord*>& getData ();
+    //! recorded / legacy rows, empty while a mdv3 session is opened lazily, use source() instead
+    MdSessionStore* getStore ();
+    //! the rows of the table: the session if one is opened, the store otherwise
+    MdChunkSource* source () const;
+    /**
+      * GUI thread: the rows of source() for another thread, a snapshot of the store or a
+      * second cache of the session file. the caller owns it, NULL if the file cannot be opened
+      */
+    MdChunkSource* threadSource ( QString* error );
 
     int size();
+    //! record i (oldest first). session records are recycled, do not keep the pointer!
+    MdDataRecord* record ( int i ) const;
 
     void saveData ();
-    bool saveDataCSV ( const QString& filename );
+    //! channels: MdChannel ids (all if empty), from / to: time range in msecs (to < 0: up to the end)
+    bool saveDataCSV ( const QString& filename, const QList<int>& channels = QList<int>(), qint32 from = 0, qint32 to = -1 );
     bool saveData ( const QString& filename, int begin=0, int end=0 );
     virtual bool loadData ( const QString& filename );
 
@@ -293,7 +120,9 @@ public:
     // 2010-07-20: file storage version 2 supports vdo
     // 2011-07-13: new binary protocol for MD version 2 (version 3)
     // 2013-04-23: new binary protocol for MD version 2 (version 4) including efr speed
-    enum { MAGICNUMBER = 0xFFAAFFAA, VERSION4 = 4, CVERSION3 = 3, CVERSION1 = 1 };
+    // 2026-10-17: columnar chunked session file mdv3 (version 5), see data/MdSessionFile.h
+    enum { MAGICNUMBER = MdFile::MAGICNUMBER, VERSION5 = MdFile::VERSION5, VERSION4 = MdFile::VERSION4,
+           CVERSION3 = MdFile::CVERSION3, CVERSION1 = MdFile::CVERSION1 };
 
     int rowCount ( const QModelIndex & parent = QModelIndex() ) const;
     int columnCount ( const QModelIndex & parent = QModelIndex() ) const;
@@ -314,6 +143,7 @@ public:
     QList<int> findKnock ( bool showWindow=true );
     QList<int> findHighEGT ( bool showWindow=true);
     QList<int> findInjectorHighDC ( bool showWindow=true);
+    //! egt, knock and injector duty events, scanned in a MdCheckJob thread
     void checkData ();
 
 
@@ -338,6 +168,14 @@ public slots:
 
     void clearPlots();
     void visualizeDataRecord (MdDataRecord* nr, bool doReplot=true);
+    //! visualizeDataRecord for row i of the store
+    void visualizeRow (int i, bool doReplot=true);
+
+    //! journal new records while the port is open (setting journal/enabled), see data/MdJournal.h
+    void enableJournal ();
+    void disableJournal ();
+    //! finish the journal in place, it is offered for recovery on the next start
+    void closeJournal ();
 
     //! helper for operations on selected cells; list is not sorted!
     QList<int> helperGetUniqueRows (QItemSelectionModel *select );
@@ -346,9 +184,54 @@ public slots:
     void showDataListIdx (int);
 
 private:
-
-    // make changes thread safe!
-    QList<MdDataRecord*> dataList;
+    //! fill the plots with the session rows up to end
+    void showSessionRows ( qint64 end );
+    //! the store or a copy of the given session rows for the analysis dialogs, rows are mapped to the copy
+    MdSessionStore* recordsForRows ( QList<int>& rows );
+    void clearSessionSelection ();
+
+    void startJournal ();
+    //! finish (rename to target) or discard the journal and end its thread
+    bool stopJournal ( const QString& target, bool discard=false );
+
+    /**
+      * bounded live mode (setting live/window_minutes, 0 = off): the store keeps the
+      * last minutes in memory and spills older chunks
+      */
+    void startSpill ();
+    //! ends the spill thread, only with a cleared store
+    void stopSpill ();
+
+    //! the plots read the rows of source(), call it whenever the source changes
+    void setPlotSource ();
+
+    //! rows of a lazily opened session shown by the plots
+    enum { SESSION_PLOT_ROWS = 8192 };
+
+    //! GUI thread only, other threads get a MdSessionStore::snapshot()
+    MdSessionStore* store;
+
+    //! lazily opened mdv3 file, NULL for recorded / legacy data
+    MdSessionCache* session;
+    qint64 sessionPlotEnd;
+    //! rows of the plot window, wider windows are drawn from the level of detail pyramid
+    int sessionWinSize;
+    MdSessionStore* sessionSelection;
+
+    MdJournal* journal;
+    JobRunnerThread* journalThread;
+    //! first store row in the journal, -1 if the rows were changed after journaling
+    int journalFirstRow;
+    bool journalEnabled;
+
+    MdSpillFile* spill;
+    JobRunnerThread* spillThread;
+    qint64 liveWindowMillis;
+    //! live rows are stored as MD2 frames, read at the start of a log
+    bool frameRows;
+
+    //! legacy file the unchanged store was loaded from, empty otherwise. mdv2 slices are cut from it
+    QString legacySource;
 
     QVector<QString> headerColNames;
 
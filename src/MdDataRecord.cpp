@@ -0,0 +1,566 @@
+/*
+    Copyright 2010-2012 Stephan Martin, Dominik Gummel
+
+    This file is part of Multidisplay.
+
+    Multidisplay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Multidisplay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Multidisplay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MdDataRecord.h"
+
+#if defined ( Q_WS_MAEMO_5 )
+#include "AppEngine.h"
+#include "mobile/Accelerometer.h"
+#include "mobile/MobileGPS.h"
+#endif
+
+MdSensorRecord::MdSensorRecord() {
+    efr_speed = 0;
+    knock = 0;
+    df_kline_framenum = 255;
+    df_kline_freq = 0;
+}
+
+MdSensorRecord::MdSensorRecord ( int time, int rpm, int throttle, double boost, double lambda, double lmm,
+                 double casetemp, double agt0, double agt1, double agt2, double agt3, double agt4,
+                 double agt5, double agt6, double agt7, double batcur,
+                 double VDOPres1, double VDOPres2, double VDOPres3,
+                 double VDOTemp1, double VDOTemp2, double VDOTemp3,
+                 double speed, int gear, int n75, double n75_req_boost, quint8 n75_req_boost_pwm, quint8 flags,
+                 double efr_speed,
+                 quint8 df_boost_raw, quint8 df_lambda, quint8 df_knock_raw, quint8 df_ect_raw, quint8 df_iat_raw,
+                 quint8 df_co_poti, quint8 df_flags, quint8 df_ign,
+                 quint8 df_cyl1_knock_retard, quint8 df_cyl1_knock_decay, quint8 df_cyl2_knock_retard,
+                 quint8 df_cyl2_knock_decay, quint8 df_cyl3_knock_retard, quint8 df_cyl3_knock_decay, quint8 df_cyl4_knock_retard,
+                 quint8 df_cyl4_knock_decay, quint8 df_voltage_raw, quint16 df_inj_time,
+                 quint8 df_cold_startup_enrichment, quint8 df_warm_startup_enrichment, quint8 df_ect_startup_enrichment,
+                 quint8 df_acceleration_enrichment, quint8 df_counter_startup_enrichment, quint8 df_iat_startup_enrichment,
+                 quint8 df_ignition_addon_counter, quint8 df_igniton_addon, quint8 df_ect_injection_addon,
+                 quint16 df_rpm_delta_hall, quint8 df_isv, quint8 df_lc_flags,
+                 double df_ignition_total_retard, double df_ect, double df_iat, double df_ignition, double df_voltage,
+                 quint16 knock, quint16 df_kline_freq, quint8 df_kline_framenum
+                 ) :
+          time(time), rpm(rpm), throttle(throttle), boost(boost), lambda(lambda), lmm(lmm), casetemp(casetemp),
+          batcur(batcur), VDOPres1(VDOPres1), VDOPres2(VDOPres2), VDOPres3(VDOPres3), VDOTemp1(VDOTemp1), VDOTemp2(VDOTemp2), VDOTemp3(VDOTemp3),
+          speed (speed), gear(gear), n75(n75), n75_req_boost(n75_req_boost), n75_req_boost_pwm(n75_req_boost_pwm), flags(flags),
+          efr_speed(efr_speed),
+          df_boost_raw(df_boost_raw), df_lambda(df_lambda), df_knock_raw(df_knock_raw), df_ect_raw(df_ect_raw), df_iat_raw(df_iat_raw), df_co_poti(df_co_poti), df_flags(df_flags), df_ign(df_ign),
+          df_cyl1_knock_retard(df_cyl1_knock_retard), df_cyl1_knock_decay(df_cyl1_knock_decay), df_cyl2_knock_retard(df_cyl2_knock_retard), df_cyl2_knock_decay(df_cyl2_knock_decay),
+          df_cyl3_knock_retard(df_cyl3_knock_retard), df_cyl3_knock_decay(df_cyl3_knock_decay), df_cyl4_knock_retard(df_cyl4_knock_retard), df_cyl4_knock_decay(df_cyl4_knock_decay),
+          df_voltage_raw(df_voltage_raw), df_inj_time(df_inj_time), df_cold_startup_enrichment(df_cold_startup_enrichment), df_warm_startup_enrichment(df_warm_startup_enrichment),
+          df_ect_enrichment(df_ect_startup_enrichment), df_acceleration_enrichment(df_acceleration_enrichment), df_counter_startup_enrichment(df_counter_startup_enrichment), df_iat_enrichment(df_iat_startup_enrichment),
+          df_ignition_addon_counter(df_ignition_addon_counter), df_igniton_addon(df_igniton_addon), df_ect_injection_addon(df_ect_injection_addon),
+          df_rpm_delta_hall(df_rpm_delta_hall),  df_isv(df_isv), df_lc_flags(df_lc_flags),
+          df_ignition_total_retard(df_ignition_total_retard), df_ect(df_ect), df_iat(df_iat), df_ignition(df_ignition), df_voltage(df_voltage),
+          knock (knock), df_kline_freq(df_kline_freq), df_kline_framenum(df_kline_framenum)
+
+{
+    egt[0]=agt0;
+    egt[1]=agt1;
+    egt[2]=agt2;
+    egt[3]=agt3;
+    egt[4]=agt4;
+    egt[5]=agt5;
+    egt[6]=agt6;
+    egt[7]=agt7;
+    df_inj_duty = 2* (( (df_inj_time / 1000.0) * rpm)/1200.0);
+}
+
+MdSensorRecord::MdSensorRecord ( const MdSensorRecord& d ) {
+    time = d.time;
+    rpm = d.rpm;
+    throttle = d.throttle;
+    boost = d.boost;
+    lambda = d.lambda;
+    lmm = d.lmm;
+    casetemp = d.casetemp;
+    egt[0] = d.egt[0];
+    egt[1] = d.egt[1];
+    egt[2] = d.egt[2];
+    egt[3] = d.egt[3];
+    egt[4] = d.egt[4];
+    egt[5] = d.egt[5];
+    egt[6] = d.egt[6];
+    egt[7] = d.egt[7];
+    batcur = d.batcur;
+    VDOPres1 = d.VDOPres1;
+    VDOPres2 = d.VDOPres2;
+    VDOPres3 = d.VDOPres3;
+    VDOTemp1 = d.VDOTemp1;
+    VDOTemp2 = d.VDOTemp2;
+    VDOTemp3 = d.VDOTemp3;
+    speed = d.speed;
+    gear = d.gear;
+    n75 = d.n75;
+    n75_req_boost = d.n75_req_boost;
+    n75_req_boost_pwm = d.n75_req_boost_pwm;
+    flags = d.flags;
+    efr_speed = d.efr_speed;
+    df_boost_raw = d.df_boost_raw;
+    df_lambda = d.df_lambda;
+    df_knock_raw = d.df_knock_raw;
+    df_ect_raw = d.df_ect_raw;
+    df_iat_raw = d.df_iat_raw;
+    df_co_poti = d.df_co_poti;
+    df_flags = d.df_flags;
+    df_ign = d.df_ign;
+    df_cyl1_knock_retard = d.df_cyl1_knock_retard;
+    df_cyl1_knock_decay = d.df_cyl1_knock_decay;
+    df_cyl2_knock_retard = d.df_cyl2_knock_retard;
+    df_cyl2_knock_decay = d.df_cyl2_knock_decay;
+    df_cyl3_knock_retard = d.df_cyl3_knock_retard;
+    df_cyl3_knock_decay = d.df_cyl3_knock_decay;
+    df_cyl4_knock_retard = d.df_cyl4_knock_retard;
+    df_cyl4_knock_decay = d.df_cyl4_knock_decay;
+    df_voltage_raw = d.df_voltage_raw;
+    df_inj_time = d.df_inj_time;
+    df_cold_startup_enrichment = d.df_cold_startup_enrichment;
+    df_warm_startup_enrichment = d.df_warm_startup_enrichment;
+    df_ect_enrichment = d.df_ect_enrichment;
+    df_acceleration_enrichment = d.df_acceleration_enrichment;
+    df_counter_startup_enrichment = d.df_counter_startup_enrichment;
+    df_iat_enrichment = d.df_iat_enrichment;
+    df_ignition_addon_counter = d.df_ignition_addon_counter;
+    df_igniton_addon = d.df_igniton_addon;
+    df_ect_injection_addon = d.df_ect_injection_addon;
+    df_rpm_delta_hall = d.df_rpm_delta_hall;
+    df_isv = d.df_isv;
+    df_lc_flags = d.df_lc_flags;
+    df_ignition_total_retard = d.df_ignition_total_retard;
+    df_ect = d.df_ect;
+    df_iat = d.df_iat;
+    df_ignition = d.df_ignition;
+    knock = d.knock;
+    df_kline_freq = d.df_kline_freq;
+    df_kline_framenum = d.df_kline_framenum;
+
+    //some computations
+    df_inj_duty = 2* (( (df_inj_time / 1000.0) * rpm)/1200.0);
+}
+
+MdSensorRecord::~MdSensorRecord() {
+}
+
+QDataStream& operator<< (QDataStream& s, MdSensorRecord *r) {
+    s << r->time;
+    s << r->rpm;
+    s << r->throttle;
+    s << r->boost;
+    s << r->lambda;
+    s << r->lmm;
+    s << r->casetemp;
+    s << r->egt[0];
+    s << r->egt[1];
+    s << r->egt[2];
+    s << r->egt[3];
+    s << r->egt[4];
+    s << r->egt[5];
+    s << r->egt[6];
+    s << r->egt[7];
+    s << r->batcur;
+    s << r->VDOPres1;
+    s << r->VDOPres2;
+    s << r->VDOPres3;
+    s << r->VDOTemp1;
+    s << r->VDOTemp2;
+    s << r->VDOTemp3;
+    s << r->speed;
+    s << r->gear;
+    s << r->n75;
+    s << r->n75_req_boost;
+    s << r->n75_req_boost_pwm;
+    s << r->flags;
+    s << r->efr_speed;
+
+    s << r->df_boost_raw;
+    s << r->df_lambda;
+    s << r->df_knock_raw;
+    s << r->df_ect_raw;
+    s << r->df_iat_raw;
+    s << r->df_co_poti;
+    s << r->df_flags;
+    s << r->df_ign;
+    s << r->df_cyl1_knock_retard;
+    s << r->df_cyl1_knock_decay;
+    s << r->df_cyl2_knock_retard;
+    s << r->df_cyl2_knock_decay;
+    s << r->df_cyl3_knock_retard;
+    s << r->df_cyl3_knock_decay;
+    s << r->df_cyl4_knock_retard;
+    s << r->df_cyl4_knock_decay;
+    s << r->df_voltage_raw;
+    s << r->df_inj_time;
+    s << r->df_cold_startup_enrichment;
+    s << r->df_warm_startup_enrichment;
+    s << r->df_ect_enrichment;
+    s << r->df_acceleration_enrichment;
+    s << r->df_counter_startup_enrichment;
+    s << r->df_iat_enrichment;
+    s << r->df_ignition_addon_counter;
+    s << r->df_igniton_addon;
+    s << r->df_ect_injection_addon;
+    s << r->df_rpm_delta_hall;
+    s << r->df_isv;
+    s << r->df_lc_flags;
+
+    s << r->df_ignition_total_retard;
+    s << r->df_ect;
+    s << r->df_iat;
+    s << r->df_ignition;
+    s << r->df_voltage;
+
+    s << r->knock;
+    s << r->df_kline_freq;
+    s << r->df_kline_framenum;
+
+    return s;
+}
+QDataStream& operator>> (QDataStream& s, MdSensorRecord *r) {
+    s >> r->time;
+    s >> r->rpm;
+    s >> r->throttle;
+    s >> r->boost;
+    s >> r->lambda;
+    s >> r->lmm;
+    s >> r->casetemp;
+    s >> r->egt[0];
+    s >> r->egt[1];
+    s >> r->egt[2];
+    s >> r->egt[3];
+    s >> r->egt[4];
+    s >> r->egt[5];
+    s >> r->egt[6];
+    s >> r->egt[7];
+    s >> r->batcur;
+    s >> r->VDOPres1;
+    s >> r->VDOPres2;
+    s >> r->VDOPres3;
+    s >> r->VDOTemp1;
+    s >> r->VDOTemp2;
+    s >> r->VDOTemp3;
+    s >> r->speed;
+    s >> r->gear;
+    s >> r->n75;
+    s >> r->n75_req_boost;
+    s >> r->n75_req_boost_pwm;
+    s >> r->flags;
+    s >> r->efr_speed;
+
+    s >> r->df_boost_raw;
+    s >> r->df_lambda;
+    s >> r->df_knock_raw;
+    s >> r->df_ect_raw;
+    s >> r->df_iat_raw;
+    s >> r->df_co_poti;
+    s >> r->df_flags;
+    s >> r->df_ign;
+    s >> r->df_cyl1_knock_retard;
+    s >> r->df_cyl1_knock_decay;
+    s >> r->df_cyl2_knock_retard;
+    s >> r->df_cyl2_knock_decay;
+    s >> r->df_cyl3_knock_retard;
+    s >> r->df_cyl3_knock_decay;
+    s >> r->df_cyl4_knock_retard;
+    s >> r->df_cyl4_knock_decay;
+    s >> r->df_voltage_raw;
+    s >> r->df_inj_time;
+    s >> r->df_cold_startup_enrichment;
+    s >> r->df_warm_startup_enrichment;
+    s >> r->df_ect_enrichment;
+    s >> r->df_acceleration_enrichment;
+    s >> r->df_counter_startup_enrichment;
+    s >> r->df_iat_enrichment;
+    s >> r->df_ignition_addon_counter;
+    s >> r->df_igniton_addon;
+    s >> r->df_ect_injection_addon;
+    s >> r->df_rpm_delta_hall;
+    s >> r->df_isv;
+    s >> r->df_lc_flags;
+
+    s >> r->df_ignition_total_retard;
+    s >> r->df_ect;
+    s >> r->df_iat;
+    s >> r->df_ignition;
+    s >> r->df_voltage;
+
+    s >> r->knock;
+    s >> r->df_kline_freq;
+    s >> r->df_kline_framenum;
+
+    //some computations
+    r->df_inj_duty = 2* (( (r->df_inj_time / 1000.0) * r->rpm)/1200.0);
+
+    return s;
+}
+
+double MdSensorRecord::getSpeed() const {
+        return speed;
+}
+int MdSensorRecord::getGear() const {
+        return gear;
+}
+int MdSensorRecord::getN75() const {
+        return n75;
+}
+double MdSensorRecord::getN75ReqBoost() const {
+    return n75_req_boost;
+}
+quint8 MdSensorRecord::getN75ReqBoostPWM() const {
+    return n75_req_boost_pwm;
+}
+quint8 MdSensorRecord::getFlags() const {
+    return flags;
+}
+
+double MdSensorRecord::getVDOTemp1() const {
+    return VDOTemp1;
+}
+double MdSensorRecord::getVDOTemp2() const {
+	return VDOTemp2;
+}
+double MdSensorRecord::getVDOTemp3() const {
+	return VDOTemp3;
+}
+double MdSensorRecord::getVDOPres1() const {
+	return VDOPres1;
+}
+double MdSensorRecord::getVDOPres2() const {
+	return VDOPres2;
+}
+double MdSensorRecord::getVDOPres3() const {
+	return VDOPres3;
+}
+
+double MdSensorRecord::getEgt0() const {
+    return egt[0];
+}
+double MdSensorRecord::getEgt1() const {
+    return egt[1];
+}
+double MdSensorRecord::getEgt2() const {
+    return egt[2];
+}
+double MdSensorRecord::getEgt3() const {
+    return egt[3];
+}
+double MdSensorRecord::getEgt4() const {
+    return egt[4];
+}
+double MdSensorRecord::getEgt5() const {
+    return egt[5];
+}
+double MdSensorRecord::getEgt6() const {
+    return egt[6];
+}
+double MdSensorRecord::getEgt7() const {
+    return egt[7];
+}
+
+QMap<QString, double> MdSensorRecord::getHighestEgt ( int typeK ) const {
+    QMap<QString, double> r;
+    double hv = -1;
+    quint8 idx = 0;
+    for ( int i = 0 ; i < qMin ( typeK, MAX_ATTACHED_TYPK ) ; i++ ) {
+        if ( egt[i] > hv ) {
+            hv = egt[i];
+            idx = i;
+        }
+    }
+    r["temp"] = hv;
+    r["idx"] = idx;
+    return r;
+}
+
+double MdSensorRecord::getBatcur() const {
+    return batcur;
+}
+
+double MdSensorRecord::getBoost() const {
+    return boost;
+}
+
+double MdSensorRecord::getCasetemp() const {
+    return casetemp;
+}
+
+double MdSensorRecord::getLambda() const {
+    return lambda;
+}
+
+double MdSensorRecord::getLmm() const {
+    return lmm;
+}
+
+int MdSensorRecord::getRpm() const {
+    return rpm;
+}
+
+int MdSensorRecord:: getThrottle() const {
+    return throttle;
+}
+
+int MdSensorRecord::getTime() const {
+    return time;
+}
+
+void MdSensorRecord::setEgt0(double agt0) {
+    this->egt[0] = agt0;
+}
+
+void MdSensorRecord::setEgt1(double agt1) {
+    this->egt[1] = agt1;
+}
+void MdSensorRecord::setEgt2(double agt) {
+    this->egt[2] = agt;
+}
+void MdSensorRecord::setEgt3(double agt) {
+    this->egt[3] = agt;
+}
+void MdSensorRecord::setEgt4(double agt) {
+    this->egt[4] = agt;
+}
+void MdSensorRecord::setEgt5(double agt) {
+    this->egt[5] = agt;
+}
+void MdSensorRecord::setEgt6(double agt) {
+    this->egt[6] = agt;
+}
+void MdSensorRecord::setEgt7(double agt) {
+    this->egt[7] = agt;
+}
+
+void MdSensorRecord::setBatcur(double batcur) {
+    this->batcur = batcur;
+}
+
+void MdSensorRecord::setBoost(double boost) {
+    this->boost = boost;
+}
+
+void MdSensorRecord::setCasetemp(double casetemp) {
+    this->casetemp = casetemp;
+}
+
+void MdSensorRecord::setLambda(double lambda) {
+    this->lambda = lambda;
+}
+
+void MdSensorRecord::setLmm(double lmm) {
+    this->lmm = lmm;
+}
+
+void MdSensorRecord::setRpm(int rpm) {
+    this->rpm = rpm;
+}
+
+void MdSensorRecord::setThrottle(int throttle) {
+    this->throttle = throttle;
+}
+
+void MdSensorRecord::setTime(int time) {
+    this->time = time;
+}
+
+void MdSensorRecord::setSpeed(int s) {
+    this->speed = s;
+}
+void MdSensorRecord::setGear(int g) {
+    this->gear = g;
+}
+void MdSensorRecord::setN75(int n) {
+    this->n75 = n;
+}
+void MdSensorRecord::setN75ReqBoost (double b) {
+    this->n75_req_boost = b;
+}
+void MdSensorRecord::setN75ReqBoostPWM (quint8 p) {
+    this->n75_req_boost_pwm = p;
+}
+void MdSensorRecord::setFlags (quint8 f) {
+    this->flags = f;
+}
+
+
+MdDataRecord::MdDataRecord ( ) {
+	sensorR = new MdSensorRecord();
+    mobileR = new MobileSensorRecord();
+}
+MdDataRecord::MdDataRecord(MdSensorRecord *sr) : sensorR(sr)  {
+    mobileR = new MobileSensorRecord();
+    assignMobileSensors();
+}
+
+void MdDataRecord::assignMobileSensors() {
+#if defined ( Q_WS_MAEMO_5 )
+    Accelerometer* a = AppEngine::getInstance()->getAccelerometer();
+    MobileGPS* g = AppEngine::getInstance()->getGps();
+
+    if ( a ) {
+        mobileR->accX = a->x;
+        mobileR->accY = a->y;
+        mobileR->accZ = a->z;
+    }
+
+    if ( g ) {
+        //numbers of the last fix, nothing is formatted per frame
+        const MdGpsFix& fix = g->lastFix();
+        mobileR->mdTimestamp = sensorR->getTime();
+        mobileR->gpsTimestamp = fix.timestamp;
+        if ( fix.isValid() ) {
+            mobileR->gpsLatitude = fix.latitude;
+            mobileR->gpsLongitude = fix.longitude;
+            mobileR->gpsAltitude = fix.altitude;
+            mobileR->gpsGroundSpeed = fix.groundSpeed;
+            mobileR->gpsDirection = fix.direction;
+            mobileR->gpsHorizontalAccuracy = fix.horizontalAccuracy;
+            mobileR->gpsVerticalAccuracy = fix.verticalAccuracy;
+        }
+        mobileR->gpsUpdateCount = g->updateCount();
+        mobileR->gpsValid = g->lastPos().isValid();
+        mobileR->millisElapsedSinceLastMdFrame = g->elapsedSinceLastMdFrame;
+    }
+#endif
+}
+
+MdDataRecord::~MdDataRecord ( ) {
+	if ( sensorR )
+		delete (sensorR);
+    if ( mobileR )
+        delete (mobileR);
+}
+
+MdSensorRecord* MdDataRecord::getSensorR() const {
+    return sensorR;
+}
+
+void MdDataRecord::setSensorR(MdSensorRecord *sensorR) {
+    this->sensorR = sensorR;
+}
+
+
+QDataStream& operator<< (QDataStream& s, MdDataRecord *d) {
+	s << d->sensorR;
+    s << d->mobileR;
+	return s;
+}
+QDataStream& operator>> (QDataStream& s, MdDataRecord *d) {
+	s >> d->sensorR;
+    //hack to be able to import old saved files which stored empty MdBoostPidRecords!
+//    MdBoostPidRecord *t = new MdBoostPidRecord ();
+//    s >> t;
+//    delete (t);
+    s >> d->mobileR;
+	return s;
+}
+
@@ -0,0 +1,230 @@
+/*
+    Copyright 2010-2012 Stephan Martin, Dominik Gummel
+
+    This file is part of Multidisplay.
+
+    Multidisplay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Multidisplay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Multidisplay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MDDATARECORD_H_
+#define MDDATARECORD_H_
+
+#define MAX_ATTACHED_TYPK 8
+
+#include "mobile/MobileSensorRecord.h"
+
+#include <QDataStream>
+#include <QVariant>
+#include <QMap>
+#include <QString>
+
+//! magic number and versions of the stored logs (see MdData::saveData)
+namespace MdFile {
+    enum { MAGICNUMBER = 0xFFAAFFAA, VERSION5 = 5, VERSION4 = 4, CVERSION3 = 3, CVERSION1 = 1 };
+}
+
+/**
+  * TODO:
+  * add mapped battery voltage
+  * add external knock
+  * add reserved bytes
+  */
+class MdSensorRecord {
+    friend QDataStream& operator<< (QDataStream& s, MdSensorRecord *r);
+    friend QDataStream& operator>> (QDataStream& s, MdSensorRecord *r);
+    friend class MdSessionColumns;
+    friend struct MdRecordField;
+
+
+public:
+    MdSensorRecord ();
+    MdSensorRecord ( int time, int rpm, int throttle, double boost, double lambda, double lmm,
+                     double casetemp, double agt0, double agt1, double agt2, double agt3, double agt4,
+                     double agt5, double agt6, double agt7, double batcur,
+                     double VDOPres1, double VDOPres2, double VDOPres3,
+                     double VDOTemp1, double VDOTemp2, double VDOTemp3,
+                     double speed, int gear, int n75, double n75_req_boost, quint8 n75_req_boost_pwm, quint8 flags,
+                     double efr_speed,
+                     quint8 df_boost_raw, quint8 df_lambda, quint8 df_knock_raw, quint8 df_ect_raw, quint8 df_iat_raw,
+                     quint8 df_co_poti, quint8 df_flags, quint8 df_ign,
+                     quint8 df_cyl1_knock_retard, quint8 df_cyl1_knock_decay, quint8 df_cyl2_knock_retard,
+                     quint8 df_cyl2_knock_decay, quint8 df_cyl3_knock_retard, quint8 df_cyl3_knock_decay, quint8 df_cyl4_knock_retard,
+                     quint8 df_cyl4_knock_decay, quint8 df_voltage_raw, quint16 df_inj_time,
+                     quint8 df_cold_startup_enrichment, quint8 df_warm_startup_enrichment, quint8 df_ect_enrichment,
+                     quint8 df_acceleration_enrichment, quint8 df_counter_startup_enrichment, quint8 df_iat_enrichment,
+                     quint8 df_ignition_addon_counter, quint8 df_igniton_addon, quint8 df_ect_injection_addon, quint16 df_rpm_delta_hall,
+                     quint8 df_isv, quint8 df_lc_flags,
+                     double df_ignition_total_retard, double df_ect, double df_iat, double df_ignition, double df_voltage,
+                     quint16 knock, quint16 df_kline_freq, quint8 df_kline_framenum
+                     );
+    MdSensorRecord ( const MdSensorRecord& d );
+    virtual ~MdSensorRecord();
+
+    double getVDOTemp1() const;
+    double getVDOTemp2() const;
+    double getVDOTemp3() const;
+    double getVDOPres1() const;
+    double getVDOPres2() const;
+    double getVDOPres3() const;
+    double getEgt0() const;
+    double getEgt1() const;
+    double getEgt2() const;
+    double getEgt3() const;
+    double getEgt4() const;
+    double getEgt5() const;
+    double getEgt6() const;
+    double getEgt7() const;
+    //! returns the highest egt value (key name temp) and the idx of the typK (key name idx) of the first typeK thermocouples
+    QMap<QString, double> getHighestEgt ( int typeK ) const;
+    double getBatcur() const;
+    double getBoost() const;
+    double getCasetemp() const;
+    double getLambda() const;
+    double getLmm() const;
+    int getRpm() const;
+    int getThrottle() const;
+    int getTime() const;
+    double getSpeed() const;
+    int getGear() const;
+    int getN75() const;
+    double getN75ReqBoost() const;
+    quint8 getN75ReqBoostPWM() const;
+    quint8 getFlags() const;
+    void setEgt0(double agt);
+    void setEgt1(double agt);
+    void setEgt2(double agt);
+    void setEgt3(double agt);
+    void setEgt4(double agt);
+    void setEgt5(double agt);
+    void setEgt6(double agt);
+    void setEgt7(double agt);
+    void setBatcur(double batcur);
+    void setBoost(double boost);
+    void setCasetemp(double casetemp);
+    void setLambda(double lambda);
+    void setLmm(double lmm);
+    void setRpm(int rpm);
+    void setThrottle(int throttle);
+    void setTime(int time);
+    void setSpeed (int speed);
+    void setGear (int g);
+    void setN75 (int n);
+    void setN75ReqBoost (double b);
+    void setN75ReqBoostPWM (quint8 p);
+    void setFlags (quint8 f);
+
+protected:
+    int time;
+    int rpm;
+    int throttle;
+    double boost;
+    double lambda;
+    double lmm;
+    double casetemp;
+    double egt[MAX_ATTACHED_TYPK];
+    double batcur;
+    double VDOPres1;
+    double VDOPres2;
+    double VDOPres3;
+    double VDOTemp1;
+    double VDOTemp2;
+    double VDOTemp3;
+    double speed;
+    int gear;
+    int n75;
+    double n75_req_boost;
+    quint8 n75_req_boost_pwm;
+    quint8 flags;
+
+public:
+    double efr_speed;
+    quint16 df_kline_freq;
+    quint8 df_kline_framenum;
+
+    //HACK: make it public to save time
+    //ECU raw Data from Digifant I
+    quint8 df_boost_raw;
+    quint8 df_lambda;
+    quint8 df_knock_raw;
+    quint8 df_ect_raw;
+    quint8 df_iat_raw;
+    quint8 df_co_poti;
+    quint8 df_flags;
+    quint8 df_ign;
+    quint8 df_cyl1_knock_retard;
+    quint8 df_cyl1_knock_decay;
+    quint8 df_cyl2_knock_retard;
+    quint8 df_cyl2_knock_decay;
+    quint8 df_cyl3_knock_retard;
+    quint8 df_cyl3_knock_decay;
+    quint8 df_cyl4_knock_retard;
+    quint8 df_cyl4_knock_decay;
+    quint8 df_voltage_raw;
+    quint16 df_inj_time;
+    quint8 df_cold_startup_enrichment;
+    quint8 df_warm_startup_enrichment;
+    quint8 df_ect_enrichment;
+    quint8 df_acceleration_enrichment;
+    quint8 df_counter_startup_enrichment;
+    quint8 df_iat_enrichment;
+    quint8 df_ignition_addon_counter;
+    quint8 df_igniton_addon;
+    quint8 df_ect_injection_addon;
+    quint16 df_rpm_delta_hall;
+    quint8 df_isv;
+    quint8 df_lc_flags;
+
+    //mapped DF1 data
+    double df_ignition_total_retard;
+    double df_ect;
+    double df_iat;
+    double df_ignition;
+    double df_voltage;
+    double df_inj_duty;
+
+    //additional for phormula knock tool
+    quint16 knock;
+};
+
+QDataStream& operator<< (QDataStream& s, MdSensorRecord *r);
+QDataStream& operator>> (QDataStream& s, MdSensorRecord *r);
+
+
+class MdDataRecord {
+    friend QDataStream& operator<< (QDataStream& s, MdDataRecord *d);
+    friend QDataStream& operator>> (QDataStream& s, MdDataRecord *d);
+
+public:
+    MdDataRecord ( );
+    MdDataRecord ( MdSensorRecord *sr );
+    virtual ~MdDataRecord ( );
+
+    MobileSensorRecord *getMobileR() const { return mobileR; };
+    void setMobileR(MobileSensorRecord *mobileR) { if (mobileR) delete (mobileR); this->mobileR = mobileR; };
+
+    MdSensorRecord *getSensorR() const;
+    void setSensorR(MdSensorRecord *sensorR);
+
+    //! copies the accelerometer and gps state into the mobile record (Maemo only)
+    void assignMobileSensors();
+
+protected:
+    MdSensorRecord *sensorR;
+    MobileSensorRecord *mobileR;
+};
+QDataStream& operator<< (QDataStream& s, MdDataRecord *d);
+QDataStream& operator>> (QDataStream& s, MdDataRecord *d);
+
+
+#endif /* MDDATARECORD_H_ */
@@ -20,7 +20,7 @@
 #ifndef MDDATARECORDV1_H_
 #define MDDATARECORDV1_H_
 
-#include "MdData.h"
+#include "MdDataRecord.h"
 
 namespace compatibility {
 
@@ -20,7 +20,7 @@
 #ifndef MdDataRecordV2_H_
 #define MdDataRecordV2_H_
 
-#include "MdData.h"
+#include "MdDataRecord.h"
 #include "Map16x1.h"
 
 namespace compatibility {
@@ -35,6 +35,7 @@
 #include <visconfigdialog.h>
 
 class MdPlotData;
+class MdChunkSource;
 class QwtPlotZoomer;
 class QwtPlotPicker;
 class QwtPlotPanner;
@@ -57,6 +58,10 @@ public:
 
     virtual void addRecord ( MdSensorRecord* r, bool doReplot=true ) = 0;
     virtual void clear () = 0;
+    //! plots drawing the rows directly (see MdChannelSeries) read them from src, NULL: no rows
+    virtual void setSource ( MdChunkSource* src ) { Q_UNUSED(src); }
+    //! shows count rows of the source starting at first
+    virtual void showRows ( qint64 first, qint64 count, bool doReplot=true ) { Q_UNUSED(first); Q_UNUSED(count); Q_UNUSED(doReplot); }
 
     virtual void setWinSize (const int &nws);
     virtual void setWinMark (const int &nwm, const int &maxMark=100);
@@ -33,15 +33,15 @@ iResultList::~iResultList () {
 }
 
 
-MdPlotData::MdPlotData (int windowMark, int windowSize) : cleanCounter(0), xRange(xRange), windowMark(windowMark), windowSize(windowSize), windowBegin(0), windowEnd(0) {
+MdPlotData::MdPlotData (int windowMark, int windowSize) : cleanCounter(0), xRange(xRange), windowMark(windowMark), windowSize(windowSize), windowBegin(0), windowEnd(0), reduced(false) {
     xData.clear();
 }
 
-MdPlotData::MdPlotData () : cleanCounter(0), xRange(0), windowMark(-1), windowSize(-1), windowBegin(0), windowEnd(0) {
+MdPlotData::MdPlotData () : cleanCounter(0), xRange(0), windowMark(-1), windowSize(-1), windowBegin(0), windowEnd(0), reduced(false) {
     xData.clear();
 }
 
-MdPlotData::MdPlotData(double xRange) : cleanCounter(0), xRange(xRange) {
+MdPlotData::MdPlotData(double xRange) : cleanCounter(0), xRange(xRange), reduced(false) {
     xData.clear();
 }
 
@@ -71,6 +71,26 @@ void MdPlotData::append (double x, double y) {
     //	}
 }
 
+void MdPlotData::append (const QVector<double>& x, const QVector<double>& y) {
+    xData += x;
+    yData += y;
+    adjustWindow();
+}
+
+void MdPlotData::setReduced (const QVector<double>& x, const QVector<double>& y) {
+    xData = x;
+    yData = y;
+    reduced = true;
+    adjustWindow();
+}
+
+void MdPlotSeries::reserve ( int rows, int curves ) {
+    x.reserve (rows);
+    y.resize (curves);
+    for ( int i = 0 ; i < curves ; i++ )
+        y[i].reserve (rows);
+}
+
 void MdPlotData::setWinSize(const int &nws) {
     windowSize = nws;
     adjustWindow();
@@ -78,14 +98,14 @@ void MdPlotData::setWinSize(const int &nws) {
 
 void MdPlotData::setWinMarkMicroRelative(const int &quotient, const bool &left, const int &maxMark) {
     //max is the beginning!
-    int step = ( round ( (double) xData.size() / (double) maxMark) ) / quotient;
+    int step = ( round ( (double) count() / (double) maxMark) ) / quotient;
     if ( left )
         windowMark += step;
     else
         windowMark -= step;
 
-    if ( windowMark >= xData.size() )
-        windowMark = xData.size() -1;
+    if ( windowMark >= count() )
+        windowMark = count() -1;
     else if ( windowMark <= 0 )
         windowMark = 0;
     adjustWindow();
@@ -93,9 +113,9 @@ void MdPlotData::setWinMarkMicroRelative(const int &quotient, const bool &left,
 
 void MdPlotData::setWinMark(const int &nwm, const int &maxMark) {
     //max is the beginning!
-    windowMark = ( round ( (double) xData.size() / (double) maxMark )  * nwm );
-    if ( windowMark >= xData.size() )
-        windowMark = xData.size() -1;
+    windowMark = ( round ( (double) count() / (double) maxMark )  * nwm );
+    if ( windowMark >= count() )
+        windowMark = count() -1;
 
 //    qDebug() << "nwm=" << nwm << " maxMark=" << maxMark << " windowMark=" << windowMark;
 
@@ -103,95 +123,76 @@ void MdPlotData::setWinMark(const int &nwm, const int &maxMark) {
 }
 
 bool MdPlotData::interpolateSearch ( const double xval, iResult &res ) {
-    if (xData.isEmpty())
+    if ( count() == 0 )
         return false;
-
-    res.x = xval;
-
-    int min = 0;
-    int max = xData.size() - 1;
-    int mid = 0;
-
-    while ( xData[mid]!=xval && min < max ) {
-        mid = (min + max) / 2;
-        if ( xval > xData[mid] )
-            min = mid + 1;
+    //first sample with x >= xval
+    int lb = 0;
+    int rb = count();
+    while ( lb < rb ) {
+        int mi = lb + (rb - lb) / 2;
+        if ( xAt(mi) < xval )
+            lb = mi + 1;
         else
-            max = mid - 1;
+            rb = mi;
     }
-    if ( xData[mid]==xval ) {
+    return interpolationResult ( lb, xval, res );
+}
+
+bool MdPlotData::interpolationResult ( int r, const double xval, iResult &res ) const {
+    res.x = xval;
+    if ( r < count() && xAt(r) == xval ) {
         res.needInterPolation = false;
-        res.l = mid;
-        res.r = mid;
-        //		qDebug() << "interpolateSearch found l=" << res.l << " r=" << res.r;
+        res.l = r;
+        res.r = r;
         return true;
-    } else if ( min == max ) {
-        res.needInterPolation = true;
-        if (xData[min]>xval) {
-            res.l = min-1;
-            res.r = min;
-        } else {
-            res.l = min;
-            res.r = min + 1;
-        }
-        //		qDebug() << "interpolateSearch found l=" << res.l << " r=" << res.r;
-
-        //boundary check
-        if ( res.r >= xData.size() ) {
-            res.r = xData.size()-1;
-            qDebug() << "interpolateSearch failed boundary check for r!";
-            return false;
-        } else if ( res.l < 0 ) {
-            res.l = 0;
-            qDebug() << "interpolateSearch failed boundary check for l!";
-            return false;
-        }
-        return true;
-    } else {
-        if (min < max)
-            qDebug() << "interpolateSearch case min < max: handle me";
-        if (min > max) {
-            res.l = max;
-            res.r = min;
-            //boundary check
-            if ( res.r >= xData.size() ) {
-                res.r = xData.size()-1;
-                qDebug() << "interpolateSearch failed boundary check for r!";
-                return false;
-            } else if ( res.l < 0 ) {
-                res.l = 0;
-                qDebug() << "interpolateSearch failed boundary check for l!";
-                return false;
-            }
-            return true;
-        }
     }
-    return false;
+    res.needInterPolation = true;
+    res.l = r - 1;
+    res.r = r;
+    //boundary check
+    if ( res.r >= count() ) {
+        res.r = count()-1;
+        qDebug() << "interpolateSearch failed boundary check for r!";
+        return false;
+    } else if ( res.l < 0 ) {
+        res.l = 0;
+        qDebug() << "interpolateSearch failed boundary check for l!";
+        return false;
+    }
+    return true;
 }
 
 double MdPlotData::getInterpolatedYValue ( int lindex, int rindex, double xval ) {
     //http://en.wikipedia.org/wiki/Linear_interpolation
-    if ( (lindex < 0) || (lindex >= xData.size()) || (rindex >= xData.size()) )
+    if ( (lindex < 0) || (lindex >= count()) || (rindex >= count()) )
         return 0;
-    double x0 = xData[lindex];
-    double y0 = yData[lindex];
-    double x1 = xData[rindex];
-    double y1 = yData[rindex];
+    if ( lindex == rindex )
+        return yAt(lindex);
+    double x0 = xAt(lindex);
+    double y0 = yAt(lindex);
+    double x1 = xAt(rindex);
+    double y1 = yAt(rindex);
     if ( x1-x0 < 0 )
         qDebug () << "lindex=" << lindex << " rindex=" << rindex << " x0=" << x0 << " x1=" << x1;
     return y0 + (xval - x0) * (y1-y0)/(x1-x0);
 }
 
 void MdPlotData::adjustWindow () {
-    windowEnd = xData.size() - 1 - windowMark;
+    if ( reduced ) {
+        windowBegin = 0;
+        windowEnd = qMax ( 0, count() - 1 );
+        return;
+    }
+    int n = count();
+    windowEnd = n - 1 - windowMark;
     if ( windowEnd < 0 ) {
-        windowEnd = xData.size() - 1;
+        windowEnd = n - 1;
         if ( windowEnd < 0 )
             windowEnd = 0;
     }
     windowBegin = windowEnd - windowSize;
     if ( windowBegin <= 0 ) {
-        if ( xData.size() > windowSize )
+        if ( n > windowSize )
             windowEnd = windowSize; //show at least the fill windowSize
         windowBegin = 0;
     }
@@ -202,29 +203,28 @@ void MdPlotData::adjustWindow () {
 
 double MdPlotData::x(size_t i) const {
     //	return xData[xData.size()-i-1];
-    if ( windowBegin + i < xData.size()-1 )
-        return xData[windowBegin + i];
+    if ( windowBegin + i < count()-1 )
+        return xAt (windowBegin + i);
     return -666.0;
 }
 
 QPointF MdPlotData::sample(size_t i) const {
     //	return yData[yData.size()-i-1];
-    if ( windowBegin + i < yData.size()-1 )
-        return QPointF (xData[windowBegin + i], yData[windowBegin + i]);
+    if ( windowBegin + i < count()-1 )
+        return QPointF (xAt (windowBegin + i), yAt (windowBegin + i));
     return QPointF (-666.0, -666);
 }
 
 void MdPlotData::cleanXLowerAs (double xDel) {
-    //XXX Hack. we should instead adjust begin / end of plottet data!!!
-    if ( xDel > 0 ){
-        int a = 0;
-        for ( int i = 0 ; i < xData.size() && xData[i]<xDel ; i++ ) {
-            xData.remove(i);
-            yData.remove(i);
-            a++;
-        }
-        qDebug() << "cleanXLowerAs: deleted " << a << " (xDel=" << xDel << ", cleanC=" << cleanCounter << " *(xData.end())=" << *(xData.end()) << " xRange=" << xRange;
-    }
+    //x is ascending, the old samples are at the front
+    int n = 0;
+    while ( n < xData.size() && xData[n] < xDel )
+        n++;
+    if ( n == 0 )
+        return;
+    xData.remove (0, n);
+    yData.remove (0, n);
+    adjustWindow();
 }
 
 void MdPlotData::clear () {
@@ -234,15 +234,16 @@ void MdPlotData::clear () {
     windowBegin=0;
     windowEnd=0;
     windowMark=0;
+    reduced=false;
     //        windowSize=0;
 }
 
 
 
 QRectF MdPlotData::boundingRect() const {
-    if ( xData.size() > 0 && windowEnd < xData.size() ) {
+    if ( count() > 0 && windowEnd < count() ) {
         //		qDebug() << "boundingRect() xData[windowBegin]=" << xData[windowBegin] << " xData[windowEnd]=" << xData[windowEnd];
-        return QRectF (xData[windowBegin], 0, xData[windowEnd] - xData[windowBegin], 0);
+        return QRectF (xAt(windowBegin), 0, xAt(windowEnd) - xAt(windowBegin), 0);
     }
     //	qDebug() << "empty boudingRect " << xData.size() << " " << windowEnd;
     //	return QwtDoubleRect ();
@@ -252,7 +253,7 @@ QRectF MdPlotData::boundingRect() const {
 
 
 size_t MdPlotData::size() const {
-    if ( windowSize < xData.size()-1 )
+    if ( !reduced && windowSize < count()-1 )
         return windowSize;
     return windowEnd - windowBegin;
 }
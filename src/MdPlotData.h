@@ -45,6 +45,19 @@ public:
 	QList<iResult*> resultList;
 };
 
+/**
+ * samples of several curves sharing their x values, e.g. a reduced series
+ * (see VisualizationPlot::showSessionLod) handed to the plot data at once
+ */
+class MdPlotSeries {
+public:
+	void reserve ( int rows, int curves );
+
+	QVector<double> x;
+	//! one vector per curve, same size as x
+	QVector< QVector<double> > y;
+};
+
 /**
  * holds the data for our plots
  *
@@ -71,15 +84,25 @@ public:
     void setY (size_t i, const double &val) { yData[i]=val; };
     QRectF 	boundingRect () const;
 	void append (double x, double y);
+	//! appends a whole series, the window is adjusted once
+	void append (const QVector<double>& x, const QVector<double>& y);
+	/**
+	 * replaces the samples by an already reduced series (min / max buckets, see
+	 * data/MdLodPyramid.h). all of it is shown until the next clear()
+	 */
+	void setReduced (const QVector<double>& x, const QVector<double>& y);
+	bool isReduced () const { return reduced; }
+	//! drops the samples with x < xDel
 	void cleanXLowerAs (double xDel);
-	void clear ();
+	virtual void clear ();
 	//! new window size in seconds!
 	void setWinSize(const int &nws);
         //! window mark in per cent: 0% is the newest record!
 	void setWinMark(const int &nwm, const int &maxMark);
 	void setWinMarkMicroRelative(const int &quotient, const bool &left, const int &maxMark);
 
-	bool interpolateSearch ( const double xval, iResult &res );
+	//! samples around xval (x ascending), false if xval is outside of the samples
+	virtual bool interpolateSearch ( const double xval, iResult &res );
 	double getInterpolatedYValue ( int lindex, int rindex, double xval );
 
     int getWindowBegin();
@@ -87,8 +110,14 @@ public:
     QVector<double> x() const ;
     QVector<double> y() const ;
 
-private:
+protected:
+	//! number of samples, the window is a range of them. the default are the vectors below
+	virtual int count () const { return xData.size(); }
+	virtual double xAt ( int i ) const { return xData[i]; }
+	virtual double yAt ( int i ) const { return yData[i]; }
 	void adjustWindow ();
+	//! fills res from r, the first sample with x >= xval
+	bool interpolationResult ( int r, const double xval, iResult &res ) const;
 
 
 	QVector<double> xData;
@@ -105,6 +134,9 @@ private:
 	int windowBegin;
 	//! end point of plotted data (higher vector index)
 	int windowEnd;
+
+	//! samples are a reduced series, the window is ignored
+	bool reduced;
 };
 
 #endif /* MDPLOTDATA_H_ */
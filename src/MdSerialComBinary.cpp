@@ -1,6 +1,6 @@
 #include "MdSerialComBinary.h"
 #include "MdData.h"
-#include "Map16x1.h"
+#include "com/MdMd2Decoder.h"
 #include "qextserialport.h"
 #include <QDebug>
 #include <AppEngine.h>
@@ -19,13 +19,9 @@ MdSerialComBinary::MdSerialComBinary(MdData *data) :
 {
     sdata = new QByteArray();
     sdata->resize(MD_MAXFRAME_SIZE);
-    dfEctMap = new Map16x1_NTC_ECT();
-    dfIatMap = new Map16x1_NTC_IAT();
-    dfVoltageMap = new Map16x1_Voltage();
+    md2Decoder = new MdMd2Decoder();
     timeHelper = QTime::currentTime();
     timeHelper.start();
-    freqMeasure = QTime::currentTime();
-    freqMeasure.start();
 
     QSettings settings("MultiDisplay", "UI");
     if ( settings.value("debug/generate_data", QVariant(false)).toBool() ) {
@@ -38,10 +34,7 @@ MdSerialComBinary::MdSerialComBinary(MdData *data) :
 }
 
 MdSerialComBinary::~MdSerialComBinary() {
-    if ( dfEctMap )
-        delete ( dfEctMap );
-    if ( dfIatMap )
-        delete ( dfIatMap );
+    delete md2Decoder;
 }
 
 void MdSerialComBinary::onReadyRead() {
@@ -239,192 +232,14 @@ void MdSerialComBinary::convertGearBoxFrame() {
 }
 
 void MdSerialComBinary::convertReceivedMd2Frame() {
-    int millisElapsed = freqMeasure.restart();
-
-    int base = 2;
-
-    quint32 time = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) + (rcvData.asBytes[base+2] << 16) + (rcvData.asBytes[base+3] << 24);
-    base += 4;
-
-    quint16 rpm = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-
-    //absolute boost!
-    double  boost = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) ) - 1;
-    base +=2;       
-
-    quint8 throttle = rcvData.asBytes[base+0];
-    base +=1;
-
-
-    double  lambda = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-
-    double  lmm = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-
-    double  casetemp = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-
-    quint16 egt0 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt1 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt2 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt3 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt4 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt5 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt6 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt7 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-
-    double  batVolt = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-
-    //FIXME pressure / temp ints???
-    quint16 vdo_pres1 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 vdo_pres2 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 vdo_pres3 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 vdo_temp1 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 vdo_temp2 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 vdo_temp3 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-
-    //quint16 speed = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    double  speed = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-
-    quint8 gear = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 n75 = rcvData.asBytes[base+0];
-    base +=1;
-    double  n75_req_boost = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-    quint8 n75_req_boost_pwm = rcvData.asBytes[base+0];
-    base++;
-    quint8 flags = rcvData.asBytes[base+0];
-    base +=1;
-    double efr_speed_tmp = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    double efr_speed = 0;
-    if ( efr_speed_tmp == 0xFFFF )
-            efr_speed = 0;
-        else
-            efr_speed = 40000000 / (efr_speed_tmp);
-
-    base +=2;
-    double knock = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-
-//    qDebug() << "efr_speed raw=" << efr_speed_tmp << " usec rise2fall=" << efr_speed_tmp/2 << " usec rise2rise "
-//             << efr_speed_tmp << " freq=" << 1000000/efr_speed_tmp << "Hz speed=" << efr_speed << " RPM"
-//             << " DataOut " << ((millisElapsed > 0) ? 1000/millisElapsed : -1) << " Hz";
+    //same layout table as MdBinaryProtocol, see MdMd2Decoder
+    MdSensorRecord *sr = md2Decoder->decode ( rcvData.asBytes, framelength );
+    if ( !sr )
+        return;
 
-#if  defined (Q_WS_MAEMO_5)  || defined (ANDROID)
-    ;
-#else
-    qDebug() << " DataOut " << ((millisElapsed > 0) ? 1000/millisElapsed : -1) << " Hz";
-#endif
-
-    // digifant
-
-    //remember: 68HC11 is big endian!!!
-    //avr8 is little endian
-    quint8 df_boost_raw = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_lambda = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_raw_knock = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_ect_raw = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_iat_raw = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_co_poti = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_flags = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_ign_raw = rcvData.asBytes[base+0];
-    base +=1;
-    //changed 2013-9-18
-    quint8 df_rpm_map=0;
-    quint8 df_lc_flags = rcvData.asBytes[base+0];
-    //quint8 df_rpm_map = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl1_knock_retard = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl1_knock_decay = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl2_knock_retard = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl2_knock_decay = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl3_knock_retard = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl3_knock_decay = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl4_knock_retard = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl4_knock_decay = rcvData.asBytes[base+0];
-    base +=1;
-    //removed 2013-9-18
-    quint8 df_sci_counter=0;
-    //quint8 df_sci_counter = rcvData.asBytes[base+0];
-    //base +=1;
-    quint8 df_voltage_raw = rcvData.asBytes[base+0];
-    base +=1;
-    quint16 df_inj_time = ((rcvData.asBytes[base+0] << 8) + (rcvData.asBytes[base+1]) )*2;
-    base +=2;
-    quint8 df_cold_startup_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_warm_startup_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_ect_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_acceleration_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_counter_startup_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_iat_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_ignition_addon_counter = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_igniton_addon = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_ect_injection_addon = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_isv = rcvData.asBytes[base+0];
-    base += 1;
-    quint16 df_rpm_delta_hall = (rcvData.asBytes[base+0] << 8) + (rcvData.asBytes[base+1]);
-    base +=2;
-    double df_computed_rpm = 0;
-    if ( df_rpm_delta_hall > 0 )
-        df_computed_rpm = 30000000 / df_rpm_delta_hall;
-
-    //from avr little endian!
-    quint16 df_freq = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base += 2;
-    quint8 df_active_frame = rcvData.asBytes[base+0];
-    base += 1;
-    if ( df_active_frame < 255 )
+    if ( sr->df_kline_framenum < 255 )
         df_connected = true;
 
-    double df_ignition_total_retard = ( df_cyl1_knock_retard + df_cyl2_knock_retard + df_cyl3_knock_retard + df_cyl4_knock_retard ) * 0.351563 ;
-    double df_ect = dfEctMap->mapValue( df_ect_raw );
-    double df_iat = dfIatMap->mapValue( df_iat_raw );
-    double df_ignition = (df_ign_raw *-0.351563)+73.9;
-    double df_voltage = dfVoltageMap->mapValue(df_voltage_raw);
-
-
 #if  defined (Q_WS_MAEMO_5)  || defined (ANDROID)
     ;
 #else
@@ -435,30 +250,16 @@ void MdSerialComBinary::convertReceivedMd2Frame() {
         }
     } else {
         if ( timeHelper.elapsed() > 1000 ) {
-            qDebug() << "K-Line frame#=" << df_active_frame << " | DF K-Line freq=" << df_freq << " | df_computed_rpm=" << df_computed_rpm;
+            double df_computed_rpm = 0;
+            if ( sr->df_rpm_delta_hall > 0 )
+                df_computed_rpm = 30000000 / sr->df_rpm_delta_hall;
+            qDebug() << "K-Line frame#=" << sr->df_kline_framenum << " | DF K-Line freq=" << sr->df_kline_freq << " | df_computed_rpm=" << df_computed_rpm;
             timeHelper.restart();
         }
 
     }
 #endif
 
-
-    MdSensorRecord *sr = new MdSensorRecord ( time, rpm, throttle, boost, lambda, lmm,
-                                              casetemp, egt0, egt1, egt2, egt3, egt4, egt5, egt6, egt7,
-                                              batVolt,
-                                              vdo_pres1, vdo_pres2, vdo_pres3,
-                                              vdo_temp1, vdo_temp2, vdo_temp3,
-                                              speed, gear, n75, n75_req_boost, n75_req_boost_pwm, flags,
-                                              efr_speed,
-                                              df_boost_raw, df_lambda, df_raw_knock, df_ect_raw, df_iat_raw, df_co_poti, df_flags, df_ign_raw,
-                                              df_cyl1_knock_retard, df_cyl1_knock_decay, df_cyl2_knock_retard, df_cyl2_knock_decay,
-                                              df_cyl3_knock_retard, df_cyl3_knock_decay, df_cyl4_knock_retard, df_cyl4_knock_decay,
-                                              df_voltage_raw, df_inj_time, df_cold_startup_enrichment, df_warm_startup_enrichment,
-                                              df_ect_enrichment, df_acceleration_enrichment, df_counter_startup_enrichment, df_iat_enrichment,
-                                              df_ignition_addon_counter, df_igniton_addon, df_ect_injection_addon,
-                                              df_rpm_delta_hall, df_isv, df_lc_flags,
-                                              df_ignition_total_retard, df_ect, df_iat, df_ignition, df_voltage,
-                                              knock, df_freq, df_active_frame );
     data->addDataRecord ( new MdDataRecord (sr), AppEngine::getInstance()->getActualizeVis1() );
 
 }
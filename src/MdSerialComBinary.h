@@ -28,9 +28,7 @@
 #define MD_SERIALOUT_BINARY_TAG_N75_PARAMS 23
 
 class MdData;
-class Map16x1_NTC_ECT;
-class Map16x1_NTC_IAT;
-class Map16x1_Voltage;
+class MdMd2Decoder;
 
 class MdSerialComBinary : public MdSerialCom
 {
@@ -105,12 +103,9 @@ protected:
     quint16 inline double2_fixed_b1000 (double in);
     QByteArray inline double2_fixed_b1000_Ba (double in);
 
-    Map16x1_NTC_ECT *dfEctMap;
-    Map16x1_NTC_IAT *dfIatMap;
-    Map16x1_Voltage *dfVoltageMap;
+    MdMd2Decoder *md2Decoder;
 
     QTime timeHelper;
-    QTime freqMeasure;
 };
 
 #endif // MDSERIALCOMBINARY_H
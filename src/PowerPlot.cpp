@@ -2,14 +2,16 @@
 
 #include "PowerPlot.h"
 #include "MdData.h"
+#include "data/MdSessionStore.h"
 #include "MdPlot.h"
 #include "MdPlotData.h"
+#include "data/MdTimeIndex.h"
 #include "math.h"
 #include <qmath.h>
 #include <qwt_legend.h>
 
 PowerPlot::PowerPlot( QMainWindow* mw, QWidget* parent, QTableView *tableView ) :
-    MdPlot(mw, parent, tableView), dataListP(NULL)
+    MdPlot(mw, parent, tableView), storeP(NULL)
 {
     din_temp = 20;
     din_air_pressure = 1013;
@@ -122,8 +124,8 @@ void PowerPlot::configAxis() {
     enableAxis(QwtPlot::yRight, true);
 }
 
-void PowerPlot::setData ( QList<MdDataRecord*>&dl, QList<int> &rn, bool useGpsSpeed ) {
-    dataListP = &dl;
+void PowerPlot::setData ( MdSessionStore* dl, QList<int> &rn, bool useGpsSpeed ) {
+    storeP = dl;
     rowNums = rn;
 
     //clean data -> remove rows without changing speed!
@@ -132,10 +134,10 @@ void PowerPlot::setData ( QList<MdDataRecord*>&dl, QList<int> &rn, bool useGpsSp
     for ( quint32 i = 0 ; i < rowNums.size() ; i++ ) {
         if ( i>0) {
             if ( useGpsSpeed ) {
-                if ( dataListP->at(rowNums.at(i-1))->getMobileR()->gpsGroundSpeed == dataListP->at(rowNums.at(i))->getMobileR()->gpsGroundSpeed )
+                if ( storeP->value<double> (MdChannel::GpsGroundSpeed, rowNums.at(i-1)) == storeP->value<double> (MdChannel::GpsGroundSpeed, rowNums.at(i)) )
                     removeIdx.append(i);
             } else {
-                if ( dataListP->at(rowNums.at(i-1))->getSensorR()->getSpeed() == dataListP->at(rowNums.at(i))->getSensorR()->getSpeed() )
+                if ( storeP->value<double> (MdChannel::Speed, rowNums.at(i-1)) == storeP->value<double> (MdChannel::Speed, rowNums.at(i)) )
                     removeIdx.append(i);
             }
         }
@@ -148,7 +150,7 @@ void PowerPlot::setData ( QList<MdDataRecord*>&dl, QList<int> &rn, bool useGpsSp
         removeIdx.clear();
         for ( quint32 i = 0 ; i < rowNums.size() ; i++ ) {
             if ( i>0) {
-                if ( dataListP->at(rowNums.at(i-1))->getSensorR()->getSpeed() == dataListP->at(rowNums.at(i))->getSensorR()->getSpeed() )
+                if ( storeP->value<double> (MdChannel::Speed, rowNums.at(i-1)) == storeP->value<double> (MdChannel::Speed, rowNums.at(i)) )
                     removeIdx.append(i);
             }
         }
@@ -197,28 +199,28 @@ QMap<int,double> PowerPlot::smoothSpeedMovingAverage (bool useGpsSpeed) {
                 if ( z >= rowNums.size() )
                     z=rowNums.size()-1;
                 if ( useGpsSpeed )
-                    sum += dataListP->at(rowNums.at(z))->getMobileR()->gpsGroundSpeed;
+                    sum += storeP->value<double> (MdChannel::GpsGroundSpeed, rowNums.at(z));
                 else
-                    sum += dataListP->at(rowNums.at(z))->getSensorR()->getSpeed();
+                    sum += storeP->value<double> (MdChannel::Speed, rowNums.at(z));
             }
             res[rowNums.at(i)] = sum / (2.0*smoothAmount + 1);
             if ( smoothAmount == 0 && useGpsSpeed )
-                res[rowNums.at(i)] = dataListP->at(rowNums.at(i))->getMobileR()->gpsGroundSpeed;
+                res[rowNums.at(i)] = storeP->value<double> (MdChannel::GpsGroundSpeed, rowNums.at(i));
             if ( smoothAmount == 0 && !useGpsSpeed )
-                res[rowNums.at(i)] = dataListP->at(rowNums.at(i))->getSensorR()->getSpeed();
+                res[rowNums.at(i)] = storeP->value<double> (MdChannel::Speed, rowNums.at(i));
             double delta = 0;
             double deltas = 0;
             if ( useGpsSpeed && i >= 1 ) {
-                delta = dataListP->at(rowNums.at(i))->getMobileR()->gpsGroundSpeed - dataListP->at(rowNums.at(i-1))->getMobileR()->gpsGroundSpeed;
+                delta = storeP->value<double> (MdChannel::GpsGroundSpeed, rowNums.at(i)) - storeP->value<double> (MdChannel::GpsGroundSpeed, rowNums.at(i-1));
                 deltas = res[rowNums.at(i)] - res[rowNums.at(i-1)];
             } else if ( i >= 1 ) {
-                delta = dataListP->at(rowNums.at(i))->getSensorR()->getSpeed() - dataListP->at(rowNums.at(i-1))->getSensorR()->getSpeed();
+                delta = storeP->value<double> (MdChannel::Speed, rowNums.at(i)) - storeP->value<double> (MdChannel::Speed, rowNums.at(i-1));
                 deltas = res[rowNums.at(i)] - res[rowNums.at(i-1)];
             }
 //            if ( useGpsSpeed )
-//                qDebug() << i << " smooth original speed=" << dataListP->at(rowNums.at(i))->getMobileR()->gpsGroundSpeed << " d=" << delta << " smoothed=" << res[rowNums.at(i)] << " d=" << deltas;
+//                qDebug() << i << " smooth original speed=" << storeP->value<double> (MdChannel::GpsGroundSpeed, rowNums.at(i)) << " d=" << delta << " smoothed=" << res[rowNums.at(i)] << " d=" << deltas;
 //            else
-//                qDebug() << i << " smooth original speed=" << dataListP->at(rowNums.at(i))->getSensorR()->getSpeed() << " d=" << delta <<  " smoothed=" << res[rowNums.at(i)] << " d=" << deltas;
+//                qDebug() << i << " smooth original speed=" << storeP->value<double> (MdChannel::Speed, rowNums.at(i)) << " d=" << delta <<  " smoothed=" << res[rowNums.at(i)] << " d=" << deltas;
     }
     return res;
 }
@@ -233,18 +235,18 @@ QMap<int,double> PowerPlot::smoothRPMMovingAverage () {
                     z=0;
                 if ( z >= rowNums.size() )
                     z=rowNums.size()-1;
-                sum += dataListP->at(rowNums.at(z))->getSensorR()->getRpm();
+                sum += storeP->value<qint32> (MdChannel::Rpm, rowNums.at(z));
             }
             res[rowNums.at(i)] = sum / (2.0*smoothAmount + 1);
             if ( smoothAmount == 0)
-                res[rowNums.at(i)] = dataListP->at(rowNums.at(i))->getSensorR()->getRpm();
+                res[rowNums.at(i)] = storeP->value<qint32> (MdChannel::Rpm, rowNums.at(i));
             double delta = 0;
             double deltas = 0;
             if ( i >= 1 ) {
-                delta = dataListP->at(rowNums.at(i))->getSensorR()->getRpm() - dataListP->at(rowNums.at(i-1))->getSensorR()->getRpm();
+                delta = storeP->value<qint32> (MdChannel::Rpm, rowNums.at(i)) - storeP->value<qint32> (MdChannel::Rpm, rowNums.at(i-1));
                 deltas = res[rowNums.at(i)] - res[rowNums.at(i-1)];
             }
-//            qDebug() << i << " smooth original rpm=" << dataListP->at(rowNums.at(i))->getSensorR()->getRpm() << " d=" << delta <<  " smoothed=" << res[rowNums.at(i)] << " d=" << deltas;
+//            qDebug() << i << " smooth original rpm=" << storeP->value<qint32> (MdChannel::Rpm, rowNums.at(i)) << " d=" << delta <<  " smoothed=" << res[rowNums.at(i)] << " d=" << deltas;
     }
     return res;
 }
@@ -283,18 +285,18 @@ QMap<int,double> PowerPlot::smoothTimeMovingAverage () {
                     z=0;
                 if ( z >= rowNums.size() )
                     z=rowNums.size()-1;
-                sum += dataListP->at(rowNums.at(z))->getSensorR()->getTime();
+                sum += storeP->value<qint32> (MdChannel::Time, rowNums.at(z));
             }
             res[rowNums.at(i)] = sum / (2.0*smoothAmount + 1);
             if ( smoothAmount == 0 )
-                res[rowNums.at(i)] = dataListP->at(rowNums.at(i))->getSensorR()->getTime();
+                res[rowNums.at(i)] = storeP->value<qint32> (MdChannel::Time, rowNums.at(i));
             double delta = 0;
             double deltas = 0;
             if ( i >= 1 ) {
-                delta = dataListP->at(rowNums.at(i))->getSensorR()->getTime() - dataListP->at(rowNums.at(i-1))->getSensorR()->getTime();
+                delta = storeP->value<qint32> (MdChannel::Time, rowNums.at(i)) - storeP->value<qint32> (MdChannel::Time, rowNums.at(i-1));
                 deltas = res[rowNums.at(i)] - res[rowNums.at(i-1)];
             }
-//            qDebug() << i << " smooth original time=" << dataListP->at(rowNums.at(i))->getSensorR()->getTime() << " d=" << delta <<  " smoothed=" << res[rowNums.at(i)] << " d=" << deltas;
+//            qDebug() << i << " smooth original time=" << storeP->value<qint32> (MdChannel::Time, rowNums.at(i)) << " d=" << delta <<  " smoothed=" << res[rowNums.at(i)] << " d=" << deltas;
     }
     return res;
 }
@@ -327,11 +329,16 @@ void PowerPlot::reCalculate( bool useGpsSpeed ) {
     qreal am_time_delta = 0;
     qreal am_rpm_delta = 0;
 
+    //the store recycles its records, cur and last get their own
+    MdDataRecord curRec;
+    MdDataRecord lastRec;
     foreach (quint32 r, rowNums) {
-        MdDataRecord *cur = dataListP->at(r);
+        MdDataRecord *cur = &curRec;
+        storeP->assignRecord (r, cur);
         MdDataRecord *last = cur;
         if ( lastUsedRow > 0 ) {
-            last = dataListP->at(lastUsedRow);
+            last = &lastRec;
+            storeP->assignRecord (lastUsedRow, last);
             lastUsedRow = r;
         } else {
             lastUsedRow = r;
@@ -362,10 +369,12 @@ void PowerPlot::reCalculate( bool useGpsSpeed ) {
     qreal sum_h_r = 0;
     lastUsedRow = 0;
     foreach (quint32 r, rowNums) {
-        MdDataRecord *cur = dataListP->at(r);
+        MdDataRecord *cur = &curRec;
+        storeP->assignRecord (r, cur);
         MdDataRecord *last = cur;
         if ( lastUsedRow > 0 ) {
-            last = dataListP->at(lastUsedRow);
+            last = &lastRec;
+            storeP->assignRecord (lastUsedRow, last);
             lastUsedRow = r;
         } else {
             lastUsedRow = r;
@@ -391,11 +400,14 @@ void PowerPlot::reCalculate( bool useGpsSpeed ) {
 
     lastUsedRow = 0;
     foreach (quint32 r, rowNums) {
-        MdDataRecord *cur = dataListP->at(r);
+        MdDataRecord *cur = &curRec;
+        storeP->assignRecord (r, cur);
 
         MdDataRecord *last = cur;
-        if ( lastUsedRow > 0 )
-            last = dataListP->at(lastUsedRow);
+        if ( lastUsedRow > 0 ) {
+            last = &lastRec;
+            storeP->assignRecord (lastUsedRow, last);
+        }
         else
             lastUsedRow = r;
 
@@ -646,7 +658,7 @@ qreal PowerPlot::findX (qreal x1, qreal y1, qreal x2, qreal y2, qreal ys) {
      return (ys - y1 + ( (y2-y1) / (x2-x1) ) * x1) / ( (y2-y1) / (x2-x1) ) ;
 }
 
-QMap<qreal,SpeedData> PowerPlot::calculateTimeBetweenSpeeds ( QList<MdDataRecord*>&dl, QList<int> &rn, qreal startspeed, qreal endspeed ) {
+QMap<qreal,SpeedData> PowerPlot::calculateTimeBetweenSpeeds ( MdSessionStore* dl, QList<int> &rn, qreal startspeed, qreal endspeed ) {
     QMap<qreal,SpeedData> timeTable;
     timeTable[-1] = SpeedData();
 
@@ -663,45 +675,42 @@ QMap<qreal,SpeedData> PowerPlot::calculateTimeBetweenSpeeds ( QList<MdDataRecord
 
     bool upperFound = false;
     foreach ( int i, rn ) {
-        if ( dl.at(i)->getSensorR()->getSpeed() < startspeed ) {
+        if ( dl->value<double> (MdChannel::Speed, i) < startspeed ) {
             idx_startl = i;
             idx_starth = i+1;
         }
-        if ( dl.at(i)->getSensorR()->getSpeed() < endspeed && !upperFound ) {
+        if ( dl->value<double> (MdChannel::Speed, i) < endspeed && !upperFound ) {
             idx_endl = i;
             idx_endh = i+1;
-            if ( dl.at(idx_endh)->getSensorR()->getSpeed() > endspeed )
+            if ( dl->value<double> (MdChannel::Speed, idx_endh) > endspeed )
                 upperFound = true;
         }
     }
-    if ( idx_endh >= dl.size() ) {
+    if ( idx_endh >= dl->rowCount() ) {
         qDebug() << "calculateTimeBetweenSpeeds out of bounds";
         return timeTable;
     }
-    if ( idx_starth >= dl.size() ) {
+    if ( idx_starth >= dl->rowCount() ) {
         qDebug() << "calculateTimeBetweenSpeeds out of bounds | start not found!";
         return timeTable;
     }
-    if ( dl.at(idx_starth)->getSensorR()->getSpeed() < startspeed ) {
+    if ( dl->value<double> (MdChannel::Speed, idx_starth) < startspeed ) {
         qDebug() << "calculateTimeBetweenSpeeds error no upper start speed found!";
         return timeTable;
     }
-    if ( dl.at(idx_endh)->getSensorR()->getSpeed() < endspeed ) {
+    if ( dl->value<double> (MdChannel::Speed, idx_endh) < endspeed ) {
         qDebug() << "calculateTimeBetweenSpeeds error no upper end speed found!";
         return timeTable;
     }
-    qreal startMillis = findX ( dl.at(idx_startl )->getSensorR()->getTime(), dl.at(idx_startl )->getSensorR()->getSpeed(),
-                                dl.at(idx_starth )->getSensorR()->getTime(), dl.at(idx_starth )->getSensorR()->getSpeed(),
+    qreal startMillis = findX ( dl->value<qint32> (MdChannel::Time, idx_startl), dl->value<double> (MdChannel::Speed, idx_startl),
+                                dl->value<qint32> (MdChannel::Time, idx_starth), dl->value<double> (MdChannel::Speed, idx_starth),
                                 startspeed );
-    qreal endMillis = findX ( dl.at(idx_endl )->getSensorR()->getTime(), dl.at(idx_endl )->getSensorR()->getSpeed(),
-                                dl.at(idx_endh )->getSensorR()->getTime(), dl.at(idx_endh )->getSensorR()->getSpeed(),
+    qreal endMillis = findX ( dl->value<qint32> (MdChannel::Time, idx_endl), dl->value<double> (MdChannel::Speed, idx_endl),
+                                dl->value<qint32> (MdChannel::Time, idx_endh), dl->value<double> (MdChannel::Speed, idx_endh),
                                 endspeed );
-    qreal startRPM = interpolate ( dl.at(idx_startl )->getSensorR()->getTime(), dl.at(idx_startl )->getSensorR()->getRpm(),
-                                   dl.at(idx_starth )->getSensorR()->getTime(), dl.at(idx_starth )->getSensorR()->getRpm(),
-                                   startMillis );
-    qreal endRPM = interpolate ( dl.at(idx_endl )->getSensorR()->getTime(), dl.at(idx_endl )->getSensorR()->getRpm(),
-                                   dl.at(idx_endh )->getSensorR()->getTime(), dl.at(idx_endh )->getSensorR()->getRpm(),
-                                   startMillis );
+    MdTimeIndex times (dl);
+    qreal startRPM = times.valueAt ( MdChannel::Rpm, startMillis );
+    qreal endRPM = times.valueAt ( MdChannel::Rpm, endMillis );
     qreal time = endMillis - startMillis;
     qDebug() << "calculateTimeBetweenSpeeds startspeed=" << startspeed << " endspeed=" << endspeed << " " << time << " msecs"
              << " startRPM=" << startRPM << " endRPM=" << endRPM;
@@ -712,7 +721,7 @@ QMap<qreal,SpeedData> PowerPlot::calculateTimeBetweenSpeeds ( QList<MdDataRecord
     return timeTable;
 }
 
-QMap<qreal, SpeedData> PowerPlot::calculateAdditionalDataTimeBetweenSpeeds( QList<MdDataRecord*>&dl, QList<int> &rn, qreal speedL, qreal speedH, bool useGps ) {
+QMap<qreal, SpeedData> PowerPlot::calculateAdditionalDataTimeBetweenSpeeds( MdSessionStore* dl, QList<int> &rn, qreal speedL, qreal speedH, bool useGps ) {
     QMap<qreal,SpeedData> timeTable;
     //sort ascending
     qSort (rn.begin(), rn.end());
@@ -720,6 +729,7 @@ QMap<qreal, SpeedData> PowerPlot::calculateAdditionalDataTimeBetweenSpeeds( QLis
     qreal first_time = 0;
     qreal alt_old = 0;
     qreal time_old = 0;
+    MdTimeIndex times (dl);
 
     for ( qreal s = speedL ; s <= speedH ; s = s+10 ) {
         int idx_l = 0;
@@ -727,22 +737,20 @@ QMap<qreal, SpeedData> PowerPlot::calculateAdditionalDataTimeBetweenSpeeds( QLis
 
         bool upperFound = false;
         foreach ( int i, rn ) {
-            if ( ( useGps ? ( dl.at(i)->getMobileR()->gpsGroundSpeed < s ) : ( dl.at(i)->getSensorR()->getSpeed() < s ) ) && !upperFound ) {
+            if ( ( useGps ? ( dl->value<double> (MdChannel::GpsGroundSpeed, i) < s ) : ( dl->value<double> (MdChannel::Speed, i) < s ) ) && !upperFound ) {
                 idx_l = i;
                 idx_h = i+1;
-                if ( useGps ? ( dl.at(idx_h)->getMobileR()->gpsGroundSpeed > s ) : ( dl.at(idx_h)->getSensorR()->getSpeed() > s ) )
+                if ( useGps ? ( dl->value<double> (MdChannel::GpsGroundSpeed, idx_h) > s ) : ( dl->value<double> (MdChannel::Speed, idx_h) > s ) )
                     upperFound = true;
             }
         }
-        if ( idx_h >= dl.size() ) {
+        if ( idx_h >= dl->rowCount() ) {
             return timeTable;
         }
-        qreal cm = findX ( dl.at(idx_l )->getSensorR()->getTime(), useGps ? (dl.at(idx_l )->getMobileR()->gpsGroundSpeed) : (dl.at(idx_l )->getSensorR()->getSpeed()),
-                                    dl.at(idx_h )->getSensorR()->getTime(), useGps ? (dl.at(idx_h )->getMobileR()->gpsGroundSpeed) : (dl.at(idx_h )->getSensorR()->getSpeed()),
+        qreal cm = findX ( dl->value<qint32> (MdChannel::Time, idx_l), useGps ? (dl->value<double> (MdChannel::GpsGroundSpeed, idx_l)) : (dl->value<double> (MdChannel::Speed, idx_l)),
+                                    dl->value<qint32> (MdChannel::Time, idx_h), useGps ? (dl->value<double> (MdChannel::GpsGroundSpeed, idx_h)) : (dl->value<double> (MdChannel::Speed, idx_h)),
                                     s );
-        qreal alt = interpolate ( dl.at(idx_l )->getSensorR()->getTime(), dl.at(idx_l )->getMobileR()->gpsAltitude,
-                                    dl.at(idx_h )->getSensorR()->getTime(), dl.at(idx_h )->getMobileR()->gpsAltitude,
-                                    cm );
+        qreal alt = times.valueAt ( MdChannel::GpsAltitude, cm );
         qreal time = 0;
 
         if (alt_old == 0)
@@ -766,7 +774,7 @@ QMap<qreal, SpeedData> PowerPlot::calculateAdditionalDataTimeBetweenSpeeds( QLis
     return timeTable;
 }
 
-QMap<qreal,SpeedData> PowerPlot::calculateTimeBetweenSpeedsGPS ( QList<MdDataRecord*>&dl, QList<int> &rn, qreal startspeed, qreal endspeed ) {
+QMap<qreal,SpeedData> PowerPlot::calculateTimeBetweenSpeedsGPS ( MdSessionStore* dl, QList<int> &rn, qreal startspeed, qreal endspeed ) {
     QMap<qreal,SpeedData> timeTable;
     timeTable[-1]=SpeedData();
 
@@ -783,45 +791,42 @@ QMap<qreal,SpeedData> PowerPlot::calculateTimeBetweenSpeedsGPS ( QList<MdDataRec
 
     bool upperFound = false;
     foreach ( int i, rn ) {
-        if ( dl.at(i)->getMobileR()->gpsGroundSpeed < startspeed ) {
+        if ( dl->value<double> (MdChannel::GpsGroundSpeed, i) < startspeed ) {
             idx_startl = i;
             idx_starth = i+1;
         }
-        if ( dl.at(i)->getMobileR()->gpsGroundSpeed < endspeed && !upperFound ) {
+        if ( dl->value<double> (MdChannel::GpsGroundSpeed, i) < endspeed && !upperFound ) {
             idx_endl = i;
             idx_endh = i+1;
-            if ( dl.at(idx_endh)->getMobileR()->gpsGroundSpeed > endspeed )
+            if ( dl->value<double> (MdChannel::GpsGroundSpeed, idx_endh) > endspeed )
                 upperFound = true;
         }
     }
-    if ( idx_endh >= dl.size() ) {
+    if ( idx_endh >= dl->rowCount() ) {
         qDebug() << "calculateTimeBetweenSpeeds out of bounds";
         return timeTable;
     }
-    if ( idx_starth >= dl.size() ) {
+    if ( idx_starth >= dl->rowCount() ) {
         qDebug() << "calculateTimeBetweenSpeeds out of bounds | start not found!";
         return timeTable;
     }
-    if ( dl.at(idx_starth)->getMobileR()->gpsGroundSpeed < startspeed ) {
+    if ( dl->value<double> (MdChannel::GpsGroundSpeed, idx_starth) < startspeed ) {
         qDebug() << "calculateTimeBetweenSpeeds error no upper start speed found!";
         return timeTable;
     }
-    if ( dl.at(idx_endh)->getMobileR()->gpsGroundSpeed < endspeed ) {
+    if ( dl->value<double> (MdChannel::GpsGroundSpeed, idx_endh) < endspeed ) {
         qDebug() << "calculateTimeBetweenSpeeds error no upper end speed found!";
         return timeTable;
     }
-    qreal startMillis = findX ( dl.at(idx_startl )->getSensorR()->getTime(), dl.at(idx_startl )->getMobileR()->gpsGroundSpeed,
-                                dl.at(idx_starth )->getSensorR()->getTime(), dl.at(idx_starth )->getMobileR()->gpsGroundSpeed,
+    qreal startMillis = findX ( dl->value<qint32> (MdChannel::Time, idx_startl), dl->value<double> (MdChannel::GpsGroundSpeed, idx_startl),
+                                dl->value<qint32> (MdChannel::Time, idx_starth), dl->value<double> (MdChannel::GpsGroundSpeed, idx_starth),
                                 startspeed );
-    qreal endMillis = findX ( dl.at(idx_endl )->getSensorR()->getTime(), dl.at(idx_endl )->getMobileR()->gpsGroundSpeed,
-                                dl.at(idx_endh )->getSensorR()->getTime(), dl.at(idx_endh )->getMobileR()->gpsGroundSpeed,
+    qreal endMillis = findX ( dl->value<qint32> (MdChannel::Time, idx_endl), dl->value<double> (MdChannel::GpsGroundSpeed, idx_endl),
+                                dl->value<qint32> (MdChannel::Time, idx_endh), dl->value<double> (MdChannel::GpsGroundSpeed, idx_endh),
                                 endspeed );
-    qreal startRPM = interpolate ( dl.at(idx_startl )->getSensorR()->getTime(), dl.at(idx_startl )->getSensorR()->getRpm(),
-                                   dl.at(idx_starth )->getSensorR()->getTime(), dl.at(idx_starth )->getSensorR()->getRpm(),
-                                   startMillis );
-    qreal endRPM = interpolate ( dl.at(idx_endl )->getSensorR()->getTime(), dl.at(idx_endl )->getSensorR()->getRpm(),
-                                   dl.at(idx_endh )->getSensorR()->getTime(), dl.at(idx_endh )->getSensorR()->getRpm(),
-                                   startMillis );
+    MdTimeIndex times (dl);
+    qreal startRPM = times.valueAt ( MdChannel::Rpm, startMillis );
+    qreal endRPM = times.valueAt ( MdChannel::Rpm, endMillis );
     qreal time = endMillis - startMillis;
     qDebug() << "calculateTimeBetweenSpeeds startspeed=" << startspeed << " endspeed=" << endspeed << " " << time << " msecs"
              << " startRPM=" << startRPM << " endRPM=" << endRPM;
@@ -34,7 +34,7 @@ public:
     //!unused
     void addRecord(MdSensorRecord *r, bool doReplot) {};
 
-    void setData ( QList<MdDataRecord*>&, QList<int>&, bool useGpsSpeed=false );
+    void setData ( MdSessionStore*, QList<int>&, bool useGpsSpeed=false );
 
     void clear ();
 
@@ -45,9 +45,9 @@ public:
 
     qreal interpolate (qreal x1, qreal y1, qreal x2, qreal y2, qreal xs);
     qreal findX (qreal x1, qreal y1, qreal x2, qreal y2, qreal ys);
-    QMap<qreal,SpeedData> calculateTimeBetweenSpeeds ( QList<MdDataRecord*>&dl, QList<int> &rn, qreal startspeed, qreal endspeed );
-    QMap<qreal,SpeedData> calculateTimeBetweenSpeedsGPS ( QList<MdDataRecord*>&dl, QList<int> &rn, qreal startspeed, qreal endspeed );
-    QMap<qreal,SpeedData> calculateAdditionalDataTimeBetweenSpeeds ( QList<MdDataRecord*>&dl, QList<int> &rn, qreal speedL, qreal speedH, bool useGps );
+    QMap<qreal,SpeedData> calculateTimeBetweenSpeeds ( MdSessionStore* dl, QList<int> &rn, qreal startspeed, qreal endspeed );
+    QMap<qreal,SpeedData> calculateTimeBetweenSpeedsGPS ( MdSessionStore* dl, QList<int> &rn, qreal startspeed, qreal endspeed );
+    QMap<qreal,SpeedData> calculateAdditionalDataTimeBetweenSpeeds ( MdSessionStore* dl, QList<int> &rn, qreal speedL, qreal speedH, bool useGps );
 
     //! returns map indexed by rownum
     QMap<int,double> smoothSpeedMovingAverage (bool useGpsSpeed);
@@ -107,7 +107,7 @@ private:
     int smoothAmount;
     qreal driveTrainLoss;
 
-    QList<MdDataRecord*> *dataListP;
+    MdSessionStore* storeP;
     QList<int> rowNums;
     QMap<int,double> smoothedSpeed;
     QMap<int,double> smoothedRPM;
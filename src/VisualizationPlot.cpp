@@ -19,6 +19,9 @@
 
 #include "VisualizationPlot.h"
 #include "MdPlotPicker.h"
+#include "data/MdSessionCache.h"
+#include "data/MdLodPyramid.h"
+#include "data/MdChunkSource.h"
 
 #include <QPen>
 #include <QColor>
@@ -27,33 +30,28 @@
 #include <qwt_plot_marker.h>
 
 
+//! channel and factor of every curve. we apply a factor to some data for better
+//! fitting to the y axis -> undo this at MdPlotPicker.cpp line 60!
+static const struct {
+    int channel;
+    double factor;
+} curves[] = {
+    { MdChannel::Boost, 1 }, { MdChannel::Rpm, 1 }, { MdChannel::Lambda, 1 }, { MdChannel::Throttle, 0.01 },
+    { MdChannel::Egt0, 1 }, { MdChannel::Egt1, 1 }, { MdChannel::Egt2, 1 },
+    { MdChannel::Egt3, 1 }, { MdChannel::Egt4, 1 }, { MdChannel::Egt5, 1 },
+    { MdChannel::VdoTemp1, 1 }, { MdChannel::VdoTemp2, 1 }, { MdChannel::VdoTemp3, 1 },
+    { MdChannel::VdoPres1, 1 }, { MdChannel::VdoPres2, 1 }, { MdChannel::VdoPres3, 1 },
+    //0-5V, FIXME map to air mass. 255 N75 duty is 10 on the left axis
+    { MdChannel::Lmm, 1 }, { MdChannel::Speed, 10 }, { MdChannel::Gear, 1 }, { MdChannel::N75, 0.04 }
+};
 
 VisualizationPlot::VisualizationPlot(QMainWindow* mw, QWidget *parent, QTableView *tableView )
     : MdPlot(mw, parent, tableView) {
 
     plotnameInSavedSettings = "Vis1";
 
-    boostData = new MdPlotData (0, 100);
-    rpmData = new MdPlotData (0, 100);
-    lambdaData = new MdPlotData (0, 100);
-    throttleData = new MdPlotData (0, 100);
-    egt0Data = new MdPlotData (0, 100);
-    egt1Data = new MdPlotData (0, 100);
-    egt2Data = new MdPlotData (0, 100);
-    egt3Data = new MdPlotData (0, 100);
-    egt4Data = new MdPlotData (0, 100);
-    egt5Data = new MdPlotData (0, 100);
-    VDOPres1Data = new MdPlotData (0, 100);
-    VDOPres2Data = new MdPlotData (0, 100);
-    VDOPres3Data = new MdPlotData (0, 100);
-    VDOTemp1Data = new MdPlotData (0, 100);
-    VDOTemp2Data = new MdPlotData (0, 100);
-    VDOTemp3Data = new MdPlotData (0, 100);
-
-    lmmData = new MdPlotData (0, 100);
-    speedData = new MdPlotData (0, 100);
-    gearData = new MdPlotData (0, 100);
-    n75Data = new MdPlotData (0, 100);
+    for ( int c = 0 ; c < CURVES ; c++ )
+        seriesData << new MdChannelSeries ( curves[c].channel, curves[c].factor, 1 / 60000.0, 100 );
 
     //	setTitle (QString("Boost / RPM / Lambda / Throttle / EGT"));
 
@@ -206,27 +204,14 @@ VisualizationPlot::VisualizationPlot(QMainWindow* mw, QWidget *parent, QTableVie
     //TODO change cursor for black background!
     canvas()->setCursor(QCursor(Qt::ArrowCursor));
 
-    boostCurve->setSamples( dynamic_cast<QwtSeriesData<QPointF>* > (boostData) );
-    rpmCurve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (rpmData) );
-    lambdaCurve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (lambdaData) );
-    throttleCurve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (throttleData) );
-    egt0Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (egt0Data) );
-    egt1Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (egt1Data) );
-    egt2Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (egt2Data) );
-    egt3Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (egt3Data) );
-    egt4Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (egt4Data) );
-    egt5Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (egt5Data) );
-    VDOTemp1Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (VDOTemp1Data) );
-    VDOTemp2Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (VDOTemp2Data)  );
-    VDOTemp3Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (VDOTemp3Data) );
-    VDOPres1Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (VDOPres1Data) );
-    VDOPres2Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (VDOPres2Data) );
-    VDOPres3Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (VDOPres3Data) );
-
-    lmmCurve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (lmmData) );
-    speedCurve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (speedData) );
-    gearCurve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (gearData) );
-    n75Curve->setSamples ( dynamic_cast<QwtSeriesData<QPointF>* > (n75Data) );
+    QList<QwtPlotCurve*> seriesCurves;
+    seriesCurves << boostCurve << rpmCurve << lambdaCurve << throttleCurve
+                 << egt0Curve << egt1Curve << egt2Curve << egt3Curve << egt4Curve << egt5Curve
+                 << VDOTemp1Curve << VDOTemp2Curve << VDOTemp3Curve
+                 << VDOPres1Curve << VDOPres2Curve << VDOPres3Curve
+                 << lmmCurve << speedCurve << gearCurve << n75Curve;
+    for ( int c = 0 ; c < CURVES ; c++ )
+        seriesCurves[c]->setSamples ( seriesData[c] );
 
 #ifndef Q_WS_MAEMO_5
     QwtLegend *legend = new QwtLegend();
@@ -244,44 +229,68 @@ VisualizationPlot::~VisualizationPlot() {
     // TODO Auto-generated destructor stub
 }
 
-void VisualizationPlot::addRecord(MdSensorRecord *r, bool doReplot) {
-    if ( r ) {
-
-        //we apply a factor to some data for better fitting to the y axis
-        //-> undo this at MdPlotPicker.cpp line 60!
-
-        boostData->append(r->getTime()/60000.0, r->getBoost() );
-        rpmData->append (r->getTime()/60000.0, r->getRpm() );
-        lambdaData->append (r->getTime()/60000.0, r->getLambda() );
-        throttleData->append(r->getTime()/60000.0, r->getThrottle()/100.0 );
-        egt0Data->append(r->getTime()/60000.0, r->getEgt0() );
-        egt1Data->append(r->getTime()/60000.0, r->getEgt1() );
-        egt2Data->append(r->getTime()/60000.0, r->getEgt2() );
-        egt3Data->append(r->getTime()/60000.0, r->getEgt3() );
-        egt4Data->append(r->getTime()/60000.0, r->getEgt4() );
-        egt5Data->append(r->getTime()/60000.0, r->getEgt5() );
-
-        VDOTemp1Data->append ( r->getTime()/60000.0, r->getVDOTemp1() );
-        VDOTemp2Data->append ( r->getTime()/60000.0, r->getVDOTemp2() );
-        VDOTemp3Data->append ( r->getTime()/60000.0, r->getVDOTemp3() );
-        VDOPres1Data->append ( r->getTime()/60000.0, r->getVDOPres1() );
-        VDOPres2Data->append ( r->getTime()/60000.0, r->getVDOPres2() );
-        VDOPres3Data->append ( r->getTime()/60000.0, r->getVDOPres3() );
-
-        //0-5V
-        //FIXME map to air mass
-        lmmData->append ( r->getTime()/60000.0, r->getLmm() );
-
-        speedData->append ( r->getTime()/60000.0, r->getSpeed() * 10 );
-        gearData->append ( r->getTime()/60000.0, r->getGear() );
-        //255 is 10 on left axis
-        n75Data->append ( r->getTime()/60000.0, r->getN75() * 0.04 );
-
-        if ( doReplot && this->isVisible() ) {
-            //              updateAxes();
-            replot();
+bool VisualizationPlot::showSessionLod ( MdSessionCache* session, qint64 first, qint64 last ) {
+    int level = session->lodLevelFor ( last - first + 1, canvas()->width() );
+    if ( level < 0 )
+        return false;
+    qint64 bucketRows = MdLodPyramid::bucketRows (level);
+    int firstBucket = first / bucketRows;
+    int count = last / bucketRows - firstBucket + 1;
+
+    QVector<float> t;
+    if ( !session->readLod (level, MdChannel::Time, firstBucket, count, t) )
+        return false;
+    count = t.size() / MdLodPyramid::VALUES;
+
+    //4 points per bucket: first, min and max (in the order they most likely occurred), last
+    MdPlotSeries s;
+    s.reserve ( count * 4, CURVES );
+    for ( int b = 0 ; b < count ; b++ ) {
+        const float* tb = t.constData() + b * MdLodPyramid::VALUES;
+        double mid = ( tb[MdLodPyramid::First] + tb[MdLodPyramid::Last] ) / 2.0;
+        s.x << tb[MdLodPyramid::First] / 60000.0 << mid / 60000.0 << mid / 60000.0 << tb[MdLodPyramid::Last] / 60000.0;
+    }
+    QVector<float> v;
+    for ( int c = 0 ; c < CURVES ; c++ ) {
+        if ( !session->readLod (level, curves[c].channel, firstBucket, count, v) || v.size() != t.size() )
+            return false;
+        const double f = curves[c].factor;
+        QVector<double>& y = s.y[c];
+        for ( int b = 0 ; b < count ; b++ ) {
+            const float* vb = v.constData() + b * MdLodPyramid::VALUES;
+            y.append ( vb[MdLodPyramid::First] * f );
+            if ( vb[MdLodPyramid::First] <= vb[MdLodPyramid::Last] ) {
+                y.append ( vb[MdLodPyramid::Min] * f );
+                y.append ( vb[MdLodPyramid::Max] * f );
+            } else {
+                y.append ( vb[MdLodPyramid::Max] * f );
+                y.append ( vb[MdLodPyramid::Min] * f );
+            }
+            y.append ( vb[MdLodPyramid::Last] * f );
         }
     }
+    for ( int c = 0 ; c < CURVES ; c++ )
+        seriesData[c]->setReduced ( s.x, s.y[c] );
+    return true;
+}
+
+void VisualizationPlot::addRecord(MdSensorRecord *r, bool doReplot) {
+    if ( r )
+        showRows ( seriesData[0]->firstRow(), seriesData[0]->rowCount() + 1, doReplot );
+}
+
+void VisualizationPlot::setSource ( MdChunkSource* src ) {
+    foreach ( MdChannelSeries* d, seriesData )
+        d->setSource (src);
+}
+
+void VisualizationPlot::showRows ( qint64 first, qint64 count, bool doReplot ) {
+    foreach ( MdChannelSeries* d, seriesData )
+        d->setRows (first, count);
+    if ( doReplot && this->isVisible() ) {
+        //              updateAxes();
+        replot();
+    }
 }
 
 
@@ -338,18 +347,8 @@ void VisualizationPlot::removeLastMarker () {
 }
 
 void VisualizationPlot::clear () {
-    boostData->clear();
-    rpmData->clear();
-    lambdaData->clear();
-    throttleData->clear();
-    egt0Data->clear();
-    egt1Data->clear();
-    egt2Data->clear();
-    egt3Data->clear();
-    lmmData->clear();
-    speedData->clear();
-    gearData->clear();
-    n75Data->clear();
+    foreach ( MdChannelSeries* d, seriesData )
+        d->clear();
     foreach (QwtPlotMarker* m, markerList) {
         m->detach();
         delete (m);
@@ -413,5 +412,6 @@ void VisualizationPlot::showCurve(QVariant info, int index)
 }
 
 int VisualizationPlot::windowBegin() {
-    return boostData->getWindowBegin();
+    //row of the source
+    return seriesData[0]->firstRow() + seriesData[0]->getWindowBegin();
 }
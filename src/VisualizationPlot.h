@@ -21,7 +21,7 @@
 #define VISUALIZATIONPLOT_H_
 
 #include "MdPlot.h"
-#include "MdPlotData.h"
+#include "MdChannelSeries.h"
 
 #include <qwt_plot_curve.h>
 #include <qwt_plot_marker.h>
@@ -34,8 +34,17 @@ public:
     VisualizationPlot( QMainWindow* mw, QWidget *parent, QTableView *tableView=0 );
 	virtual ~VisualizationPlot();
 
+    //! r is the next row of the source, it is shown with the rows before
     void addRecord ( MdSensorRecord* r, bool doReplot=true );
 	void clear ();
+    void setSource ( MdChunkSource* src );
+    void showRows ( qint64 first, qint64 count, bool doReplot=true );
+
+    /**
+      * shows the rows first..last of a session from its level of detail pyramid.
+      * false if there is no level for the canvas width, plot the rows then.
+      */
+    bool showSessionLod ( MdSessionCache* session, qint64 first, qint64 last );
 
     int windowBegin();
 
@@ -52,6 +61,8 @@ public slots:
     void removeLastMarker ();
 
 private:
+    enum { CURVES = 20 };
+
 	Ui::MultidisplayUIMainWindowClass *ui;
 	QwtPlotCurve *boostCurve;
 	QwtPlotCurve *rpmCurve;
@@ -76,28 +87,8 @@ private:
     QwtPlotCurve *gearCurve;
     QwtPlotCurve *n75Curve;
 
-	MdPlotData *boostData;
-	MdPlotData *rpmData;
-	MdPlotData *lambdaData;
-	MdPlotData *throttleData;
-	MdPlotData *egt0Data;
-	MdPlotData *egt1Data;
-    MdPlotData *egt2Data;
-    MdPlotData *egt3Data;
-    MdPlotData *egt4Data;
-    MdPlotData *egt5Data;
-//        MdPlotData *egt6Data;
-//        MdPlotData *egt7Data;
-	MdPlotData *VDOPres1Data;
-	MdPlotData *VDOPres2Data;
-	MdPlotData *VDOPres3Data;
-	MdPlotData *VDOTemp1Data;
-	MdPlotData *VDOTemp2Data;
-	MdPlotData *VDOTemp3Data;
-    MdPlotData *lmmData;
-    MdPlotData *speedData;
-    MdPlotData *gearData;
-    MdPlotData *n75Data;
+    //! one per curve, in the order of the curves table in VisualizationPlot.cpp
+    QList<MdChannelSeries*> seriesData;
 
 	QList<QwtPlotMarker*> markerList;
     QList<int> markerMillisecsList;
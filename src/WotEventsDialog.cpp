@@ -66,16 +66,16 @@ void WotEventsDialog::show ( QList<int> idxL ) {
 
     int row = 0;
     foreach ( int i , idxL ) {
-        QTableWidgetItem *wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getTime() ) );
+        QTableWidgetItem *wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getTime() ) );
         wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         ui->tableWidget->setItem (row,0,wi);
 
 
-        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getRpm() ) );
+        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getRpm() ) );
         wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         ui->tableWidget->setItem (row,1,wi);
 
-        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getBoost() ) );
+        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getBoost() ) );
         wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         ui->tableWidget->setItem (row,2,wi);
 
@@ -97,19 +97,19 @@ void WotEventsDialog::showKnock ( QList<int> idxL ) {
 
     int row = 0;
     foreach ( int i , idxL ) {
-        QTableWidgetItem *wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getTime() ) );
+        QTableWidgetItem *wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getTime() ) );
         wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         ui->tableWidget->setItem (row,0,wi);
 
-        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getRpm() ) );
+        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getRpm() ) );
         wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         ui->tableWidget->setItem (row,1,wi);
 
-        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getBoost() ) );
+        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getBoost() ) );
         wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         ui->tableWidget->setItem (row,2,wi);
 
-        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->df_ignition_total_retard ) );
+        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->df_ignition_total_retard ) );
         wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         ui->tableWidget->setItem (row,3,wi);
 
@@ -131,20 +131,20 @@ void WotEventsDialog::showEGT ( QList<int> idxL ) {
 
     int row = 0;
     foreach ( int i , idxL ) {
-        QTableWidgetItem *wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getTime() ) );
+        QTableWidgetItem *wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getTime() ) );
         wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         ui->tableWidget->setItem (row,0,wi);
 
-        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getRpm() ) );
+        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getRpm() ) );
         wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         ui->tableWidget->setItem (row,1,wi);
 
-        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getBoost() ) );
+        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getBoost() ) );
         wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         ui->tableWidget->setItem (row,2,wi);
 
-        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getHighestEgt()["temp"] )
-                                   + " " + QChar(0x00B0) + "C (" + QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getHighestEgt()["idx"]) + ")");
+        wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getHighestEgt ( AppEngine::getInstance()->numConnectedTypeK )["temp"] )
+                                   + " " + QChar(0x00B0) + "C (" + QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getHighestEgt ( AppEngine::getInstance()->numConnectedTypeK )["idx"]) + ")");
         wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         ui->tableWidget->setItem (row,3,wi);
 
@@ -182,7 +182,7 @@ void WotEventsDialog::show ( QMap<QString,QMap<QString,QVariant > > &d ) {
             QTableWidgetItem  *wi = new QTableWidgetItem( e );
             if ( e == "Inj duty cycle") {
                 wi->setText( wi->text() + " " +
-                             QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->df_inj_duty,
+                             QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->df_inj_duty,
                                               'f', 1) + " %");
             }
             wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
@@ -193,31 +193,31 @@ void WotEventsDialog::show ( QMap<QString,QMap<QString,QVariant > > &d ) {
                 wi->setIcon( QIcon::fromTheme(d[e]["icon"].toString()) );
             }
             if ( e == "Inj duty cycle") {
-                if ( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->df_inj_duty >= 100 )
+                if ( AppEngine::getInstance()->getData()->record(i)->getSensorR()->df_inj_duty >= 100 )
                     wi->setIcon( QIcon::fromTheme("dialog-error") );
             }
             if ( e == "EGT") {
-                if ( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->df_inj_duty >= 980 )
+                if ( AppEngine::getInstance()->getData()->record(i)->getSensorR()->df_inj_duty >= 980 )
                     wi->setIcon( QIcon::fromTheme("dialog-error") );
             }
 
-            wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getTime() ) );
+            wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getTime() ) );
             wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
             ui->tableWidget->setItem (row,1,wi);
 
-            wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getRpm() ) );
+            wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getRpm() ) );
             wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
             ui->tableWidget->setItem (row,2,wi);
 
-            wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getBoost() ) );
+            wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getBoost() ) );
             wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
             ui->tableWidget->setItem (row,3,wi);
 
-            wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getHighestEgt()["temp"] )
-                                       + " " + QChar(0x00B0) + "C (" + QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->getHighestEgt()["idx"]) + ")");
+            wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getHighestEgt ( AppEngine::getInstance()->numConnectedTypeK )["temp"] )
+                                       + " " + QChar(0x00B0) + "C (" + QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->getHighestEgt ( AppEngine::getInstance()->numConnectedTypeK )["idx"]) + ")");
             ui->tableWidget->setItem (row,4,wi);
 
-            wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->getData()[i]->getSensorR()->df_ignition_total_retard ) );
+            wi = new QTableWidgetItem( QString::number( AppEngine::getInstance()->getData()->record(i)->getSensorR()->df_ignition_total_retard ) );
             wi->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
             ui->tableWidget->setItem (row,5,wi);
 
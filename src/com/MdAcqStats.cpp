@@ -0,0 +1,189 @@
+#include "com/MdAcqStats.h"
+#include "com/MdFrameSplitter.h"
+
+#include <QStringList>
+
+MdLogHistogram::MdLogHistogram () : n(0), max(0) {
+}
+
+int MdLogHistogram::bucketOf ( quint32 value ) {
+    int b = 0;
+    while ( value ) {
+        b++;
+        value >>= 1;
+    }
+    return b;
+}
+
+quint32 MdLogHistogram::bucketLow ( int b ) {
+    return b > 0 ? 1u << (b - 1) : 0;
+}
+
+void MdLogHistogram::add ( quint32 value ) {
+    int v = (int) qMin ( value, (quint32) 0x7fffffff );
+    buckets[ bucketOf (v) ].fetchAndAddRelaxed (1);
+    n.fetchAndAddRelaxed (1);
+    //single writer: no compare and swap needed
+    if ( v > max.fetchAndAddRelaxed (0) )
+        max.fetchAndStoreRelaxed (v);
+}
+
+void MdLogHistogram::reset () {
+    for ( int b = 0 ; b < BUCKETS ; b++ )
+        buckets[b].fetchAndStoreRelaxed (0);
+    n.fetchAndStoreRelaxed (0);
+    max.fetchAndStoreRelaxed (0);
+}
+
+quint32 MdLogHistogram::count () {
+    return n.fetchAndAddRelaxed (0);
+}
+
+quint32 MdLogHistogram::maximum () {
+    return max.fetchAndAddRelaxed (0);
+}
+
+quint32 MdLogHistogram::bucket ( int b ) {
+    return buckets[b].fetchAndAddRelaxed (0);
+}
+
+quint32 MdLogHistogram::percentile ( double p ) {
+    quint32 total = count();
+    if ( total == 0 )
+        return 0;
+    quint32 target = qMax ( (quint32) 1, (quint32) ( p * total + 0.5 ) );
+    quint32 sum = 0;
+    for ( int b = 0 ; b < BUCKETS ; b++ ) {
+        sum += bucket (b);
+        if ( sum >= target )
+            return qMin ( b + 1 < BUCKETS ? bucketLow (b + 1) - 1 : 0x7fffffffu, maximum() );
+    }
+    return maximum();
+}
+
+QString MdLogHistogram::toText ( const QString& unit ) {
+    quint32 counts[BUCKETS];
+    quint32 largest = 0;
+    for ( int b = 0 ; b < BUCKETS ; b++ ) {
+        counts[b] = bucket (b);
+        largest = qMax ( largest, counts[b] );
+    }
+
+    QString text = QString ( "  n=%1 p50<=%2 p99<=%3 max=%4 %5\n" ).arg ( count() ).arg ( percentile (0.5) )
+            .arg ( percentile (0.99) ).arg ( maximum() ).arg ( unit );
+    for ( int b = 0 ; b < BUCKETS ; b++ ) {
+        if ( counts[b] == 0 )
+            continue;
+        quint32 high = b + 1 < BUCKETS ? bucketLow (b + 1) - 1 : 0x7fffffffu;
+        text += QString ( "  %1 - %2 %3 %4\n" ).arg ( bucketLow (b), 10 ).arg ( high, -10 ).arg ( counts[b], 9 )
+                .arg ( QString ( (int) ( 40.0 * counts[b] / largest + 0.5 ), '#' ) );
+    }
+    return text;
+}
+
+
+MdAcqStats::MdAcqStats ()
+    : lastNoise(0), lastBadTags(0), lastBadFrames(0), burst(0), lastReceived(-1), lastDevice(0),
+      skewFrames(0), skewMin(0), skewPrevMin(0) {
+    since.start();
+}
+
+void MdAcqStats::splitterUpdate ( const MdFrameSplitter& splitter ) {
+    //the splitter counters only grow, the differences survive a wrap
+    quint32 d = splitter.noiseBytes() - lastNoise;
+    lastNoise += d;
+    burst += d;
+    noiseBytes.fetchAndAddRelaxed (d);
+    d = splitter.badTagCount() - lastBadTags;
+    lastBadTags += d;
+    badTags.fetchAndAddRelaxed (d);
+    d = splitter.badFrameCount() - lastBadFrames;
+    lastBadFrames += d;
+    badFrames.fetchAndAddRelaxed (d);
+}
+
+void MdAcqStats::frameSplit ( const MdFrameSplitter& splitter ) {
+    splitterUpdate (splitter);
+    if ( burst == 0 )
+        return;
+    resyncs.fetchAndAddRelaxed (1);
+    resyncBytes.add (burst);
+    burst = 0;
+}
+
+void MdAcqStats::measurementFrame ( qint64 received, quint32 deviceMillis ) {
+    frames.fetchAndAddRelaxed (1);
+
+    qint64 offset = received / 1000000 - deviceMillis;
+    if ( lastReceived < 0 || deviceMillis < lastDevice ) {
+        //first frame or the MD restarted
+        skewMin = skewPrevMin = offset;
+        skewFrames = 0;
+    } else
+        gaps.add ( (quint32) qMin ( ( received - lastReceived ) / 1000, (qint64) 0x7fffffff ) );
+    skewMin = qMin ( skewMin, offset );
+    skew.add ( (quint32) ( offset - qMin ( skewMin, skewPrevMin ) ) );
+    if ( ++skewFrames == SKEW_WINDOW ) {
+        skewPrevMin = skewMin;
+        skewMin = offset;
+        skewFrames = 0;
+    }
+
+    lastReceived = received;
+    lastDevice = deviceMillis;
+}
+
+void MdAcqStats::replyFrame ( qint64 received ) {
+    replies.fetchAndAddRelaxed (1);
+    while ( !pending.isEmpty() ) {
+        qint64 rtt = received - pending.takeFirst();
+        if ( rtt / 1000000 <= COMMAND_TIMEOUT_MILLIS ) {
+            roundTrip.add ( (quint32) ( rtt / 1000 ) );
+            break;
+        }
+        unanswered.fetchAndAddRelaxed (1);
+    }
+}
+
+void MdAcqStats::commandSent ( qint64 sent ) {
+    commands.fetchAndAddRelaxed (1);
+    while ( !pending.isEmpty() && ( sent - pending.first() ) / 1000000 > COMMAND_TIMEOUT_MILLIS ) {
+        pending.removeFirst();
+        unanswered.fetchAndAddRelaxed (1);
+    }
+    pending.append (sent);
+}
+
+void MdAcqStats::reset () {
+    QAtomicInt* counters[] = { &frames, &replies, &backlogged, &dropped, &resyncs, &noiseBytes,
+                               &badTags, &badFrames, &commands, &unanswered };
+    for ( unsigned i = 0 ; i < sizeof(counters) / sizeof(counters[0]) ; i++ )
+        counters[i]->fetchAndStoreRelaxed (0);
+    gaps.reset();
+    skew.reset();
+    resyncBytes.reset();
+    roundTrip.reset();
+    since.restart();
+}
+
+QString MdAcqStats::toText () {
+    double s = seconds();
+    quint32 n = frames.fetchAndAddRelaxed (0);
+    QStringList lines;
+    lines << QString ( "acquisition statistics of the last %1 s" ).arg ( s, 0, 'f', 1 );
+    lines << QString ( "measurement frames  %1 (%2 /s)" ).arg ( n ).arg ( s > 0 ? n / s : 0, 0, 'f', 1 );
+    lines << QString ( "backlogged          %1" ).arg ( backlogged.fetchAndAddRelaxed (0) );
+    lines << QString ( "dropped (short)     %1" ).arg ( dropped.fetchAndAddRelaxed (0) );
+    lines << QString ( "broken frames       %1 without ETX, %2 without tag" )
+             .arg ( badFrames.fetchAndAddRelaxed (0) ).arg ( badTags.fetchAndAddRelaxed (0) );
+    lines << QString ( "resyncs             %1, %2 bytes skipped" )
+             .arg ( resyncs.fetchAndAddRelaxed (0) ).arg ( noiseBytes.fetchAndAddRelaxed (0) );
+    lines << QString ( "reply frames        %1" ).arg ( replies.fetchAndAddRelaxed (0) );
+    lines << QString ( "commands            %1, %2 unanswered" )
+             .arg ( commands.fetchAndAddRelaxed (0) ).arg ( unanswered.fetchAndAddRelaxed (0) );
+    lines << "" << "frame gap" << gaps.toText ("us");
+    lines << "receive time - device time (skew)" << skew.toText ("ms");
+    lines << "bytes skipped per resync" << resyncBytes.toText ("bytes");
+    lines << "command round trip" << roundTrip.toText ("us");
+    return lines.join ("\n");
+}
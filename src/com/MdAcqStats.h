@@ -0,0 +1,127 @@
+#ifndef MDACQSTATS_H
+#define MDACQSTATS_H
+
+#include <QtGlobal>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+
+class MdFrameSplitter;
+
+/**
+  * histogram with power of two buckets: bucket 0 counts 0, bucket b the values in
+  * [2^(b-1), 2^b). one writer, any number of readers, no locks: every bucket is an atomic
+  * counter, a reader may see a value in the count but not yet in its bucket.
+  */
+class MdLogHistogram {
+public:
+    enum { BUCKETS = 32 };
+
+    MdLogHistogram ();
+
+    //! writer: values above INT_MAX are counted as INT_MAX
+    void add ( quint32 value );
+    void reset ();
+
+    quint32 count ();
+    quint32 maximum ();
+    quint32 bucket ( int b );
+    //! smallest value of bucket b
+    static quint32 bucketLow ( int b );
+    static int bucketOf ( quint32 value );
+    //! upper end of the bucket the fraction p of the values is in, 0 if empty
+    quint32 percentile ( double p );
+
+    //! a line per used bucket: range, count and a bar
+    QString toText ( const QString& unit );
+
+private:
+    Q_DISABLE_COPY (MdLogHistogram)
+
+    QAtomicInt buckets[BUCKETS];
+    QAtomicInt n;
+    QAtomicInt max;
+};
+
+/**
+  * telemetry of the acquisition thread (see MdAcquisition): frame counts, what the frame
+  * splitter lost and histograms of the frame timing. written by the acquisition thread
+  * only, read and reset by the GUI (MdAcqStatsDialog) without locking the acquisition.
+  *
+  * skew is host receive time minus the Time field of the frame, relative to the smallest
+  * such offset of the last two SKEW_WINDOW frames (the frames with the least delay on the
+  * way). the window follows the drift of the two clocks, a reset of the MD starts a new
+  * baseline. a command round trip lasts from transmit to the next reply frame (ACK, map,
+  * parameter or gear ratio frame). only commands the MD answers are timed and counted,
+  * those without reply within COMMAND_TIMEOUT_MILLIS count as unanswered.
+  */
+class MdAcqStats {
+public:
+    enum { SKEW_WINDOW = 500, COMMAND_TIMEOUT_MILLIS = 2000 };
+
+    MdAcqStats ();
+
+    //! writer: the splitter returned a frame, the bytes it skipped before are one resync
+    void frameSplit ( const MdFrameSplitter& splitter );
+    //! writer: takes the counters of the splitter after a block
+    void splitterUpdate ( const MdFrameSplitter& splitter );
+    //! writer: received is MdSampleQueue::now(), deviceMillis the Time field of the frame
+    void measurementFrame ( qint64 received, quint32 deviceMillis );
+    //! writer: a frame answering a command
+    void replyFrame ( qint64 received );
+    //! writer: a command that expects a reply
+    void commandSent ( qint64 sent );
+    //! writer: a measurement frame had to wait for room in the queue
+    void frameBacklogged () { backlogged.fetchAndAddRelaxed (1); }
+    //! writer: a measurement frame too short for its layout, dropped
+    void frameDropped () { dropped.fetchAndAddRelaxed (1); }
+
+    //! zeroes counters and histograms. call reset() and toText() from the same thread
+    void reset ();
+    //! seconds since construction or reset()
+    double seconds () const { return since.elapsed() / 1000.0; }
+    //! counters and histograms as text, the diagnostics panel and its file dump
+    QString toText ();
+
+    quint32 frameCount () { return frames.fetchAndAddRelaxed (0); }
+
+    //! usecs between measurement frames
+    MdLogHistogram gaps;
+    //! msecs, see above
+    MdLogHistogram skew;
+    //! bytes skipped per resync
+    MdLogHistogram resyncBytes;
+    //! usecs from command to reply
+    MdLogHistogram roundTrip;
+
+private:
+    Q_DISABLE_COPY (MdAcqStats)
+
+    QAtomicInt frames;
+    QAtomicInt replies;
+    QAtomicInt backlogged;
+    QAtomicInt dropped;
+    QAtomicInt resyncs;
+    QAtomicInt noiseBytes;
+    QAtomicInt badTags;
+    QAtomicInt badFrames;
+    QAtomicInt commands;
+    QAtomicInt unanswered;
+    QElapsedTimer since;
+
+    //writer only, not touched by reset()
+    quint32 lastNoise;
+    quint32 lastBadTags;
+    quint32 lastBadFrames;
+    quint32 burst;
+    qint64 lastReceived;
+    quint32 lastDevice;
+    int skewFrames;
+    qint64 skewMin;
+    qint64 skewPrevMin;
+    //! send times of the commands waiting for a reply, oldest first
+    QList<qint64> pending;
+};
+
+#endif // MDACQSTATS_H
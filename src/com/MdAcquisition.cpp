@@ -0,0 +1,281 @@
+#include "com/MdAcquisition.h"
+#include "com/MdAbstractCom.h"
+#include "com/MdMd2Decoder.h"
+#include "data/MdChannel.h"
+#include "data/MdRawCapture.h"
+
+#include "MdDataRecord.h"
+
+#include <QTimer>
+#include <QDebug>
+
+#include <string.h>
+
+MdSampleQueue::MdSampleQueue ( int capacity ) : head(0), tail(0), latencyCount(0), latencySum(0), latencyMax(0) {
+    int size = 2;
+    while ( size < capacity )
+        size <<= 1;
+    ring.resize (size);
+    for ( int i = 0 ; i < size ; i++ ) {
+        ring[i].sensor = new MdSensorRecord();
+        ring[i].received = 0;
+    }
+    mask = size - 1;
+    clock.start();
+}
+
+MdSampleQueue::~MdSampleQueue () {
+    for ( int i = 0 ; i < ring.size() ; i++ )
+        delete ring[i].sensor;
+}
+
+MdSampleQueue::Sample* MdSampleQueue::back () {
+    int h = head.fetchAndAddRelaxed (0);
+    //acquire: the consumer is done with the slot
+    if ( ((h + 1) & mask) == tail.fetchAndAddAcquire (0) )
+        return NULL;
+    return &ring[h];
+}
+
+void MdSampleQueue::push () {
+    int h = head.fetchAndAddRelaxed (0);
+    //release: the slot is written before the consumer sees the new head
+    head.fetchAndStoreRelease ( (h + 1) & mask );
+}
+
+MdSampleQueue::Sample* MdSampleQueue::front () {
+    int t = tail.fetchAndAddRelaxed (0);
+    if ( t == head.fetchAndAddAcquire (0) )
+        return NULL;
+    return &ring[t];
+}
+
+void MdSampleQueue::pop () {
+    int t = tail.fetchAndAddRelaxed (0);
+    if ( t == head.fetchAndAddAcquire (0) )
+        return;
+    int ms = (int) ( ( now() - ring[t].received ) / 1000000 );
+    tail.fetchAndStoreRelease ( (t + 1) & mask );
+
+    latencyCount.fetchAndAddRelaxed (1);
+    latencySum.fetchAndAddRelaxed (ms);
+    int max = latencyMax.fetchAndAddRelaxed (0);
+    while ( ms > max && !latencyMax.testAndSetRelaxed ( max, ms ) )
+        max = latencyMax.fetchAndAddRelaxed (0);
+}
+
+int MdSampleQueue::size () {
+    int h = head.fetchAndAddAcquire (0);
+    int t = tail.fetchAndAddAcquire (0);
+    return (h - t) & mask;
+}
+
+void MdSampleQueue::takeLatency ( int& count, double& average, int& maximum ) {
+    count = latencyCount.fetchAndStoreRelaxed (0);
+    int sum = latencySum.fetchAndStoreRelaxed (0);
+    maximum = latencyMax.fetchAndStoreRelaxed (0);
+    average = count > 0 ? (double) sum / count : 0;
+}
+
+
+MdAcquisition::MdAcquisition ( MdAbstractCom* ac, int queueSize )
+    : ac(ac), queue(queueSize), version(MdMd2Decoder::VERSION_CURRENT),
+      rawCapture(NULL), rawCaptureLiveDecode(true), df_connected(false),
+      reportFrames(0), reportMaxDepth(0), reportMaxBacklog(0), reportNoise(0), reportBadTags(0), reportBadFrames(0) {
+    dec = new MdMd2Decoder (version);
+    timeField = MdMd2Decoder::field (MdChannel::Time);
+
+    //children move to the job thread together with the job
+    backlogTimer = new QTimer (this);
+    backlogTimer->setInterval (BACKLOG_MILLIS);
+    connect ( backlogTimer, SIGNAL(timeout()), this, SLOT(flushBacklog()) );
+    if ( ac ) {
+        ac->setParent (this);
+        connect ( ac, SIGNAL(bytesRead(QByteArray)), this, SLOT(incomingData(QByteArray)) );
+    }
+}
+
+MdAcquisition::~MdAcquisition () {
+    delete rawCapture;
+    delete dec;
+}
+
+void MdAcquisition::start () {
+    dfReportTimer.start();
+    reportTimer.start();
+}
+
+void MdAcquisition::stop () {
+    stopRawCapture();
+    backlogTimer->stop();
+}
+
+//! the 0x06 commands get an ACK or a data frame back, the buttons, the output switch and the MD1 commands nothing
+static bool expectsReply ( const QByteArray& command ) {
+    if ( command.size() < 2 || (quint8) command[0] != 6 )
+        return false;
+    quint8 sub = command[1];
+    return ( sub >= 1 && sub <= 11 ) || sub == 13 || sub == 14;
+}
+
+//! frames answering a command. boost pid frames are streamed like the measurement frames
+static bool isReply ( quint8 tag ) {
+    switch ( tag ) {
+    case MD_SERIALOUT_BINARY_TAG_ACK:
+    case MD_SERIALOUT_BINARY_TAG_N75_DUTY_MAP:
+    case MD_SERIALOUT_BINARY_TAG_N75_SETPOINT_MAP:
+    case MD_SERIALOUT_BINARY_TAG_N75_PARAMS:
+    case MD_SERIALOUT_BINARY_TAG_GEAR_RATIO_6G:
+        return true;
+    }
+    return false;
+}
+
+void MdAcquisition::transmit ( const QByteArray& bytes ) {
+    if ( !ac )
+        return;
+    if ( expectsReply (bytes) )
+        stats.commandSent ( queue.now() );
+    ac->transmitMsg (bytes);
+}
+
+void MdAcquisition::incomingData ( const QByteArray& bytes ) {
+    //frames inside the block are handled in place
+    splitter.feed ( (const quint8*) bytes.constData(), bytes.size() );
+    int length;
+    while ( const quint8* frame = splitter.next (length) ) {
+        stats.frameSplit (splitter);
+        frameComplete ( frame, length );
+    }
+    stats.splitterUpdate (splitter);
+
+    if ( reportTimer.elapsed() > REPORT_MILLIS )
+        report();
+}
+
+void MdAcquisition::frameComplete ( const quint8* frame, int length ) {
+    qint64 received = queue.now();
+    bool measurement = frame[1] == MD_SERIALOUT_BINARY_TAG;
+    if ( measurement )
+        stats.measurementFrame ( received, dec->raw ( frame, *timeField ) );
+    else if ( isReply (frame[1]) )
+        stats.replyFrame (received);
+
+    if ( rawCapture ) {
+        rawCapture->append ( frame, length );
+        //capture only: measurement frames are decoded later from the capture
+        if ( !rawCaptureLiveDecode && measurement )
+            return;
+    }
+    if ( !measurement ) {
+        emit frameReceived ( QByteArray ( (const char*) frame, length ) );
+        return;
+    }
+
+    reportFrames++;
+    //the order of the frames is kept: nothing overtakes the backlog
+    if ( backlog.isEmpty() && enqueue ( frame, received ) )
+        return;
+    stats.frameBacklogged();
+    backlog.append ( QByteArray ( (const char*) frame, length ) );
+    backlogReceived.append (received);
+    reportMaxBacklog = qMax ( reportMaxBacklog, backlog.size() );
+    if ( !backlogTimer->isActive() )
+        backlogTimer->start();
+}
+
+bool MdAcquisition::enqueue ( const quint8* frame, qint64 received ) {
+    MdSampleQueue::Sample* s = queue.back();
+    if ( !s )
+        return false;
+    MdSensorRecord* sr = s->sensor;
+    //a short frame is skipped, it is not worth a slot
+    if ( !dec->decode ( frame, MD_SERIALOUT_BINARY_TAG, sr ) ) {
+        stats.frameDropped();
+        return true;
+    }
+    memcpy ( s->frame, frame, MD_SERIALOUT_BINARY_TAG );
+    s->received = received;
+    queue.push();
+    reportMaxDepth = qMax ( reportMaxDepth, queue.size() );
+
+    if ( sr->df_kline_framenum < 255 )
+        df_connected = true;
+
+#if  defined (Q_WS_MAEMO_5)  || defined (ANDROID)
+    ;
+#else
+    if ( ! df_connected ) {
+        if ( dfReportTimer.elapsed() > 10000 ) {
+            qDebug() << "no connection to Digifant";
+            dfReportTimer.restart();
+        }
+    } else {
+        if ( dfReportTimer.elapsed() > 1000 ) {
+            double df_computed_rpm = 0;
+            if ( sr->df_rpm_delta_hall > 0 )
+                df_computed_rpm = 30000000 / sr->df_rpm_delta_hall;
+            qDebug() << "K-Line frame#=" << sr->df_kline_framenum << " | DF K-Line freq=" << sr->df_kline_freq << " | df_computed_rpm=" << df_computed_rpm;
+            dfReportTimer.restart();
+        }
+    }
+#endif
+    return true;
+}
+
+void MdAcquisition::flushBacklog () {
+    while ( !backlog.isEmpty() ) {
+        if ( !enqueue ( (const quint8*) backlog.first().constData(), backlogReceived.first() ) )
+            return;
+        backlog.removeFirst();
+        backlogReceived.removeFirst();
+    }
+    backlogTimer->stop();
+}
+
+void MdAcquisition::report () {
+    double seconds = reportTimer.restart() / 1000.0;
+    int count;
+    double avgLatency;
+    int maxLatency;
+    queue.takeLatency ( count, avgLatency, maxLatency );
+    if ( reportFrames > 0 || count > 0 )
+        qDebug() << "acquisition:" << qRound ( reportFrames / seconds ) << "frames/s, queue max" << reportMaxDepth
+                 << "of" << queue.capacity() << ", backlog max" << reportMaxBacklog
+                 << ", hand-off latency avg" << avgLatency << "ms max" << maxLatency << "ms";
+    //the splitter counters are never reset, MdAcqStats takes differences of them too
+    if ( splitter.noiseBytes() != reportNoise )
+        qDebug() << "(WARN) acquisition: lost sync" << splitter.badFrameCount() - reportBadFrames << "times without ETX,"
+                 << splitter.badTagCount() - reportBadTags << "times without tag," << splitter.noiseBytes() - reportNoise << "bytes skipped";
+    reportNoise = splitter.noiseBytes();
+    reportBadTags = splitter.badTagCount();
+    reportBadFrames = splitter.badFrameCount();
+    reportFrames = 0;
+    reportMaxDepth = queue.size();
+    reportMaxBacklog = backlog.size();
+}
+
+bool MdAcquisition::startRawCapture ( const QString& filename, bool liveDecode ) {
+    stopRawCapture();
+    rawCapture = new MdRawCaptureWriter (filename);
+    if ( !rawCapture->open (version) ) {
+        emit showStatusMessage ( "raw capture failed: " + rawCapture->errorString() );
+        delete rawCapture;
+        rawCapture = NULL;
+        return false;
+    }
+    rawCaptureLiveDecode = liveDecode;
+    emit showStatusMessage ( "capturing raw frames to " + filename );
+    return true;
+}
+
+void MdAcquisition::stopRawCapture () {
+    if ( !rawCapture )
+        return;
+    if ( !rawCapture->close() )
+        qDebug() << "raw capture " << rawCapture->fileName() << " incomplete: " << rawCapture->errorString();
+    emit showStatusMessage ( QString("raw capture stopped, %1 frames").arg(rawCapture->frameCount()) );
+    delete rawCapture;
+    rawCapture = NULL;
+    rawCaptureLiveDecode = true;
+}
@@ -0,0 +1,159 @@
+#ifndef MDACQUISITION_H
+#define MDACQUISITION_H
+
+#include "com/MdAcqStats.h"
+#include "com/MdBinaryProtocol.h"
+#include "com/MdFrameSplitter.h"
+#include "com/MdMd2Decoder.h"
+#include "thread/workerjob.h"
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QVector>
+
+class MdAbstractCom;
+class MdRawCaptureWriter;
+class MdSensorRecord;
+class QTimer;
+
+/**
+  * lock free ring of decoded measurement frames from the acquisition thread (single
+  * producer) to the GUI thread (single consumer). same protocol as MdRecordQueue, but the
+  * producer decodes right into the free slot and the slot keeps the frame for the
+  * frame rows of the store (see MdSessionColumns::appendFrame).
+  */
+class MdSampleQueue {
+public:
+    struct Sample {
+        MdSensorRecord* sensor;
+        quint8 frame[MD_MAXFRAME_SIZE];
+        //! now() when the frame was complete
+        qint64 received;
+    };
+
+    explicit MdSampleQueue ( int capacity );
+    ~MdSampleQueue ();
+
+    //! producer: slot to fill, NULL if the queue is full
+    Sample* back ();
+    //! producer: hands the slot of back() to the consumer
+    void push ();
+    //! consumer: oldest sample, NULL if the queue is empty
+    Sample* front ();
+    //! consumer: releases front() and adds its hand-off latency to the statistics
+    void pop ();
+
+    //! samples in the queue, exact on the consumer side
+    int size ();
+    int capacity () const { return mask; }
+    //! nsecs of the clock both threads stamp with
+    qint64 now () const { return clock.nsecsElapsed(); }
+
+    /**
+      * hand-off latency (received to pop) in msecs of the samples popped since the
+      * last call, resets the statistics. count is 0 if nothing was popped
+      */
+    void takeLatency ( int& count, double& average, int& maximum );
+
+private:
+    Q_DISABLE_COPY (MdSampleQueue)
+
+    QVector<Sample> ring;
+    int mask;
+    QAtomicInt head;
+    QAtomicInt tail;
+    QElapsedTimer clock;
+
+    QAtomicInt latencyCount;
+    QAtomicInt latencySum;
+    QAtomicInt latencyMax;
+};
+
+/**
+  * serial side of the MD protocol in its own thread (see JobRunnerThread): owns the port,
+  * splits the byte stream into frames, captures them and decodes the measurement frames
+  * into a MdSampleQueue the GUI drains once per tick (MdBinaryProtocol::drain). all other
+  * frames are handed over by frameReceived(). slow paints or dialogs only let the queue
+  * grow, the port is read on time.
+  *
+  * measurement frames are never dropped: when the queue is full they wait as raw frames
+  * in a backlog and are decoded into the queue as soon as the GUI made room.
+  * every REPORT_MILLIS the thread reports frame rate, queue depth, backlog and hand-off latency,
+  * the frame timing, resyncs and command round trips are collected in statistics().
+  */
+class MdAcquisition : public WorkerJob {
+    Q_OBJECT
+public:
+    enum { DEFAULT_QUEUE_SIZE = 1024, BACKLOG_MILLIS = 20, REPORT_MILLIS = 10000 };
+
+    //! takes ownership of ac, it is moved to the acquisition thread with the job
+    MdAcquisition ( MdAbstractCom* ac, int queueSize = DEFAULT_QUEUE_SIZE );
+    ~MdAcquisition ();
+
+    MdSampleQueue* samples () { return &queue; }
+    //! MdMd2Decoder::Version of the frames in the queue
+    int frameVersion () const { return version; }
+    //! written by the job thread, readable from any thread
+    MdAcqStats* statistics () { return &stats; }
+
+signals:
+    //! a complete frame other than a measurement frame
+    void frameReceived ( const QByteArray& frame );
+    void showStatusMessage ( const QString& );
+
+public slots:
+    void start ();
+    //! closes the raw capture, runs in the job thread
+    void stop ();
+
+    //! sends a command to the port and starts its round trip time if the MD answers it
+    void transmit ( const QByteArray& bytes );
+
+    //! see MdBinaryProtocol::startRawCapture
+    bool startRawCapture ( const QString& filename, bool liveDecode );
+    void stopRawCapture ();
+
+protected slots:
+    void incomingData ( const QByteArray& bytes );
+    void flushBacklog ();
+
+protected:
+    void frameComplete ( const quint8* frame, int length );
+    //! decodes frame into the queue, false if the queue is full
+    bool enqueue ( const quint8* frame, qint64 received );
+    void report ();
+
+    MdAbstractCom* ac;
+    MdSampleQueue queue;
+    MdMd2Decoder* dec;
+    int version;
+
+    MdFrameSplitter splitter;
+    MdAcqStats stats;
+    //! the device time of a measurement frame
+    const MdMd2Decoder::Field* timeField;
+
+    //! measurement frames waiting for room in the queue, oldest first
+    QList<QByteArray> backlog;
+    QList<qint64> backlogReceived;
+    QTimer* backlogTimer;
+
+    MdRawCaptureWriter* rawCapture;
+    bool rawCaptureLiveDecode;
+
+    bool df_connected;
+    QElapsedTimer dfReportTimer;
+
+    QElapsedTimer reportTimer;
+    quint32 reportFrames;
+    int reportMaxDepth;
+    int reportMaxBacklog;
+    //! splitter counters at the last report
+    quint32 reportNoise;
+    quint32 reportBadTags;
+    quint32 reportBadFrames;
+};
+
+#endif // MDACQUISITION_H
@@ -1,34 +1,21 @@
 #include "com/MdAbstractCom.h"
+#include "com/MdAcquisition.h"
 #include "com/MdBinaryProtocol.h"
+#include "data/MdRecordPool.h"
+#include "thread/jobrunnerthread.h"
 
 #include "MdData.h"
-#include "Map16x1.h"
 
 #include <QDebug>
 #include <AppEngine.h>
-#include <QTime>
 #include <QTimer>
 #include <QSettings>
 
-MdBinaryProtocol::MdBinaryProtocol(QObject *parent, MdData *data, MdAbstractCom *ac) :
-    QObject(parent), md(data), ac(ac),
-    index(0),
-    status(MD_STATUS_FRAME_COMPLETE),
-    discarded_frames(0),
-    framelength(0),
-    df_connected(false)
+#include <string.h>
 
+MdBinaryProtocol::MdBinaryProtocol(QObject *parent, MdData *data, MdAbstractCom *ac) :
+    QObject(parent), md(data), ac(ac)
 {
-    sdata = new QByteArray();
-    sdata->resize(MD_MAXFRAME_SIZE);
-    dfEctMap = new Map16x1_NTC_ECT();
-    dfIatMap = new Map16x1_NTC_IAT();
-    dfVoltageMap = new Map16x1_Voltage();
-    timeHelper = QTime::currentTime();
-    timeHelper.start();
-    freqMeasure = QTime::currentTime();
-    freqMeasure.start();
-
     QSettings settings("MultiDisplay", "UI");
     if ( settings.value("debug/generate_data", QVariant(false)).toBool() ) {
         debugDataGenTimer = new QTimer(this);
@@ -38,33 +25,49 @@ MdBinaryProtocol::MdBinaryProtocol(QObject *parent, MdData *data, MdAbstractCom
         debugTime = 0;
     }
 
+    acq = new MdAcquisition ( ac, settings.value("live/queue_frames", QVariant(MdAcquisition::DEFAULT_QUEUE_SIZE)).toInt() );
+    connect ( acq, SIGNAL(frameReceived(QByteArray)), this, SLOT(incomingFrame(QByteArray)) );
+    connect ( acq, SIGNAL(showStatusMessage(QString)), this, SIGNAL(showStatusMessage(QString)) );
     if ( ac ) {
-        connect ( ac, SIGNAL(bytesRead(QByteArray)), this, SLOT(incomingData(QByteArray)) );
         connect ( ac, SIGNAL(portClosed()), this, SLOT(onPortClosed()) );
         connect ( ac, SIGNAL(portOpened()), this, SLOT(onPortOpened()) );
     }
+    acqThread = new JobRunnerThread ( this, acq );
+    acqThread->start();
+
+    drainTimer = new QTimer(this);
+    connect ( drainTimer, SIGNAL(timeout()), this, SLOT(drain()) );
+    drainTimer->start (DRAIN_MILLIS);
 }
 
 MdBinaryProtocol::~MdBinaryProtocol() {
-    if ( dfEctMap )
-        delete ( dfEctMap );
-    if ( dfIatMap )
-        delete ( dfIatMap );
-    if ( dfVoltageMap )
-        delete dfVoltageMap;
-    if ( sdata )
-        delete sdata;
+    QMetaObject::invokeMethod ( acq, "stop", Qt::BlockingQueuedConnection );
+    acqThread->quit();
+    //the thread is gone, the port goes with the job
+    delete acq;
+    delete acqThread;
+}
+
+void MdBinaryProtocol::transmit (const QByteArray& t) {
+    if ( ac )
+        QMetaObject::invokeMethod ( acq, "transmit", Qt::QueuedConnection, Q_ARG(QByteArray, t) );
+}
+
+MdAcqStats* MdBinaryProtocol::acquisitionStats() {
+    return acq->statistics();
 }
 
 void MdBinaryProtocol::closePort()
 {
     if ( ac )
-        ac->closePort();
+        QMetaObject::invokeMethod ( ac, "closePort", Qt::QueuedConnection );
 }
 
 bool MdBinaryProtocol::changePortSettings (QString sport, QString speed) {
-    if (ac)
-        ac->changePortSettings(sport,speed);
+    if ( !ac )
+        return false;
+    QMetaObject::invokeMethod ( ac, "changePortSettings", Qt::QueuedConnection, Q_ARG(QString, sport), Q_ARG(QString, speed) );
+    return true;
 }
 
 void MdBinaryProtocol::onPortOpened()
@@ -78,91 +81,43 @@ void MdBinaryProtocol::onPortClosed()
 }
 
 
-void MdBinaryProtocol::incomingData(const QByteArray &bytes) {
-
-    for ( qint32 i = 0 ; i < bytes.size() ; i++ ) {
-        quint8 d = (quint8) bytes[i];
-
-        switch ( status ) {
-
-        case MD_STATUS_FRAMEERROR:
-        case MD_STATUS_FRAME_COMPLETE:
-            //new frame --> check for start char
-            index = 0;
-            for ( int i=0; i < (MD_MAXFRAME_SIZE-1) ; i++ ) {
-                    rcvData.asBytes[i]=0xFF;
-                    (*sdata)[i]=0xFF;
-            }
-
-            if ( d != MD_FRAMEBEGIN ) {
-                    //skip it
-            } else {
-                    status = MD_STATUS_WAITING_FOR_TAG;
-                    rcvData.asBytes[index] = d;
-                    (*sdata)[index]=d;
-                    index++;
-            }
-            break;
-
-        case MD_STATUS_WAITING_FOR_TAG:
-            if ( d == MD_SERIALOUT_BINARY_TAG || d == MD_SERIALOUT_BINARY_BOOSTPID_TAG
-                 || d == MD_SERIALOUT_BINARY_TAG_N75_DUTY_MAP || d == MD_SERIALOUT_BINARY_TAG_N75_SETPOINT_MAP
-                 || d == MD_SERIALOUT_BINARY_TAG_ACK  || d == MD_SERIALOUT_BINARY_TAG_N75_PARAMS
-                 || d == MD_SERIALOUT_BINARY_TAG_GEAR_RATIO_6G ) {
-                status = MD_STATUS_RECEIVING;
-                framelength = d;
-                rcvData.asBytes[index] = d;
-                (*sdata)[index]=d;
-                index++;
-            } else {
-                qDebug() << "(WARN) expected tag but did not get one! d=" << d;
-                framelength = 0;
-            }
-            break;
-
-        case MD_STATUS_RECEIVING:
-            if ( index == framelength-1 ) {
-                    //last char -> check for end char
-                    if ( d != MD_FRAMEEND ) {
-                            discarded_frames++;
-                            if ( discarded_frames % 100 == 0 )
-                                qDebug() << "(WARN) frame discarded! expected framelength=" << framelength << " #discarded frames=" << discarded_frames << " d=" << d << " data=" << sdata->toHex();
-                            status = MD_STATUS_FRAMEERROR;
-                    } else {
-                            rcvData.asBytes[index] = d;
-                            (*sdata)[index]=d;
-                            //frame complete!
-                            status = MD_STATUS_FRAME_COMPLETE;
-                            index = 0;
-                            //do sth with it!
-                            emit frameReceived();
-                            this->convertReceivedFrame();
-
-                    }
-            } else {
-                    rcvData.asBytes[index] = d;
-                    (*sdata)[index]=d;
-                    index++;
-            }
-            break;
-        }
+void MdBinaryProtocol::incomingFrame (const QByteArray &frame) {
+    memcpy ( rcvData.asBytes, frame.constData(), qMin ( frame.size(), (int) MD_MAXFRAME_SIZE ) );
+    emit frameReceived();
+    convertReceivedFrame();
+}
+
+void MdBinaryProtocol::drain() {
+    MdSampleQueue* q = acq->samples();
+    int n = q->size();
+    if ( n == 0 )
+        return;
+    MdRecordPool* pool = MdRecordPool::instance();
+    bool replot = AppEngine::getInstance()->getActualizeVis1();
+    //only what was queued when the tick started, a fast port can't keep the GUI in here
+    for ( int i = 0 ; i < n ; i++ ) {
+        MdSampleQueue::Sample* s = q->front();
+        //pooled record, no heap allocation per frame
+        MdDataRecord* r = pool->acquire();
+        *r->getSensorR() = *s->sensor;
+        r->assignMobileSensors();
+        emit frameReceived();
+        //the store copies the frame, the slot can go back to the acquisition thread afterwards
+        md->addDataRecord ( r, replot && i == n - 1, s->frame, acq->frameVersion() );
+        q->pop();
     }
-
 }
 
 void MdBinaryProtocol::openPort()
 {
     if ( ac )
-        ac->openPort();
+        QMetaObject::invokeMethod ( ac, "openPort", Qt::QueuedConnection );
 }
 
 void MdBinaryProtocol::convertReceivedFrame() {
 //    qDebug() << "frame competely received! tag=" << rcvData.asBytes[1] << "(" << sdata->toHex() << ")";
 
     switch  ( rcvData.asBytes[1] ) {
-    case MD_SERIALOUT_BINARY_TAG:
-        convertReceivedMd2Frame();
-        break;
     case MD_SERIALOUT_BINARY_BOOSTPID_TAG:
         break;
     case MD_SERIALOUT_BINARY_TAG_N75_DUTY_MAP:
@@ -273,271 +228,55 @@ void MdBinaryProtocol::convertGearBoxFrame() {
     emit gearboxSettingsReceived(serial, g1, g2, g3, g4, g5, g6);
 }
 
-void MdBinaryProtocol::convertReceivedMd2Frame() {
-    int millisElapsed = freqMeasure.restart();
-
-    int base = 2;
-
-    quint32 time = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) + (rcvData.asBytes[base+2] << 16) + (rcvData.asBytes[base+3] << 24);
-    base += 4;
-
-    quint16 rpm = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-
-    //absolute boost!
-    double  boost = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) ) - 1;
-    base +=2;
-
-    quint8 throttle = rcvData.asBytes[base+0];
-    base +=1;
-
-
-    double  lambda = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-
-    double  lmm = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-
-    double  casetemp = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-
-    quint16 egt0 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt1 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt2 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt3 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt4 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt5 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt6 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 egt7 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-
-    double  batVolt = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-
-    //FIXME pressure / temp ints???
-    quint16 vdo_pres1 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 vdo_pres2 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 vdo_pres3 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 vdo_temp1 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 vdo_temp2 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-    quint16 vdo_temp3 = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-
-    //quint16 speed = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    double  speed = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-
-    quint8 gear = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 n75 = rcvData.asBytes[base+0];
-    base +=1;
-    double  n75_req_boost = fixed_b100_2double( quint16 ( rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8) ) );
-    base +=2;
-    quint8 n75_req_boost_pwm = rcvData.asBytes[base+0];
-    base++;
-    quint8 flags = rcvData.asBytes[base+0];
-    base +=1;
-    double efr_speed_tmp = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    double efr_speed = 0;
-    if ( efr_speed_tmp == 0xFFFF )
-            efr_speed = 0;
-        else
-            efr_speed = 40000000 / (efr_speed_tmp);
-
-    base +=2;
-    double knock = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base +=2;
-
-//    qDebug() << "efr_speed raw=" << efr_speed_tmp << " usec rise2fall=" << efr_speed_tmp/2 << " usec rise2rise "
-//             << efr_speed_tmp << " freq=" << 1000000/efr_speed_tmp << "Hz speed=" << efr_speed << " RPM"
-//             << " DataOut " << ((millisElapsed > 0) ? 1000/millisElapsed : -1) << " Hz";
-
-#if  defined (Q_WS_MAEMO_5)  || defined (ANDROID)
-    ;
-#else
-    qDebug() << " DataOut " << ((millisElapsed > 0) ? 1000/millisElapsed : -1) << " Hz";
-#endif
-
-    // digifant
-
-    //remember: 68HC11 is big endian!!!
-    //avr8 is little endian
-    quint8 df_boost_raw = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_lambda = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_raw_knock = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_ect_raw = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_iat_raw = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_co_poti = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_flags = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_ign_raw = rcvData.asBytes[base+0];
-    base +=1;
-    //changed 2013-9-18
-    quint8 df_rpm_map=0;
-    quint8 df_lc_flags = rcvData.asBytes[base+0];
-    //quint8 df_rpm_map = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl1_knock_retard = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl1_knock_decay = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl2_knock_retard = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl2_knock_decay = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl3_knock_retard = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl3_knock_decay = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl4_knock_retard = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_cyl4_knock_decay = rcvData.asBytes[base+0];
-    base +=1;
-    //removed 2013-9-18
-    quint8 df_sci_counter=0;
-    //quint8 df_sci_counter = rcvData.asBytes[base+0];
-    //base +=1;
-    quint8 df_voltage_raw = rcvData.asBytes[base+0];
-    base +=1;
-    quint16 df_inj_time = ((rcvData.asBytes[base+0] << 8) + (rcvData.asBytes[base+1]) )*2;
-    base +=2;
-    quint8 df_cold_startup_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_warm_startup_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_ect_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_acceleration_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_counter_startup_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_iat_enrichment = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_ignition_addon_counter = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_igniton_addon = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_ect_injection_addon = rcvData.asBytes[base+0];
-    base +=1;
-    quint8 df_isv = rcvData.asBytes[base+0];
-    base += 1;
-    quint16 df_rpm_delta_hall = (rcvData.asBytes[base+0] << 8) + (rcvData.asBytes[base+1]);
-    base +=2;
-    double df_computed_rpm = 0;
-    if ( df_rpm_delta_hall > 0 )
-        df_computed_rpm = 30000000 / df_rpm_delta_hall;
-
-    //from avr little endian!
-    quint16 df_freq = rcvData.asBytes[base+0] + (rcvData.asBytes[base+1] << 8);
-    base += 2;
-    quint8 df_active_frame = rcvData.asBytes[base+0];
-    base += 1;
-    if ( df_active_frame < 255 )
-        df_connected = true;
-
-    double df_ignition_total_retard = ( df_cyl1_knock_retard + df_cyl2_knock_retard + df_cyl3_knock_retard + df_cyl4_knock_retard ) * 0.351563 ;
-    double df_ect = dfEctMap->mapValue( df_ect_raw );
-    double df_iat = dfIatMap->mapValue( df_iat_raw );
-    double df_ignition = (df_ign_raw *-0.351563)+73.9;
-    if ( (df_lc_flags & 3)==1 )
-        df_ignition = (2*df_ign_raw *-0.351563)+73.9;
-    double df_voltage = dfVoltageMap->mapValue(df_voltage_raw);
-
-
-#if  defined (Q_WS_MAEMO_5)  || defined (ANDROID)
-    ;
-#else
-    if ( ! df_connected ) {
-        if ( timeHelper.elapsed() > 10000 ) {
-            qDebug() << "no connection to Digifant";
-            timeHelper.restart();
-        }
-    } else {
-        if ( timeHelper.elapsed() > 1000 ) {
-            qDebug() << "K-Line frame#=" << df_active_frame << " | DF K-Line freq=" << df_freq << " | df_computed_rpm=" << df_computed_rpm;
-            timeHelper.restart();
-        }
-
-    }
-#endif
-
-
-    MdSensorRecord *sr = new MdSensorRecord ( time, rpm, throttle, boost, lambda, lmm,
-                                              casetemp, egt0, egt1, egt2, egt3, egt4, egt5, egt6, egt7,
-                                              batVolt,
-                                              vdo_pres1, vdo_pres2, vdo_pres3,
-                                              vdo_temp1, vdo_temp2, vdo_temp3,
-                                              speed, gear, n75, n75_req_boost, n75_req_boost_pwm, flags,
-                                              efr_speed,
-                                              df_boost_raw, df_lambda, df_raw_knock, df_ect_raw, df_iat_raw, df_co_poti, df_flags, df_ign_raw,
-                                              df_cyl1_knock_retard, df_cyl1_knock_decay, df_cyl2_knock_retard, df_cyl2_knock_decay,
-                                              df_cyl3_knock_retard, df_cyl3_knock_decay, df_cyl4_knock_retard, df_cyl4_knock_decay,
-                                              df_voltage_raw, df_inj_time, df_cold_startup_enrichment, df_warm_startup_enrichment,
-                                              df_ect_enrichment, df_acceleration_enrichment, df_counter_startup_enrichment, df_iat_enrichment,
-                                              df_ignition_addon_counter, df_igniton_addon, df_ect_injection_addon,
-                                              df_rpm_delta_hall, df_isv, df_lc_flags,
-                                              df_ignition_total_retard, df_ect, df_iat, df_ignition, df_voltage,
-                                              knock, df_freq, df_active_frame );
-    md->addDataRecord ( new MdDataRecord (sr), AppEngine::getInstance()->getActualizeVis1() );
+bool MdBinaryProtocol::startRawCapture ( const QString& filename, bool liveDecode ) {
+    bool ok = false;
+    QMetaObject::invokeMethod ( acq, "startRawCapture", Qt::BlockingQueuedConnection,
+                                Q_RETURN_ARG(bool, ok), Q_ARG(QString, filename), Q_ARG(bool, liveDecode) );
+    return ok;
+}
 
+void MdBinaryProtocol::stopRawCapture() {
+    QMetaObject::invokeMethod ( acq, "stopRawCapture", Qt::BlockingQueuedConnection );
 }
 
 void MdBinaryProtocol::mdCmdAp() {
     QByteArray ap;
     ap.append(2);
     ap.append(1);
-    ac->transmitMsg (ap);
+    transmit (ap);
 }
 void MdBinaryProtocol::mdCmdAh() {
     QByteArray ah;
     ah.append(2);
     ah.append(2);
-    ac->transmitMsg (ah);
+    transmit (ah);
 }
 void MdBinaryProtocol::mdCmdBp() {
     QByteArray bp;
     bp.append(2);
     bp.append(3);
-    ac->transmitMsg (bp);
+    transmit (bp);
 }
 void MdBinaryProtocol::mdCmdBh() {
     QByteArray bh;
     //    bh={2,4};
     bh.append(2);
     bh.append(3);
-    ac->transmitMsg (bh);
+    transmit (bh);
 }
 
 void MdBinaryProtocol::mdCmdActivateSerialOutput() {
     QByteArray mdso;
     mdso.append(3);
     mdso.append(2);
-    ac->transmitMsg (mdso);
+    transmit (mdso);
 }
 void MdBinaryProtocol::mdCmdActivateSerialBinaryOutput() {
     QByteArray t;
     t.push_back (3);
     t.push_back (4);
     qDebug() << "cmd transmit length=" << t.length();
-    ac->transmitMsg(t);
+    transmit (t);
 }
 
 void MdBinaryProtocol::mdCmdDisableSerialOutput() {
@@ -545,32 +284,32 @@ void MdBinaryProtocol::mdCmdDisableSerialOutput() {
     t.push_back (3);
     t.push_back ( (char) 0);
     qDebug() << "cmd transmit length=" << t.length();
-    ac->transmitMsg(t);
+    transmit (t);
 }
 
 void MdBinaryProtocol::mdCmdCalBoost() {
     QByteArray mdcalboost;
     mdcalboost.append(4);
     mdcalboost.append(2);
-    ac->transmitMsg (mdcalboost);
+    transmit (mdcalboost);
 }
 void MdBinaryProtocol::mdCmdLoadFromEeprom() {
     QByteArray mdload;
     mdload.append(4);
     mdload.append(3);
-    ac->transmitMsg (mdload);
+    transmit (mdload);
 }
 void MdBinaryProtocol::mdCmdSave2Eeprom() {
     QByteArray mdsave;
     mdsave.append(4);
     mdsave.append(1);
-    ac->transmitMsg (mdsave);
+    transmit (mdsave);
 }
 void MdBinaryProtocol::mdCmdReadEeprom() {
     QByteArray mdload;
     mdload.append(4);
     mdload.append(3);
-    ac->transmitMsg (mdload);
+    transmit (mdload);
 }
 
 
@@ -583,7 +322,7 @@ void MdBinaryProtocol::mdCmdReqN75DutyMap (quint8 gear, quint8 mode, quint8 seri
     t.push_back ( (quint8) mode );
     t.push_back ( (quint8) serial );
     qDebug() << "cmd transmit length=" << t.length() << " " << t.toHex();
-    ac->transmitMsg(t);
+    transmit (t);
 }
 void MdBinaryProtocol::mdCmdReqN75SetpointMap (quint8 gear, quint8 mode, quint8 serial) {
     QByteArray t;
@@ -593,7 +332,7 @@ void MdBinaryProtocol::mdCmdReqN75SetpointMap (quint8 gear, quint8 mode, quint8
     t.push_back ( (quint8) mode );
     t.push_back ( (quint8) serial );
     qDebug() << "cmd transmit length=" << t.length() << " " << t.toHex();
-    ac->transmitMsg(t);
+    transmit (t);
 }
 void MdBinaryProtocol::mdCmdWriteN75DutyMap (quint8 gear, quint8 mode, quint8 serial, QVector<quint8>* data) {
     QByteArray t;
@@ -605,7 +344,7 @@ void MdBinaryProtocol::mdCmdWriteN75DutyMap (quint8 gear, quint8 mode, quint8 se
     for (quint8 i = 0 ; i < 16 ; i++)
         t.push_back( data->at(i));
     qDebug() << "cmd transmit length=" << t.length() << " " << t.toHex();
-    ac->transmitMsg(t);
+    transmit (t);
     delete data;
 }
 
@@ -621,7 +360,7 @@ void MdBinaryProtocol::mdCmdWriteN75SetpointMap (quint8 gear, quint8 mode, quint
         t.push_back( quint8 (double2_fixed_b100( data->at(i) ) >> 8) );
     }
     qDebug() << "cmd transmit length=" << t.length() << " " << t.toHex();
-    ac->transmitMsg(t);
+    transmit (t);
     delete data;
 }
 void MdBinaryProtocol::mdCmdWriteN75MapsToEEprom () {
@@ -656,7 +395,7 @@ void MdBinaryProtocol::mdCmdWriteN75Settings (quint8 serial, double aKp, double
     t.push_back ( flags );
     t.push_back ( double2_fixed_b100_Ba  (maxBoost) );
     qDebug() << "mdCmdWriteN75Settings tx length=" << t.length() << " data=" << t.toHex();
-    ac->transmitMsg(t);
+    transmit (t);
 }
 
 void MdBinaryProtocol::mdCmdReadN75SettingsFromEEprom (quint8 serial) {
@@ -671,7 +410,7 @@ void MdBinaryProtocol::mdSendCommand (quint8 cmd, quint8 subcmd, quint8 serial)
     t.push_back ( (quint8) subcmd );
     t.push_back ( (quint8) serial );
     qDebug() << "mdSendCommand tx length=" << t.length() << " data=" << t.toHex();
-    ac->transmitMsg(t);
+    transmit (t);
 }
 
 void MdBinaryProtocol::mdCmdSetSerialFrequency (quint16 frequency, quint8 serial) {
@@ -683,7 +422,7 @@ void MdBinaryProtocol::mdCmdSetSerialFrequency (quint16 frequency, quint8 serial
     t.push_back ( (quint8) (s & 0xFF) );
     t.push_back ( (quint8) (s >> 8) );
     qDebug() << "mdCmdSetSerialFrequency frequency=" << frequency << " hz (" << s << ") " << t.toHex();
-    ac->transmitMsg(t);
+    transmit (t);
 }
 
 void MdBinaryProtocol::mdCmdReadGearbox (quint8 serial) {
@@ -692,7 +431,7 @@ void MdBinaryProtocol::mdCmdReadGearbox (quint8 serial) {
     t.push_back ( (quint8) 6 );
     t.push_back ( (quint8) 13 );
     t.push_back ( (quint8) serial );
-    ac->transmitMsg(t);
+    transmit (t);
 }
 
 void MdBinaryProtocol::mdCmdWriteGearbox (double g1, double g2, double g3, double g4, double g5, double g6, quint8 serial) {
@@ -708,7 +447,7 @@ void MdBinaryProtocol::mdCmdWriteGearbox (double g1, double g2, double g3, doubl
     t.push_back ( double2_fixed_b1000_Ba(g4) );
     t.push_back ( double2_fixed_b1000_Ba(g5) );
     t.push_back ( double2_fixed_b1000_Ba(g6) );
-    ac->transmitMsg(t);
+    transmit (t);
     qDebug() << "tx=" << t.toHex();
 }
 
@@ -724,13 +463,15 @@ void MdBinaryProtocol::debugDataGenUpdate() {
         df_ignition_total_retard=48;
     }
 
-    MdSensorRecord *sr = new MdSensorRecord ();
+    MdDataRecord* r = MdRecordPool::instance()->acquire();
+    MdSensorRecord *sr = r->getSensorR();
+    *sr = MdSensorRecord ();
     sr->setTime( debugTime );
     sr->setRpm(debugRPMCounter);
     sr->setThrottle(thr);
     sr->df_boost_raw = 128;
     sr->df_ignition_total_retard = df_ignition_total_retard;
 
-    md->addDataRecord ( new MdDataRecord (sr), AppEngine::getInstance()->getActualizeVis1() );
+    md->addDataRecord ( r, AppEngine::getInstance()->getActualizeVis1() );
     emit showStatusBarSampleCount ( QString::number (md->size()) );
 }
@@ -2,7 +2,6 @@
 #define MDBINARYPROTOCOL_H
 
 #include <QObject>
-#include <QTime>
 #include <QTimer>
 
 
@@ -30,19 +29,30 @@
 #define MD_SERIALOUT_BINARY_TAG_N75_PARAMS 23
 
 class MdData;
-class Map16x1_NTC_ECT;
-class Map16x1_NTC_IAT;
-class Map16x1_Voltage;
 class MdAbstractCom;
-
+class MdAcquisition;
+class MdAcqStats;
+class JobRunnerThread;
+
+/**
+  * GUI side of the MD protocol: the commands, the replies and the measurement frames.
+  * the port, the frame parsing and decoding run in the thread of a MdAcquisition, the
+  * decoded frames are drained into MdData every DRAIN_MILLIS (one replot per drain).
+  */
 class MdBinaryProtocol : public QObject {
 
     Q_OBJECT
 
 public:
+    enum { DRAIN_MILLIS = 40 };
+
+    //! takes ownership of ac, it lives in the acquisition thread from now on
     MdBinaryProtocol(QObject *parent, MdData *data, MdAbstractCom* ac);
     ~MdBinaryProtocol();
 
+    //! telemetry of the acquisition thread, see MdAcqStatsDialog
+    MdAcqStats* acquisitionStats();
+
 signals:
     void portOpened();
     void portClosed();
@@ -99,32 +109,41 @@ public slots:
     void closePort();
     bool changePortSettings (QString sport, QString speed);
 
+    /**
+      * appends every validated frame to a mdraw capture (see data/MdRawCapture.h).
+      * without liveDecode the measurement frames are only captured, not converted.
+      */
+    bool startRawCapture (const QString& filename, bool liveDecode=true);
+    void stopRawCapture ();
+
 private slots:
-    virtual void incomingData( const QByteArray& bytes);
+    //! a reply frame from the acquisition thread
+    void incomingFrame ( const QByteArray& frame );
 
 protected slots:
     void onPortOpened();
     void onPortClosed();
 
+    //! adds the measurement frames the acquisition thread queued since the last tick
+    void drain();
+
     void debugDataGenUpdate();
 
 protected:
     MdData *md;
     MdAbstractCom *ac;
-
-    qint8 index;
-    qint8 status;
-    qint16 discarded_frames;
-    quint8 framelength;
-    bool df_connected;
+    MdAcquisition *acq;
+    JobRunnerThread *acqThread;
+    QTimer *drainTimer;
 
     union {
             quint8 asBytes[MD_MAXFRAME_SIZE];
         } rcvData;
-    QByteArray *sdata;
+
+    //! queued to the port in the acquisition thread
+    void transmit (const QByteArray& t);
 
     void convertReceivedFrame();
-    void convertReceivedMd2Frame();
     void convertReceivedN75DutyMapFrame();
     void convertReceivedN75SetpointMapFrame();
     void convertReceivedN75SettingsFrame();
@@ -137,13 +156,6 @@ protected:
     quint16 inline double2_fixed_b1000 (double in);
     QByteArray inline double2_fixed_b1000_Ba (double in);
 
-    Map16x1_NTC_ECT *dfEctMap;
-    Map16x1_NTC_IAT *dfIatMap;
-    Map16x1_Voltage *dfVoltageMap;
-
-    QTime timeHelper;
-    QTime freqMeasure;
-
     //debug data generation
     int debugRPMCounter;
     int debugTime;
@@ -0,0 +1,153 @@
+#include "com/MdFrameSplitter.h"
+
+#include <string.h>
+
+MdFrameSplitter::MdFrameSplitter () : block(NULL), blockLength(0), pos(0), carryLength(0), carryUsed(0) {
+    resetCounters();
+}
+
+void MdFrameSplitter::feed ( const quint8* data, int length ) {
+    block = data;
+    blockLength = length;
+    pos = 0;
+}
+
+void MdFrameSplitter::reset () {
+    noise += carryLength - carryUsed;
+    carryLength = carryUsed = 0;
+    block = NULL;
+    blockLength = pos = 0;
+}
+
+void MdFrameSplitter::resetCounters () {
+    frames = noise = badTags = badFrames = 0;
+}
+
+int MdFrameSplitter::frameLength ( quint8 tag ) {
+    switch ( tag ) {
+    case MD_SERIALOUT_BINARY_TAG:
+    case MD_SERIALOUT_BINARY_BOOSTPID_TAG:
+    case MD_SERIALOUT_BINARY_TAG_N75_DUTY_MAP:
+    case MD_SERIALOUT_BINARY_TAG_N75_SETPOINT_MAP:
+    case MD_SERIALOUT_BINARY_TAG_ACK:
+    case MD_SERIALOUT_BINARY_TAG_N75_PARAMS:
+    case MD_SERIALOUT_BINARY_TAG_GEAR_RATIO_6G:
+        return tag;
+    }
+    return 0;
+}
+
+const quint8* MdFrameSplitter::completeCarry ( int& length ) {
+    //the frame returned last time
+    if ( carryUsed > 0 ) {
+        carryLength -= carryUsed;
+        memmove ( carry, carry + carryUsed, carryLength );
+        carryUsed = 0;
+    }
+
+    while ( carryLength > 0 ) {
+        if ( carry[0] != MD_FRAMEBEGIN ) {
+            const quint8* stx = (const quint8*) memchr ( carry, MD_FRAMEBEGIN, carryLength );
+            int k = stx ? stx - carry : carryLength;
+            noise += k;
+            carryLength -= k;
+            memmove ( carry, carry + k, carryLength );
+            continue;
+        }
+
+        //kept: bytes from earlier blocks, the ones after them are block[pos - taken, pos)
+        int kept = carryLength;
+        int taken = 0;
+        if ( carryLength == 1 ) {
+            if ( pos >= blockLength )
+                return NULL;
+            carry[carryLength++] = block[pos++];
+            taken++;
+        }
+        int len = frameLength ( carry[1] );
+        if ( len ) {
+            if ( carryLength < len ) {
+                int n = qMin ( len - carryLength, blockLength - pos );
+                memcpy ( carry + carryLength, block + pos, n );
+                carryLength += n;
+                pos += n;
+                taken += n;
+                if ( carryLength < len )
+                    return NULL;
+            }
+            if ( carry[len - 1] == MD_FRAMEEND ) {
+                carryUsed = len;
+                frames++;
+                length = len;
+                return carry;
+            }
+            badFrames++;
+        } else
+            badTags++;
+
+        //resync at the next STX, it may be in the carry or in the block
+        const quint8* stx = (const quint8*) memchr ( carry + 1, MD_FRAMEBEGIN, carryLength - 1 );
+        if ( !stx ) {
+            noise += carryLength;
+            carryLength = 0;
+            break;
+        }
+        int k = stx - carry;
+        noise += k;
+        if ( k >= kept ) {
+            //scanned again in the block
+            pos -= carryLength - k;
+            carryLength = 0;
+        } else {
+            memmove ( carry, carry + k, kept - k );
+            carryLength = kept - k;
+            pos -= taken;
+        }
+    }
+    return NULL;
+}
+
+const quint8* MdFrameSplitter::next ( int& length ) {
+    if ( carryLength > 0 ) {
+        const quint8* frame = completeCarry (length);
+        if ( frame || carryLength > 0 )
+            return frame;
+    }
+
+    while ( pos < blockLength ) {
+        const quint8* stx = (const quint8*) memchr ( block + pos, MD_FRAMEBEGIN, blockLength - pos );
+        if ( !stx ) {
+            noise += blockLength - pos;
+            pos = blockLength;
+            break;
+        }
+        int at = stx - block;
+        noise += at - pos;
+        int avail = blockLength - at;
+        int len = avail > 1 ? frameLength ( block[at + 1] ) : 0;
+        if ( avail < 2 || ( len && avail < len ) ) {
+            //the rest of the frame comes with the next block
+            memcpy ( carry, block + at, avail );
+            carryLength = avail;
+            pos = blockLength;
+            break;
+        }
+        if ( !len ) {
+            badTags++;
+            noise++;
+            pos = at + 1;
+            continue;
+        }
+        if ( block[at + len - 1] != MD_FRAMEEND ) {
+            badFrames++;
+            noise++;
+            pos = at + 1;
+            continue;
+        }
+        pos = at + len;
+        frames++;
+        length = len;
+        return block + at;
+    }
+    return NULL;
+}
@@ -0,0 +1,65 @@
+#ifndef MDFRAMESPLITTER_H
+#define MDFRAMESPLITTER_H
+
+#include "com/MdBinaryProtocol.h"
+
+#include <QtGlobal>
+
+/**
+  * splits the received byte stream into MD frames: STX, tag, payload, ETX, where the tag is
+  * the frame length. works on whole blocks of bytes: memchr() to the next STX, the tag
+  * gives the length, the ETX at that length is the one check of a frame. a frame inside
+  * the block is returned in place, only a frame across two blocks is copied together.
+  *
+  * noise and broken frames are skipped from the next STX on (which may be inside the
+  * broken frame), so a resync costs one scan of the bytes that were lost and is counted.
+  * nothing is cleared between frames.
+  */
+class MdFrameSplitter {
+public:
+    MdFrameSplitter ();
+
+    //! the next block of received bytes, it has to stay valid while next() is called
+    void feed ( const quint8* data, int length );
+    /**
+      * the next complete frame of the block, NULL when the block is used up (the start of
+      * a frame at its end is kept for the next block). valid until the next call
+      */
+    const quint8* next ( int& length );
+    //! drops a partially received frame, e.g. after the port was reopened
+    void reset ();
+
+    //! frame length of a tag, 0 if it is not a tag
+    static int frameLength ( quint8 tag );
+
+    //! counters since construction or resetCounters()
+    quint32 frameCount () const { return frames; }
+    //! bytes which were not part of a frame
+    quint32 noiseBytes () const { return noise; }
+    //! STX followed by something else than a tag
+    quint32 badTagCount () const { return badTags; }
+    //! STX and tag without the ETX at the end of the frame
+    quint32 badFrameCount () const { return badFrames; }
+    void resetCounters ();
+
+protected:
+    //! frames in the carry and the frame continued in the block, NULL if the carry is used up or needs more bytes
+    const quint8* completeCarry ( int& length );
+
+    const quint8* block;
+    int blockLength;
+    int pos;
+
+    //! begin of a frame received with an earlier block
+    quint8 carry[MD_MAXFRAME_SIZE];
+    int carryLength;
+    //! length of the frame next() returned from the carry, dropped by the next call
+    int carryUsed;
+
+    quint32 frames;
+    quint32 noise;
+    quint32 badTags;
+    quint32 badFrames;
+};
+
+#endif // MDFRAMESPLITTER_H
@@ -0,0 +1,365 @@
+#include "com/MdMd2Decoder.h"
+#include "data/MdChannel.h"
+
+#include "MdDataRecord.h"
+#include "Map16x1.h"
+
+/**
+  * the frame layouts in MdChannel order, one line per frame channel:
+  * channel, width, flags, divisor, add, offset in VERSION_2012, VERSION_2013 (-1: not in that layout).
+  * the fields table and the reads of decode() are generated from it.
+  *
+  * boost is absolute, efr_speed is read as the period of the turbo speed sensor,
+  * df_inj_time counts 2us steps, df_kline_freq comes from the avr (little endian).
+  * VERSION_2012 has df_sci_counter before df_voltage_raw and df_rpm_map instead of df_lc_flags.
+  * the Computed fields are the input bytes of the conversions in decode() and computeColumn().
+  */
+#define MD2_FIELDS(F) \
+    F( Time, 4, 0, 1, 0, 2, 2 ) \
+    F( Rpm, 2, 0, 1, 0, 6, 6 ) \
+    F( Throttle, 1, 0, 1, 0, 10, 10 ) \
+    F( Boost, 2, 0, 100, -1, 8, 8 ) \
+    F( Lambda, 2, 0, 100, 0, 11, 11 ) \
+    F( Lmm, 2, 0, 100, 0, 13, 13 ) \
+    F( Casetemp, 2, 0, 100, 0, 15, 15 ) \
+    F( Egt0, 2, 0, 1, 0, 17, 17 ) \
+    F( Egt1, 2, 0, 1, 0, 19, 19 ) \
+    F( Egt2, 2, 0, 1, 0, 21, 21 ) \
+    F( Egt3, 2, 0, 1, 0, 23, 23 ) \
+    F( Egt4, 2, 0, 1, 0, 25, 25 ) \
+    F( Egt5, 2, 0, 1, 0, 27, 27 ) \
+    F( Egt6, 2, 0, 1, 0, 29, 29 ) \
+    F( Egt7, 2, 0, 1, 0, 31, 31 ) \
+    F( Batcur, 2, 0, 100, 0, 33, 33 ) \
+    F( VdoPres1, 2, 0, 1, 0, 35, 35 ) \
+    F( VdoPres2, 2, 0, 1, 0, 37, 37 ) \
+    F( VdoPres3, 2, 0, 1, 0, 39, 39 ) \
+    F( VdoTemp1, 2, 0, 1, 0, 41, 41 ) \
+    F( VdoTemp2, 2, 0, 1, 0, 43, 43 ) \
+    F( VdoTemp3, 2, 0, 1, 0, 45, 45 ) \
+    F( Speed, 2, 0, 100, 0, 47, 47 ) \
+    F( Gear, 1, 0, 1, 0, 49, 49 ) \
+    F( N75, 1, 0, 1, 0, 50, 50 ) \
+    F( N75ReqBoost, 2, 0, 100, 0, 51, 51 ) \
+    F( N75ReqBoostPwm, 1, 0, 1, 0, 53, 53 ) \
+    F( Flags, 1, 0, 1, 0, 54, 54 ) \
+    F( EfrSpeed, 2, MdMd2Decoder::Computed, 1, 0, 55, 55 ) \
+    F( DfBoostRaw, 1, 0, 1, 0, 59, 59 ) \
+    F( DfLambda, 1, 0, 1, 0, 60, 60 ) \
+    F( DfKnockRaw, 1, 0, 1, 0, 61, 61 ) \
+    F( DfEctRaw, 1, 0, 1, 0, 62, 62 ) \
+    F( DfIatRaw, 1, 0, 1, 0, 63, 63 ) \
+    F( DfCoPoti, 1, 0, 1, 0, 64, 64 ) \
+    F( DfFlags, 1, 0, 1, 0, 65, 65 ) \
+    F( DfIgn, 1, 0, 1, 0, 66, 66 ) \
+    F( DfCyl1KnockRetard, 1, 0, 1, 0, 68, 68 ) \
+    F( DfCyl1KnockDecay, 1, 0, 1, 0, 69, 69 ) \
+    F( DfCyl2KnockRetard, 1, 0, 1, 0, 70, 70 ) \
+    F( DfCyl2KnockDecay, 1, 0, 1, 0, 71, 71 ) \
+    F( DfCyl3KnockRetard, 1, 0, 1, 0, 72, 72 ) \
+    F( DfCyl3KnockDecay, 1, 0, 1, 0, 73, 73 ) \
+    F( DfCyl4KnockRetard, 1, 0, 1, 0, 74, 74 ) \
+    F( DfCyl4KnockDecay, 1, 0, 1, 0, 75, 75 ) \
+    F( DfVoltageRaw, 1, 0, 1, 0, 77, 76 ) \
+    F( DfInjTime, 2, MdMd2Decoder::BigEndian, 0.5, 0, 78, 77 ) \
+    F( DfColdStartupEnrichment, 1, 0, 1, 0, 80, 79 ) \
+    F( DfWarmStartupEnrichment, 1, 0, 1, 0, 81, 80 ) \
+    F( DfEctEnrichment, 1, 0, 1, 0, 82, 81 ) \
+    F( DfAccelerationEnrichment, 1, 0, 1, 0, 83, 82 ) \
+    F( DfCounterStartupEnrichment, 1, 0, 1, 0, 84, 83 ) \
+    F( DfIatEnrichment, 1, 0, 1, 0, 85, 84 ) \
+    F( DfIgnitionAddonCounter, 1, 0, 1, 0, 86, 85 ) \
+    F( DfIgnitionAddon, 1, 0, 1, 0, 87, 86 ) \
+    F( DfEctInjectionAddon, 1, 0, 1, 0, 88, 87 ) \
+    F( DfRpmDeltaHall, 2, MdMd2Decoder::BigEndian, 1, 0, 90, 89 ) \
+    F( DfIsv, 1, 0, 1, 0, 89, 88 ) \
+    F( DfLcFlags, 1, 0, 1, 0, -1, 67 ) \
+    F( DfIgnitionTotalRetard, 1, MdMd2Decoder::Computed, 1, 0, 68, 68 ) \
+    F( DfEct, 1, MdMd2Decoder::Computed, 1, 0, 62, 62 ) \
+    F( DfIat, 1, MdMd2Decoder::Computed, 1, 0, 63, 63 ) \
+    F( DfIgnition, 1, MdMd2Decoder::Computed, 1, 0, 66, 66 ) \
+    F( DfVoltage, 1, MdMd2Decoder::Computed, 1, 0, 77, 76 ) \
+    F( Knock, 2, 0, 1, 0, 57, 57 ) \
+    F( DfKlineFreq, 2, 0, 1, 0, 92, 91 ) \
+    F( DfKlineFramenum, 1, 0, 1, 0, 94, 93 )
+
+#define MD2_FIELD_ENTRY(ch, width, flags, divisor, add, o2012, o2013) \
+    { MdChannel::ch, width, flags, divisor, add, { o2012, o2013 } },
+static const MdMd2Decoder::Field fields[] = {
+    MD2_FIELDS (MD2_FIELD_ENTRY)
+};
+#undef MD2_FIELD_ENTRY
+
+//! frame length per Version
+static const int lengths[MdMd2Decoder::VERSION_COUNT] = { 96, 95 };
+
+enum { FRAME_CHANNELS = MdChannel::DfKlineFramenum + 1 };
+
+//! the offset column of version, a new Version is a new parameter
+static inline int layoutOffset ( int version, int o2012, int o2013 ) {
+    return version == MdMd2Decoder::VERSION_2012 ? o2012 : o2013;
+}
+
+/**
+  * the Width bytes at offset o as integer, 0 if o < 0. with constant arguments (the reads
+  * of decode()) this is the code of a hand written read, no branch and no loop is left
+  */
+template <int Width, int Flags> static inline qint64 readField ( const quint8* d, int o ) {
+    if ( o < 0 )
+        return 0;
+    quint32 r = 0;
+    for ( int i = 0 ; i < Width ; i++ )
+        r |= (quint32) d[ o + ( (Flags & MdMd2Decoder::BigEndian) ? Width - 1 - i : i ) ] << (8 * i);
+    if ( !(Flags & MdMd2Decoder::Signed) )
+        return r;
+    quint32 sign = 1u << (8 * Width - 1);
+    return (qint64) (r ^ sign) - sign;
+}
+
+//! all fields of a frame of Version as integers, indexed by channel
+template <int Version> static void readFrame ( const quint8* d, qint64* r ) {
+#define MD2_READ(ch, width, flags, divisor, add, o2012, o2013) \
+    r[MdChannel::ch] = readField<width, flags> ( d, layoutOffset ( Version, o2012, o2013 ) );
+    MD2_FIELDS (MD2_READ)
+#undef MD2_READ
+}
+
+//! the fields of r with a divisor or add, the others are used as integers
+static void scaleFrame ( const qint64* r, double* v ) {
+#define MD2_SCALE(ch, width, flags, divisor, add, o2012, o2013) \
+    if ( divisor != 1 || add != 0 ) \
+        v[MdChannel::ch] = r[MdChannel::ch] / (double) divisor + add;
+    MD2_FIELDS (MD2_SCALE)
+#undef MD2_SCALE
+}
+
+/**
+  * appends a column of one field, Width and Flags (BigEndian, Signed) are the shape of
+  * the field -> the loop has no branch per frame. integers go through qint64:
+  * df_inj_time wraps like the 16 bit field it is
+  */
+template <int Width, int Flags, typename T>
+static void fillColumn ( const quint8* frames, int stride, int count, int o, double divisor, double add, T* out ) {
+    const quint8* d = frames;
+    if ( divisor == 1 && add == 0 ) {
+        for ( int i = 0 ; i < count ; i++, d += stride )
+            out[i] = (T) readField<Width, Flags> ( d, o );
+        return;
+    }
+    for ( int i = 0 ; i < count ; i++, d += stride )
+        out[i] = (T) (qint64) ( readField<Width, Flags> ( d, o ) / divisor + add );
+}
+
+template <int Width, int Flags>
+static void fillColumn ( const quint8* frames, int stride, int count, int o, double divisor, double add, double* out ) {
+    const quint8* d = frames;
+    for ( int i = 0 ; i < count ; i++, d += stride )
+        out[i] = readField<Width, Flags> ( d, o ) / divisor + add;
+}
+
+//! fillColumn() of the shape of f at offset o, zeros for a shape the layout does not use
+template <typename T>
+static void fieldColumn ( const MdMd2Decoder::Field& f, int o, const quint8* frames, int stride, int count, T* out ) {
+    switch ( f.width * 4 + ( f.flags & (MdMd2Decoder::BigEndian | MdMd2Decoder::Signed) ) ) {
+#define MD2_SHAPE(width, flags) \
+    case width * 4 + flags: \
+        fillColumn<width, flags> ( frames, stride, count, o, f.divisor, f.add, out ); \
+        break;
+    MD2_SHAPE (1, 0) MD2_SHAPE (1, 1) MD2_SHAPE (1, 2) MD2_SHAPE (1, 3)
+    MD2_SHAPE (2, 0) MD2_SHAPE (2, 1) MD2_SHAPE (2, 2) MD2_SHAPE (2, 3)
+    MD2_SHAPE (4, 0) MD2_SHAPE (4, 1) MD2_SHAPE (4, 2) MD2_SHAPE (4, 3)
+#undef MD2_SHAPE
+    default:
+        for ( int i = 0 ; i < count ; i++ )
+            out[i] = 0;
+    }
+}
+
+MdMd2Decoder::MdMd2Decoder ( int version ) : ver(version) {
+    if ( !isKnownVersion (ver) )
+        ver = VERSION_CURRENT;
+    dfEctMap = new Map16x1_NTC_ECT();
+    dfIatMap = new Map16x1_NTC_IAT();
+    dfVoltageMap = new Map16x1_Voltage();
+}
+
+MdMd2Decoder::~MdMd2Decoder () {
+    delete dfEctMap;
+    delete dfIatMap;
+    delete dfVoltageMap;
+}
+
+bool MdMd2Decoder::isKnownVersion ( int version ) {
+    return version >= VERSION_2012 && version <= VERSION_COUNT;
+}
+
+int MdMd2Decoder::frameLength ( int version ) {
+    return isKnownVersion (version) ? lengths[version - 1] : lengths[VERSION_CURRENT - 1];
+}
+
+MdSensorRecord* MdMd2Decoder::decode ( const quint8* frame, int length ) {
+    MdSensorRecord* sr = new MdSensorRecord();
+    if ( !decode ( frame, length, sr ) ) {
+        delete sr;
+        return NULL;
+    }
+    return sr;
+}
+
+bool MdMd2Decoder::decode ( const quint8* frame, int length, MdSensorRecord* out ) {
+    if ( length < frameLength (ver) )
+        return false;
+
+    qint64 r[FRAME_CHANNELS];
+    if ( ver == VERSION_2012 )
+        readFrame<VERSION_2012> ( frame, r );
+    else
+        readFrame<VERSION_2013> ( frame, r );
+    double v[FRAME_CHANNELS];
+    scaleFrame ( r, v );
+
+    using namespace MdChannel;
+    v[EfrSpeed] = ( r[EfrSpeed] == 0xFFFF ) ? 0 : 40000000.0 / r[EfrSpeed];
+    v[DfIgnitionTotalRetard] = ( r[DfCyl1KnockRetard] + r[DfCyl2KnockRetard] + r[DfCyl3KnockRetard] + r[DfCyl4KnockRetard] ) * 0.351563;
+    v[DfEct] = dfEctMap->mapValue ( (int) r[DfEct] );
+    v[DfIat] = dfIatMap->mapValue ( (int) r[DfIat] );
+    //launch control doubles the ignition step
+    v[DfIgnition] = ( ( ( r[DfLcFlags] & 3 ) == 1 ? 2 : 1 ) * r[DfIgnition] * -0.351563 ) + 73.9;
+    v[DfVoltage] = dfVoltageMap->mapValue ( (int) r[DfVoltage] );
+
+    *out = MdSensorRecord ( (qint32) r[Time], r[Rpm], r[Throttle], v[Boost], v[Lambda], v[Lmm],
+                            v[Casetemp], r[Egt0], r[Egt1], r[Egt2], r[Egt3], r[Egt4], r[Egt5], r[Egt6], r[Egt7],
+                            v[Batcur],
+                            r[VdoPres1], r[VdoPres2], r[VdoPres3],
+                            r[VdoTemp1], r[VdoTemp2], r[VdoTemp3],
+                            v[Speed], r[Gear], r[N75], v[N75ReqBoost], r[N75ReqBoostPwm], r[Flags],
+                            v[EfrSpeed],
+                            r[DfBoostRaw], r[DfLambda], r[DfKnockRaw], r[DfEctRaw],
+                            r[DfIatRaw], r[DfCoPoti], r[DfFlags], r[DfIgn],
+                            r[DfCyl1KnockRetard], r[DfCyl1KnockDecay], r[DfCyl2KnockRetard], r[DfCyl2KnockDecay],
+                            r[DfCyl3KnockRetard], r[DfCyl3KnockDecay], r[DfCyl4KnockRetard], r[DfCyl4KnockDecay],
+                            r[DfVoltageRaw], (qint64) v[DfInjTime],
+                            r[DfColdStartupEnrichment], r[DfWarmStartupEnrichment], r[DfEctEnrichment],
+                            r[DfAccelerationEnrichment], r[DfCounterStartupEnrichment], r[DfIatEnrichment],
+                            r[DfIgnitionAddonCounter], r[DfIgnitionAddon], r[DfEctInjectionAddon],
+                            r[DfRpmDeltaHall], r[DfIsv], r[DfLcFlags],
+                            v[DfIgnitionTotalRetard], v[DfEct], v[DfIat], v[DfIgnition], v[DfVoltage],
+                            r[Knock], r[DfKlineFreq], r[DfKlineFramenum] );
+    return true;
+}
+
+const MdMd2Decoder::Field* MdMd2Decoder::field ( int channel ) {
+    if ( channel < 0 || channel >= FRAME_CHANNELS )
+        return NULL;
+    return &fields[channel];
+}
+
+int MdMd2Decoder::offset ( int version, const Field& f ) {
+    if ( !isKnownVersion (version) )
+        version = VERSION_CURRENT;
+    return f.offset[version - 1];
+}
+
+quint32 MdMd2Decoder::raw ( const quint8* frame, const Field& f ) const {
+    int o = offset ( ver, f );
+    if ( o < 0 )
+        return 0;
+    quint32 r = 0;
+    for ( int i = 0 ; i < f.width ; i++ )
+        r |= (quint32) frame[ o + ( (f.flags & BigEndian) ? f.width - 1 - i : i ) ] << (8 * i);
+    return r;
+}
+
+double MdMd2Decoder::value ( const quint8* frame, const Field& f ) {
+    double v;
+    if ( f.flags & Computed )
+        computeColumn ( f.channel, frame, 0, 1, &v );
+    else
+        fieldColumn ( f, offset ( ver, f ), frame, 0, 1, &v );
+    return v;
+}
+
+void MdMd2Decoder::computeColumn ( int channel, const quint8* frames, int stride, int count, double* out ) {
+    int o = offset ( ver, fields[channel] );
+    const quint8* d = frames;
+    switch ( channel ) {
+    case MdChannel::EfrSpeed:
+        for ( int i = 0 ; i < count ; i++, d += stride ) {
+            qint64 period = readField<2, 0> ( d, o );
+            out[i] = ( period == 0xFFFF ) ? 0 : 40000000.0 / period;
+        }
+        break;
+    case MdChannel::DfIgnitionTotalRetard: {
+        int c1 = offset ( ver, fields[MdChannel::DfCyl1KnockRetard] );
+        int c2 = offset ( ver, fields[MdChannel::DfCyl2KnockRetard] );
+        int c3 = offset ( ver, fields[MdChannel::DfCyl3KnockRetard] );
+        int c4 = offset ( ver, fields[MdChannel::DfCyl4KnockRetard] );
+        for ( int i = 0 ; i < count ; i++, d += stride )
+            out[i] = ( readField<1, 0> ( d, c1 ) + readField<1, 0> ( d, c2 )
+                       + readField<1, 0> ( d, c3 ) + readField<1, 0> ( d, c4 ) ) * 0.351563;
+        break;
+    }
+    case MdChannel::DfEct:
+        for ( int i = 0 ; i < count ; i++, d += stride )
+            out[i] = dfEctMap->mapValue ( (int) readField<1, 0> ( d, o ) );
+        break;
+    case MdChannel::DfIat:
+        for ( int i = 0 ; i < count ; i++, d += stride )
+            out[i] = dfIatMap->mapValue ( (int) readField<1, 0> ( d, o ) );
+        break;
+    case MdChannel::DfIgnition: {
+        int lc = offset ( ver, fields[MdChannel::DfLcFlags] );
+        for ( int i = 0 ; i < count ; i++, d += stride )
+            out[i] = ( ( ( readField<1, 0> ( d, lc ) & 3 ) == 1 ? 2 : 1 ) * readField<1, 0> ( d, o ) * -0.351563 ) + 73.9;
+        break;
+    }
+    case MdChannel::DfVoltage:
+        for ( int i = 0 ; i < count ; i++, d += stride )
+            out[i] = dfVoltageMap->mapValue ( (int) readField<1, 0> ( d, o ) );
+        break;
+    default:
+        for ( int i = 0 ; i < count ; i++ )
+            out[i] = 0;
+    }
+}
+
+//! MdChannel::visit visitor appending a decoded column, one pass over all frames
+struct FieldColumn {
+    typedef void Result;
+    MdMd2Decoder* dec;
+    const MdMd2Decoder::Field* f;
+    const quint8* frames;
+    int stride;
+    int count;
+    QByteArray* out;
+    template <typename T> void apply () {
+        int old = out->size();
+        out->resize ( old + count * (int) sizeof(T) );
+        T* o = reinterpret_cast<T*> ( out->data() + old );
+        fieldColumn ( *f, MdMd2Decoder::offset ( dec->version(), *f ), frames, stride, count, o );
+    }
+};
+
+template <> void FieldColumn::apply<double> () {
+    int old = out->size();
+    out->resize ( old + count * (int) sizeof(double) );
+    double* o = reinterpret_cast<double*> ( out->data() + old );
+    if ( f->flags & MdMd2Decoder::Computed )
+        dec->computeColumn ( f->channel, frames, stride, count, o );
+    else
+        fieldColumn ( *f, MdMd2Decoder::offset ( dec->version(), *f ), frames, stride, count, o );
+}
+
+void MdMd2Decoder::decodeColumn ( int channel, const quint8* frames, int stride, int count, QByteArray& out ) {
+    const Field* f = field (channel);
+    if ( !f || count <= 0 )
+        return;
+    FieldColumn v = { this, f, frames, stride, count, &out };
+    MdChannel::visit ( MdChannel::descriptor(channel).type, v );
+}
+
+void MdMd2Decoder::decodeColumns ( const quint8* frames, int stride, int count, QByteArray* const* out ) {
+    for ( int c = 0 ; c < FRAME_CHANNELS ; c++ )
+        if ( out[c] )
+            decodeColumn ( c, frames, stride, count, *out[c] );
+}
@@ -0,0 +1,107 @@
+#ifndef MDMD2DECODER_H
+#define MDMD2DECODER_H
+
+#include <QtGlobal>
+#include <QByteArray>
+
+class MdSensorRecord;
+class Map16x1_NTC_ECT;
+class Map16x1_NTC_IAT;
+class Map16x1_Voltage;
+
+/**
+  * converts a complete MD2 measurement frame (STX tag ... ETX) into a sensor record.
+  * no state besides the Digifant maps -> the same frame always gives the same record,
+  * which is what the raw capture re-decoding relies on. not thread safe, use one
+  * decoder per thread.
+  *
+  * the frame layouts are one table (see Field), a line per MdChannel::Frame channel with
+  * the offset of the field in every Version. decode() runs reads generated from the table
+  * with the offsets as constants, the columns read a field with one loop per shape.
+  * a new frame revision is a new Version and an offset column in the table.
+  */
+class MdMd2Decoder {
+public:
+    /**
+      * frame layouts / conversion revisions, stored in raw captures.
+      * add a new version instead of changing an old one!
+      */
+    enum Version {
+        //! df_rpm_map instead of df_lc_flags, df_sci_counter after the knock bytes
+        VERSION_2012 = 1,
+        //! 2013-9-18: df_lc_flags, no df_sci_counter
+        VERSION_2013 = 2,
+        VERSION_CURRENT = VERSION_2013,
+        VERSION_COUNT = VERSION_CURRENT
+    };
+
+    //! how the bytes of a field are read
+    enum FieldFlags {
+        //! the Digifant values (68HC11 is big endian), the MD itself is little endian
+        BigEndian = 1,
+        Signed = 2,
+        //! the bytes are the input of a conversion (map, sum, period), see value()
+        Computed = 4
+    };
+    /**
+      * a frame channel: the width bytes at offset[version - 1] (-1: not in that layout)
+      * as integer, raw / divisor + add is the value of the channel
+      */
+    struct Field {
+        quint16 channel;
+        quint8 width;
+        quint8 flags;
+        double divisor;
+        double add;
+        qint8 offset[VERSION_COUNT];
+    };
+
+    MdMd2Decoder ( int version = VERSION_CURRENT );
+    virtual ~MdMd2Decoder ();
+
+    int version () const { return ver; }
+    static bool isKnownVersion ( int version );
+    //! frame length including STX, tag and ETX
+    static int frameLength ( int version );
+
+    //! NULL if the frame is too short for this layout. the caller takes ownership!
+    MdSensorRecord* decode ( const quint8* frame, int length );
+    //! assigns all fields of out, nothing is allocated. false (out unchanged) if the frame is too short
+    bool decode ( const quint8* frame, int length, MdSensorRecord* out );
+
+    //! field of a MdChannel::Frame channel, NULL for the others
+    static const Field* field ( int channel );
+    //! offset of f in a frame of version, -1 if that layout does not have the field
+    static int offset ( int version, const Field& f );
+    //! the field bytes of a frame (of version()) as integer, 0 if the layout does not have the field
+    quint32 raw ( const quint8* frame, const Field& f ) const;
+    //! the value decode() gives the record field of a frame channel
+    double value ( const quint8* frame, const Field& f );
+    /**
+      * decodes channel from count frames stride bytes apart and appends the values in the
+      * type of the channel to out, which is one column of a MdSessionColumns
+      */
+    void decodeColumn ( int channel, const quint8* frames, int stride, int count, QByteArray& out );
+    /**
+      * batch form of decode(): decodeColumn() of every frame channel with a column in out
+      * (indexed by channel, NULL: skipped). one pass per channel over the frames instead
+      * of a record per frame
+      */
+    void decodeColumns ( const quint8* frames, int stride, int count, QByteArray* const* out );
+
+protected:
+    friend struct FieldColumn;
+
+    void computeColumn ( int channel, const quint8* frames, int stride, int count, double* out );
+
+    int ver;
+    Map16x1_NTC_ECT *dfEctMap;
+    Map16x1_NTC_IAT *dfIatMap;
+    Map16x1_Voltage *dfVoltageMap;
+
+private:
+    MdMd2Decoder ( const MdMd2Decoder& );
+    MdMd2Decoder& operator= ( const MdMd2Decoder& );
+};
+
+#endif // MDMD2DECODER_H
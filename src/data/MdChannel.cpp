@@ -0,0 +1,106 @@
+#include "data/MdChannel.h"
+
+namespace MdChannel {
+
+#define MD_CHANNEL_DESCRIPTOR(id, type, name, label, unit, scale, usage, field) { id, type, name, label, unit, scale, usage },
+static const Descriptor descriptors[Count] = {
+    MD_CHANNELS(MD_CHANNEL_DESCRIPTOR)
+};
+#undef MD_CHANNEL_DESCRIPTOR
+
+static const TableColumn tableColumns[] = {
+    { Time, NULL },
+    { Rpm, NULL },
+    { Boost, NULL },
+    { Throttle, NULL },
+    { Lambda, NULL },
+    { Lmm, NULL },
+    { Casetemp, NULL },
+    { Egt0, NULL },
+    { Egt1, NULL },
+    { Egt2, NULL },
+    { Egt3, NULL },
+    { Egt4, NULL },
+    { Egt5, NULL },
+    { Egt6, NULL },
+    { Egt7, NULL },
+    { Batcur, NULL },
+    { VdoPres1, NULL },
+    { VdoPres2, NULL },
+    { VdoPres3, NULL },
+    { VdoTemp1, NULL },
+    { VdoTemp2, NULL },
+    { VdoTemp3, NULL },
+    { Speed, NULL },
+    { Gear, NULL },
+    { N75, NULL },
+    { N75ReqBoost, NULL },
+    { N75ReqBoostPwm, NULL },
+    { EfrSpeed, NULL },
+
+    //Digifant
+    { DfIgnition, NULL },
+    { DfIgnitionTotalRetard, NULL },
+    { DfInjTime, NULL },
+    { DfIat, NULL },
+    { DfEct, NULL },
+    { DfKnockRaw, NULL },
+    { DfBoostRaw, NULL },
+    { DfColdStartupEnrichment, NULL },
+    { DfWarmStartupEnrichment, NULL },
+    { DfEctEnrichment, NULL },
+    { DfIatEnrichment, NULL },
+    { DfCounterStartupEnrichment, NULL },
+    { DfVoltage, NULL },
+    { DfAccelerationEnrichment, NULL },
+    { DfEctInjectionAddon, NULL },
+    { DfLambda, NULL },
+    { DfCoPoti, NULL },
+    { DfIsv, NULL },
+    { DfLcFlags, NULL },
+    //freq / framenum
+    { DfKlineFreq, "Kline dbg" },
+
+    //latitude, longitude
+    { GpsLatitude, "GPS Coordinates" },
+    { GpsGroundSpeed, NULL },
+    { GpsAltitude, NULL },
+    //x | y | z
+    { AccX, "Acceleration" }
+};
+
+const Descriptor& descriptor ( int id ) {
+    Q_ASSERT ( id >= 0 && id < Count );
+    return descriptors[id];
+}
+
+int typeSize ( int type ) {
+    switch ( type ) {
+    case TypeUInt8:
+        return 1;
+    case TypeUInt16:
+        return 2;
+    case TypeInt32:
+        return 4;
+    case TypeInt64:
+    case TypeDouble:
+        return 8;
+    }
+    return 0;
+}
+
+int tableColumnCount () {
+    return sizeof(tableColumns) / sizeof(tableColumns[0]);
+}
+
+const TableColumn& tableColumn ( int column ) {
+    Q_ASSERT ( column >= 0 && column < tableColumnCount() );
+    return tableColumns[column];
+}
+
+const char* tableHeader ( int column ) {
+    const TableColumn& c = tableColumn (column);
+    return c.header ? c.header : descriptors[c.channel].label;
+}
+
+} // namespace
@@ -0,0 +1,211 @@
+#ifndef MDCHANNEL_H
+#define MDCHANNEL_H
+
+#include <QtGlobal>
+
+/**
+  * channel schema of a stored session (mdv3) and the registry of everything known about a channel.
+  * every field of MdSensorRecord and MobileSensorRecord gets a stable id.
+  * the ids are written to the file header -> never renumber, only append!
+  */
+namespace MdChannel {
+
+enum Type {
+    TypeUInt8 = 1,
+    TypeUInt16 = 2,
+    TypeInt32 = 3,
+    TypeInt64 = 4,
+    TypeDouble = 5,
+    //! variable length, stored as quint16 length + utf8 bytes per row
+    TypeString = 6
+};
+
+//! what a channel is used for besides being stored
+enum Usage {
+    //! a physical value worth a curve or a min / max (no bit fields, counters, debug values)
+    Plot = 1,
+    //! column of the default csv export
+    Export = 2,
+    //! field of the MD2 frame, see MdMd2Decoder::field
+    Frame = 4,
+    //! sent by the Digifant, changes at the K-line frame rate only (see MdSessionColumns::pack)
+    Kline = 8
+};
+
+/**
+  * the registry, one line per channel in id order:
+  * id, storage type, file name, label, unit, raw to physical scale, usage, record field.
+  * the enum, the descriptor table and the typed Value<> are generated from it, the
+  * record field (a member of the MdSensorRecord s or the MobileSensorRecord m) gives
+  * the record accessors of MdSessionColumns.
+  *
+  * gps_latitude was the coordinate text (TypeString) before, see MdSessionReader.
+  * gps_timestamp is msecs since epoch.
+  * df_kline_freq is measured by the MD for every frame, it is not a K-line value.
+  */
+#define MD_CHANNELS(X) \
+    X( Time, TypeInt32, "time", "Time", "ms", 1, Plot|Export|Frame, s.time ) \
+    X( Rpm, TypeInt32, "rpm", "RPM", "1/min", 1, Plot|Export|Frame, s.rpm ) \
+    X( Throttle, TypeInt32, "throttle", "Throttle", "%", 1, Plot|Export|Frame, s.throttle ) \
+    X( Boost, TypeDouble, "boost", "Boost", "bar", 1, Plot|Export|Frame, s.boost ) \
+    X( Lambda, TypeDouble, "lambda", "Lambda", "", 1, Plot|Export|Frame, s.lambda ) \
+    X( Lmm, TypeDouble, "lmm", "LMM", "V", 1, Plot|Export|Frame, s.lmm ) \
+    X( Casetemp, TypeDouble, "casetemp", "CaseTemp", "degC", 1, Plot|Export|Frame, s.casetemp ) \
+    X( Egt0, TypeDouble, "egt0", "AGT0", "degC", 1, Plot|Export|Frame, s.egt[0] ) \
+    X( Egt1, TypeDouble, "egt1", "AGT1", "degC", 1, Plot|Export|Frame, s.egt[1] ) \
+    X( Egt2, TypeDouble, "egt2", "AGT2", "degC", 1, Plot|Export|Frame, s.egt[2] ) \
+    X( Egt3, TypeDouble, "egt3", "AGT3", "degC", 1, Plot|Export|Frame, s.egt[3] ) \
+    X( Egt4, TypeDouble, "egt4", "AGT4", "degC", 1, Plot|Export|Frame, s.egt[4] ) \
+    X( Egt5, TypeDouble, "egt5", "AGT5", "degC", 1, Plot|Export|Frame, s.egt[5] ) \
+    X( Egt6, TypeDouble, "egt6", "AGT6", "degC", 1, Plot|Export|Frame, s.egt[6] ) \
+    X( Egt7, TypeDouble, "egt7", "AGT7", "degC", 1, Plot|Export|Frame, s.egt[7] ) \
+    X( Batcur, TypeDouble, "batcur", "Battery V", "V", 1, Plot|Export|Frame, s.batcur ) \
+    X( VdoPres1, TypeDouble, "vdo_pres1", "VDO Pres1", "bar", 0.001, Plot|Export|Frame, s.VDOPres1 ) \
+    X( VdoPres2, TypeDouble, "vdo_pres2", "VDO Pres2", "bar", 0.001, Plot|Export|Frame, s.VDOPres2 ) \
+    X( VdoPres3, TypeDouble, "vdo_pres3", "VDO Pres3", "bar", 0.001, Plot|Export|Frame, s.VDOPres3 ) \
+    X( VdoTemp1, TypeDouble, "vdo_temp1", "VDO Temp1", "degC", 1, Plot|Export|Frame, s.VDOTemp1 ) \
+    X( VdoTemp2, TypeDouble, "vdo_temp2", "VDO Temp2", "degC", 1, Plot|Export|Frame, s.VDOTemp2 ) \
+    X( VdoTemp3, TypeDouble, "vdo_temp3", "VDO Temp3", "degC", 1, Plot|Export|Frame, s.VDOTemp3 ) \
+    X( Speed, TypeDouble, "speed", "Speed", "km/h", 1, Plot|Export|Frame, s.speed ) \
+    X( Gear, TypeInt32, "gear", "Gear", "", 1, Plot|Export|Frame, s.gear ) \
+    X( N75, TypeInt32, "n75", "N75 duty", "", 1, Plot|Export|Frame, s.n75 ) \
+    X( N75ReqBoost, TypeDouble, "n75_req_boost", "N75 Pid Bst", "bar", 1, Plot|Export|Frame, s.n75_req_boost ) \
+    X( N75ReqBoostPwm, TypeUInt8, "n75_req_boost_pwm", "N75 Map duty", "", 1, Plot|Export|Frame, s.n75_req_boost_pwm ) \
+    X( Flags, TypeUInt8, "flags", "Flags", "", 1, Export|Frame, s.flags ) \
+    X( EfrSpeed, TypeDouble, "efr_speed", "EFR speed", "1/min", 1, Plot|Export|Frame, s.efr_speed ) \
+    X( DfBoostRaw, TypeUInt8, "df_boost_raw", "DF boost", "", 1, Plot|Export|Frame|Kline, s.df_boost_raw ) \
+    X( DfLambda, TypeUInt8, "df_lambda", "DF Lambda Raw", "", 1, Plot|Export|Frame|Kline, s.df_lambda ) \
+    X( DfKnockRaw, TypeUInt8, "df_knock_raw", "DF raw knock", "", 1, Plot|Export|Frame|Kline, s.df_knock_raw ) \
+    X( DfEctRaw, TypeUInt8, "df_ect_raw", "DF ECT raw", "", 1, Export|Frame|Kline, s.df_ect_raw ) \
+    X( DfIatRaw, TypeUInt8, "df_iat_raw", "DF IAT raw", "", 1, Export|Frame|Kline, s.df_iat_raw ) \
+    X( DfCoPoti, TypeUInt8, "df_co_poti", "DF CO", "", 1, Plot|Export|Frame|Kline, s.df_co_poti ) \
+    X( DfFlags, TypeUInt8, "df_flags", "DF flags", "", 1, Export|Frame|Kline, s.df_flags ) \
+    X( DfIgn, TypeUInt8, "df_ign", "DF Ign raw", "", 1, Export|Frame|Kline, s.df_ign ) \
+    X( DfCyl1KnockRetard, TypeUInt8, "df_cyl1_knock_retard", "DF cyl1 knock retard", "deg", 0.351563, Plot|Export|Frame|Kline, s.df_cyl1_knock_retard ) \
+    X( DfCyl1KnockDecay, TypeUInt8, "df_cyl1_knock_decay", "DF cyl1 knock decay", "", 1, Export|Frame|Kline, s.df_cyl1_knock_decay ) \
+    X( DfCyl2KnockRetard, TypeUInt8, "df_cyl2_knock_retard", "DF cyl2 knock retard", "deg", 0.351563, Plot|Export|Frame|Kline, s.df_cyl2_knock_retard ) \
+    X( DfCyl2KnockDecay, TypeUInt8, "df_cyl2_knock_decay", "DF cyl2 knock decay", "", 1, Export|Frame|Kline, s.df_cyl2_knock_decay ) \
+    X( DfCyl3KnockRetard, TypeUInt8, "df_cyl3_knock_retard", "DF cyl3 knock retard", "deg", 0.351563, Plot|Export|Frame|Kline, s.df_cyl3_knock_retard ) \
+    X( DfCyl3KnockDecay, TypeUInt8, "df_cyl3_knock_decay", "DF cyl3 knock decay", "", 1, Export|Frame|Kline, s.df_cyl3_knock_decay ) \
+    X( DfCyl4KnockRetard, TypeUInt8, "df_cyl4_knock_retard", "DF cyl4 knock retard", "deg", 0.351563, Plot|Export|Frame|Kline, s.df_cyl4_knock_retard ) \
+    X( DfCyl4KnockDecay, TypeUInt8, "df_cyl4_knock_decay", "DF cyl4 knock decay", "", 1, Export|Frame|Kline, s.df_cyl4_knock_decay ) \
+    X( DfVoltageRaw, TypeUInt8, "df_voltage_raw", "DF voltage raw", "", 1, Export|Frame|Kline, s.df_voltage_raw ) \
+    X( DfInjTime, TypeUInt16, "df_inj_time", "DF Injection", "ms", 0.001, Plot|Export|Frame|Kline, s.df_inj_time ) \
+    X( DfColdStartupEnrichment, TypeUInt8, "df_cold_startup_enrichment", "DF cold startup enrich", "", 1, Plot|Export|Frame|Kline, s.df_cold_startup_enrichment ) \
+    X( DfWarmStartupEnrichment, TypeUInt8, "df_warm_startup_enrichment", "DF warm startup enrich", "", 1, Plot|Export|Frame|Kline, s.df_warm_startup_enrichment ) \
+    X( DfEctEnrichment, TypeUInt8, "df_ect_enrichment", "DF ect enrich", "", 1, Plot|Export|Frame|Kline, s.df_ect_enrichment ) \
+    X( DfAccelerationEnrichment, TypeUInt8, "df_acceleration_enrichment", "DF acc enrich", "", 1, Plot|Export|Frame|Kline, s.df_acceleration_enrichment ) \
+    X( DfCounterStartupEnrichment, TypeUInt8, "df_counter_startup_enrichment", "DF counter startup enrich", "", 1, Plot|Export|Frame|Kline, s.df_counter_startup_enrichment ) \
+    X( DfIatEnrichment, TypeUInt8, "df_iat_enrichment", "DF iat enrich", "", 1, Plot|Export|Frame|Kline, s.df_iat_enrichment ) \
+    X( DfIgnitionAddonCounter, TypeUInt8, "df_ignition_addon_counter", "DF ign addon counter", "", 1, Export|Frame|Kline, s.df_ignition_addon_counter ) \
+    X( DfIgnitionAddon, TypeUInt8, "df_igniton_addon", "DF ign addon", "", 1, Plot|Export|Frame|Kline, s.df_igniton_addon ) \
+    X( DfEctInjectionAddon, TypeUInt8, "df_ect_injection_addon", "DF ect inj addon", "", 1, Plot|Export|Frame|Kline, s.df_ect_injection_addon ) \
+    X( DfRpmDeltaHall, TypeUInt16, "df_rpm_delta_hall", "DF rpm delta hall", "", 1, Export|Frame|Kline, s.df_rpm_delta_hall ) \
+    X( DfIsv, TypeUInt8, "df_isv", "DF ISV", "", 1, Plot|Export|Frame|Kline, s.df_isv ) \
+    X( DfLcFlags, TypeUInt8, "df_lc_flags", "DF LC flags", "", 1, Export|Frame|Kline, s.df_lc_flags ) \
+    X( DfIgnitionTotalRetard, TypeDouble, "df_ignition_total_retard", "DF Ign Retard", "deg", 1, Plot|Export|Frame|Kline, s.df_ignition_total_retard ) \
+    X( DfEct, TypeDouble, "df_ect", "DF ECT", "degC", 1, Plot|Export|Frame|Kline, s.df_ect ) \
+    X( DfIat, TypeDouble, "df_iat", "DF IAT", "degC", 1, Plot|Export|Frame|Kline, s.df_iat ) \
+    X( DfIgnition, TypeDouble, "df_ignition", "DF Ignition", "deg", 1, Plot|Export|Frame|Kline, s.df_ignition ) \
+    X( DfVoltage, TypeDouble, "df_voltage", "DF voltage", "V", 1, Plot|Export|Frame|Kline, s.df_voltage ) \
+    X( Knock, TypeUInt16, "knock", "Knock", "", 1, Plot|Export|Frame, s.knock ) \
+    X( DfKlineFreq, TypeUInt16, "df_kline_freq", "Kline freq", "Hz", 1, Frame, s.df_kline_freq ) \
+    X( DfKlineFramenum, TypeUInt8, "df_kline_framenum", "Kline frame", "", 1, Frame|Kline, s.df_kline_framenum ) \
+    \
+    /* MobileSensorRecord */ \
+    X( AccX, TypeDouble, "acc_x", "Acceleration X", "", 1, Plot|Export, m.accX ) \
+    X( AccY, TypeDouble, "acc_y", "Acceleration Y", "", 1, Plot|Export, m.accY ) \
+    X( AccZ, TypeDouble, "acc_z", "Acceleration Z", "", 1, Plot|Export, m.accZ ) \
+    X( MdTimestamp, TypeInt32, "md_timestamp", "MD time", "ms", 1, Export, m.mdTimestamp ) \
+    X( GpsTimestamp, TypeInt64, "gps_timestamp", "GPS time", "ms", 1, Export, m.gpsTimestamp ) \
+    X( GpsLatitude, TypeDouble, "gps_latitude", "GPS Latitude", "deg", 1, Export, m.gpsLatitude ) \
+    X( GpsAltitude, TypeDouble, "gps_altitude", "GPS Altitude", "m", 1, Plot|Export, m.gpsAltitude ) \
+    X( GpsGroundSpeed, TypeDouble, "gps_ground_speed", "GPS Speed", "m/s", 1, Plot|Export, m.gpsGroundSpeed ) \
+    X( GpsDirection, TypeDouble, "gps_direction", "GPS Direction", "deg", 1, Export, m.gpsDirection ) \
+    X( GpsHorizontalAccuracy, TypeDouble, "gps_horizontal_accuracy", "GPS hor. accuracy", "m", 1, Export, m.gpsHorizontalAccuracy ) \
+    X( GpsVerticalAccuracy, TypeDouble, "gps_vertical_accuracy", "GPS vert. accuracy", "m", 1, Export, m.gpsVerticalAccuracy ) \
+    X( GpsValid, TypeUInt8, "gps_valid", "GPS valid", "", 1, Export, m.gpsValid ) \
+    X( GpsUpdateCount, TypeInt32, "gps_update_count", "GPS updates", "", 1, Export, m.gpsUpdateCount ) \
+    X( MillisSinceLastMdFrame, TypeInt32, "millis_since_last_md_frame", "GPS MD frame age", "ms", 1, 0, m.millisElapsedSinceLastMdFrame ) \
+    X( GpsLongitude, TypeDouble, "gps_longitude", "GPS Longitude", "deg", 1, Export, m.gpsLongitude )
+
+#define MD_CHANNEL_ID(id, type, name, label, unit, scale, usage, field) id,
+enum Id {
+    MD_CHANNELS(MD_CHANNEL_ID)
+    Count
+};
+#undef MD_CHANNEL_ID
+
+struct Descriptor {
+    quint16 id;
+    quint8 type;
+    //! stored in the file header and used as csv header
+    const char* name;
+    //! shown in the data view
+    const char* label;
+    const char* unit;
+    //! physical value = stored value * scale
+    double scale;
+    //! Usage flags
+    quint8 usage;
+};
+
+const Descriptor& descriptor ( int id );
+
+//! size of one value in bytes, 0 for TypeString
+int typeSize ( int type );
+
+//! C++ type of a storage type
+template <int T> struct Storage;
+template <> struct Storage<TypeUInt8> { typedef quint8 Type; };
+template <> struct Storage<TypeUInt16> { typedef quint16 Type; };
+template <> struct Storage<TypeInt32> { typedef qint32 Type; };
+template <> struct Storage<TypeInt64> { typedef qint64 Type; };
+template <> struct Storage<TypeDouble> { typedef double Type; };
+
+//! C++ type of channel Id, e.g. Value<Rpm>::Type is qint32
+template <int Id> struct Value;
+#define MD_CHANNEL_VALUE(id, type, name, label, unit, scale, usage, field) \
+    template <> struct Value<id> { typedef Storage<type>::Type Type; };
+MD_CHANNELS(MD_CHANNEL_VALUE)
+#undef MD_CHANNEL_VALUE
+
+/**
+  * calls v.apply<T>() with the C++ type of a fixed size storage type and returns its result,
+  * V::Result for TypeString. one switch per column instead of a QVariant per value:
+  *
+  *   struct Sum { typedef double Result; const char* p; int n;
+  *                template <typename T> double apply () { ... reinterpret_cast<const T*> (p) ... } };
+  */
+template <typename V> typename V::Result visit ( int type, V& v ) {
+    switch ( type ) {
+    case TypeUInt8:
+        return v.template apply<quint8> ();
+    case TypeUInt16:
+        return v.template apply<quint16> ();
+    case TypeInt32:
+        return v.template apply<qint32> ();
+    case TypeInt64:
+        return v.template apply<qint64> ();
+    case TypeDouble:
+        return v.template apply<double> ();
+    }
+    return typename V::Result ();
+}
+
+//! columns of the data view, in order. hidden columns are saved by position -> only append!
+struct TableColumn {
+    //! the value shown, the view formats some columns from more channels
+    quint16 channel;
+    //! NULL: the label of the channel
+    const char* header;
+};
+
+int tableColumnCount ();
+const TableColumn& tableColumn ( int column );
+//! header of a data view column
+const char* tableHeader ( int column );
+
+} // namespace
+
+#endif // MDCHANNEL_H
@@ -0,0 +1,260 @@
+#include "data/MdChannelCodec.h"
+#include "data/MdChannel.h"
+
+#include <string.h>
+
+static inline void putVarint ( QByteArray& out, quint64 v ) {
+    char buf[10];
+    int n = 0;
+    while ( v >= 0x80 ) {
+        buf[n++] = (char) (v | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = (char) v;
+    out.append ( buf, n );
+}
+
+static inline bool getVarint ( const uchar*& p, const uchar* end, quint64& v ) {
+    v = 0;
+    for ( int shift = 0 ; p < end && shift < 64 ; shift += 7 ) {
+        uchar b = *p++;
+        v |= (quint64) (b & 0x7F) << shift;
+        if ( !(b & 0x80) )
+            return true;
+    }
+    return false;
+}
+
+static inline quint64 zigzag ( qint64 v ) {
+    return ( (quint64) v << 1 ) ^ (quint64) (v >> 63);
+}
+
+static inline qint64 unzigzag ( quint64 v ) {
+    return (qint64) (v >> 1) ^ -(qint64) (v & 1);
+}
+
+static bool isInteger ( int type ) {
+    return type == MdChannel::TypeUInt8 || type == MdChannel::TypeUInt16
+            || type == MdChannel::TypeInt32 || type == MdChannel::TypeInt64;
+}
+
+/**
+  * integer channels as zigzag varints of the first (order 1) or second (order 2) difference
+  */
+template <typename T> static void encodeDiff ( const T* v, int rows, int order, QByteArray& out ) {
+    //unsigned arithmetic: differences of extreme 64 bit values wrap instead of overflowing
+    quint64 prev = 0;
+    quint64 prevDelta = 0;
+    for ( int i = 0 ; i < rows ; i++ ) {
+        quint64 delta = (quint64) (qint64) v[i] - prev;
+        putVarint ( out, zigzag ( (qint64) (order == 2 ? delta - prevDelta : delta) ) );
+        prev = (quint64) (qint64) v[i];
+        prevDelta = delta;
+    }
+}
+
+template <typename T> static bool decodeDiff ( const uchar* p, const uchar* end, int rows, int order, T* v ) {
+    quint64 prev = 0;
+    quint64 prevDelta = 0;
+    quint64 u;
+    for ( int i = 0 ; i < rows ; i++ ) {
+        if ( !getVarint ( p, end, u ) )
+            return false;
+        quint64 delta = order == 2 ? prevDelta + (quint64) unzigzag(u) : (quint64) unzigzag(u);
+        prev += delta;
+        prevDelta = delta;
+        v[i] = (T) prev;
+    }
+    return p == end;
+}
+
+static void encodeInt ( int type, const QByteArray& values, int rows, int order, QByteArray& out ) {
+    const char* d = values.constData();
+    switch ( type ) {
+    case MdChannel::TypeUInt8: encodeDiff ( reinterpret_cast<const quint8*> (d), rows, order, out ); break;
+    case MdChannel::TypeUInt16: encodeDiff ( reinterpret_cast<const quint16*> (d), rows, order, out ); break;
+    case MdChannel::TypeInt32: encodeDiff ( reinterpret_cast<const qint32*> (d), rows, order, out ); break;
+    case MdChannel::TypeInt64: encodeDiff ( reinterpret_cast<const qint64*> (d), rows, order, out ); break;
+    }
+}
+
+static bool decodeInt ( int type, const char* data, int len, int rows, int order, QByteArray& values ) {
+    values.resize ( rows * MdChannel::typeSize(type) );
+    const uchar* p = reinterpret_cast<const uchar*> (data);
+    char* d = values.data();
+    switch ( type ) {
+    case MdChannel::TypeUInt8: return decodeDiff ( p, p + len, rows, order, reinterpret_cast<quint8*> (d) );
+    case MdChannel::TypeUInt16: return decodeDiff ( p, p + len, rows, order, reinterpret_cast<quint16*> (d) );
+    case MdChannel::TypeInt32: return decodeDiff ( p, p + len, rows, order, reinterpret_cast<qint32*> (d) );
+    case MdChannel::TypeInt64: return decodeDiff ( p, p + len, rows, order, reinterpret_cast<qint64*> (d) );
+    }
+    return false;
+}
+
+
+//! timestamps at a steady rate: the second difference is mostly 0 -> 1 byte per row
+class MdDeltaDeltaCodec : public MdChannelCodec {
+public:
+    int id () const { return DeltaDelta; }
+    bool supports ( int type ) const { return isInteger (type); }
+    void encode ( int type, const QByteArray& values, int rows, QByteArray& out ) const {
+        encodeInt ( type, values, rows, 2, out );
+    }
+    bool decode ( int type, const char* data, int len, int rows, QByteArray& values ) const {
+        return decodeInt ( type, data, len, rows, 2, values );
+    }
+};
+
+//! slowly changing integers (rpm, throttle, gear)
+class MdZigZagVarintCodec : public MdChannelCodec {
+public:
+    int id () const { return ZigZagVarint; }
+    bool supports ( int type ) const { return isInteger (type); }
+    void encode ( int type, const QByteArray& values, int rows, QByteArray& out ) const {
+        encodeInt ( type, values, rows, 1, out );
+    }
+    bool decode ( int type, const char* data, int len, int rows, QByteArray& values ) const {
+        return decodeInt ( type, data, len, rows, 1, values );
+    }
+};
+
+//! flag and raw Digifant bytes: varint run length + value
+class MdRunLengthCodec : public MdChannelCodec {
+public:
+    int id () const { return RunLength; }
+    bool supports ( int type ) const { return type == MdChannel::TypeUInt8; }
+    void encode ( int type, const QByteArray& values, int rows, QByteArray& out ) const {
+        Q_UNUSED(type);
+        const uchar* v = reinterpret_cast<const uchar*> (values.constData());
+        int i = 0;
+        while ( i < rows ) {
+            int run = 1;
+            while ( i + run < rows && v[i + run] == v[i] )
+                run++;
+            putVarint ( out, run );
+            out.append ( (char) v[i] );
+            i += run;
+        }
+    }
+    bool decode ( int type, const char* data, int len, int rows, QByteArray& values ) const {
+        Q_UNUSED(type);
+        values.resize ( rows );
+        char* d = values.data();
+        const uchar* p = reinterpret_cast<const uchar*> (data);
+        const uchar* end = p + len;
+        int i = 0;
+        quint64 run;
+        while ( p < end ) {
+            if ( !getVarint ( p, end, run ) || p >= end || run > (quint64) (rows - i) )
+                return false;
+            memset ( d + i, *p++, run );
+            i += run;
+        }
+        return i == rows;
+    }
+};
+
+/**
+  * doubles: xor with the previous value, byte aligned variant of the Gorilla scheme.
+  * control byte: leading zero bytes << 4 | trailing zero bytes, followed by the
+  * remaining bytes of the xor. equal values cost one byte (0x80).
+  */
+class MdXorFloatCodec : public MdChannelCodec {
+public:
+    int id () const { return XorFloat; }
+    bool supports ( int type ) const { return type == MdChannel::TypeDouble; }
+    void encode ( int type, const QByteArray& values, int rows, QByteArray& out ) const {
+        Q_UNUSED(type);
+        const char* d = values.constData();
+        quint64 prev = 0;
+        for ( int i = 0 ; i < rows ; i++ ) {
+            quint64 bits;
+            memcpy ( &bits, d + i * sizeof(double), sizeof(double) );
+            quint64 x = bits ^ prev;
+            prev = bits;
+            if ( x == 0 ) {
+                out.append ( (char) 0x80 );
+                continue;
+            }
+            int lead = 0;
+            while ( !(x >> (56 - lead * 8) & 0xFF) )
+                lead++;
+            int trail = 0;
+            while ( !(x >> (trail * 8) & 0xFF) )
+                trail++;
+            int n = 8 - lead - trail;
+            char buf[9];
+            buf[0] = (char) (lead << 4 | trail);
+            x >>= trail * 8;
+            for ( int b = 0 ; b < n ; b++ )
+                buf[1 + b] = (char) (x >> (b * 8));
+            out.append ( buf, n + 1 );
+        }
+    }
+    bool decode ( int type, const char* data, int len, int rows, QByteArray& values ) const {
+        Q_UNUSED(type);
+        values.resize ( rows * sizeof(double) );
+        char* d = values.data();
+        const uchar* p = reinterpret_cast<const uchar*> (data);
+        const uchar* end = p + len;
+        quint64 prev = 0;
+        for ( int i = 0 ; i < rows ; i++ ) {
+            if ( p >= end )
+                return false;
+            int lead = *p >> 4;
+            int trail = *p & 0x0F;
+            p++;
+            int n = 8 - lead - trail;
+            //the encoder writes trail 0 - 7 (and lead 8 for equal values), a shift by 64 bits is undefined
+            if ( trail > 7 || lead > 8 || n < 0 || p + n > end )
+                return false;
+            quint64 x = 0;
+            for ( int b = 0 ; b < n ; b++ )
+                x |= (quint64) p[b] << (b * 8);
+            p += n;
+            prev ^= x << (trail * 8);
+            memcpy ( d + i * sizeof(double), &prev, sizeof(double) );
+        }
+        return p == end;
+    }
+};
+
+
+const MdChannelCodec* MdChannelCodec::get ( int id ) {
+    static const MdDeltaDeltaCodec deltaDelta;
+    static const MdZigZagVarintCodec zigZagVarint;
+    static const MdRunLengthCodec runLength;
+    static const MdXorFloatCodec xorFloat;
+
+    switch ( id ) {
+    case DeltaDelta:
+        return &deltaDelta;
+    case ZigZagVarint:
+        return &zigZagVarint;
+    case RunLength:
+        return &runLength;
+    case XorFloat:
+        return &xorFloat;
+    }
+    return NULL;
+}
+
+int MdChannelCodec::defaultFor ( int channelId ) {
+    switch ( channelId ) {
+    case MdChannel::Time:
+    case MdChannel::MdTimestamp:
+    case MdChannel::GpsTimestamp:
+        return DeltaDelta;
+    }
+    switch ( MdChannel::descriptor(channelId).type ) {
+    case MdChannel::TypeUInt8:
+        return RunLength;
+    case MdChannel::TypeUInt16:
+    case MdChannel::TypeInt32:
+    case MdChannel::TypeInt64:
+        return ZigZagVarint;
+    case MdChannel::TypeDouble:
+        return XorFloat;
+    }
+    return Raw;
+}
@@ -0,0 +1,30 @@
+#ifndef MDCHANNELCODEC_H
+#define MDCHANNELCODEC_H
+
+#include <QByteArray>
+
+/**
+  * compression of one channel block of a mdv3 chunk.
+  * values are handed in and out as typed arrays in host byte order, the encoded
+  * form is byte order independent. the codec id is stored per channel in the file header.
+  */
+class MdChannelCodec {
+public:
+    //! stored in the file, never renumber
+    enum Id { Raw = 0, DeltaDelta = 1, ZigZagVarint = 2, RunLength = 3, XorFloat = 4 };
+
+    virtual ~MdChannelCodec () {}
+
+    virtual int id () const = 0;
+    virtual bool supports ( int type ) const = 0;
+    virtual void encode ( int type, const QByteArray& values, int rows, QByteArray& out ) const = 0;
+    //! false if the block is corrupt or does not hold exactly rows values
+    virtual bool decode ( int type, const char* data, int len, int rows, QByteArray& values ) const = 0;
+
+    //! codec for id or NULL if unknown. Raw has no codec object, blocks are stored as they are
+    static const MdChannelCodec* get ( int id );
+    //! codec used by the writer for a channel
+    static int defaultFor ( int channelId );
+};
+
+#endif // MDCHANNELCODEC_H
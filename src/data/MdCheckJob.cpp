@@ -0,0 +1,20 @@
+#include "data/MdCheckJob.h"
+#include "data/MdChunkSource.h"
+#include "data/MdEventScan.h"
+
+MdCheckJob::MdCheckJob ( MdChunkSource* src, int typeK ) : src(src), typeK(typeK) {
+}
+
+MdCheckJob::~MdCheckJob () {
+    delete src;
+}
+
+void MdCheckJob::start () {
+    egt = MdEventScan::highEgt ( src, typeK );
+    emit progress (1);
+    knock = MdEventScan::knock (src);
+    emit progress (2);
+    dc = MdEventScan::injectorHighDc (src);
+    emit progress (3);
+    emit jobFinished();
+}
@@ -0,0 +1,42 @@
+#ifndef MDCHECKJOB_H
+#define MDCHECKJOB_H
+
+#include "thread/workerjob.h"
+
+#include <QList>
+
+class MdChunkSource;
+
+/**
+  * runs the detectors of MdData::checkData() (egt, knock, injector duty cycle) in its
+  * own thread. the source must not be read by anybody else meanwhile: a MdSessionSnapshot
+  * of the running log, which keeps growing on the GUI thread, or a MdSessionCache of its own.
+  * the rows are picked up after jobFinished().
+  */
+class MdCheckJob : public WorkerJob {
+    Q_OBJECT
+public:
+    //! takes ownership of src, typeK: number of connected thermocouples
+    MdCheckJob ( MdChunkSource* src, int typeK );
+    ~MdCheckJob ();
+
+    QList<int> egtRows () const { return egt; }
+    QList<int> knockRows () const { return knock; }
+    QList<int> injectorDcRows () const { return dc; }
+
+signals:
+    //! number of detectors done (of 3)
+    void progress ( int done );
+
+public slots:
+    void start ();
+
+protected:
+    MdChunkSource* src;
+    int typeK;
+    QList<int> egt;
+    QList<int> knock;
+    QList<int> dc;
+};
+
+#endif // MDCHECKJOB_H
@@ -0,0 +1,92 @@
+#ifndef MDCHUNKSOURCE_H
+#define MDCHUNKSOURCE_H
+
+#include "data/MdSessionColumns.h"
+
+class MdDataRecord;
+
+/**
+  * rows stored as a sequence of column chunks: the in memory MdSessionStore
+  * or a lazily opened mdv3 file (MdSessionCache).
+  * scans should walk the chunks and read the columns directly, record() is
+  * meant for single rows only.
+  */
+class MdChunkSource {
+public:
+    virtual ~MdChunkSource () {}
+
+    virtual qint64 rowCount () const = 0;
+    virtual int chunkCount () const = 0;
+    //! chunk holding row, -1 if row is out of range
+    virtual int chunkForRow ( qint64 row ) const = 0;
+    virtual qint64 chunkFirstRow ( int chunk ) const = 0;
+    //! time channel of the last row of chunk, known without reading the chunk (see MdTimeIndex)
+    virtual qint32 chunkLastTime ( int chunk ) const = 0;
+    //! chunk i or NULL on read errors. valid until the next chunk() / record() call
+    virtual const MdSessionColumns* chunk ( int i ) = 0;
+    //! row as record, owned by the source and recycled after a few hundred other rows
+    virtual MdDataRecord* record ( qint64 row ) = 0;
+    /**
+      * changes whenever a chunk returned by chunk() before may have gone away
+      * (evicted, paged out, rows removed). a chunk fetched in the same generation is still valid.
+      */
+    virtual quint32 generation () const = 0;
+};
+
+/**
+  * random access to single values of a chunk source, the chunk of the last row is kept
+  * as long as the source generation does not change. several cursors may share a source.
+  */
+class MdRowCursor {
+public:
+    MdRowCursor ( MdChunkSource* src ) : src(src), cur(NULL), first(0), end(0), gen(0) {}
+
+    //! chunk holding row (row - firstRow() is the row in it), NULL if row is out of range
+    const MdSessionColumns* columns ( qint64 row ) {
+        if ( cur && row >= first && row < end && gen == src->generation() )
+            return cur;
+        int ci = src->chunkForRow (row);
+        cur = ( ci < 0 ) ? NULL : src->chunk (ci);
+        if ( !cur )
+            return NULL;
+        gen = src->generation();
+        first = src->chunkFirstRow (ci);
+        end = first + cur->rowCount();
+        return cur;
+    }
+    qint64 firstRow () const { return first; }
+
+    template <typename T> T value ( int id, qint64 row ) {
+        const MdSessionColumns* c = columns (row);
+        return c ? c->value<T> (id, row - first) : T();
+    }
+    //! value of channel Id in its own type, e.g. get<MdChannel::Rpm> (row)
+    template <int Id> typename MdChannel::Value<Id>::Type get ( qint64 row ) {
+        return value<typename MdChannel::Value<Id>::Type> ( Id, row );
+    }
+    /**
+      * end (exclusive) of the rows from row on with the same value of channel id, at least row + 1.
+      * steps over a K-line frame at once in packed chunks, see MdSessionColumns::pack
+      */
+    qint64 runEnd ( int id, qint64 row ) {
+        const MdSessionColumns* c = columns (row);
+        return c ? first + c->runEnd ( id, row - first ) : row + 1;
+    }
+    //! physical value of a numeric channel (stored value * scale)
+    double physical ( int id, qint64 row ) {
+        return toDouble (id, row) * MdChannel::descriptor(id).scale;
+    }
+    double toDouble ( int id, qint64 row ) {
+        const MdSessionColumns* c = columns (row);
+        return c ? c->toDouble (id, row - first) : 0;
+    }
+
+private:
+    MdChunkSource* src;
+    const MdSessionColumns* cur;
+    qint64 first;
+    qint64 end;
+    quint32 gen;
+};
+
+#endif // MDCHUNKSOURCE_H
@@ -0,0 +1,294 @@
+#include "data/MdCsvExporter.h"
+#include "data/MdSessionColumns.h"
+#include "data/MdSessionFile.h"
+#include "data/MdSessionStore.h"
+#include "data/MdTimeIndex.h"
+
+#include <QFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QVector>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+//! one block of the export: the columns, its text and the rows in the time range
+struct MdCsvBlock {
+    MdSessionColumns cols;
+    QByteArray text;
+    int rows;
+};
+
+//! formats the columns of a block
+class MdCsvFormatJob : public QRunnable {
+public:
+    MdCsvFormatJob ( const MdCsvExporter* exporter, MdCsvBlock* block )
+        : exporter(exporter), block(block) {
+        setAutoDelete (true);
+    }
+
+    void run () {
+        block->text.resize (0);
+        block->rows = exporter->format ( block->cols, block->text );
+    }
+
+protected:
+    const MdCsvExporter* exporter;
+    MdCsvBlock* block;
+};
+
+
+MdCsvExporter::MdCsvExporter ()
+    : timeFrom(0), timeTo(-1), sep('\t'), decimals(4), written(0) {
+}
+
+void MdCsvExporter::setChannels ( const QList<int>& ids ) {
+    channels.clear();
+    foreach ( int id, ids )
+        if ( id >= 0 && id < MdChannel::Count )
+            channels.append (id);
+}
+
+void MdCsvExporter::setTimeRange ( qint32 from, qint32 to ) {
+    timeFrom = from;
+    timeTo = to;
+}
+
+void MdCsvExporter::setDecimals ( int d ) {
+    decimals = qBound ( 0, d, 9 );
+}
+
+QList<int> MdCsvExporter::blockChannels () const {
+    QList<int> l = exportedChannels();
+    if ( !l.contains (MdChannel::Time) )
+        l.append (MdChannel::Time);
+    return l;
+}
+
+QList<int> MdCsvExporter::exportedChannels () const {
+    if ( !channels.isEmpty() )
+        return channels;
+    QList<int> l;
+    for ( int id = 0 ; id < MdChannel::Count ; id++ )
+        if ( MdChannel::descriptor(id).usage & MdChannel::Export )
+            l.append (id);
+    return l;
+}
+
+int MdCsvExporter::formatInt ( char* buf, qint64 v ) {
+    char tmp[24];
+    int n = 0;
+    quint64 u = v < 0 ? 0ULL - (quint64) v : (quint64) v;
+    do {
+        tmp[n++] = '0' + (char) (u % 10);
+        u /= 10;
+    } while ( u );
+    char* p = buf;
+    if ( v < 0 )
+        *p++ = '-';
+    while ( n > 0 )
+        *p++ = tmp[--n];
+    return p - buf;
+}
+
+int MdCsvExporter::formatDouble ( char* buf, double v, int decimals ) {
+    static const quint64 pow10[] = { 1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL,
+                                     1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL };
+    if ( v != v ) {
+        memcpy ( buf, "nan", 3 );
+        return 3;
+    }
+    decimals = qBound ( 0, decimals, 9 );
+    double scaled = fabs (v) * pow10[decimals] + 0.5;
+    //too large for the fixed point path (or inf)
+    if ( !(scaled < 9.0e15) )
+        return qsnprintf ( buf, 32, "%.17g", v );
+
+    quint64 n = (quint64) scaled;
+    quint64 ip = n / pow10[decimals];
+    quint64 fp = n % pow10[decimals];
+    char* p = buf;
+    if ( v < 0 && n != 0 )
+        *p++ = '-';
+    p += formatInt ( p, (qint64) ip );
+    if ( fp ) {
+        char d[9];
+        for ( int i = decimals - 1 ; i >= 0 ; i-- ) {
+            d[i] = '0' + (char) (fp % 10);
+            fp /= 10;
+        }
+        int len = decimals;
+        while ( d[len-1] == '0' )
+            len--;
+        *p++ = '.';
+        memcpy ( p, d, len );
+        p += len;
+    }
+    return p - buf;
+}
+
+int MdCsvExporter::format ( const MdSessionColumns& block, QByteArray& out ) const {
+    QList<int> ids = exportedChannels();
+
+    //resolve the columns once per block
+    const int n = ids.size();
+    QVector<int> type (n);
+    QVector<const char*> base (n);
+    for ( int c = 0 ; c < n ; c++ ) {
+        type[c] = MdChannel::descriptor (ids[c]).type;
+        base[c] = block.raw (ids[c]).constData();
+    }
+    const qint32* time = reinterpret_cast<const qint32*> ( block.raw (MdChannel::Time).constData() );
+
+    out.reserve ( out.size() + block.rowCount() * n * 8 );
+    char buf[40];
+    int rows = 0;
+    for ( int r = 0 ; r < block.rowCount() ; r++ ) {
+        if ( time[r] < timeFrom || (timeTo >= 0 && time[r] > timeTo) )
+            continue;
+        for ( int c = 0 ; c < n ; c++ ) {
+            int len = 0;
+            if ( c > 0 )
+                buf[len++] = sep;
+            switch ( type[c] ) {
+            case MdChannel::TypeUInt8:
+                len += formatInt ( buf + len, reinterpret_cast<const quint8*> (base[c])[r] );
+                break;
+            case MdChannel::TypeUInt16:
+                len += formatInt ( buf + len, reinterpret_cast<const quint16*> (base[c])[r] );
+                break;
+            case MdChannel::TypeInt32:
+                len += formatInt ( buf + len, reinterpret_cast<const qint32*> (base[c])[r] );
+                break;
+            case MdChannel::TypeInt64:
+                len += formatInt ( buf + len, reinterpret_cast<const qint64*> (base[c])[r] );
+                break;
+            case MdChannel::TypeDouble:
+                len += formatDouble ( buf + len, reinterpret_cast<const double*> (base[c])[r], decimals );
+                break;
+            case MdChannel::TypeString: {
+                out.append ( buf, len );
+                len = 0;
+                QByteArray s = block.strings (ids[c]).value (r).toUtf8();
+                if ( s.contains (sep) || s.contains ('"') || s.contains ('\n') ) {
+                    s.replace ( "\"", "\"\"" );
+                    out.append ('"');
+                    out.append (s);
+                    out.append ('"');
+                } else
+                    out.append (s);
+                break;
+            }
+            }
+            out.append ( buf, len );
+        }
+        out.append ('\n');
+        rows++;
+    }
+    return rows;
+}
+
+QByteArray MdCsvExporter::header () const {
+    QByteArray h;
+    QList<int> ids = exportedChannels();
+    for ( int c = 0 ; c < ids.size() ; c++ ) {
+        if ( c > 0 )
+            h.append (sep);
+        h.append ( MdChannel::descriptor (ids[c]).name );
+    }
+    h.append ('\n');
+    return h;
+}
+
+bool MdCsvExporter::open ( QFile& f ) {
+    written = 0;
+    if ( !f.open (QIODevice::WriteOnly | QIODevice::Truncate) ) {
+        error = f.errorString();
+        return false;
+    }
+    return write (f, header());
+}
+
+bool MdCsvExporter::write ( QFile& f, const QByteArray& text ) {
+    if ( f.write (text) != text.size() ) {
+        error = f.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool MdCsvExporter::exportStore ( MdSessionStore& store, const QString& filename ) {
+    QFile f (filename);
+    if ( !open (f) )
+        return false;
+
+    //only the chunks of the time range
+    MdTimeIndex times (&store);
+    int c = store.chunkForRow ( times.lowerBound (timeFrom) );
+    int end = ( timeTo < 0 ) ? store.chunkCount() : store.chunkForRow ( times.upperBound (timeTo) - 1 ) + 1;
+    if ( c < 0 )
+        c = end;
+
+    //a few chunks per thread in flight, written in row order
+    const int wave = qMax ( 1, QThread::idealThreadCount() ) * 2;
+    QVector<MdCsvBlock> blocks (wave);
+    QThreadPool pool;
+    while ( c < end ) {
+        int j = 0;
+        //implicitly shared copies, a chunk paged in from the spill file is dropped by the next chunk() call
+        for ( ; j < wave && c < end ; j++, c++ ) {
+            blocks[j].cols = *store.chunk (c);
+            pool.start ( new MdCsvFormatJob (this, &blocks[j]) );
+        }
+        pool.waitForDone();
+        for ( int i = 0 ; i < j ; i++ ) {
+            if ( !write (f, blocks[i].text) )
+                return false;
+            written += blocks[i].rows;
+        }
+    }
+    f.close();
+    return true;
+}
+
+bool MdCsvExporter::exportSession ( const QString& sessionFile, const QString& filename ) {
+    MdSessionReader reader (sessionFile);
+    if ( !reader.open() ) {
+        error = reader.errorString();
+        return false;
+    }
+    QFile f (filename);
+    if ( !open (f) )
+        return false;
+
+    const QList<int> wanted = blockChannels();
+    const int wave = qMax ( 1, QThread::idealThreadCount() ) * 2;
+    QVector<MdCsvBlock> blocks (wave);
+    QThreadPool pool;
+    for ( int c = 0 ; c < reader.chunkCount() ; ) {
+        int j = 0;
+        //chunks are decoded here, formatting runs in parallel
+        for ( ; j < wave && c < reader.chunkCount() ; c++ ) {
+            const MdSessionChunkInfo& ci = reader.chunkInfo (c);
+            if ( ci.timeEnd < timeFrom || (timeTo >= 0 && ci.timeBegin > timeTo) )
+                continue;
+            if ( !reader.readChunk (c, blocks[j].cols, wanted) ) {
+                pool.waitForDone();
+                error = reader.errorString();
+                return false;
+            }
+            pool.start ( new MdCsvFormatJob (this, &blocks[j]) );
+            j++;
+        }
+        pool.waitForDone();
+        for ( int i = 0 ; i < j ; i++ ) {
+            if ( !write (f, blocks[i].text) )
+                return false;
+            written += blocks[i].rows;
+        }
+    }
+    f.close();
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef MDCSVEXPORTER_H
+#define MDCSVEXPORTER_H
+
+#include <QList>
+#include <QString>
+#include <QByteArray>
+
+class MdSessionColumns;
+class MdSessionStore;
+class QFile;
+
+/**
+  * CSV export straight from the channel values, the table model is not involved.
+  *
+  * the blocks are the chunks of the in memory store or the decoded mdv3 chunks,
+  * blocks are formatted on a thread pool and written in file order.
+  * one column per channel (MdChannel names in the header), time in msecs, oldest row first.
+  */
+class MdCsvExporter {
+public:
+    MdCsvExporter ();
+
+    //! exported channels in this order, the MdChannel::Export channels if empty
+    void setChannels ( const QList<int>& ids );
+    //! only rows with from <= time <= to (msecs), to < 0: up to the end
+    void setTimeRange ( qint32 from, qint32 to );
+    void setSeparator ( char s ) { sep = s; }
+    //! decimals of double channels, trailing zeros are dropped
+    void setDecimals ( int d );
+
+    //! exports the rows of the store, its chunks are formatted in place
+    bool exportStore ( MdSessionStore& store, const QString& filename );
+    //! exports a mdv3 file, only the exported channels get decoded
+    bool exportSession ( const QString& sessionFile, const QString& filename );
+
+    qint64 rowsWritten () const { return written; }
+    QString errorString () const { return error; }
+
+    //! the header line with the channel names
+    QByteArray header () const;
+    //! formats the rows of block in the time range into out (appends), returns the row count
+    int format ( const MdSessionColumns& block, QByteArray& out ) const;
+    //! channels a block needs: the exported ones + time for the range check
+    QList<int> blockChannels () const;
+    //! the channels of the csv columns
+    QList<int> exportedChannels () const;
+
+    //! fast number to text, no locale. buf needs 32 bytes, returns the length
+    static int formatInt ( char* buf, qint64 v );
+    static int formatDouble ( char* buf, double v, int decimals );
+
+    enum { BLOCK_ROWS = 4096 };
+
+protected:
+    bool open ( QFile& f );
+    bool write ( QFile& f, const QByteArray& text );
+
+    QList<int> channels;
+    qint32 timeFrom;
+    qint32 timeTo;
+    char sep;
+    int decimals;
+    qint64 written;
+    QString error;
+};
+
+#endif // MDCSVEXPORTER_H
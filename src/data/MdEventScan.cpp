@@ -0,0 +1,237 @@
+#include "data/MdEventScan.h"
+#include "data/MdChunkSource.h"
+
+double MdEventScan::highestEgt ( MdRowCursor& rc, qint64 row, int typeK ) {
+    double hv = -1;
+    for ( int i = 0 ; i < typeK ; i++ )
+        hv = qMax ( hv, rc.value<double> (MdChannel::Egt0 + i, row) );
+    return hv;
+}
+
+double MdEventScan::injectorDuty ( MdRowCursor& rc, qint64 row ) {
+    return 2* (( (rc.get<MdChannel::DfInjTime> (row) / 1000.0) * rc.get<MdChannel::Rpm> (row))/1200.0);
+}
+
+QList<int> MdEventScan::wot ( MdChunkSource* src ) {
+    QList <int> wotIdxL;
+    #define STATE_NO_WOT 1
+    #define STATE_WOT_START 2
+    #define STATE_WOT_FOUND 3
+    quint8 state = STATE_NO_WOT;
+    int wot_start_time = 0;
+    int wot_end_time = 0;
+    int wot_start_idx = 0;
+
+    MdRowCursor rc (src);
+    for ( int i = 0 ; i < src->rowCount() ; i++ ) {
+        switch ( state ) {
+            case STATE_NO_WOT:
+            if ( rc.get<MdChannel::Throttle> (i) >= 80 ) {
+                if ( wot_end_time + 2000 > rc.get<MdChannel::Time> (i) ) {
+                    //delta between two WOT events too small -> discard the 2. wot event
+                    //we have just a gear change here!
+                   state = STATE_WOT_FOUND;
+                } else {
+                    state = STATE_WOT_START;
+                    wot_start_time = rc.get<MdChannel::Time> (i);
+                    wot_start_idx = i;
+                }
+            }
+            break;
+            case STATE_WOT_START:
+            if ( rc.get<MdChannel::Throttle> (i) < 80 )
+                state = STATE_NO_WOT;
+            else {
+                if ( wot_start_time + 2000 < rc.get<MdChannel::Time> (i)  ) {
+                    //2 secs wot
+                    state = STATE_WOT_FOUND;
+                    wotIdxL.append(wot_start_idx);
+                }
+            }
+            break;
+            case STATE_WOT_FOUND:
+            if ( rc.get<MdChannel::Throttle> (i) < 80 ) {
+                state = STATE_NO_WOT;
+                wot_end_time = rc.get<MdChannel::Time> (i);
+            }
+            break;
+        }
+    }
+
+    return wotIdxL;
+}
+
+QList<int> MdEventScan::knock ( MdChunkSource* src ) {
+    QList <int> knockIdxL;
+    #define STATE_NO_KNOCK 1
+    #define STATE_KNOCK 2
+    #define STATE_KNOCK_FOUND 3
+    quint8 state = STATE_NO_KNOCK;
+    int knock_idx = 0;
+    const qreal knock_threshold = 4;
+    qreal knock_max = 0;
+
+    MdRowCursor rc (src);
+    for ( int i = 0 ; i < src->rowCount() ; ) {
+        quint8 before = state;
+        switch ( state ) {
+            case STATE_NO_KNOCK:
+            if ( rc.get<MdChannel::DfIgnitionTotalRetard> (i) >= knock_threshold ) {
+                state = STATE_KNOCK;
+                knock_idx = i;
+                knock_max = rc.get<MdChannel::DfIgnitionTotalRetard> (i);
+            }
+            break;
+            case STATE_KNOCK:
+            if ( rc.get<MdChannel::DfIgnitionTotalRetard> (i) < knock_threshold ) {
+                state = STATE_KNOCK_FOUND;
+
+            } else {
+                if ( knock_max < rc.get<MdChannel::DfIgnitionTotalRetard> (i) ) {
+                    knock_max = rc.get<MdChannel::DfIgnitionTotalRetard> (i);
+                    knock_idx = i;
+                }
+            }
+            break;
+            case STATE_KNOCK_FOUND:
+            knockIdxL.append(knock_idx);
+            state = STATE_NO_KNOCK;
+            break;
+        }
+        //the rest of the Digifant frame changes nothing
+        if ( state == before && state != STATE_KNOCK_FOUND )
+            i = rc.runEnd ( MdChannel::DfIgnitionTotalRetard, i );
+        else
+            i++;
+    }
+
+    return knockIdxL;
+}
+
+QList<int> MdEventScan::highEgt ( MdChunkSource* src, int typeK ) {
+    QList <int> egtIdxL;
+    #define STATE_LO 1
+    #define STATE_HIGH 2
+    #define STATE_HIGH_FOUND 3
+    quint8 state = STATE_LO;
+    int egt_idx = 0;
+    const qreal egt_threshold = 950;
+    qreal egt_max = 0;
+
+    MdRowCursor rc (src);
+    for ( int i = 0 ; i < src->rowCount() ; i++ ) {
+        switch ( state ) {
+            case STATE_LO:
+            if ( highestEgt (rc, i, typeK) >= egt_threshold ) {
+                state = STATE_HIGH;
+                egt_idx = i;
+                egt_max = highestEgt (rc, i, typeK);
+            }
+            break;
+            case STATE_HIGH:
+            if ( highestEgt (rc, i, typeK) < egt_threshold ) {
+                state = STATE_HIGH_FOUND;
+
+            } else {
+                if ( egt_max < highestEgt (rc, i, typeK) ) {
+                    egt_max = highestEgt (rc, i, typeK);
+                    egt_idx = i;
+                }
+            }
+            break;
+            case STATE_HIGH_FOUND:
+            egtIdxL.append(egt_idx);
+            state = STATE_LO;
+            break;
+        }
+    }
+
+    return egtIdxL;
+}
+
+QList<int> MdEventScan::injectorHighDc ( MdChunkSource* src ) {
+    QList <int> dcIdxL;
+    #define STATE_LO 1
+    #define STATE_HIGH 2
+    #define STATE_HIGH_FOUND 3
+    quint8 state = STATE_LO;
+    int idx = 0;
+    const qreal dc_threshold = 90;
+    qreal max = 0;
+
+    MdRowCursor rc (src);
+    for ( int i = 0 ; i < src->rowCount() ; i++ ) {
+        switch ( state ) {
+            case STATE_LO:
+            if ( injectorDuty (rc, i) >= dc_threshold ) {
+                state = STATE_HIGH;
+                idx = i;
+                max = injectorDuty (rc, i);
+            }
+            break;
+            case STATE_HIGH:
+            if ( injectorDuty (rc, i) < dc_threshold ) {
+                state = STATE_HIGH_FOUND;
+
+            } else {
+                if ( max < injectorDuty (rc, i) ) {
+                    max = injectorDuty (rc, i);
+                    idx = i;
+                }
+            }
+            break;
+            case STATE_HIGH_FOUND:
+            dcIdxL.append(idx);
+            state = STATE_LO;
+            break;
+        }
+    }
+
+    return dcIdxL;
+}
+
+QList<int> MdEventScan::lc ( MdChunkSource* src ) {
+    QList <int> lcIdxL;
+    #define STATE_NO_LC 1
+    #define STATE_LC_START 2
+    #define STATE_LC_FOUND 3
+    quint8 state = STATE_NO_LC;
+    int lc_start_time = 0;
+    int lc_start_idx = 0;
+
+    MdRowCursor rc (src);
+    for ( int i = 0 ; i < src->rowCount() ; ) {
+        quint8 before = state;
+        switch ( state ) {
+            case STATE_NO_LC:
+            if ( (rc.get<MdChannel::DfLcFlags> (i) & 3) == 1 ) {
+                state = STATE_LC_START;
+                lc_start_time = rc.get<MdChannel::Time> (i);
+                lc_start_idx = i;
+            }
+            break;
+            case STATE_LC_START:
+            if (  ((rc.get<MdChannel::DfLcFlags> (i) & 3) == 1) )
+                state = STATE_NO_LC;
+            else {
+                if ( lc_start_time + 1000 < rc.get<MdChannel::Time> (i)  ) {
+                    //2 secs lc
+                    state = STATE_LC_FOUND;
+                    lcIdxL.append(lc_start_idx);
+                }
+            }
+            break;
+            case STATE_LC_FOUND:
+            if ( (rc.get<MdChannel::DfLcFlags> (i) & 3) == 0 )
+                state = STATE_NO_LC;
+            break;
+        }
+        //the start phase depends on the time, the others on the Digifant frame only
+        if ( state == before && state != STATE_LC_START )
+            i = rc.runEnd ( MdChannel::DfLcFlags, i );
+        else
+            i++;
+    }
+
+    return lcIdxL;
+}
@@ -0,0 +1,32 @@
+#ifndef MDEVENTSCAN_H
+#define MDEVENTSCAN_H
+
+#include <QList>
+
+class MdChunkSource;
+class MdRowCursor;
+
+/**
+  * event detectors behind the find / check entries of the data view. they only read
+  * the columns of src and return the data rows of the events, so they run on any source:
+  * the shown rows on the GUI thread or a snapshot of the running log in a MdCheckJob.
+  */
+namespace MdEventScan {
+    //! starts of wide open throttle phases longer than 2s, gear changes don't end them
+    QList<int> wot ( MdChunkSource* src );
+    //! row of the highest total retard of every phase >= 4 deg
+    QList<int> knock ( MdChunkSource* src );
+    //! row of the highest egt of every phase >= 950 deg over the first typeK thermocouples
+    QList<int> highEgt ( MdChunkSource* src, int typeK );
+    //! row of the highest injector duty cycle of every phase >= 90%
+    QList<int> injectorHighDc ( MdChunkSource* src );
+    //! starts of launch control phases longer than 1s
+    QList<int> lc ( MdChunkSource* src );
+
+    //! MdSensorRecord::getHighestEgt(typeK)["temp"] from the columns
+    double highestEgt ( MdRowCursor& rc, qint64 row, int typeK );
+    //! MdSensorRecord::df_inj_duty from the columns
+    double injectorDuty ( MdRowCursor& rc, qint64 row );
+}
+
+#endif // MDEVENTSCAN_H
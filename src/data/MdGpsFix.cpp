@@ -0,0 +1,53 @@
+#include "data/MdGpsFix.h"
+
+#include <QRegExp>
+#include <QStringList>
+
+MdGpsFix::MdGpsFix ()
+    : timestamp(-1), latitude(0), longitude(0), altitude(0), groundSpeed(0), direction(0),
+      horizontalAccuracy(0), verticalAccuracy(0) {
+}
+
+static QString dms ( double v, char positive, char negative ) {
+    double a = qAbs (v);
+    int deg = (int) a;
+    int min = (int) ( (a - deg) * 60 );
+    double sec = ( (a - deg) * 60 - min ) * 60;
+    //59.96 would be printed as 60.0
+    if ( sec >= 59.95 ) {
+        sec = 0;
+        if ( ++min == 60 ) {
+            min = 0;
+            deg++;
+        }
+    }
+    return QString ("%1%2 %3' %4\" %5").arg(deg).arg(QChar(0x00B0)).arg(min).arg(sec, 0, 'f', 1)
+            .arg( QChar ( v < 0 ? negative : positive ) );
+}
+
+QString MdGpsFix::coordinateString ( double latitude, double longitude ) {
+    return dms ( latitude, 'N', 'S' ) + ", " + dms ( longitude, 'E', 'W' );
+}
+
+bool MdGpsFix::parseCoordinate ( const QString& s, double& latitude, double& longitude ) {
+    QStringList parts = s.split (',');
+    if ( parts.size() < 2 )
+        return false;
+    QRegExp dmsRx ( "(\\d+)\\D+(\\d+)'\\s*([\\d.]+)\"\\s*([NSEW])" );
+    double v[2];
+    for ( int i = 0 ; i < 2 ; i++ ) {
+        QString p = parts[i].trimmed();
+        bool ok;
+        v[i] = p.toDouble (&ok);
+        if ( ok )
+            continue;
+        if ( dmsRx.indexIn (p) < 0 )
+            return false;
+        v[i] = dmsRx.cap(1).toDouble() + dmsRx.cap(2).toDouble() / 60 + dmsRx.cap(3).toDouble() / 3600;
+        if ( dmsRx.cap(4) == "S" || dmsRx.cap(4) == "W" )
+            v[i] = -v[i];
+    }
+    latitude = v[0];
+    longitude = v[1];
+    return true;
+}
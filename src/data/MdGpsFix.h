@@ -0,0 +1,36 @@
+#ifndef MDGPSFIX_H
+#define MDGPSFIX_H
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+  * numbers of the last GPS fix (about 1 Hz), the MD records copy them into their numeric
+  * GPS channels (see MdDataRecord::assignMobileSensors). nothing is formatted per frame,
+  * the coordinate text is made when it is shown or exported.
+  */
+class MdGpsFix {
+public:
+    MdGpsFix ();
+
+    //! false until the first fix
+    bool isValid () const { return timestamp >= 0; }
+
+    //! msecs since epoch, -1 without fix
+    qint64 timestamp;
+    double latitude;
+    double longitude;
+    //! altitude and the attributes are NaN if the source has none
+    float altitude;
+    float groundSpeed;
+    float direction;
+    float horizontalAccuracy;
+    float verticalAccuracy;
+
+    //! degrees, minutes, seconds with hemisphere like QGeoCoordinate::toString()
+    static QString coordinateString ( double latitude, double longitude );
+    //! reads coordinateString() / QGeoCoordinate::toString() output or decimal degrees, false if s is neither
+    static bool parseCoordinate ( const QString& s, double& latitude, double& longitude );
+};
+
+#endif // MDGPSFIX_H
@@ -0,0 +1,166 @@
+#include "data/MdJournal.h"
+#include "data/MdSessionFile.h"
+
+#include "MdDataRecord.h"
+
+#include <QTimer>
+#include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QDebug>
+
+#if QT_VERSION >= 0x050000
+#include <QStandardPaths>
+#else
+#include <QDesktopServices>
+#endif
+
+MdRecordQueue::MdRecordQueue ( int capacity ) : head(0), tail(0) {
+    int size = 2;
+    while ( size < capacity )
+        size <<= 1;
+    ring.fill ( NULL, size );
+    mask = size - 1;
+}
+
+MdRecordQueue::~MdRecordQueue () {
+    foreach ( MdDataRecord* r, ring )
+        if ( r )
+            delete r;
+}
+
+bool MdRecordQueue::push ( const MdDataRecord* r ) {
+    int h = head.fetchAndAddRelaxed (0);
+    int next = (h + 1) & mask;
+    //acquire: the consumer is done with the slot
+    if ( next == tail.fetchAndAddAcquire (0) )
+        return false;
+    if ( !ring[h] )
+        ring[h] = new MdDataRecord();
+    *ring[h]->getSensorR() = *r->getSensorR();
+    if ( r->getMobileR() )
+        *ring[h]->getMobileR() = *r->getMobileR();
+    //release: the slot is written before the consumer sees the new head
+    head.fetchAndStoreRelease (next);
+    return true;
+}
+
+MdDataRecord* MdRecordQueue::front () {
+    int t = tail.fetchAndAddRelaxed (0);
+    if ( t == head.fetchAndAddAcquire (0) )
+        return NULL;
+    return ring[t];
+}
+
+void MdRecordQueue::pop () {
+    int t = tail.fetchAndAddRelaxed (0);
+    if ( t != head.fetchAndAddAcquire (0) )
+        tail.fetchAndStoreRelease ( (t + 1) & mask );
+}
+
+
+MdJournal::MdJournal ( const QString& filename, int syncMillis )
+    : filename(filename), queue(QUEUE_SIZE), writer(NULL), timer(NULL), syncMillis(syncMillis),
+      queued(0), lost(0), ok(true) {
+}
+
+MdJournal::~MdJournal () {
+    if ( writer )
+        delete writer;
+}
+
+QString MdJournal::directory () {
+#if QT_VERSION >= 0x050000
+    return QStandardPaths::writableLocation (QStandardPaths::DataLocation) + QDir::separator() + "journal";
+#else
+    return QDesktopServices::storageLocation (QDesktopServices::DataLocation) + QDir::separator() + "journal";
+#endif
+}
+
+QString MdJournal::newFileName () {
+    QDir().mkpath ( directory() );
+    return directory() + QDir::separator() + QDateTime::currentDateTime().toString("yyyy-MM-ddThhmmss") + ".mdv3";
+}
+
+bool MdJournal::append ( const MdDataRecord* r ) {
+    if ( !r || !r->getSensorR() )
+        return false;
+    //copy: the table owns r and may recycle or change it while the journal thread is busy
+    if ( !queue.push (r) ) {
+        lost++;
+        return false;
+    }
+    queued++;
+    return true;
+}
+
+void MdJournal::start () {
+    writer = new MdSessionWriter (filename);
+    writer->setJournal (true);
+    if ( !writer->open() ) {
+        ok = false;
+        error = writer->errorString();
+        qDebug() << "MdJournal: can not open " << filename << ": " << error;
+        return;
+    }
+    lastSync.start();
+    timer = new QTimer (this);
+    connect ( timer, SIGNAL(timeout()), this, SLOT(drain()) );
+    timer->start ( DRAIN_MILLIS );
+}
+
+void MdJournal::drain () {
+    MdDataRecord* r;
+    while ( (r = queue.front()) != NULL ) {
+        if ( ok && !writer->append (r) ) {
+            ok = false;
+            error = writer->errorString();
+        }
+        queue.pop();
+    }
+    if ( ok && writer->pendingRows() > 0 && lastSync.elapsed() >= syncMillis ) {
+        if ( !writer->sync() ) {
+            ok = false;
+            error = writer->errorString();
+            qDebug() << "MdJournal: sync of " << filename << " failed: " << error;
+        }
+        lastSync.restart();
+    }
+}
+
+void MdJournal::finish ( const QString& target ) {
+    if ( timer )
+        timer->stop();
+    if ( writer ) {
+        drain();
+        if ( ok && !writer->sync() ) {
+            ok = false;
+            error = writer->errorString();
+        }
+        if ( !writer->close() && ok ) {
+            ok = false;
+            error = writer->errorString();
+        }
+    }
+    if ( ok && !target.isEmpty() ) {
+        QFile::remove (target);
+        if ( !QFile::rename (filename, target) ) {
+            ok = false;
+            error = "can not move the journal to " + target;
+        }
+    }
+    emit jobFinished();
+}
+
+void MdJournal::discard () {
+    if ( timer )
+        timer->stop();
+    while ( queue.front() )
+        queue.pop();
+    if ( writer ) {
+        delete writer;
+        writer = NULL;
+    }
+    QFile::remove (filename);
+    emit jobFinished();
+}
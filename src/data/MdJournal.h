@@ -0,0 +1,105 @@
+#ifndef MDJOURNAL_H
+#define MDJOURNAL_H
+
+#include "thread/workerjob.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+class MdDataRecord;
+class MdSessionWriter;
+class QTimer;
+
+/**
+  * lock free single producer / single consumer ring of records.
+  * one slot stays empty to tell a full ring from an empty one.
+  * the slots hold their own records, allocated on first use and then reused:
+  * push() copies, nothing is allocated per record once the ring went round.
+  */
+class MdRecordQueue {
+public:
+    //! capacity is rounded up to a power of two
+    MdRecordQueue ( int capacity );
+    ~MdRecordQueue ();
+
+    //! producer: copies r into the next slot, false if the ring is full
+    bool push ( const MdDataRecord* r );
+    //! consumer: oldest record or NULL if the ring is empty. stays in the ring until pop()
+    MdDataRecord* front ();
+    //! consumer: frees the slot of front()
+    void pop ();
+
+private:
+    QVector<MdDataRecord*> ring;
+    int mask;
+    //! next slot to write, only changed by the producer
+    QAtomicInt head;
+    //! next slot to read, only changed by the consumer
+    QAtomicInt tail;
+};
+
+/**
+  * crash safe journal of the live data.
+  *
+  * the acquisition path (GUI thread) copies the new records into a lock free
+  * queue, the job drains it in its own thread and appends them to a mdv3 journal
+  * (see MdSessionWriter::setJournal). the journal is forced to disk every syncMillis.
+  * finish() writes the chunk directory and renames the journal to the target file,
+  * a journal left behind by a crash is completed by MdSessionFile::recover().
+  */
+class MdJournal : public WorkerJob {
+    Q_OBJECT
+public:
+    MdJournal ( const QString& filename, int syncMillis = DEFAULT_SYNC_MILLIS );
+    ~MdJournal ();
+
+    //! GUI thread: queues a copy of the record, never blocks. false if the writer fell behind
+    bool append ( const MdDataRecord* r );
+
+    QString fileName () const { return filename; }
+    //! records queued / lost because the queue was full (GUI thread)
+    quint64 appended () const { return queued; }
+    quint64 dropped () const { return lost; }
+
+    //! result of the last finish() / discard()
+    bool isOk () const { return ok; }
+    QString errorString () const { return error; }
+
+    //! where the journals of the running and crashed sessions live
+    static QString directory ();
+    //! new journal file name in directory()
+    static QString newFileName ();
+
+    enum { QUEUE_SIZE = 4096, DEFAULT_SYNC_MILLIS = 2000, DRAIN_MILLIS = 250 };
+
+public slots:
+    //! opens the journal, runs in the job thread
+    void start ();
+    /**
+      * writes the queued records and the chunk directory. the finished journal is
+      * renamed to target, with an empty target it stays where it is
+      */
+    void finish ( const QString& target );
+    //! stops and deletes the journal
+    void discard ();
+
+protected slots:
+    void drain ();
+
+protected:
+    QString filename;
+    MdRecordQueue queue;
+    MdSessionWriter* writer;
+    QTimer* timer;
+    QElapsedTimer lastSync;
+    int syncMillis;
+
+    quint64 queued;
+    quint64 lost;
+    bool ok;
+    QString error;
+};
+
+#endif // MDJOURNAL_H
@@ -0,0 +1,224 @@
+#include "data/MdLegacyIndex.h"
+#include "data/MdSessionFile.h"
+
+#include "MdDataRecord.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QDebug>
+
+MdLegacyIndex::MdLegacyIndex ()
+    : fileSize(0), fileModified(0), version(0), step(DEFAULT_STRIDE), rows(0) {
+}
+
+QString MdLegacyIndex::sidecarName ( const QString& filename ) {
+    return filename + ".mdidx";
+}
+
+bool MdLegacyIndex::load ( const QString& filename ) {
+    QFile f ( sidecarName (filename) );
+    if ( !f.open (QIODevice::ReadOnly) ) {
+        error = f.errorString();
+        return false;
+    }
+    QDataStream ds (&f);
+    ds.setVersion(QDataStream::Qt_4_6);
+    quint32 magic, v, s, n;
+    ds >> magic;
+    ds >> v;
+    if ( magic != MAGICNUMBER || v != VERSION ) {
+        error = "not a mdidx file";
+        return false;
+    }
+    QFileInfo fi (filename);
+    ds >> fileSize;
+    ds >> fileModified;
+    if ( fileSize != fi.size() || fileModified != fi.lastModified().toMSecsSinceEpoch() ) {
+        error = "index is out of date";
+        return false;
+    }
+    ds >> version;
+    ds >> s;
+    ds >> rows;
+    ds >> n;
+    if ( ds.status() != QDataStream::Ok || s == 0 || (qint64) n != (rows + s - 1) / s ) {
+        error = "corrupt index";
+        return false;
+    }
+    //never written for an empty log, the loaders divide by the entries
+    if ( rows <= 0 ) {
+        error = "empty index";
+        return false;
+    }
+    step = s;
+    offsets.resize (n);
+    times.resize (n);
+    for ( quint32 i = 0 ; i < n ; i++ ) {
+        ds >> offsets[i];
+        ds >> times[i];
+    }
+    if ( ds.status() != QDataStream::Ok ) {
+        error = "truncated index";
+        return false;
+    }
+    file = filename;
+    return true;
+}
+
+bool MdLegacyIndex::save () const {
+    QFile f ( sidecarName (file) );
+    if ( !f.open (QIODevice::WriteOnly | QIODevice::Truncate) )
+        return false;
+    QDataStream ds (&f);
+    ds.setVersion(QDataStream::Qt_4_6);
+    ds << (quint32) MAGICNUMBER;
+    ds << (quint32) VERSION;
+    ds << fileSize;
+    ds << fileModified;
+    ds << version;
+    ds << (quint32) step;
+    ds << rows;
+    ds << (quint32) offsets.size();
+    for ( int i = 0 ; i < offsets.size() ; i++ ) {
+        ds << offsets[i];
+        ds << times[i];
+    }
+    return ds.status() == QDataStream::Ok;
+}
+
+void MdLegacyIndex::reset ( const QString& filename, quint32 fileVersion, int stride ) {
+    QFileInfo fi (filename);
+    file = filename;
+    fileSize = fi.size();
+    fileModified = fi.lastModified().toMSecsSinceEpoch();
+    version = fileVersion;
+    step = qMax ( 1, stride );
+    rows = 0;
+    offsets.clear();
+    times.clear();
+}
+
+void MdLegacyIndex::addRecord ( qint64 offset, const MdDataRecord* r ) {
+    if ( rows % step == 0 ) {
+        offsets.append (offset);
+        times.append ( r && r->getSensorR() ? r->getSensorR()->getTime() : 0 );
+    }
+    rows++;
+}
+
+bool MdLegacyIndex::build ( const QString& filename, int stride ) {
+    MdLegacyImporter in (filename);
+    if ( !in.open() ) {
+        error = in.errorString();
+        return false;
+    }
+    reset ( filename, in.version(), stride );
+    qint64 pos = in.position();
+    MdDataRecord* r;
+    while ( (r = in.next()) != NULL ) {
+        addRecord (pos, r);
+        delete r;
+        pos = in.position();
+    }
+    //same as MdLoadJob: an empty log gets no sidecar
+    if ( isValid() && !save() )
+        qDebug() << "MdLegacyIndex: can not write " << sidecarName (filename);
+    return true;
+}
+
+bool MdLegacyIndex::open ( const QString& filename, int stride ) {
+    if ( load (filename) )
+        return true;
+    return build (filename, stride);
+}
+
+int MdLegacyIndex::entryForTime ( qint32 millis ) const {
+    //times are ascending within a log
+    int l = 0;
+    int r = times.size() - 1;
+    int found = 0;
+    while ( l <= r ) {
+        int mid = (l + r) / 2;
+        if ( times[mid] <= millis ) {
+            found = mid;
+            l = mid + 1;
+        } else
+            r = mid - 1;
+    }
+    return found;
+}
+
+bool MdLegacyIndex::seek ( MdLegacyImporter& in, qint32 millis ) const {
+    if ( offsets.isEmpty() )
+        return false;
+    return in.seek ( offsets[entryForTime (millis)] );
+}
+
+qint64 MdLegacyIndex::rowOffset ( MdLegacyImporter& in, qint64 row ) const {
+    if ( row >= rows )
+        return fileSize;
+    int entry = row / step;
+    if ( !in.seek (offsets[entry]) )
+        return -1;
+    for ( qint64 skip = row - (qint64) entry * step ; skip > 0 ; skip-- ) {
+        MdDataRecord* r = in.next();
+        if ( !r )
+            return -1;
+        delete r;
+    }
+    return in.position();
+}
+
+bool MdLegacyIndex::slice ( const QString& target, qint64 first, qint64 last, QString* errorString ) const {
+    if ( first < 0 || last >= rows || first > last ) {
+        if ( errorString )
+            *errorString = "slice out of bounds";
+        return false;
+    }
+    MdLegacyImporter in (file);
+    if ( !in.open() ) {
+        if ( errorString )
+            *errorString = in.errorString();
+        return false;
+    }
+    qint64 begin = rowOffset (in, first);
+    qint64 end = rowOffset (in, last + 1);
+    if ( begin < 0 || end < begin ) {
+        if ( errorString )
+            *errorString = "the index does not match " + file;
+        return false;
+    }
+
+    QFile src (file);
+    QFile dst (target);
+    if ( !src.open (QIODevice::ReadOnly) || !src.seek (begin) ) {
+        if ( errorString )
+            *errorString = src.errorString();
+        return false;
+    }
+    if ( !dst.open (QIODevice::WriteOnly | QIODevice::Truncate) ) {
+        if ( errorString )
+            *errorString = dst.errorString();
+        return false;
+    }
+    QDataStream ds (&dst);
+    ds.setVersion(QDataStream::Qt_4_6);
+    ds << (quint32) MdFile::MAGICNUMBER;
+    ds << version;
+
+    //the records are copied as they are
+    qint64 left = end - begin;
+    while ( left > 0 ) {
+        QByteArray block = src.read ( qMin (left, (qint64) 64 * 1024) );
+        if ( block.isEmpty() || dst.write (block) != block.size() ) {
+            if ( errorString )
+                *errorString = block.isEmpty() ? src.errorString() : dst.errorString();
+            return false;
+        }
+        left -= block.size();
+    }
+    dst.close();
+    return true;
+}
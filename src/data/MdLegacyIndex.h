@@ -0,0 +1,84 @@
+#ifndef MDLEGACYINDEX_H
+#define MDLEGACYINDEX_H
+
+#include <QString>
+#include <QVector>
+
+class MdDataRecord;
+class MdLegacyImporter;
+
+/**
+  * record offset index of a legacy (CVERSION1, CVERSION3, VERSION4) file.
+  *
+  * legacy records have no fixed size (QDateTime and QString of the mobile record),
+  * the index remembers the byte offset and time of every stride-th record. it is
+  * cached next to the log as <file>.mdidx and rebuilt when size or modification
+  * time of the log changed.
+  *
+  * sidecar (QDataStream, Qt_4_6):
+  *   quint32 magic, quint32 version (1), qint64 log size, qint64 log modification time (msecs),
+  *   quint32 legacy file version, quint32 stride, qint64 rows, quint32 entry count,
+  *   per entry: qint64 offset, qint32 time
+  */
+class MdLegacyIndex {
+public:
+    MdLegacyIndex ();
+
+    enum { MAGICNUMBER = 0xFFAAFF49, VERSION = 1, DEFAULT_STRIDE = 4096 };
+
+    static QString sidecarName ( const QString& filename );
+
+    //! loads the sidecar of filename if it is up to date
+    bool load ( const QString& filename );
+    //! indexes filename in one pass and caches the sidecar
+    bool build ( const QString& filename, int stride = DEFAULT_STRIDE );
+    //! load() or build()
+    bool open ( const QString& filename, int stride = DEFAULT_STRIDE );
+    //! writes the sidecar, false if the directory is read only
+    bool save () const;
+
+    //! incremental build while the file is read anyway (see MdLoadJob)
+    void reset ( const QString& filename, quint32 fileVersion, int stride = DEFAULT_STRIDE );
+    //! offset is the position of r in the file, call it for every record in file order
+    void addRecord ( qint64 offset, const MdDataRecord* r );
+
+    bool isValid () const { return !file.isEmpty() && rows > 0; }
+    QString fileName () const { return file; }
+    quint32 fileVersion () const { return version; }
+    int stride () const { return step; }
+    qint64 rowCount () const { return rows; }
+
+    //! entry i starts at row i * stride()
+    int entryCount () const { return offsets.size(); }
+    qint64 offset ( int entry ) const { return offsets[entry]; }
+    qint32 time ( int entry ) const { return times[entry]; }
+    //! last entry starting at or before millis
+    int entryForTime ( qint32 millis ) const;
+
+    //! positions in at the index point at or before millis, next() continues from there
+    bool seek ( MdLegacyImporter& in, qint32 millis ) const;
+
+    /**
+      * copies the rows first..last of the indexed file into a new legacy file of the same version.
+      * only the records between the index points and the slice boundaries are decoded.
+      */
+    bool slice ( const QString& target, qint64 first, qint64 last, QString* errorString = 0 ) const;
+
+    QString errorString () const { return error; }
+
+protected:
+    //! offset of the record row, decodes at most stride() - 1 records
+    qint64 rowOffset ( MdLegacyImporter& in, qint64 row ) const;
+
+    QString file;
+    qint64 fileSize;
+    qint64 fileModified;
+    quint32 version;
+    int step;
+    qint64 rows;
+    QVector<qint64> offsets;
+    QVector<qint32> times;
+    QString error;
+};
+
+#endif // MDLEGACYINDEX_H
@@ -0,0 +1,145 @@
+#include "data/MdLoadJob.h"
+#include "data/MdSessionFile.h"
+#include "data/MdLegacyIndex.h"
+#include "data/MdSessionStore.h"
+
+#include "MdData.h"
+
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QVector>
+#include <QDebug>
+
+MdLoadJob::MdLoadJob ( const QString& filename )
+    : filename(filename), rows(new MdSessionStore()), cancelled(0), fileVersion(0), ok(true) {
+}
+
+MdLoadJob::~MdLoadJob () {
+    if ( rows )
+        delete rows;
+}
+
+MdSessionStore* MdLoadJob::takeStore () {
+    MdSessionStore* s = rows;
+    rows = NULL;
+    return s;
+}
+
+bool MdLoadJob::isCancelled () const {
+    return cancelled.fetchAndAddRelaxed (0) != 0;
+}
+
+void MdLoadJob::cancel () {
+    cancelled.fetchAndStoreRelaxed (1);
+}
+
+//! decodes count records starting at a record offset of the index
+class MdLegacyRangeJob : public QRunnable {
+public:
+    MdLegacyRangeJob ( const QString& filename, qint64 offset, qint64 count,
+                       MdSessionStore* out, QAtomicInt* cancelled, QAtomicInt* done )
+        : filename(filename), offset(offset), count(count), out(out), cancelled(cancelled), done(done) {
+        setAutoDelete (true);
+    }
+
+    void run () {
+        MdLegacyImporter in (filename);
+        if ( in.open() && in.seek (offset) ) {
+            MdDataRecord* r;
+            for ( qint64 i = 0 ; i < count && cancelled->fetchAndAddRelaxed (0) == 0 ; i++ ) {
+                if ( (r = in.next()) == NULL )
+                    break;
+                out->append (r);
+                delete r;
+            }
+        }
+        done->fetchAndAddRelaxed (1);
+    }
+
+protected:
+    QString filename;
+    qint64 offset;
+    qint64 count;
+    MdSessionStore* out;
+    QAtomicInt* cancelled;
+    QAtomicInt* done;
+};
+
+void MdLoadJob::start () {
+    MdLegacyIndex index;
+    if ( !index.load (filename) || !loadParallel (index) )
+        loadSequential ();
+
+    if ( ok && !isCancelled() )
+        emit progress (100);
+    emit jobFinished();
+}
+
+bool MdLoadJob::loadParallel ( const MdLegacyIndex& index ) {
+    if ( index.entryCount() == 0 )
+        return false;
+    fileVersion = index.fileVersion();
+    //a few ranges per thread, the last ones are shorter
+    int parts = qMin ( index.entryCount(), qMax ( 1, QThread::idealThreadCount() ) * 4 );
+    int entriesPerPart = (index.entryCount() + parts - 1) / parts;
+    QVector<MdSessionStore*> ranges (parts);
+    QAtomicInt done (0);
+    QThreadPool pool;
+    parts = 0;
+    for ( int e = 0 ; e < index.entryCount() ; e += entriesPerPart ) {
+        qint64 first = (qint64) e * index.stride();
+        qint64 count = qMin ( (qint64) entriesPerPart * index.stride(), index.rowCount() - first );
+        ranges[parts] = new MdSessionStore();
+        pool.start ( new MdLegacyRangeJob (filename, index.offset (e), count, ranges[parts], &cancelled, &done) );
+        parts++;
+    }
+    while ( !pool.waitForDone (100) )
+        emit progress ( done.fetchAndAddRelaxed (0) * 100 / parts );
+
+    for ( int i = 0 ; i < parts ; i++ ) {
+        rows->append ( *ranges[i] );
+        delete ranges[i];
+    }
+    if ( isCancelled() )
+        return true;
+    if ( rows->rowCount() != index.rowCount() ) {
+        //the log changed without changing size and time -> read it again
+        qDebug() << "MdLoadJob: index of " << filename << " does not match, loading sequentially";
+        rows->clear();
+        return false;
+    }
+    qDebug() << "legacy file version " << fileVersion << " loaded with " << parts << " ranges";
+    return true;
+}
+
+void MdLoadJob::loadSequential () {
+    MdLegacyImporter importer (filename);
+    if ( !importer.open() ) {
+        ok = false;
+        error = importer.errorString();
+        return;
+    }
+    fileVersion = importer.version();
+    qDebug() << "legacy file version " << fileVersion;
+
+    //the index is built on the way, the next load of the file runs in parallel
+    MdLegacyIndex index;
+    index.reset ( filename, fileVersion );
+    int percent = 0;
+    qint64 pos = importer.position();
+    MdDataRecord* r = NULL;
+    while ( !isCancelled() && (r = importer.next()) != NULL ) {
+        index.addRecord (pos, r);
+        pos = importer.position();
+        rows->append (r);
+        delete r;
+        //the progress is only checked every 1024 records, QFile::size() is not free
+        if ( (rows->rowCount() & 1023) == 0 && importer.progress() != percent ) {
+            percent = importer.progress();
+            emit progress (percent);
+        }
+    }
+    if ( !isCancelled() && index.isValid() && !index.save() )
+        qDebug() << "MdLoadJob: can not write " << MdLegacyIndex::sidecarName (filename);
+}
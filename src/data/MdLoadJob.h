@@ -0,0 +1,60 @@
+#ifndef MDLOADJOB_H
+#define MDLOADJOB_H
+
+#include "thread/workerjob.h"
+
+#include <QAtomicInt>
+#include <QString>
+
+class MdSessionStore;
+class MdLegacyIndex;
+
+/**
+  * loads a legacy (CVERSION1, CVERSION3, VERSION4) file in its own thread.
+  *
+  * the records are decoded into a MdSessionStore off the GUI thread, MdData takes
+  * the result with a single row insert when jobFinished() arrives.
+  * mdv3 sessions don't need it, they are opened lazily by MdSessionCache.
+  *
+  * with an up to date MdLegacyIndex sidecar disjoint ranges are decoded on a thread pool,
+  * otherwise the file is read sequentially and the sidecar is written for the next time.
+  */
+class MdLoadJob : public WorkerJob {
+    Q_OBJECT
+public:
+    MdLoadJob ( const QString& filename );
+    //! deletes the rows if they were not taken
+    ~MdLoadJob ();
+
+    //! the loaded rows, the caller takes ownership!
+    MdSessionStore* takeStore ();
+
+    quint32 version () const { return fileVersion; }
+    bool isCancelled () const;
+    //! false if the file could not be read
+    bool isOk () const { return ok; }
+    QString errorString () const { return error; }
+
+signals:
+    void progress ( int percent );
+
+public slots:
+    void start ();
+    //! thread safe, connect with Qt::DirectConnection: the job thread is busy while loading
+    void cancel ();
+
+protected:
+    //! false if the index does not match the file
+    bool loadParallel ( const MdLegacyIndex& index );
+    void loadSequential ();
+
+    QString filename;
+    MdSessionStore* rows;
+    //! mutable for the read in isCancelled(), QAtomicInt has no const load in Qt4
+    mutable QAtomicInt cancelled;
+    quint32 fileVersion;
+    bool ok;
+    QString error;
+};
+
+#endif // MDLOADJOB_H
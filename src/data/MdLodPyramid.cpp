@@ -0,0 +1,133 @@
+#include "data/MdLodPyramid.h"
+#include "data/MdSessionColumns.h"
+
+//! folds the rows of a typed column into the pending bucket, full buckets go to out
+template <typename T>
+static void accumulate ( const T* v, int rows, int n, float* p, QVector<float>& out ) {
+    for ( int r = 0 ; r < rows ; r++ ) {
+        float f = (float) v[r];
+        if ( n == 0 ) {
+            p[MdLodPyramid::Min] = f;
+            p[MdLodPyramid::Max] = f;
+            p[MdLodPyramid::First] = f;
+        } else {
+            p[MdLodPyramid::Min] = qMin ( p[MdLodPyramid::Min], f );
+            p[MdLodPyramid::Max] = qMax ( p[MdLodPyramid::Max], f );
+        }
+        p[MdLodPyramid::Last] = f;
+        if ( ++n == MdLodPyramid::BASE_ROWS ) {
+            for ( int i = 0 ; i < MdLodPyramid::VALUES ; i++ )
+                out.append ( p[i] );
+            n = 0;
+        }
+    }
+}
+
+//! MdChannel::visit visitor running accumulate() on a column
+struct Accumulate {
+    typedef void Result;
+    const char* base;
+    int rows;
+    int n;
+    float* p;
+    QVector<float>* out;
+    template <typename T> void apply () { accumulate ( reinterpret_cast<const T*> (base), rows, n, p, *out ); }
+};
+
+MdLodPyramid::MdLodPyramid () : pendingRows(0), finished(false) {
+    clear();
+}
+
+void MdLodPyramid::clear () {
+    levels.resize (1);
+    levels[0].clear();
+    levels[0].resize ( MdChannel::Count );
+    pending.fill ( 0, MdChannel::Count * VALUES );
+    pendingRows = 0;
+    finished = false;
+}
+
+int MdLodPyramid::bucketCount ( int level ) const {
+    return levels[level][MdChannel::Time].size() / VALUES;
+}
+
+qint64 MdLodPyramid::bucketRows ( int level ) {
+    qint64 n = BASE_ROWS;
+    for ( int l = 0 ; l < level ; l++ )
+        n *= REDUCTION;
+    return n;
+}
+
+int MdLodPyramid::levelFor ( int levels, qint64 rows, int pixels ) {
+    int found = -1;
+    for ( int l = 0 ; l < levels ; l++ )
+        if ( rows / bucketRows (l) >= qMax (1, pixels) )
+            found = l;
+    return found;
+}
+
+void MdLodPyramid::addChunk ( const MdSessionColumns& cols ) {
+    if ( finished )
+        return;
+    const int rows = cols.rowCount();
+    for ( int id = 0 ; id < MdChannel::Count ; id++ ) {
+        float* p = pending.data() + id * VALUES;
+        QVector<float>& out = levels[0][id];
+        if ( !cols.hasChannel (id) ) {
+            QVector<double> zero ( rows, 0.0 );
+            accumulate ( zero.constData(), rows, pendingRows, p, out );
+            continue;
+        }
+        Accumulate v = { cols.raw(id).constData(), rows, pendingRows, p, &out };
+        MdChannel::visit ( MdChannel::descriptor(id).type, v );
+    }
+    pendingRows = (pendingRows + rows) % BASE_ROWS;
+}
+
+void MdLodPyramid::flushPending () {
+    if ( pendingRows == 0 )
+        return;
+    for ( int id = 0 ; id < MdChannel::Count ; id++ ) {
+        if ( MdChannel::descriptor(id).type == MdChannel::TypeString )
+            continue;
+        for ( int i = 0 ; i < VALUES ; i++ )
+            levels[0][id].append ( pending[id * VALUES + i] );
+    }
+    pendingRows = 0;
+}
+
+void MdLodPyramid::finish () {
+    if ( finished )
+        return;
+    flushPending();
+    finished = true;
+    if ( bucketCount (0) == 0 ) {
+        levels.clear();
+        return;
+    }
+
+    while ( bucketCount (levels.size() - 1) / REDUCTION >= MIN_BUCKETS ) {
+        const QVector< QVector<float> >& below = levels.last();
+        QVector< QVector<float> > level ( MdChannel::Count );
+        for ( int id = 0 ; id < MdChannel::Count ; id++ ) {
+            const QVector<float>& b = below[id];
+            QVector<float>& out = level[id];
+            const int n = b.size() / VALUES;
+            out.reserve ( ((n + REDUCTION - 1) / REDUCTION) * VALUES );
+            for ( int first = 0 ; first < n ; first += REDUCTION ) {
+                int last = qMin ( first + REDUCTION, n ) - 1;
+                float lo = b[first * VALUES + Min];
+                float hi = b[first * VALUES + Max];
+                for ( int i = first + 1 ; i <= last ; i++ ) {
+                    lo = qMin ( lo, b[i * VALUES + Min] );
+                    hi = qMax ( hi, b[i * VALUES + Max] );
+                }
+                out.append (lo);
+                out.append (hi);
+                out.append ( b[first * VALUES + First] );
+                out.append ( b[last * VALUES + Last] );
+            }
+        }
+        levels.append (level);
+    }
+}
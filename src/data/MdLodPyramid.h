@@ -0,0 +1,56 @@
+#ifndef MDLODPYRAMID_H
+#define MDLODPYRAMID_H
+
+#include <QVector>
+
+class MdSessionColumns;
+
+/**
+  * level of detail pyramid of a session: min, max, first and last value of every
+  * numeric channel per bucket of rows. level 0 buckets hold BASE_ROWS rows, every
+  * further level merges REDUCTION buckets of the level below. the last level is the
+  * last one with at least MIN_BUCKETS buckets.
+  *
+  * a plot n pixels wide needs the n..n*REDUCTION buckets of one level only, whatever
+  * the length of the session. the values are floats, precise enough for plotting.
+  */
+class MdLodPyramid {
+public:
+    enum { BASE_ROWS = 64, REDUCTION = 4, MIN_BUCKETS = 64 };
+    //! floats per bucket
+    enum Value { Min = 0, Max, First, Last, VALUES };
+
+    MdLodPyramid ();
+
+    //! adds the rows of a chunk, all channels
+    void addChunk ( const MdSessionColumns& cols );
+    //! closes the last bucket and builds the coarser levels
+    void finish ();
+    void clear ();
+
+    int levelCount () const { return levels.size(); }
+    int bucketCount ( int level ) const;
+    //! VALUES floats per bucket, empty for string channels
+    const QVector<float>& values ( int level, int channel ) const { return levels[level][channel]; }
+
+    //! rows per bucket of a level
+    static qint64 bucketRows ( int level );
+    /**
+      * coarsest of levels with at least pixels buckets over rows,
+      * -1 if even level 0 is too coarse (plot the rows).
+      */
+    static int levelFor ( int levels, qint64 rows, int pixels );
+
+protected:
+    //! appends the pending bucket of every channel to level 0
+    void flushPending ();
+
+    //! [level][channel]
+    QVector< QVector< QVector<float> > > levels;
+    //! bucket in progress, VALUES per channel
+    QVector<float> pending;
+    int pendingRows;
+    bool finished;
+};
+
+#endif // MDLODPYRAMID_H
@@ -0,0 +1,263 @@
+#include "data/MdRawCapture.h"
+#include "data/MdSessionFile.h"
+#include "com/MdMd2Decoder.h"
+#include "com/MdBinaryProtocol.h"
+
+#include "MdDataRecord.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QDebug>
+
+#include <string.h>
+
+MdRawCaptureWriter::MdRawCaptureWriter ( const QString& filename )
+    : file(filename), lastMicros(0), frames(0) {
+}
+
+MdRawCaptureWriter::~MdRawCaptureWriter () {
+    if ( file.isOpen() )
+        close();
+}
+
+bool MdRawCaptureWriter::open ( int decoderVersion ) {
+    if ( !file.open (QIODevice::WriteOnly | QIODevice::Truncate) ) {
+        error = file.errorString();
+        return false;
+    }
+    QDataStream ds (&file);
+    ds.setVersion(QDataStream::Qt_4_6);
+    ds << (quint32) MdRawCapture::MAGICNUMBER;
+    ds << (quint32) MdRawCapture::VERSION;
+    ds << (quint8) decoderVersion;
+    ds << (qint64) QDateTime::currentMSecsSinceEpoch();
+    clock.start();
+    lastMicros = 0;
+    frames = 0;
+    buffer.clear();
+    buffer.reserve ( FLUSH_BYTES + 256 );
+    return ds.status() == QDataStream::Ok;
+}
+
+bool MdRawCaptureWriter::append ( const quint8* frame, int length ) {
+    if ( !file.isOpen() || length <= 0 || length > 0xFF )
+        return false;
+
+    qint64 now = clock.nsecsElapsed() / 1000;
+    quint64 delta = now > lastMicros ? now - lastMicros : 0;
+    lastMicros = now;
+
+    //varint time delta + length + frame in one append
+    char rec[10 + 1 + 0xFF];
+    int n = 0;
+    while ( delta >= 0x80 ) {
+        rec[n++] = (char) (delta | 0x80);
+        delta >>= 7;
+    }
+    rec[n++] = (char) delta;
+    rec[n++] = (char) length;
+    memcpy ( rec + n, frame, length );
+    buffer.append ( rec, n + length );
+    frames++;
+
+    if ( buffer.size() >= FLUSH_BYTES )
+        return flush();
+    return true;
+}
+
+bool MdRawCaptureWriter::flush () {
+    if ( buffer.isEmpty() )
+        return true;
+    bool ok = file.write (buffer) == buffer.size();
+    if ( !ok )
+        error = file.errorString();
+    file.flush();
+    buffer.resize (0);
+    return ok;
+}
+
+bool MdRawCaptureWriter::close () {
+    if ( !file.isOpen() )
+        return false;
+    bool ok = flush();
+    file.close();
+    return ok;
+}
+
+
+MdRawCaptureReader::MdRawCaptureReader ( const QString& filename )
+    : file(filename), mapped(NULL), base(NULL), captureDecoderVersion(0), start(0), truncated(false) {
+}
+
+MdRawCaptureReader::~MdRawCaptureReader () {
+    close();
+}
+
+bool MdRawCaptureReader::open () {
+    if ( !file.open (QIODevice::ReadOnly) ) {
+        error = file.errorString();
+        return false;
+    }
+    QDataStream ds (&file);
+    ds.setVersion(QDataStream::Qt_4_6);
+    quint32 magic, version;
+    ds >> magic;
+    ds >> version;
+    if ( ds.status() != QDataStream::Ok || magic != MdRawCapture::MAGICNUMBER || version != MdRawCapture::VERSION ) {
+        error = "not a mdraw file";
+        return false;
+    }
+    ds >> captureDecoderVersion;
+    ds >> start;
+    if ( ds.status() != QDataStream::Ok ) {
+        error = "truncated mdraw header";
+        return false;
+    }
+    qint64 pos = file.pos();
+    qint64 size = file.size();
+
+    mapped = file.map ( 0, size );
+    if ( mapped ) {
+        base = mapped;
+    } else {
+        file.seek (0);
+        content = file.readAll();
+        base = reinterpret_cast<const quint8*> (content.constData());
+        size = content.size();
+    }
+
+    //one frame per ~100 bytes
+    offsets.reserve ( (size - pos) / 100 + 1 );
+    rxMicros.reserve ( (size - pos) / 100 + 1 );
+    qint64 t = 0;
+    while ( pos < size ) {
+        quint64 delta = 0;
+        int shift = 0;
+        bool complete = false;
+        while ( pos < size && shift < 64 ) {
+            quint8 b = base[pos++];
+            delta |= (quint64) (b & 0x7F) << shift;
+            shift += 7;
+            if ( !(b & 0x80) ) {
+                complete = true;
+                break;
+            }
+        }
+        if ( !complete || pos >= size || pos + 1 + base[pos] > size ) {
+            truncated = true;
+            break;
+        }
+        int len = base[pos++];
+        t += delta;
+        offsets.append (pos);
+        rxMicros.append (t);
+        pos += len;
+    }
+    return true;
+}
+
+void MdRawCaptureReader::close () {
+    if ( mapped ) {
+        file.unmap (mapped);
+        mapped = NULL;
+    }
+    content.clear();
+    base = NULL;
+    offsets.clear();
+    rxMicros.clear();
+    if ( file.isOpen() )
+        file.close();
+}
+
+
+//! decodes a range of capture frames into a column block
+class MdRawDecodeJob : public QRunnable {
+public:
+    MdRawDecodeJob ( const MdRawCaptureReader* reader, int first, int count, int version, MdSessionColumns* out )
+        : reader(reader), first(first), count(count), version(version), out(out) {
+        setAutoDelete (true);
+    }
+
+    void run () {
+        MdMd2Decoder decoder (version);
+        int length = MdMd2Decoder::frameLength (version);
+        //no MdDataRecord(MdSensorRecord*) here, it would sample the current mobile sensors
+        MdDataRecord rec;
+        //frame form: the frame channels are decoded at the end, one pass per channel
+        out->setFrameVersion (version);
+        out->reserve ( count );
+        for ( int i = first ; i < first + count ; i++ ) {
+            const quint8* f = reader->frame (i);
+            int len = reader->frameLength (i);
+            if ( len < length || f[1] != MD_SERIALOUT_BINARY_TAG )
+                continue;
+            out->appendFrame ( f, &rec );
+        }
+        out->dropFrames (decoder);
+    }
+
+protected:
+    const MdRawCaptureReader* reader;
+    int first;
+    int count;
+    int version;
+    MdSessionColumns* out;
+};
+
+bool MdRawCapture::decodeToSession ( const QString& capture, const QString& session,
+                                     int decoderVersion, QString* errorString ) {
+    MdRawCaptureReader reader (capture);
+    if ( !reader.open() ) {
+        if ( errorString )
+            *errorString = reader.errorString();
+        return false;
+    }
+    if ( decoderVersion == 0 )
+        decoderVersion = reader.decoderVersion();
+    if ( !MdMd2Decoder::isKnownVersion (decoderVersion) ) {
+        if ( errorString )
+            *errorString = QString("unknown MD2 decoder version %1").arg(decoderVersion);
+        return false;
+    }
+    if ( reader.isTruncated() )
+        qDebug() << "MdRawCapture: " << capture << " ends with an incomplete frame, ignored";
+
+    MdSessionWriter writer (session);
+    if ( !writer.open() ) {
+        if ( errorString )
+            *errorString = writer.errorString();
+        return false;
+    }
+
+    //one chunk per job, a few jobs per thread in flight -> bounded memory for long captures
+    const int chunkRows = MdSessionFile::DEFAULT_CHUNK_ROWS;
+    const int wave = qMax ( 1, QThread::idealThreadCount() ) * 2;
+    QThreadPool pool;
+    bool ok = true;
+    QVector<MdSessionColumns*> blocks;
+    for ( int first = 0 ; ok && first < reader.frameCount() ; ) {
+        blocks.clear();
+        for ( int j = 0 ; j < wave && first < reader.frameCount() ; j++ ) {
+            int count = qMin ( chunkRows, reader.frameCount() - first );
+            MdSessionColumns* c = new MdSessionColumns();
+            blocks.append (c);
+            pool.start ( new MdRawDecodeJob (&reader, first, count, decoderVersion, c) );
+            first += count;
+        }
+        pool.waitForDone();
+        //written in capture order
+        foreach ( MdSessionColumns* c, blocks ) {
+            if ( ok )
+                ok = writer.appendChunk (*c);
+            delete c;
+        }
+    }
+
+    ok = writer.close() && ok;
+    if ( !ok && errorString )
+        *errorString = writer.errorString();
+    return ok;
+}
@@ -0,0 +1,97 @@
+#ifndef MDRAWCAPTURE_H
+#define MDRAWCAPTURE_H
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QElapsedTimer>
+
+/**
+  * mdraw capture file: the validated serial frames as they were received
+  *
+  * header (QDataStream, Qt_4_6):
+  *   quint32 magic, quint32 version (1), quint8 MD2 decoder version at capture time,
+  *   qint64 capture start (msecs since epoch, wall clock)
+  * per frame:
+  *   varint receive time delta to the previous frame in microseconds (monotonic clock),
+  *   quint8 frame length, frame bytes including STX, tag and ETX
+  *
+  * nothing is converted at capture time, a capture can be decoded into a mdv3 session
+  * later with any MdMd2Decoder version. a truncated last frame (crash, power loss) is ignored.
+  */
+namespace MdRawCapture {
+    enum { MAGICNUMBER = 0xFFAAFF52, VERSION = 1 };
+
+    /**
+      * decodes the MD2 frames of a capture into a mdv3 session, chunks are decoded in parallel.
+      * decoderVersion 0 uses the version recorded in the capture.
+      */
+    bool decodeToSession ( const QString& capture, const QString& session,
+                           int decoderVersion = 0, QString* errorString = 0 );
+}
+
+class MdRawCaptureWriter {
+public:
+    MdRawCaptureWriter ( const QString& filename );
+    virtual ~MdRawCaptureWriter ();
+
+    bool open ( int decoderVersion );
+    //! buffers the frame with the current receive time, written in blocks of FLUSH_BYTES
+    bool append ( const quint8* frame, int length );
+    bool flush ();
+    bool close ();
+
+    bool isOpen () const { return file.isOpen(); }
+    QString fileName () const { return file.fileName(); }
+    quint64 frameCount () const { return frames; }
+    QString errorString () const { return error; }
+
+    enum { FLUSH_BYTES = 64 * 1024 };
+
+protected:
+    QFile file;
+    QElapsedTimer clock;
+    qint64 lastMicros;
+    QByteArray buffer;
+    quint64 frames;
+    QString error;
+};
+
+class MdRawCaptureReader {
+public:
+    MdRawCaptureReader ( const QString& filename );
+    virtual ~MdRawCaptureReader ();
+
+    //! reads the header and indexes all frames
+    bool open ();
+    void close ();
+
+    int decoderVersion () const { return captureDecoderVersion; }
+    qint64 startTime () const { return start; }
+
+    int frameCount () const { return offsets.size(); }
+    const quint8* frame ( int i ) const { return base + offsets[i]; }
+    int frameLength ( int i ) const { return base[offsets[i] - 1]; }
+    //! receive time in microseconds since the capture start
+    qint64 receiveTime ( int i ) const { return rxMicros[i]; }
+    //! true if the file ends with an incomplete frame
+    bool isTruncated () const { return truncated; }
+
+    QString errorString () const { return error; }
+
+protected:
+    QFile file;
+    uchar* mapped;
+    //! file content if it can not be mapped
+    QByteArray content;
+    const quint8* base;
+    quint8 captureDecoderVersion;
+    qint64 start;
+    QVector<qint64> offsets;
+    QVector<qint64> rxMicros;
+    bool truncated;
+    QString error;
+};
+
+#endif // MDRAWCAPTURE_H
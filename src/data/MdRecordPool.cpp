@@ -0,0 +1,73 @@
+#include "data/MdRecordPool.h"
+
+#include "MdDataRecord.h"
+
+#include <QDebug>
+
+MdRecordPool::MdRecordPool ()
+    : acquires(0), allocs(0), bytes(0), reportAcquires(0), reportAllocs(0) {
+    reportTimer.start();
+}
+
+MdRecordPool::~MdRecordPool () {
+    foreach ( MdDataRecord* b, blocks )
+        delete[] b;
+}
+
+MdRecordPool* MdRecordPool::instance () {
+    static MdRecordPool pool;
+    return &pool;
+}
+
+void MdRecordPool::grow () {
+    //every record allocates its sensor and mobile part
+    MdDataRecord* b = new MdDataRecord[BLOCK_RECORDS];
+    blocks.append (b);
+    allocs += 1 + 2 * BLOCK_RECORDS;
+    bytes += BLOCK_RECORDS * ( sizeof(MdDataRecord) + sizeof(MdSensorRecord) + sizeof(MobileSensorRecord) );
+    freeList.reserve ( blocks.size() * BLOCK_RECORDS );
+    for ( int i = BLOCK_RECORDS - 1 ; i >= 0 ; i-- )
+        freeList.append ( b + i );
+}
+
+MdDataRecord* MdRecordPool::acquire () {
+    if ( freeList.isEmpty() )
+        grow();
+    acquires++;
+    if ( reportTimer.elapsed() >= REPORT_MILLIS )
+        report();
+    MdDataRecord* r = freeList.last();
+    freeList.removeLast();
+    return r;
+}
+
+void MdRecordPool::release ( MdDataRecord* r ) {
+    if ( !r )
+        return;
+    if ( owns (r) )
+        freeList.append (r);
+    else
+        delete r;
+}
+
+bool MdRecordPool::owns ( const MdDataRecord* r ) const {
+    quintptr p = (quintptr) r;
+    foreach ( const MdDataRecord* b, blocks )
+        if ( p >= (quintptr) b && p < (quintptr) (b + BLOCK_RECORDS) )
+            return true;
+    return false;
+}
+
+void MdRecordPool::report () {
+    qint64 ms = reportTimer.restart();
+#if  defined (Q_WS_MAEMO_5)  || defined (ANDROID)
+    Q_UNUSED (ms);
+#else
+    if ( ms > 0 )
+        qDebug() << "MdRecordPool: " << (acquires - reportAcquires) * 1000 / ms << " records/s | "
+                 << (allocs - reportAllocs) * 1000 / ms << " heap allocations/s | "
+                 << blocks.size() << " blocks, " << bytes << " bytes, " << freeList.size() << " free";
+#endif
+    reportAcquires = acquires;
+    reportAllocs = allocs;
+}
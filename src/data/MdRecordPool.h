@@ -0,0 +1,59 @@
+#ifndef MDRECORDPOOL_H
+#define MDRECORDPOOL_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QVector>
+
+class MdDataRecord;
+
+/**
+  * recycled records for the acquisition path. the records are allocated in blocks
+  * of BLOCK_RECORDS and handed out from a free list, a released record goes back
+  * to the list -> once the first block is in use a new frame costs no heap allocation.
+  *
+  * the values of an acquired record are the ones of its last use, the caller
+  * has to assign all of them. not thread safe, GUI thread only (see instance()).
+  */
+class MdRecordPool {
+public:
+    enum { BLOCK_RECORDS = 256, REPORT_MILLIS = 10000 };
+
+    MdRecordPool ();
+    ~MdRecordPool ();
+
+    MdDataRecord* acquire ();
+    //! records not acquired from this pool are deleted
+    void release ( MdDataRecord* r );
+    bool owns ( const MdDataRecord* r ) const;
+
+    //! records handed out / heap allocations / heap bytes since the start
+    quint64 acquired () const { return acquires; }
+    quint64 heapAllocations () const { return allocs; }
+    quint64 heapBytes () const { return bytes; }
+    int freeRecords () const { return freeList.size(); }
+    int blockCount () const { return blocks.size(); }
+
+    //! pool of the GUI thread
+    static MdRecordPool* instance ();
+
+private:
+    Q_DISABLE_COPY (MdRecordPool)
+
+    void grow ();
+    //! acquires and allocations per second every REPORT_MILLIS
+    void report ();
+
+    QList<MdDataRecord*> blocks;
+    QVector<MdDataRecord*> freeList;
+
+    quint64 acquires;
+    quint64 allocs;
+    quint64 bytes;
+
+    QElapsedTimer reportTimer;
+    quint64 reportAcquires;
+    quint64 reportAllocs;
+};
+
+#endif // MDRECORDPOOL_H
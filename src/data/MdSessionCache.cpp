@@ -0,0 +1,124 @@
+#include "data/MdSessionCache.h"
+
+#include "MdDataRecord.h"
+
+#include <QDebug>
+
+MdSessionCache::MdSessionCache ( const QString& filename, qint64 budgetBytes )
+    : reader(filename), budgetBytes(budgetBytes), resident(0), hitCount(0), missCount(0), gen(0) {
+    recordSlot.fill ( NULL, RECORD_SLOTS );
+    recordSlotRow.fill ( -1, RECORD_SLOTS );
+}
+
+MdSessionCache::~MdSessionCache () {
+    foreach ( MdSessionColumns* c, chunks )
+        delete c;
+    chunks.clear();
+    foreach ( MdDataRecord* r, recordSlot )
+        if ( r )
+            delete r;
+}
+
+qint64 MdSessionCache::defaultBudget () {
+#if  defined (Q_WS_MAEMO_5)  || defined (ANDROID)
+    return 8 * 1024 * 1024;
+#else
+    return 64 * 1024 * 1024;
+#endif
+}
+
+bool MdSessionCache::open () {
+    if ( !reader.open() )
+        return false;
+    firstRow.resize ( reader.chunkCount() );
+    qint64 r = 0;
+    for ( int i = 0 ; i < reader.chunkCount() ; i++ ) {
+        firstRow[i] = r;
+        r += reader.chunkInfo(i).rows;
+    }
+    return true;
+}
+
+int MdSessionCache::chunkForRow ( qint64 row ) const {
+    if ( row < 0 || row >= rowCount() )
+        return -1;
+    //last chunk with firstRow <= row
+    int lb = 0;
+    int rb = firstRow.size() - 1;
+    while ( lb < rb ) {
+        int mi = lb + (rb - lb + 1) / 2;
+        if ( firstRow[mi] <= row )
+            lb = mi;
+        else
+            rb = mi - 1;
+    }
+    return lb;
+}
+
+const MdSessionColumns* MdSessionCache::chunk ( int i ) {
+    if ( i < 0 || i >= chunkCount() )
+        return NULL;
+
+    MdSessionColumns* c = chunks.value (i, NULL);
+    if ( c ) {
+        hitCount++;
+        lru.removeOne (i);
+        lru.append (i);
+        return c;
+    }
+
+    missCount++;
+    c = new MdSessionColumns();
+    if ( !reader.readChunk (i, *c) ) {
+        qDebug() << "MdSessionCache: " << reader.errorString();
+        delete c;
+        return NULL;
+    }
+    qint64 b = c->byteSize();
+    chunks.insert (i, c);
+    chunkBytes.insert (i, b);
+    lru.append (i);
+    resident += b;
+    evict (i);
+    return c;
+}
+
+MdDataRecord* MdSessionCache::record ( qint64 row ) {
+    if ( row < 0 || row >= rowCount() )
+        return NULL;
+    int slot = row % RECORD_SLOTS;
+    if ( recordSlotRow[slot] == row )
+        return recordSlot[slot];
+
+    int ci = chunkForRow (row);
+    const MdSessionColumns* c = chunk (ci);
+    if ( !c )
+        return NULL;
+    if ( !recordSlot[slot] )
+        recordSlot[slot] = new MdDataRecord();
+    c->assignRecord ( row - firstRow[ci], recordSlot[slot] );
+    recordSlotRow[slot] = row;
+    return recordSlot[slot];
+}
+
+void MdSessionCache::setBudget ( qint64 bytes ) {
+    budgetBytes = bytes;
+    evict (-1);
+}
+
+void MdSessionCache::evict ( int keep ) {
+    while ( resident > budgetBytes && !lru.isEmpty() ) {
+        int i = lru.first();
+        if ( i == keep ) {
+            //the requested chunk alone exceeds the budget
+            if ( lru.size() == 1 )
+                break;
+            lru.move (0, lru.size() - 1);
+            continue;
+        }
+        lru.removeFirst();
+        resident -= chunkBytes.take (i);
+        delete chunks.take (i);
+        gen++;
+    }
+}
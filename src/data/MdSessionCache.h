@@ -0,0 +1,84 @@
+#ifndef MDSESSIONCACHE_H
+#define MDSESSIONCACHE_H
+
+#include "data/MdSessionFile.h"
+#include "data/MdChunkSource.h"
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+class MdDataRecord;
+
+/**
+  * lazy view of a mdv3 file. open() only reads the header and the chunk directory,
+  * chunks are decoded when a row of them is requested and dropped least recently
+  * used first as soon as the decoded chunks exceed the memory budget.
+  */
+class MdSessionCache : public MdChunkSource {
+public:
+    MdSessionCache ( const QString& filename, qint64 budgetBytes = defaultBudget() );
+    virtual ~MdSessionCache ();
+
+    bool open ();
+    QString errorString () const { return reader.errorString(); }
+    QString fileName () const { return reader.fileName(); }
+
+    qint64 rowCount () const { return reader.rowCount(); }
+    int chunkCount () const { return reader.chunkCount(); }
+    const MdSessionChunkInfo& chunkInfo ( int i ) const { return reader.chunkInfo(i); }
+
+    //! chunk holding row, -1 if row is out of range
+    int chunkForRow ( qint64 row ) const;
+    qint64 chunkFirstRow ( int chunk ) const { return firstRow[chunk]; }
+    qint32 chunkLastTime ( int chunk ) const { return reader.chunkInfo(chunk).timeEnd; }
+
+    //! level of detail pyramid of the file, see MdSessionReader::readLod
+    int lodLevelFor ( qint64 rows, int pixels ) const { return reader.lodLevelFor (rows, pixels); }
+    bool readLod ( int level, int channel, int first, int count, QVector<float>& values ) {
+        return reader.readLod (level, channel, first, count, values);
+    }
+
+    //! decoded chunk or NULL on read errors. valid until the next chunk() / record() call
+    const MdSessionColumns* chunk ( int i );
+    quint32 generation () const { return gen; }
+
+    /**
+      * row as record. the record is owned by the cache and stays valid
+      * until RECORD_SLOTS other rows were requested.
+      */
+    MdDataRecord* record ( qint64 row );
+
+    void setBudget ( qint64 bytes );
+    qint64 budget () const { return budgetBytes; }
+    qint64 residentBytes () const { return resident; }
+    quint64 hits () const { return hitCount; }
+    quint64 misses () const { return missCount; }
+
+    static qint64 defaultBudget ();
+
+    enum { RECORD_SLOTS = 512 };
+
+protected:
+    //! drop least recently used chunks until we are below the budget, keep at least keep
+    void evict ( int keep );
+
+    MdSessionReader reader;
+    QVector<qint64> firstRow;
+
+    QHash<int, MdSessionColumns*> chunks;
+    //! chunk numbers, least recently used first
+    QList<int> lru;
+    QHash<int, qint64> chunkBytes;
+    qint64 budgetBytes;
+    qint64 resident;
+    quint64 hitCount;
+    quint64 missCount;
+    //! counts the evicted chunks, see MdChunkSource::generation
+    quint32 gen;
+
+    QVector<MdDataRecord*> recordSlot;
+    QVector<qint64> recordSlotRow;
+};
+
+#endif // MDSESSIONCACHE_H
@@ -0,0 +1,369 @@
+#include "data/MdSessionColumns.h"
+#include "com/MdMd2Decoder.h"
+
+#include "MdDataRecord.h"
+#include "mobile/MobileSensorRecord.h"
+
+#include <algorithm>
+#include <cstring>
+
+MdSessionColumns::MdSessionColumns () : rows(0), frameVer(0), decodedRows(0), packed(false), packedTypeK(0) {
+    cols.resize ( MdChannel::Count );
+    strs.resize ( MdChannel::Count );
+    present.fill ( true, MdChannel::Count );
+}
+
+void MdSessionColumns::clear () {
+    for ( int i = 0 ; i < MdChannel::Count ; i++ ) {
+        cols[i].clear();
+        strs[i].clear();
+    }
+    frames.clear();
+    frameVer = 0;
+    packed = false;
+    runFirst.clear();
+    runs.clear();
+    rows = decodedRows = 0;
+}
+
+void MdSessionColumns::clearRows () {
+    for ( int i = 0 ; i < MdChannel::Count ; i++ ) {
+        cols[i].resize (0);
+        strs[i].clear();
+    }
+    frames.resize (0);
+    frameVer = 0;
+    packed = false;
+    runFirst.clear();
+    runs.clear();
+    rows = decodedRows = 0;
+}
+
+void MdSessionColumns::reserve ( int n ) {
+    if ( hasFrames() )
+        frames.reserve ( n * MdMd2Decoder::frameLength (frameVer) );
+    for ( int i = 0 ; i < MdChannel::Count ; i++ ) {
+        if ( !present[i] )
+            continue;
+        //decoded on demand, mostly for a few chunks only
+        if ( hasFrames() && MdMd2Decoder::field (i) )
+            continue;
+        int ts = MdChannel::typeSize( MdChannel::descriptor(i).type );
+        if ( ts > 0 )
+            cols[i].reserve ( n * ts );
+        else
+            strs[i].reserve ( n );
+    }
+}
+
+void MdSessionColumns::zeroRows ( int n ) {
+    clearRows();
+    for ( int i = 0 ; i < MdChannel::Count ; i++ ) {
+        int ts = MdChannel::typeSize ( MdChannel::descriptor(i).type );
+        if ( ts > 0 )
+            cols[i].fill ( 0, n * ts );
+        else
+            for ( int r = 0 ; r < n ; r++ )
+                strs[i].append ( QString() );
+    }
+    rows = decodedRows = n;
+}
+
+void MdSessionColumns::setChannels ( const QList<int>& ids ) {
+    present.fill ( false );
+    foreach ( int id, ids ) {
+        if ( id >= 0 && id < MdChannel::Count )
+            present[id] = true;
+    }
+}
+
+void MdSessionColumns::setAllChannels () {
+    present.fill ( true );
+}
+
+//! MdChannel::visit visitor reading one value
+struct ColumnToDouble {
+    typedef double Result;
+    const char* data;
+    int row;
+    template <typename T> double apply () { return reinterpret_cast<const T*> (data)[row]; }
+};
+
+double MdSessionColumns::toDouble ( int id, int row ) const {
+    ColumnToDouble v = { cols[id].constData(), row };
+    return MdChannel::visit ( MdChannel::descriptor(id).type, v );
+}
+
+qint64 MdSessionColumns::byteSize () const {
+    qint64 b = 0;
+    for ( int i = 0 ; i < MdChannel::Count ; i++ ) {
+        b += cols[i].capacity();
+        foreach ( const QString& s, strs[i] )
+            b += s.capacity() * sizeof(QChar) + sizeof(QString);
+    }
+    foreach ( const QByteArray& r, runs )
+        b += r.capacity();
+    return b + frames.capacity() + runFirst.capacity() * sizeof(int);
+}
+
+void MdSessionColumns::appendRows ( const MdSessionColumns& src, int first, int count ) {
+    for ( int i = 0 ; i < MdChannel::Count ; i++ ) {
+        if ( !present[i] )
+            continue;
+        int ts = MdChannel::typeSize( MdChannel::descriptor(i).type );
+        if ( ts > 0 )
+            cols[i].append ( src.cols[i].constData() + first * ts, count * ts );
+        else
+            strs[i] += src.strs[i].mid ( first, count );
+    }
+    rows += count;
+    decodedRows = rows;
+}
+
+void MdSessionColumns::removeRows ( int first, int count ) {
+    for ( int i = 0 ; i < MdChannel::Count ; i++ ) {
+        if ( !present[i] )
+            continue;
+        int ts = MdChannel::typeSize( MdChannel::descriptor(i).type );
+        if ( ts > 0 )
+            cols[i].remove ( first * ts, count * ts );
+        else
+            for ( int r = 0 ; r < count ; r++ )
+                strs[i].removeAt (first);
+    }
+    rows -= count;
+    decodedRows = rows;
+}
+
+void MdSessionColumns::setFrameVersion ( int version ) {
+    Q_ASSERT ( rows == 0 );
+    frameVer = version;
+}
+
+void MdSessionColumns::appendFrame ( const quint8* frame, const MdDataRecord* r ) {
+    frames.append ( reinterpret_cast<const char*> (frame), MdMd2Decoder::frameLength (frameVer) );
+    appendRecord (r);
+}
+
+//! channels kept as runs or not at all in the packed form
+static bool isPackedChannel ( int id, int typeK ) {
+    if ( id >= MdChannel::Egt0 + typeK && id <= MdChannel::Egt7 )
+        return true;
+    return MdChannel::descriptor(id).usage & MdChannel::Kline;
+}
+
+void MdSessionColumns::pack ( int typeK ) {
+    if ( hasFrames() || packed || rows == 0 )
+        return;
+    //a run ends with a new Digifant frame number or any other K-line value
+    runFirst.resize (0);
+    runFirst.append (0);
+    const quint8* num = reinterpret_cast<const quint8*> ( cols[MdChannel::DfKlineFramenum].constData() );
+    for ( int r = 1 ; r < rows ; r++ ) {
+        bool same = !present[MdChannel::DfKlineFramenum] || num[r] == num[r-1];
+        for ( int i = 0 ; same && i < MdChannel::Count ; i++ ) {
+            if ( !present[i] || !(MdChannel::descriptor(i).usage & MdChannel::Kline) )
+                continue;
+            int ts = MdChannel::typeSize ( MdChannel::descriptor(i).type );
+            const char* d = cols[i].constData() + r * ts;
+            same = memcmp ( d, d - ts, ts ) == 0;
+        }
+        if ( !same )
+            runFirst.append (r);
+    }
+
+    runs.resize ( MdChannel::Count );
+    for ( int i = 0 ; i < MdChannel::Count ; i++ ) {
+        if ( !present[i] || !isPackedChannel (i, typeK) )
+            continue;
+        if ( MdChannel::descriptor(i).usage & MdChannel::Kline ) {
+            int ts = MdChannel::typeSize ( MdChannel::descriptor(i).type );
+            runs[i].resize ( runFirst.size() * ts );
+            for ( int e = 0 ; e < runFirst.size() ; e++ )
+                memcpy ( runs[i].data() + e * ts, cols[i].constData() + runFirst[e] * ts, ts );
+        } else
+            //thermocouple not fitted, as materialize() expands it
+            cols[i].fill (0);
+    }
+    //the columns stay as the expanded form until dematerialize()
+    packed = true;
+    packedTypeK = typeK;
+    decodedRows = rows;
+}
+
+//! MdChannel::visit visitor filling a column from the run values
+struct RunExpand {
+    typedef void Result;
+    const QVector<int>* first;
+    const QByteArray* values;
+    int rows;
+    QByteArray* out;
+    template <typename T> void apply () {
+        out->resize ( rows * (int) sizeof(T) );
+        T* o = reinterpret_cast<T*> ( out->data() );
+        const T* v = reinterpret_cast<const T*> ( values->constData() );
+        int n = first->size();
+        for ( int e = 0 ; e < n ; e++ )
+            std::fill ( o + first->at(e), o + ( e + 1 < n ? first->at(e+1) : rows ), v[e] );
+    }
+};
+
+void MdSessionColumns::materialize ( MdMd2Decoder* dec ) {
+    if ( decodedRows == rows )
+        return;
+    if ( hasFrames() ) {
+        Q_ASSERT ( dec && dec->version() == frameVer );
+        int stride = MdMd2Decoder::frameLength (frameVer);
+        const quint8* f = reinterpret_cast<const quint8*> ( frames.constData() ) + decodedRows * stride;
+        QByteArray* out[MdChannel::Count];
+        for ( int i = 0 ; i < MdChannel::Count ; i++ )
+            out[i] = present[i] && MdMd2Decoder::field (i) ? &cols[i] : NULL;
+        dec->decodeColumns ( f, stride, rows - decodedRows, out );
+    } else if ( packed ) {
+        for ( int i = 0 ; i < MdChannel::Count ; i++ ) {
+            if ( !present[i] || !isPackedChannel (i, packedTypeK) )
+                continue;
+            const MdChannel::Descriptor& d = MdChannel::descriptor(i);
+            if ( d.usage & MdChannel::Kline ) {
+                RunExpand v = { &runFirst, &runs[i], rows, &cols[i] };
+                MdChannel::visit ( d.type, v );
+            } else
+                //thermocouple not fitted
+                cols[i].fill ( 0, rows * MdChannel::typeSize (d.type) );
+        }
+    }
+    decodedRows = rows;
+}
+
+void MdSessionColumns::dematerialize () {
+    if ( !hasFrames() && !packed )
+        return;
+    for ( int i = 0 ; i < MdChannel::Count ; i++ )
+        if ( hasFrames() ? MdMd2Decoder::field (i) != NULL : isPackedChannel (i, packedTypeK) )
+            cols[i].clear();
+    decodedRows = 0;
+}
+
+void MdSessionColumns::unpack () {
+    if ( !packed )
+        return;
+    materialize (NULL);
+    packed = false;
+    runFirst.clear();
+    runs.clear();
+}
+
+int MdSessionColumns::runEnd ( int id, int row ) const {
+    if ( !packed || !(MdChannel::descriptor(id).usage & MdChannel::Kline) )
+        return row + 1;
+    const int* b = runFirst.constData();
+    int e = std::upper_bound ( b, b + runFirst.size(), row ) - b;
+    return e < runFirst.size() ? runFirst[e] : rows;
+}
+
+void MdSessionColumns::dropFrames ( MdMd2Decoder& dec ) {
+    if ( !hasFrames() )
+        return;
+    materialize (&dec);
+    frames.clear();
+    frameVer = 0;
+}
+
+typedef void (*FieldGet) ( const MdSensorRecord& s, const MobileSensorRecord& m, void* value );
+typedef void (*FieldSet) ( MdSensorRecord& s, MobileSensorRecord& m, const void* value );
+
+/**
+  * record accessors of every channel, generated from the record field of MD_CHANNELS:
+  * get converts the field to the storage type of the channel, set converts it back.
+  * a friend of MdSensorRecord.
+  */
+struct MdRecordField {
+#define MD_CHANNEL_ACCESSORS(id, type, name, label, unit, scale, usage, field) \
+    static void get##id ( const MdSensorRecord& s, const MobileSensorRecord& m, void* value ) { \
+        Q_UNUSED (s); Q_UNUSED (m); \
+        *static_cast<MdChannel::Value<MdChannel::id>::Type*> (value) = field; \
+    } \
+    static void set##id ( MdSensorRecord& s, MobileSensorRecord& m, const void* value ) { \
+        Q_UNUSED (s); Q_UNUSED (m); \
+        field = *static_cast<const MdChannel::Value<MdChannel::id>::Type*> (value); \
+    }
+    MD_CHANNELS(MD_CHANNEL_ACCESSORS)
+#undef MD_CHANNEL_ACCESSORS
+};
+
+#define MD_CHANNEL_GET(id, type, name, label, unit, scale, usage, field) MdRecordField::get##id,
+static const FieldGet fieldGet[MdChannel::Count] = {
+    MD_CHANNELS(MD_CHANNEL_GET)
+};
+#undef MD_CHANNEL_GET
+
+#define MD_CHANNEL_SET(id, type, name, label, unit, scale, usage, field) MdRecordField::set##id,
+static const FieldSet fieldSet[MdChannel::Count] = {
+    MD_CHANNELS(MD_CHANNEL_SET)
+};
+#undef MD_CHANNEL_SET
+
+//! MdChannel::visit visitor appending the record field of a channel to its column
+struct FieldAppend {
+    typedef void Result;
+    FieldGet get;
+    const MdSensorRecord* s;
+    const MobileSensorRecord* m;
+    QByteArray* out;
+    template <typename T> void apply () {
+        T v;
+        get ( *s, *m, &v );
+        out->append ( reinterpret_cast<const char*> (&v), sizeof(T) );
+    }
+};
+
+//! MdChannel::visit visitor assigning a value of a column to the record field of its channel
+struct FieldAssign {
+    typedef void Result;
+    FieldSet set;
+    const char* data;
+    int row;
+    MdSensorRecord* s;
+    MobileSensorRecord* m;
+    template <typename T> void apply () {
+        set ( *s, *m, reinterpret_cast<const T*> (data) + row );
+    }
+};
+
+void MdSessionColumns::appendRecord ( const MdDataRecord* r ) {
+    const MdSensorRecord* s = r->getSensorR();
+    const MobileSensorRecord* m = r->getMobileR();
+    MobileSensorRecord empty;
+    if ( !m )
+        m = &empty;
+
+    for ( int id = 0 ; id < MdChannel::Count ; id++ ) {
+        if ( !present[id] )
+            continue;
+        //in the frame
+        if ( hasFrames() && MdMd2Decoder::field (id) )
+            continue;
+        FieldAppend v = { fieldGet[id], s, m, &cols[id] };
+        MdChannel::visit ( MdChannel::descriptor(id).type, v );
+    }
+    rows++;
+    if ( !hasFrames() )
+        decodedRows = rows;
+}
+
+void MdSessionColumns::assignRecord ( int row, MdDataRecord* r ) const {
+    MdSensorRecord* s = r->getSensorR();
+    MobileSensorRecord* m = r->getMobileR();
+
+    for ( int id = 0 ; id < MdChannel::Count ; id++ ) {
+        if ( !present[id] )
+            continue;
+        if ( id >= MdChannel::AccX && !m )
+            break;
+        FieldAssign v = { fieldSet[id], cols[id].constData(), row, s, m };
+        MdChannel::visit ( MdChannel::descriptor(id).type, v );
+    }
+
+    //some computations
+    s->df_inj_duty = 2* (( (s->df_inj_time / 1000.0) * s->rpm)/1200.0);
+}
@@ -0,0 +1,125 @@
+#ifndef MDSESSIONCOLUMNS_H
+#define MDSESSIONCOLUMNS_H
+
+#include "data/MdChannel.h"
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+
+class MdDataRecord;
+class MdMd2Decoder;
+
+/**
+  * column buffer of a session block: one contiguous typed array per channel.
+  * used by the mdv3 writer to transpose records and by the reader to hand out
+  * decoded chunks. only the enabled channels are stored.
+  *
+  * live rows may be kept in frame form instead: the MD2 frames as received plus the
+  * columns of the channels that are not in the frame (MdChannel::Frame). the frame
+  * channels are decoded by materialize() when the chunk is read and can be dropped
+  * again by dematerialize(). only a materialized chunk may be read, only a chunk in
+  * column form may be changed (appendRows, removeRows, raw()).
+  *
+  * a complete chunk in column form can be packed instead: the MdChannel::Kline channels
+  * are kept once per run of rows with the same Digifant frame, the EGTs of thermocouples
+  * that are not fitted are not kept at all. the columns stay as they are until dematerialize()
+  * frees them, materialize() expands them again. the runs stay and let scans step over a
+  * K-line frame at once (runEnd).
+  */
+class MdSessionColumns {
+public:
+    MdSessionColumns ();
+
+    //! drop all rows, keep the channel selection
+    void clear ();
+    //! drop all rows, the reserve()d arrays keep their capacity
+    void clearRows ();
+    void reserve ( int rows );
+    //! n rows of zeros / empty strings in all columns, stands in for a chunk that could not be read
+    void zeroRows ( int n );
+
+    int rowCount () const { return rows; }
+    void setRowCount ( int n ) { rows = decodedRows = n; }
+
+    //! enable only the given channels (default: all)
+    void setChannels ( const QList<int>& ids );
+    void setAllChannels ();
+    bool hasChannel ( int id ) const { return id >= 0 && id < MdChannel::Count && present[id]; }
+
+    //! transpose a record into the enabled columns
+    void appendRecord ( const MdDataRecord* r );
+
+    //! frame form with frames of MdMd2Decoder::Version version, only while the chunk is empty
+    void setFrameVersion ( int version );
+    //! MdMd2Decoder::Version of the frames, 0 in column form
+    int frameVersion () const { return frameVer; }
+    bool hasFrames () const { return frameVer != 0; }
+    //! row r has to be the record decoded from frame
+    void appendFrame ( const quint8* frame, const MdDataRecord* r );
+    //! keeps the K-line channels as runs and typeK EGT channels, column form only
+    void pack ( int typeK );
+    bool isPacked () const { return packed; }
+    /**
+      * decodes the frame channels of the rows added since the last call or expands the packed
+      * channels. dec has to be of frameVersion(), NULL if the chunk has no frames
+      */
+    void materialize ( MdMd2Decoder* dec );
+    bool isMaterialized () const { return decodedRows == rows; }
+    //! frees the decoded frame channels or the expanded packed channels, the frames / runs stay
+    void dematerialize ();
+    //! materializes and drops the frames -> column form
+    void dropFrames ( MdMd2Decoder& dec );
+    //! materializes and drops the runs -> column form
+    void unpack ();
+    //! end (exclusive) of the rows from row on with the same value of channel id, row + 1 if id is not packed
+    int runEnd ( int id, int row ) const;
+    //! assign the enabled columns of row to the record fields
+    void assignRecord ( int row, MdDataRecord* r ) const;
+
+    //! append count rows of src starting at first, both need the same channels enabled
+    void appendRows ( const MdSessionColumns& src, int first, int count );
+    //! drop count rows starting at first
+    void removeRows ( int first, int count );
+
+    //! typed values (host byte order) of a fixed size channel
+    QByteArray& raw ( int id ) { return cols[id]; }
+    const QByteArray& raw ( int id ) const { return cols[id]; }
+    //! values of a TypeString channel
+    QStringList& strings ( int id ) { return strs[id]; }
+    const QStringList& strings ( int id ) const { return strs[id]; }
+
+    template <typename T> T value ( int id, int row ) const {
+        return reinterpret_cast<const T*> ( cols[id].constData() )[row];
+    }
+    //! value of channel Id in its own type, e.g. get<MdChannel::Rpm> (row)
+    template <int Id> typename MdChannel::Value<Id>::Type get ( int row ) const {
+        return value<typename MdChannel::Value<Id>::Type> ( Id, row );
+    }
+    //! any numeric channel converted to double
+    double toDouble ( int id, int row ) const;
+
+    //! approximate heap usage of the column data
+    qint64 byteSize () const;
+
+private:
+    QVector<QByteArray> cols;
+    QVector<QStringList> strs;
+    QVector<bool> present;
+    int rows;
+
+    //! frame form: rows frames of MdMd2Decoder::frameLength (frameVer)
+    QByteArray frames;
+    int frameVer;
+    //! rows of the frame / packed channels decoded into cols
+    int decodedRows;
+
+    //! packed form: first row of every run, values of the K-line channels per run
+    bool packed;
+    int packedTypeK;
+    QVector<int> runFirst;
+    QVector<QByteArray> runs;
+};
+
+#endif // MDSESSIONCOLUMNS_H
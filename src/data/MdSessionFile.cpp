@@ -0,0 +1,749 @@
+#include "data/MdSessionFile.h"
+#include "data/MdChannelCodec.h"
+#include "data/MdGpsFix.h"
+
+#include "MdDataRecord.h"
+#include "MdDataRecordV1.h"
+#include "MdDataRecordV2.h"
+#include "Map16x1.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <string.h>
+
+#if defined (Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+//! file blocks are little endian, swap in place on big endian hosts
+static void swapToFileOrder ( QByteArray& a, int typeSize ) {
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    if ( typeSize > 1 ) {
+        char* d = a.data();
+        for ( int i = 0 ; i + typeSize <= a.size() ; i += typeSize )
+            std::reverse ( d + i, d + i + typeSize );
+    }
+#else
+    Q_UNUSED(a);
+    Q_UNUSED(typeSize);
+#endif
+}
+
+//! fsync: the journal must survive a crash of the whole system
+static bool syncToDisk ( QFile& file ) {
+#if defined (Q_OS_WIN)
+    return _commit ( file.handle() ) == 0;
+#else
+    return fsync ( file.handle() ) == 0;
+#endif
+}
+
+//! appends the chunk directory (and the level of detail table) and links it from the header
+static bool writeDirectory ( QFile& file, qint64 directoryOffsetPos, const QList<MdSessionChunkInfo>& directory,
+                             const QByteArray& lodTable = QByteArray() ) {
+    file.seek ( file.size() );
+    qint64 dirOffset = file.pos();
+    QDataStream ds (&file);
+    ds.setVersion(QDataStream::Qt_4_6);
+    ds << (quint32) directory.size();
+    foreach ( const MdSessionChunkInfo& ci, directory ) {
+        ds << ci.offset;
+        ds << ci.rows;
+        ds << ci.timeBegin;
+        ds << ci.timeEnd;
+        for ( int i = 0 ; i < ci.channelOffset.size() ; i++ ) {
+            ds << ci.channelOffset[i];
+            ds << ci.channelLength[i];
+        }
+    }
+    if ( !lodTable.isEmpty() && file.write (lodTable) != lodTable.size() )
+        return false;
+    //the directory is valid now -> link it from the header
+    file.seek ( directoryOffsetPos );
+    ds << dirOffset;
+    return ds.status() == QDataStream::Ok;
+}
+
+quint32 MdSessionFile::probeVersion ( const QString& filename ) {
+    QFile f (filename);
+    if ( !f.open (QIODevice::ReadOnly) )
+        return 0;
+    QDataStream ds (&f);
+    ds.setVersion(QDataStream::Qt_4_6);
+    quint32 magic = 0, version = 0;
+    ds >> magic;
+    ds >> version;
+    if ( ds.status() != QDataStream::Ok || magic != MAGICNUMBER )
+        return 0;
+    return version;
+}
+
+
+bool MdSessionFile::recover ( const QString& filename, qint64* rows, QString* errorString ) {
+    QFile f (filename);
+    if ( !f.open (QIODevice::ReadWrite) ) {
+        if ( errorString )
+            *errorString = f.errorString();
+        return false;
+    }
+    QDataStream ds (&f);
+    ds.setVersion(QDataStream::Qt_4_6);
+    quint32 magic, version, chunkRows;
+    quint16 channelCount = 0;
+    ds >> magic;
+    ds >> version;
+    if ( magic != MAGICNUMBER || version != VERSION ) {
+        if ( errorString )
+            *errorString = "not a mdv3 file";
+        return false;
+    }
+    ds >> chunkRows;
+    ds >> channelCount;
+    for ( int i = 0 ; i < channelCount ; i++ ) {
+        quint16 id;
+        quint8 type, codec;
+        QByteArray name;
+        ds >> id;
+        ds >> type;
+        ds >> codec;
+        ds >> name;
+    }
+    qint64 directoryOffsetPos = f.pos();
+    qint64 dirOffset;
+    ds >> dirOffset;
+    if ( ds.status() != QDataStream::Ok ) {
+        if ( errorString )
+            *errorString = "truncated mdv3 header";
+        return false;
+    }
+
+    if ( dirOffset > 0 ) {
+        //closed properly
+        if ( rows ) {
+            MdSessionReader r (filename);
+            *rows = r.open() ? r.rowCount() : 0;
+        }
+        return true;
+    }
+
+    //journal chunks up to the first incomplete or damaged one
+    qint64 n = 0;
+    QList<MdSessionChunkInfo> directory;
+    qint64 end = f.pos();
+    const qint64 headerSize = 4 + 4 + 4 + 4 + 2 + 4 * channelCount;
+    while ( end + headerSize <= f.size() ) {
+        f.seek (end);
+        quint32 mark;
+        quint16 checksum;
+        MdSessionChunkInfo ci;
+        ds >> mark;
+        ds >> ci.rows;
+        ds >> ci.timeBegin;
+        ds >> ci.timeEnd;
+        ds >> checksum;
+        ci.channelOffset.resize ( channelCount );
+        ci.channelLength.resize ( channelCount );
+        qint64 length = 0;
+        for ( int i = 0 ; i < channelCount ; i++ ) {
+            ds >> ci.channelLength[i];
+            ci.channelOffset[i] = length;
+            length += ci.channelLength[i];
+        }
+        if ( ds.status() != QDataStream::Ok || mark != JOURNAL_CHUNK_MARK )
+            break;
+        ci.offset = f.pos();
+        if ( ci.offset + length > f.size() )
+            break;
+        QByteArray payload = f.read ( length );
+        if ( payload.size() != length || qChecksum ( payload.constData(), payload.size() ) != checksum )
+            break;
+        directory.append (ci);
+        n += ci.rows;
+        end = ci.offset + length;
+    }
+
+    if ( end < f.size() ) {
+        qDebug() << "MdSessionFile::recover " << filename << ": dropping " << (f.size() - end) << " bytes of an incomplete chunk";
+        f.resize (end);
+    }
+    bool ok = writeDirectory ( f, directoryOffsetPos, directory );
+    f.close();
+    if ( rows )
+        *rows = n;
+    if ( !ok && errorString )
+        *errorString = "writing the chunk directory failed";
+    return ok;
+}
+
+
+MdSessionChunkInfo::MdSessionChunkInfo () : offset(0), rows(0), timeBegin(0), timeEnd(0) {
+}
+
+
+MdSessionWriter::MdSessionWriter ( const QString& filename, int chunkRows )
+    : file(filename), chunkRows(chunkRows), journal(false), directoryOffsetPos(0), rows(0) {
+    codecs.resize ( MdChannel::Count );
+    for ( int id = 0 ; id < MdChannel::Count ; id++ )
+        codecs[id] = MdChannelCodec::defaultFor (id);
+    buffer.reserve ( chunkRows );
+}
+
+void MdSessionWriter::setCodec ( int channel, int codec ) {
+    const MdChannelCodec* c = MdChannelCodec::get (codec);
+    if ( channel < 0 || channel >= MdChannel::Count || file.isOpen() )
+        return;
+    if ( codec == MdChannelCodec::Raw || ( c && c->supports ( MdChannel::descriptor(channel).type ) ) )
+        codecs[channel] = codec;
+}
+
+void MdSessionWriter::setJournal ( bool on ) {
+    if ( !file.isOpen() )
+        journal = on;
+}
+
+MdSessionWriter::~MdSessionWriter () {
+    if ( file.isOpen() )
+        close();
+}
+
+bool MdSessionWriter::open () {
+    if ( !file.open (QIODevice::WriteOnly | QIODevice::Truncate) ) {
+        error = file.errorString();
+        return false;
+    }
+    lod.clear();
+    QDataStream ds (&file);
+    ds.setVersion(QDataStream::Qt_4_6);
+    ds << (quint32) MdSessionFile::MAGICNUMBER;
+    ds << (quint32) MdSessionFile::VERSION;
+    ds << (quint32) chunkRows;
+    ds << (quint16) MdChannel::Count;
+    for ( int id = 0 ; id < MdChannel::Count ; id++ ) {
+        const MdChannel::Descriptor& d = MdChannel::descriptor(id);
+        ds << d.id;
+        ds << d.type;
+        ds << codecs[id];
+        ds << QByteArray (d.name);
+    }
+    directoryOffsetPos = file.pos();
+    ds << (qint64) 0;
+    return ds.status() == QDataStream::Ok;
+}
+
+bool MdSessionWriter::append ( const MdDataRecord* r ) {
+    if ( !r || !r->getSensorR() )
+        return false;
+    buffer.appendRecord (r);
+    rows++;
+    if ( buffer.rowCount() >= chunkRows )
+        return flushChunk();
+    return true;
+}
+
+bool MdSessionWriter::appendChunk ( const MdSessionColumns& cols ) {
+    if ( !flushChunk() )
+        return false;
+    if ( cols.rowCount() == 0 )
+        return true;
+    rows += cols.rowCount();
+    return writeChunk (cols);
+}
+
+bool MdSessionWriter::flushChunk () {
+    if ( buffer.rowCount() == 0 )
+        return true;
+    if ( !writeChunk (buffer) )
+        return false;
+    buffer.clear();
+    return true;
+}
+
+bool MdSessionWriter::writeChunk ( const MdSessionColumns& cols ) {
+    MdSessionChunkInfo ci;
+    ci.rows = cols.rowCount();
+    ci.timeBegin = cols.value<qint32> (MdChannel::Time, 0);
+    ci.timeEnd = cols.value<qint32> (MdChannel::Time, cols.rowCount() - 1);
+    ci.channelOffset.resize ( MdChannel::Count );
+    ci.channelLength.resize ( MdChannel::Count );
+
+    //all blocks of the chunk in one write
+    QByteArray payload;
+    for ( int id = 0 ; id < MdChannel::Count ; id++ ) {
+        const MdChannel::Descriptor& d = MdChannel::descriptor(id);
+        QByteArray block;
+        const MdChannelCodec* codec = MdChannelCodec::get ( codecs[id] );
+        if ( codec ) {
+            codec->encode ( d.type, cols.raw(id), cols.rowCount(), block );
+        } else if ( d.type == MdChannel::TypeString ) {
+            foreach ( const QString& s, cols.strings(id) ) {
+                QByteArray u = s.toUtf8();
+                quint16 len = qMin ( u.size(), 0xFFFF );
+                block.append ( (char) (len & 0xFF) );
+                block.append ( (char) (len >> 8) );
+                block.append ( u.constData(), len );
+            }
+        } else {
+            block = cols.raw(id);
+            swapToFileOrder ( block, MdChannel::typeSize(d.type) );
+        }
+        ci.channelOffset[id] = payload.size();
+        ci.channelLength[id] = block.size();
+        payload.append (block);
+    }
+
+    if ( journal ) {
+        QDataStream ds (&file);
+        ds.setVersion(QDataStream::Qt_4_6);
+        ds << (quint32) MdSessionFile::JOURNAL_CHUNK_MARK;
+        ds << ci.rows;
+        ds << ci.timeBegin;
+        ds << ci.timeEnd;
+        ds << (quint16) qChecksum ( payload.constData(), payload.size() );
+        for ( int id = 0 ; id < MdChannel::Count ; id++ )
+            ds << ci.channelLength[id];
+        if ( ds.status() != QDataStream::Ok ) {
+            error = file.errorString();
+            return false;
+        }
+    }
+
+    ci.offset = file.pos();
+    if ( file.write (payload) != payload.size() ) {
+        error = file.errorString();
+        return false;
+    }
+    directory.append (ci);
+    lod.addChunk (cols);
+    return true;
+}
+
+bool MdSessionWriter::writeLod ( QByteArray& table ) {
+    lod.finish();
+    if ( lod.levelCount() == 0 )
+        return true;
+
+    QList<int> ids;
+    for ( int id = 0 ; id < MdChannel::Count ; id++ )
+        if ( MdChannel::descriptor(id).type != MdChannel::TypeString )
+            ids.append (id);
+
+    QDataStream ts (&table, QIODevice::WriteOnly);
+    ts.setVersion(QDataStream::Qt_4_6);
+    ts << (quint32) MdSessionFile::LOD_MARK;
+    ts << (quint32) MdLodPyramid::BASE_ROWS;
+    ts << (quint32) MdLodPyramid::REDUCTION;
+    ts << (quint8) lod.levelCount();
+    for ( int l = 0 ; l < lod.levelCount() ; l++ )
+        ts << (quint32) lod.bucketCount (l);
+    ts << (quint16) ids.size();
+
+    file.seek ( file.size() );
+    foreach ( int id, ids ) {
+        ts << (quint16) id;
+        for ( int l = 0 ; l < lod.levelCount() ; l++ ) {
+            const QVector<float>& v = lod.values (l, id);
+            QByteArray block ( reinterpret_cast<const char*> (v.constData()), v.size() * sizeof(float) );
+            swapToFileOrder ( block, sizeof(float) );
+            ts << (qint64) file.pos();
+            ts << (quint32) block.size();
+            if ( file.write (block) != block.size() ) {
+                error = file.errorString();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool MdSessionWriter::sync () {
+    if ( !file.isOpen() || !flushChunk() )
+        return false;
+    if ( !file.flush() || !syncToDisk (file) ) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool MdSessionWriter::close () {
+    if ( !file.isOpen() )
+        return false;
+    bool ok = flushChunk();
+    QByteArray lodTable;
+    ok = writeLod (lodTable) && ok;
+    ok = writeDirectory ( file, directoryOffsetPos, directory, lodTable ) && ok;
+    file.close();
+    return ok;
+}
+
+
+MdSessionReader::MdSessionReader ( const QString& filename ) : file(filename), mapped(NULL), coordinateTextPos(-1), rows(0) {
+    filePos.fill ( -1, MdChannel::Count );
+}
+
+MdSessionReader::~MdSessionReader () {
+    close();
+}
+
+bool MdSessionReader::open () {
+    if ( !file.open (QIODevice::ReadOnly) ) {
+        error = file.errorString();
+        return false;
+    }
+    QDataStream ds (&file);
+    ds.setVersion(QDataStream::Qt_4_6);
+    quint32 magic, version, chunkRows;
+    quint16 channelCount;
+    ds >> magic;
+    ds >> version;
+    if ( magic != MdSessionFile::MAGICNUMBER || version != MdSessionFile::VERSION ) {
+        error = "not a mdv3 file";
+        return false;
+    }
+    ds >> chunkRows;
+    ds >> channelCount;
+    fileType.resize ( channelCount );
+    fileCodec.resize ( channelCount );
+    for ( int i = 0 ; i < channelCount ; i++ ) {
+        quint16 id;
+        quint8 type, codec;
+        QByteArray name;
+        ds >> id;
+        ds >> type;
+        ds >> codec;
+        ds >> name;
+        fileType[i] = type;
+        fileCodec[i] = codec;
+        //channels of newer versions, with a changed type or an unknown codec are skipped
+        const MdChannelCodec* c = MdChannelCodec::get (codec);
+        bool codecOk = codec == MdChannelCodec::Raw || ( c && c->supports (type) );
+        if ( id < MdChannel::Count && MdChannel::descriptor(id).type == type && codecOk )
+            filePos[id] = i;
+        else if ( id == MdChannel::GpsLatitude && type == MdChannel::TypeString && codec == MdChannelCodec::Raw )
+            coordinateTextPos = i;
+    }
+    qint64 dirOffset;
+    ds >> dirOffset;
+    if ( ds.status() != QDataStream::Ok || dirOffset <= 0 || dirOffset >= file.size() ) {
+        error = "incomplete mdv3 file (no chunk directory)";
+        return false;
+    }
+
+    file.seek ( dirOffset );
+    quint32 count;
+    ds >> count;
+    for ( quint32 c = 0 ; c < count && ds.status() == QDataStream::Ok ; c++ ) {
+        MdSessionChunkInfo ci;
+        ds >> ci.offset;
+        ds >> ci.rows;
+        ds >> ci.timeBegin;
+        ds >> ci.timeEnd;
+        ci.channelOffset.resize ( channelCount );
+        ci.channelLength.resize ( channelCount );
+        for ( int i = 0 ; i < channelCount ; i++ ) {
+            ds >> ci.channelOffset[i];
+            ds >> ci.channelLength[i];
+        }
+        rows += ci.rows;
+        chunks.append (ci);
+    }
+    if ( ds.status() != QDataStream::Ok ) {
+        error = "corrupt chunk directory";
+        return false;
+    }
+    readLodTable (ds);
+
+    //pages are only faulted in when a chunk is decoded. without a mapping we fall back to seek + read
+    mapped = file.map ( 0, file.size() );
+    if ( !mapped )
+        qDebug() << "MdSessionReader: mapping " << file.fileName() << " failed, using buffered reads";
+    return true;
+}
+
+void MdSessionReader::close () {
+    if ( mapped ) {
+        file.unmap (mapped);
+        mapped = NULL;
+    }
+    if ( file.isOpen() )
+        file.close();
+}
+
+bool MdSessionReader::readBlock ( qint64 offset, quint32 length, QByteArray& block ) {
+    if ( offset < 0 || offset + length > file.size() ) {
+        error = "chunk block beyond the end of the file";
+        return false;
+    }
+    if ( mapped ) {
+        //copy: the blocks are not aligned and have to be swapped on big endian hosts
+        block = QByteArray ( reinterpret_cast<const char*> (mapped + offset), length );
+        return true;
+    }
+    if ( !file.seek ( offset ) ) {
+        error = file.errorString();
+        return false;
+    }
+    block = file.read ( length );
+    if ( block.size() != (int) length ) {
+        error = "short read";
+        return false;
+    }
+    return true;
+}
+
+void MdSessionReader::readLodTable ( QDataStream& ds ) {
+    lodBuckets.clear();
+    lodOffset.clear();
+    if ( file.atEnd() )
+        return;
+    quint32 mark, baseRows, reduction;
+    quint8 levels;
+    quint16 channelCount;
+    ds >> mark;
+    ds >> baseRows;
+    ds >> reduction;
+    ds >> levels;
+    //another bucket layout would need another MdLodPyramid::levelFor()
+    if ( ds.status() != QDataStream::Ok || mark != MdSessionFile::LOD_MARK
+         || baseRows != MdLodPyramid::BASE_ROWS || reduction != MdLodPyramid::REDUCTION )
+        return;
+    QVector<int> buckets (levels);
+    for ( int l = 0 ; l < levels ; l++ ) {
+        quint32 n;
+        ds >> n;
+        buckets[l] = n;
+    }
+    QVector< QVector<qint64> > offsets ( MdChannel::Count, QVector<qint64> (levels, -1) );
+    ds >> channelCount;
+    for ( int c = 0 ; c < channelCount ; c++ ) {
+        quint16 id;
+        ds >> id;
+        for ( int l = 0 ; l < levels ; l++ ) {
+            qint64 offset;
+            quint32 length;
+            ds >> offset;
+            ds >> length;
+            bool fits = offset >= 0 && offset + length <= file.size()
+                        && length == (quint32) buckets[l] * MdLodPyramid::VALUES * sizeof(float);
+            if ( id < MdChannel::Count && MdChannel::descriptor(id).type != MdChannel::TypeString && fits )
+                offsets[id][l] = offset;
+        }
+    }
+    if ( ds.status() != QDataStream::Ok ) {
+        qDebug() << "MdSessionReader: ignoring the broken level of detail table of " << file.fileName();
+        return;
+    }
+    lodBuckets = buckets;
+    lodOffset = offsets;
+}
+
+bool MdSessionReader::readLod ( int level, int channel, int first, int count, QVector<float>& values ) {
+    values.clear();
+    if ( level < 0 || level >= lodBuckets.size() || channel < 0 || channel >= MdChannel::Count
+         || lodOffset[channel][level] < 0 ) {
+        error = "no level of detail data";
+        return false;
+    }
+    first = qMax ( 0, first );
+    count = qMin ( count, lodBuckets[level] - first );
+    if ( count <= 0 )
+        return true;
+    const int bucketBytes = MdLodPyramid::VALUES * sizeof(float);
+    QByteArray block;
+    if ( !readBlock ( lodOffset[channel][level] + (qint64) first * bucketBytes, count * bucketBytes, block ) )
+        return false;
+    swapToFileOrder ( block, sizeof(float) );
+    values.resize ( count * MdLodPyramid::VALUES );
+    memcpy ( values.data(), block.constData(), block.size() );
+    return true;
+}
+
+bool MdSessionReader::hasChannel ( int id ) const {
+    if ( coordinateTextPos >= 0 && ( id == MdChannel::GpsLatitude || id == MdChannel::GpsLongitude ) )
+        return true;
+    return id >= 0 && id < MdChannel::Count && filePos[id] >= 0;
+}
+
+//! string block (quint16 length + utf8 per row) of a TypeString channel
+static void decodeStrings ( const QByteArray& block, quint32 rows, QStringList& sl ) {
+    const char* b = block.constData();
+    int pos = 0;
+    for ( quint32 r = 0 ; r < rows && pos + 2 <= block.size() ; r++ ) {
+        int len = (quint8) b[pos] | ( (quint8) b[pos+1] << 8 );
+        pos += 2;
+        sl.append ( QString::fromUtf8 (b + pos, qMin (len, block.size() - pos) ) );
+        pos += len;
+    }
+}
+
+bool MdSessionReader::readCoordinateText ( int i, int id, MdSessionColumns& cols ) {
+    const MdSessionChunkInfo& ci = chunks.at(i);
+    QByteArray block;
+    if ( !readBlock ( ci.offset + ci.channelOffset[coordinateTextPos], ci.channelLength[coordinateTextPos], block ) ) {
+        error += " in chunk " + QString::number(i);
+        return false;
+    }
+    QStringList sl;
+    decodeStrings ( block, ci.rows, sl );
+    QByteArray& c = cols.raw(id);
+    c.resize ( ci.rows * sizeof(double) );
+    double* v = reinterpret_cast<double*> ( c.data() );
+    for ( quint32 r = 0 ; r < ci.rows ; r++ ) {
+        double lat = 0, lon = 0;
+        if ( (int) r < sl.size() )
+            MdGpsFix::parseCoordinate ( sl.at(r), lat, lon );
+        v[r] = ( id == MdChannel::GpsLatitude ) ? lat : lon;
+    }
+    return true;
+}
+
+bool MdSessionReader::readChunk ( int i, MdSessionColumns& cols, const QList<int>& channels ) {
+    if ( i < 0 || i >= chunks.size() )
+        return false;
+    const MdSessionChunkInfo& ci = chunks.at(i);
+
+    QList<int> wanted = channels;
+    if ( wanted.isEmpty() )
+        for ( int id = 0 ; id < MdChannel::Count ; id++ )
+            wanted.append (id);
+
+    cols.setChannels ( wanted );
+    cols.clear();
+
+    foreach ( int id, wanted ) {
+        const MdChannel::Descriptor& d = MdChannel::descriptor(id);
+        int ts = MdChannel::typeSize (d.type);
+        int p = filePos[id];
+        if ( p < 0 && coordinateTextPos >= 0 && ( id == MdChannel::GpsLatitude || id == MdChannel::GpsLongitude ) ) {
+            if ( !readCoordinateText ( i, id, cols ) )
+                return false;
+            continue;
+        }
+        if ( p < 0 ) {
+            if ( d.type == MdChannel::TypeString ) {
+                for ( quint32 r = 0 ; r < ci.rows ; r++ )
+                    cols.strings(id).append ( QString() );
+            } else
+                cols.raw(id).fill ( 0, ci.rows * ts );
+            continue;
+        }
+
+        QByteArray block;
+        if ( !readBlock ( ci.offset + ci.channelOffset[p], ci.channelLength[p], block ) ) {
+            error += " in chunk " + QString::number(i);
+            return false;
+        }
+
+        //every column has to hold the rows of the chunk, the readers of the columns do not check
+        const MdChannelCodec* codec = MdChannelCodec::get ( fileCodec[p] );
+        bool ok;
+        if ( codec ) {
+            ok = codec->decode ( d.type, block.constData(), block.size(), ci.rows, cols.raw(id) );
+        } else if ( d.type == MdChannel::TypeString ) {
+            decodeStrings ( block, ci.rows, cols.strings(id) );
+            ok = cols.strings(id).size() == (int) ci.rows;
+        } else {
+            ok = block.size() == (int) ci.rows * ts;
+            swapToFileOrder ( block, ts );
+            cols.raw(id) = block;
+        }
+        if ( !ok ) {
+            error = "corrupt block of channel " + QString(d.name) + " in chunk " + QString::number(i);
+            return false;
+        }
+    }
+    cols.setRowCount ( ci.rows );
+    return true;
+}
+
+
+MdLegacyImporter::MdLegacyImporter ( const QString& filename ) : file(filename), fileVersion(0) {
+}
+
+MdLegacyImporter::~MdLegacyImporter () {
+    if ( file.isOpen() )
+        file.close();
+}
+
+bool MdLegacyImporter::open () {
+    if ( !file.open (QIODevice::ReadOnly) ) {
+        error = file.errorString();
+        return false;
+    }
+    ds.setDevice (&file);
+    ds.setVersion(QDataStream::Qt_4_6);
+    quint32 magic;
+    ds >> magic;
+    ds >> fileVersion;
+    if ( fileVersion != MdFile::CVERSION1 && fileVersion != MdFile::CVERSION3 && fileVersion != MdFile::VERSION4 ) {
+        error = "load of incompatible file version " + QString::number(fileVersion) + " attempted!";
+        return false;
+    }
+    return true;
+}
+
+MdDataRecord* MdLegacyImporter::next () {
+    if ( !file.isOpen() || ds.atEnd() )
+        return NULL;
+
+    switch ( fileVersion ) {
+    case MdFile::CVERSION1: {
+        compatibility::MdDataRecordV1* rc = new compatibility::MdDataRecordV1();
+        ds >> rc;
+        return rc;
+    }
+    case MdFile::CVERSION3: {
+        static Map16x1_Voltage vmap;
+        compatibility::MdDataRecordV2* rc = new compatibility::MdDataRecordV2();
+        ds >> rc;
+        rc->getSensorR()->df_voltage = vmap.mapValue(rc->getSensorR()->df_voltage_raw);
+        return rc;
+    }
+    case MdFile::VERSION4: {
+        MdDataRecord* r = new MdDataRecord();
+        ds >> r;
+        return r;
+    }
+    }
+    return NULL;
+}
+
+bool MdLegacyImporter::seek ( qint64 offset ) {
+    if ( !file.isOpen() || !file.seek (offset) )
+        return false;
+    ds.resetStatus();
+    return true;
+}
+
+int MdLegacyImporter::progress () const {
+    if ( !file.isOpen() || file.size() <= 0 )
+        return 0;
+    return (int) ( file.pos() * 100 / file.size() );
+}
+
+bool MdLegacyImporter::convert ( const QString& src, const QString& dst, QString* errorString ) {
+    MdLegacyImporter in (src);
+    if ( !in.open() ) {
+        if ( errorString )
+            *errorString = in.errorString();
+        return false;
+    }
+    MdSessionWriter out (dst);
+    if ( !out.open() ) {
+        if ( errorString )
+            *errorString = out.errorString();
+        return false;
+    }
+    MdDataRecord* r;
+    while ( (r = in.next()) != NULL ) {
+        out.append (r);
+        delete r;
+    }
+    bool ok = out.close();
+    if ( !ok && errorString )
+        *errorString = out.errorString();
+    qDebug() << "MdLegacyImporter::convert " << src << " -> " << dst << " rows=" << out.rowCount();
+    return ok;
+}
@@ -0,0 +1,205 @@
+#ifndef MDSESSIONFILE_H
+#define MDSESSIONFILE_H
+
+#include "data/MdSessionColumns.h"
+#include "data/MdLodPyramid.h"
+
+#include <QFile>
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <QDataStream>
+
+class MdDataRecord;
+
+/**
+  * mdv3 session file
+  *
+  * header (QDataStream, Qt_4_6):
+  *   quint32 magic, quint32 version (5), quint32 rows per chunk,
+  *   quint16 channel count, per channel: quint16 id, quint8 type, quint8 codec, QByteArray name
+  *   qint64 offset of the chunk directory (0 while the file is being written)
+  * chunks:
+  *   per channel one block of the chunk rows, encoded with the channel codec
+  *   (codec 0: contiguous little endian values, see data/MdChannelCodec.h)
+  * chunk directory:
+  *   quint32 chunk count, per chunk: qint64 offset, quint32 rows, qint32 first time, qint32 last time,
+  *   per channel quint32 offset (relative to the chunk) and quint32 length
+  * level of detail table (optional, right behind the chunk directory, see data/MdLodPyramid.h):
+  *   quint32 LOD_MARK, quint32 base rows, quint32 reduction, quint8 level count,
+  *   per level quint32 buckets, quint16 channel count,
+  *   per channel quint16 id, per level qint64 offset and quint32 length of the block.
+  *   the blocks (little endian floats, min max first last per bucket) are written before the
+  *   chunk directory. older readers stop after the chunk directory and never see them.
+  *
+  * journal chunk header (journal writers only, in front of the chunk blocks, ignored by readers):
+  *   quint32 JOURNAL_CHUNK_MARK, quint32 rows, qint32 first time, qint32 last time,
+  *   quint16 qChecksum of the blocks, per channel quint32 length
+  *   a journal without directory can be completed by recover() after a crash.
+  *
+  * only the header and the directory are read on open. the reader maps the file
+  * if possible, a chunk channel is then a copy out of the mapping, otherwise one seek + read.
+  */
+namespace MdSessionFile {
+    enum { MAGICNUMBER = 0xFFAAFFAA, VERSION = 5, DEFAULT_CHUNK_ROWS = 4096, JOURNAL_CHUNK_MARK = 0x4A524E4C,
+           LOD_MARK = 0x4C4F4450 };
+
+    //! returns the file version or 0 if the file can not be read
+    quint32 probeVersion ( const QString& filename );
+
+    /**
+      * completes a journal that was not closed: the chunk directory is rebuilt from the
+      * journal chunk headers, a torn last chunk is cut off. complete files are left alone.
+      */
+    bool recover ( const QString& filename, qint64* rows=0, QString* errorString=0 );
+}
+
+class MdSessionChunkInfo {
+public:
+    MdSessionChunkInfo ();
+
+    qint64 offset;
+    quint32 rows;
+    qint32 timeBegin;
+    qint32 timeEnd;
+    //! indexed by the channel position in the file header
+    QVector<quint32> channelOffset;
+    QVector<quint32> channelLength;
+};
+
+class MdSessionWriter {
+public:
+    MdSessionWriter ( const QString& filename, int chunkRows = MdSessionFile::DEFAULT_CHUNK_ROWS );
+    virtual ~MdSessionWriter ();
+
+    //! override the codec of a channel (MdChannelCodec::Id), before open()
+    void setCodec ( int channel, int codec );
+    //! write journal chunk headers, before open()
+    void setJournal ( bool on );
+
+    bool open ();
+    bool append ( const MdDataRecord* r );
+    //! writes the pending rows and then cols as one chunk (all channels must be enabled)
+    bool appendChunk ( const MdSessionColumns& cols );
+    //! writes the pending rows as a chunk and forces the file to disk
+    bool sync ();
+    //! writes the pending chunk and the chunk directory
+    bool close ();
+
+    qint64 rowCount () const { return rows; }
+    //! rows not yet written to the file
+    int pendingRows () const { return buffer.rowCount(); }
+    QString errorString () const { return error; }
+
+protected:
+    bool flushChunk ();
+    bool writeChunk ( const MdSessionColumns& cols );
+    //! writes the pyramid blocks, table is the level of detail table for the directory
+    bool writeLod ( QByteArray& table );
+
+    QFile file;
+    int chunkRows;
+    bool journal;
+    QVector<quint8> codecs;
+    MdSessionColumns buffer;
+    QList<MdSessionChunkInfo> directory;
+    MdLodPyramid lod;
+    qint64 directoryOffsetPos;
+    qint64 rows;
+    QString error;
+};
+
+class MdSessionReader {
+public:
+    MdSessionReader ( const QString& filename );
+    virtual ~MdSessionReader ();
+
+    //! reads header and chunk directory
+    bool open ();
+    void close ();
+
+    int chunkCount () const { return chunks.size(); }
+    const MdSessionChunkInfo& chunkInfo ( int i ) const { return chunks.at(i); }
+    qint64 rowCount () const { return rows; }
+    bool hasChannel ( int id ) const;
+    bool isMapped () const { return mapped != NULL; }
+    QString fileName () const { return file.fileName(); }
+
+    /**
+      * decodes the given channels (all if empty) of chunk i into cols.
+      * channels unknown to the file are filled with 0.
+      */
+    bool readChunk ( int i, MdSessionColumns& cols, const QList<int>& channels = QList<int>() );
+
+    //! level of detail pyramid, files written before it or recovered journals have none
+    bool hasLod () const { return !lodBuckets.isEmpty(); }
+    int lodLevels () const { return lodBuckets.size(); }
+    int lodBucketCount ( int level ) const { return lodBuckets[level]; }
+    //! coarsest level with at least pixels buckets over rows, -1: plot the rows
+    int lodLevelFor ( qint64 rows, int pixels ) const { return MdLodPyramid::levelFor ( lodLevels(), rows, pixels ); }
+    /**
+      * MdLodPyramid::VALUES floats per bucket of a numeric channel,
+      * buckets first .. first + count - 1 (clipped to the level)
+      */
+    bool readLod ( int level, int channel, int first, int count, QVector<float>& values );
+
+    QString errorString () const { return error; }
+
+protected:
+    //! block of a chunk channel, from the mapping or read from the file
+    bool readBlock ( qint64 offset, quint32 length, QByteArray& block );
+    //! level of detail table behind the chunk directory, the pyramid is ignored if it is broken
+    void readLodTable ( QDataStream& ds );
+    //! GpsLatitude or GpsLongitude of chunk i parsed from the coordinate text of older files
+    bool readCoordinateText ( int i, int id, MdSessionColumns& cols );
+
+    QFile file;
+    uchar* mapped;
+    //! channel id -> position in the file header, -1 if not stored
+    QVector<int> filePos;
+    QVector<quint8> fileType;
+    QVector<quint8> fileCodec;
+    //! position of the gps_coordinate text channel, -1 if the file has none
+    int coordinateTextPos;
+    QList<MdSessionChunkInfo> chunks;
+    qint64 rows;
+    QVector<int> lodBuckets;
+    //! [channel id][level] block offset, -1 if not stored
+    QVector< QVector<qint64> > lodOffset;
+    QString error;
+};
+
+/**
+  * streams the records of CVERSION1 / CVERSION3 / VERSION4 files
+  */
+class MdLegacyImporter {
+public:
+    MdLegacyImporter ( const QString& filename );
+    virtual ~MdLegacyImporter ();
+
+    bool open ();
+    quint32 version () const { return fileVersion; }
+
+    //! next record or NULL at the end of the file. the caller takes ownership!
+    MdDataRecord* next ();
+    //! read position in per cent of the file size
+    int progress () const;
+    //! byte offset of the next record
+    qint64 position () const { return file.pos(); }
+    //! continues at a record boundary, e.g. an offset of MdLegacyIndex
+    bool seek ( qint64 offset );
+    QString fileName () const { return file.fileName(); }
+
+    QString errorString () const { return error; }
+
+    //! converts a legacy file to mdv3 without keeping more than one record in memory
+    static bool convert ( const QString& src, const QString& dst, QString* errorString=0 );
+
+protected:
+    QFile file;
+    QDataStream ds;
+    quint32 fileVersion;
+    QString error;
+};
+
+#endif // MDSESSIONFILE_H
@@ -0,0 +1,80 @@
+#include "data/MdSessionSnapshot.h"
+#include "data/MdSpillFile.h"
+#include "com/MdMd2Decoder.h"
+
+#include "MdDataRecord.h"
+
+MdSessionSnapshot::MdSessionSnapshot () : rows(0), ver(0), pagedChunk(-1), dec(NULL), gen(0) {
+    recordSlot.fill ( NULL, RECORD_SLOTS );
+    recordSlotRow.fill ( -1, RECORD_SLOTS );
+}
+
+MdSessionSnapshot::~MdSessionSnapshot () {
+    foreach ( MdDataRecord* r, recordSlot )
+        if ( r )
+            delete r;
+    delete dec;
+}
+
+int MdSessionSnapshot::chunkForRow ( qint64 row ) const {
+    if ( row < 0 || row >= rows )
+        return -1;
+    //last chunk with firstRow <= row
+    int lb = 0;
+    int rb = firstRow.size() - 1;
+    while ( lb < rb ) {
+        int mi = lb + (rb - lb + 1) / 2;
+        if ( firstRow[mi] <= row )
+            lb = mi;
+        else
+            rb = mi - 1;
+    }
+    return lb;
+}
+
+int MdSessionSnapshot::chunkRows ( int ci ) const {
+    return ( ci + 1 < firstRow.size() ? firstRow[ci + 1] : rows ) - firstRow[ci];
+}
+
+const MdSessionColumns* MdSessionSnapshot::chunk ( int i ) {
+    if ( i < 0 || i >= firstRow.size() )
+        return NULL;
+    if ( spillOffset[i] < 0 && chunks.at(i).isMaterialized() )
+        return &chunks.at (i);
+    if ( pagedChunk == i )
+        return &paged;
+
+    gen++;
+    pagedChunk = i;
+    if ( spillOffset[i] < 0 ) {
+        //frames or runs the store did not expand, the copy is expanded here
+        paged = chunks.at (i);
+        if ( paged.hasFrames() && ( !dec || dec->version() != paged.frameVersion() ) ) {
+            delete dec;
+            dec = new MdMd2Decoder ( paged.frameVersion() );
+        }
+        paged.materialize ( paged.hasFrames() ? dec : NULL );
+        return &paged;
+    }
+    paged.clearRows();
+    int n = chunkRows (i);
+    if ( !spill.isOpen() )
+        spill.open (QIODevice::ReadOnly);
+    if ( !spill.isOpen() || !MdSpillFile::readChunk ( spill, spillOffset[i], paged ) || paged.rowCount() != n )
+        paged.zeroRows (n);
+    return &paged;
+}
+
+MdDataRecord* MdSessionSnapshot::record ( qint64 row ) {
+    int ci = chunkForRow (row);
+    if ( ci < 0 )
+        return NULL;
+    int slot = row % RECORD_SLOTS;
+    if ( recordSlotRow[slot] == row )
+        return recordSlot[slot];
+    if ( !recordSlot[slot] )
+        recordSlot[slot] = new MdDataRecord();
+    chunk(ci)->assignRecord ( row - firstRow[ci], recordSlot[slot] );
+    recordSlotRow[slot] = row;
+    return recordSlot[slot];
+}
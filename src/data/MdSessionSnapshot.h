@@ -0,0 +1,70 @@
+#ifndef MDSESSIONSNAPSHOT_H
+#define MDSESSIONSNAPSHOT_H
+
+#include "data/MdChunkSource.h"
+
+#include <QFile>
+#include <QVector>
+
+class MdMd2Decoder;
+
+/**
+  * immutable view of the rows a MdSessionStore had when MdSessionStore::snapshot() was called.
+  *
+  * the chunks in memory are implicitly shared copies, taking a snapshot costs a reference
+  * per chunk and no row is copied. the store keeps appending and removing, the first write
+  * to a shared chunk detaches the store's side, the snapshot never sees it. spilled chunks
+  * are read back through the snapshot's own handle of the spill file (zeros once the file
+  * is gone), frame and packed chunks are expanded into the same page. nothing is shared
+  * with the store but reference counts, so a snapshot can be handed to a worker thread and
+  * scanned there while the log goes on.
+  * a snapshot itself is not thread safe, one thread reads it at a time.
+  */
+class MdSessionSnapshot : public MdChunkSource {
+public:
+    enum { RECORD_SLOTS = 64 };
+
+    virtual ~MdSessionSnapshot ();
+
+    qint64 rowCount () const { return rows; }
+    int chunkCount () const { return firstRow.size(); }
+    int chunkForRow ( qint64 row ) const;
+    qint64 chunkFirstRow ( int chunk ) const { return firstRow[chunk]; }
+    qint32 chunkLastTime ( int chunk ) const { return lastTime[chunk]; }
+    const MdSessionColumns* chunk ( int i );
+    //! owned by the snapshot, valid until RECORD_SLOTS other rows were requested
+    MdDataRecord* record ( qint64 row );
+    quint32 generation () const { return gen; }
+
+    //! MdSessionStore::version() when the snapshot was taken
+    quint32 version () const { return ver; }
+
+private:
+    friend class MdSessionStore;
+    MdSessionSnapshot ();
+    Q_DISABLE_COPY (MdSessionSnapshot)
+
+    int chunkRows ( int ci ) const;
+
+    //! shared copies of the chunks in memory, empty for spilled ones
+    QVector<MdSessionColumns> chunks;
+    //! offset of a chunk in the spill file, -1 if it is in chunks
+    QVector<qint64> spillOffset;
+    QVector<qint64> firstRow;
+    QVector<qint32> lastTime;
+    qint64 rows;
+    quint32 ver;
+
+    QFile spill;
+    //! the spilled or decoded frame chunk read last, -1 if none
+    int pagedChunk;
+    MdSessionColumns paged;
+    MdMd2Decoder* dec;
+
+    QVector<MdDataRecord*> recordSlot;
+    QVector<qint64> recordSlotRow;
+    //! see MdChunkSource::generation
+    quint32 gen;
+};
+
+#endif // MDSESSIONSNAPSHOT_H
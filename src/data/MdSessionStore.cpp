@@ -0,0 +1,428 @@
+#include "data/MdSessionStore.h"
+#include "data/MdSpillFile.h"
+#include "data/MdSessionSnapshot.h"
+#include "com/MdMd2Decoder.h"
+
+#include "MdDataRecord.h"
+
+MdSessionStore::MdSessionStore () : rows(0), uniform(true), typeK(MAX_ATTACHED_TYPK), spill(NULL), windowMillis(0), nextSpillId(0), maxDecoded(MATERIALIZED_CHUNKS), maxPaged(PAGED_CHUNKS), dec(NULL), gen(0), ver(0) {
+    recordSlot.fill ( NULL, RECORD_SLOTS );
+    recordSlotRow.fill ( -1, RECORD_SLOTS );
+}
+
+MdSessionStore::~MdSessionStore () {
+    setSpill ( NULL, 0 );
+    clear();
+    foreach ( MdSessionColumns* c, spare )
+        delete c;
+    foreach ( MdDataRecord* r, recordSlot )
+        if ( r )
+            delete r;
+    delete dec;
+}
+
+int MdSessionStore::chunkForRow ( qint64 row ) const {
+    if ( row < 0 || row >= rows )
+        return -1;
+    if ( uniform )
+        return row / CHUNK_ROWS;
+    //last chunk with firstRow <= row
+    int lb = 0;
+    int rb = firstRow.size() - 1;
+    while ( lb < rb ) {
+        int mi = lb + (rb - lb + 1) / 2;
+        if ( firstRow[mi] <= row )
+            lb = mi;
+        else
+            rb = mi - 1;
+    }
+    return lb;
+}
+
+int MdSessionStore::chunkRows ( int ci ) const {
+    return ( ci + 1 < firstRow.size() ? firstRow[ci + 1] : rows ) - firstRow[ci];
+}
+
+const MdSessionColumns* MdSessionStore::chunk ( int i ) {
+    if ( i < 0 || i >= chunks.size() )
+        return NULL;
+    return columns (i);
+}
+
+const MdSessionColumns* MdSessionStore::columns ( int ci ) const {
+    if ( chunks[ci] ) {
+        if ( chunks[ci]->hasFrames() || chunks[ci]->isPacked() )
+            materialize ( chunks[ci] );
+        return chunks[ci];
+    }
+    int id = spillId[ci];
+    if ( writing.contains (id) )
+        return writing.value (id);
+    int p = pagedId.indexOf (id);
+    if ( p >= 0 ) {
+        pagedId.move ( p, pagedId.size() - 1 );
+        paged.move ( p, paged.size() - 1 );
+        return paged.last();
+    }
+
+    MdSessionColumns* c;
+    //the window got smaller
+    while ( paged.size() > maxPaged ) {
+        pagedId.removeFirst();
+        delete paged.takeFirst();
+        gen++;
+    }
+    if ( paged.size() >= maxPaged ) {
+        c = paged.takeFirst();
+        pagedId.removeFirst();
+        gen++;
+    } else
+        c = new MdSessionColumns();
+    c->clearRows();
+    int n = chunkRows (ci);
+    //the rows have to be there, a broken read gives zeros
+    if ( !spill->read (id, *c) || c->rowCount() != n )
+        c->zeroRows (n);
+    paged.append (c);
+    pagedId.append (id);
+    return c;
+}
+
+MdSessionColumns* MdSessionStore::resident ( int ci ) {
+    if ( chunks[ci] ) {
+        unpack ( chunks[ci] );
+        return chunks[ci];
+    }
+    //implicitly shared copy, the spill thread may still read the original
+    MdSessionColumns* c = new MdSessionColumns();
+    *c = *columns (ci);
+    int p = pagedId.indexOf ( spillId[ci] );
+    if ( p >= 0 ) {
+        pagedId.removeAt (p);
+        recycle ( paged.takeAt (p) );
+    }
+    chunks[ci] = c;
+    spillId[ci] = -1;
+    return c;
+}
+
+void MdSessionStore::materialize ( MdSessionColumns* c ) const {
+    int p = decoded.indexOf (c);
+    if ( p >= 0 )
+        decoded.move ( p, decoded.size() - 1 );
+    else {
+        //the window may have got smaller
+        while ( decoded.size() >= maxDecoded ) {
+            decoded.takeFirst()->dematerialize();
+            gen++;
+        }
+        decoded.append (c);
+    }
+    //only the rows appended since the last read
+    c->materialize ( c->hasFrames() ? decoder ( c->frameVersion() ) : NULL );
+}
+
+void MdSessionStore::unpack ( MdSessionColumns* c ) {
+    if ( !c->hasFrames() && !c->isPacked() )
+        return;
+    decoded.removeOne (c);
+    if ( c->hasFrames() )
+        c->dropFrames ( *decoder ( c->frameVersion() ) );
+    else
+        c->unpack();
+}
+
+MdMd2Decoder* MdSessionStore::decoder ( int version ) const {
+    if ( !dec || dec->version() != version ) {
+        delete dec;
+        dec = new MdMd2Decoder (version);
+    }
+    return dec;
+}
+
+MdDataRecord* MdSessionStore::record ( qint64 row ) {
+    if ( row < 0 || row >= rows )
+        return NULL;
+    int slot = row % RECORD_SLOTS;
+    if ( recordSlotRow[slot] == row )
+        return recordSlot[slot];
+    if ( !recordSlot[slot] )
+        recordSlot[slot] = new MdDataRecord();
+    assignRecord ( row, recordSlot[slot] );
+    recordSlotRow[slot] = row;
+    return recordSlot[slot];
+}
+
+void MdSessionStore::assignRecord ( qint64 row, MdDataRecord* r ) const {
+    int ci = chunkForRow (row);
+    if ( ci >= 0 )
+        columns(ci)->assignRecord ( row - firstRow[ci], r );
+}
+
+double MdSessionStore::toDouble ( int id, qint64 row ) const {
+    int ci = chunkForRow (row);
+    return columns(ci)->toDouble ( id, row - firstRow[ci] );
+}
+
+MdSessionColumns* MdSessionStore::tail ( int frameVersion ) {
+    if ( !chunks.isEmpty() && chunks.last()->frameVersion() != frameVersion && chunks.last()->rowCount() < CHUNK_ROWS ) {
+        //records go on in column form, other frames in a chunk of their own
+        if ( frameVersion == 0 )
+            unpack ( chunks.last() );
+        else
+            uniform = false;
+    }
+    if ( chunks.isEmpty() || chunks.last()->rowCount() >= CHUNK_ROWS || chunks.last()->frameVersion() != frameVersion ) {
+        //the last chunk is complete. packed, it keeps its columns while it is one of the chunks read last
+        if ( !chunks.isEmpty() && !chunks.last()->hasFrames() ) {
+            chunks.last()->pack (typeK);
+            materialize ( chunks.last() );
+        }
+        MdSessionColumns* c;
+        if ( spare.isEmpty() )
+            c = new MdSessionColumns();
+        else {
+            c = spare.last();
+            spare.removeLast();
+        }
+        c->setFrameVersion (frameVersion);
+        c->reserve (CHUNK_ROWS);
+        chunks.append (c);
+        firstRow.append (rows);
+        lastTime.append (0);
+        spillId.append (-1);
+    }
+    return chunks.last();
+}
+
+void MdSessionStore::append ( const MdDataRecord* r ) {
+    if ( !r || !r->getSensorR() )
+        return;
+    MdSessionColumns* t = tail();
+    t->appendRecord (r);
+    lastTime.last() = r->getSensorR()->getTime();
+    rows++;
+    ver++;
+    if ( spill && t->rowCount() == CHUNK_ROWS )
+        spillOld();
+}
+
+void MdSessionStore::appendFrame ( const quint8* frame, int frameVersion, const MdDataRecord* r ) {
+    if ( !r || !r->getSensorR() )
+        return;
+    MdSessionColumns* t = tail (frameVersion);
+    t->appendFrame ( frame, r );
+    lastTime.last() = r->getSensorR()->getTime();
+    rows++;
+    ver++;
+    if ( spill && t->rowCount() == CHUNK_ROWS )
+        spillOld();
+}
+
+void MdSessionStore::append ( const MdSessionColumns& cols, int first, int count ) {
+    int end = ( count < 0 ) ? cols.rowCount() : qMin ( first + count, cols.rowCount() );
+    //fill up the last chunk first, the chunks stay full
+    for ( int done = first ; done < end ; ) {
+        MdSessionColumns* t = tail();
+        int n = qMin ( end - done, CHUNK_ROWS - t->rowCount() );
+        t->appendRows ( cols, done, n );
+        updateLastTime ( chunks.size() - 1 );
+        done += n;
+        rows += n;
+    }
+    ver++;
+    if ( spill )
+        spillOld();
+}
+
+void MdSessionStore::append ( MdSessionStore& other ) {
+    for ( int i = 0 ; i < other.chunkCount() ; i++ )
+        append ( *other.columns (i) );
+}
+
+void MdSessionStore::removeRows ( qint64 first, qint64 count ) {
+    if ( first < 0 || count <= 0 || first >= rows )
+        return;
+    count = qMin ( count, rows - first );
+    QVector<int> counts ( chunks.size() );
+    for ( int i = 0 ; i < chunks.size() ; i++ )
+        counts[i] = chunkRows (i);
+    //one pass over the touched chunks, empty ones are dropped
+    int ci = chunkForRow (first);
+    int from = first - firstRow[ci];
+    while ( ci < chunks.size() && count > 0 ) {
+        MdSessionColumns* c = resident (ci);
+        int n = qMin ( (qint64) c->rowCount() - from, count );
+        c->removeRows ( from, n );
+        rows -= n;
+        count -= n;
+        if ( c->rowCount() == 0 ) {
+            recycle (c);
+            chunks.remove (ci);
+            spillId.remove (ci);
+            lastTime.remove (ci);
+            counts.remove (ci);
+        } else {
+            counts[ci] = c->rowCount();
+            updateLastTime (ci);
+            ci++;
+        }
+        from = 0;
+    }
+    updateFirstRows (counts);
+    //with the chunks after it gone an older chunk is the last again. tail() reads it and
+    //appends to it if it has room -> it can neither stay spilled nor packed
+    int last = chunks.size() - 1;
+    if ( last >= 0 && ( !chunks[last] || ( counts[last] < CHUNK_ROWS && chunks[last]->isPacked() ) ) )
+        resident (last);
+    recordSlotRow.fill (-1);
+    gen++;
+    ver++;
+}
+
+void MdSessionStore::clear () {
+    foreach ( MdSessionColumns* c, chunks )
+        if ( c )
+            recycle (c);
+    chunks.clear();
+    firstRow.clear();
+    lastTime.clear();
+    spillId.clear();
+    foreach ( MdSessionColumns* c, paged )
+        recycle (c);
+    paged.clear();
+    pagedId.clear();
+    //the chunks in writing stay until the spill file is done with them
+    rows = 0;
+    uniform = true;
+    typeK = MAX_ATTACHED_TYPK;
+    recordSlotRow.fill (-1);
+    ver++;
+}
+
+MdSessionSnapshot* MdSessionStore::snapshot () {
+    MdSessionSnapshot* s = new MdSessionSnapshot();
+    int n = chunks.size();
+    s->chunks.resize (n);
+    s->spillOffset.fill ( -1, n );
+    for ( int ci = 0 ; ci < n ; ci++ ) {
+        if ( chunks[ci] )
+            s->chunks[ci] = *chunks[ci];
+        else if ( writing.contains (spillId[ci]) )
+            s->chunks[ci] = *writing.value (spillId[ci]);
+        else if ( (s->spillOffset[ci] = spill->offset (spillId[ci])) < 0 )
+            s->chunks[ci] = *columns (ci);
+    }
+    s->firstRow = firstRow;
+    s->lastTime = lastTime;
+    s->rows = rows;
+    s->ver = ver;
+    if ( spill )
+        s->spill.setFileName ( spill->fileName() );
+
+    //the tail is shared now, copy it once with room for the rest of its rows
+    if ( n > 0 && chunks.last() && chunks.last()->rowCount() < CHUNK_ROWS )
+        chunks.last()->reserve (CHUNK_ROWS);
+    return s;
+}
+
+void MdSessionStore::setSpill ( MdSpillFile* s, qint64 window ) {
+    if ( spill && spill != s ) {
+        //everything back into memory before the old file goes away
+        for ( int ci = 0 ; ci < chunks.size() ; ci++ )
+            if ( !chunks[ci] )
+                resident (ci);
+        foreach ( MdSessionColumns* c, writing )
+            delete c;
+        writing.clear();
+        gen++;
+    }
+    spill = s;
+    windowMillis = window;
+}
+
+void MdSessionStore::spillOld () {
+    foreach ( int id, spill->takeWritten() )
+        if ( writing.contains (id) )
+            recycle ( writing.take (id) );
+    if ( !spill->isOk() || rows == 0 )
+        return;
+
+    qint64 newest = lastTime.last();
+    //the last chunk is being filled, the older ones are in time order
+    for ( int ci = 0 ; ci < chunks.size() - 1 ; ci++ ) {
+        MdSessionColumns* c = chunks[ci];
+        if ( !c )
+            continue;
+        if ( newest - lastTime[ci] <= windowMillis )
+            break;
+        //the spill file takes columns only
+        unpack (c);
+        int id = nextSpillId++;
+        writing.insert (id, c);
+        chunks[ci] = NULL;
+        spillId[ci] = id;
+        spill->write (id, c);
+    }
+}
+
+void MdSessionStore::recycle ( MdSessionColumns* c ) {
+    gen++;
+    decoded.removeOne (c);
+    if ( spare.size() < SPARE_CHUNKS ) {
+        c->clearRows();
+        spare.append (c);
+    } else
+        delete c;
+}
+
+void MdSessionStore::updateLastTime ( int ci ) {
+    const MdSessionColumns* c = chunks[ci];
+    if ( c->rowCount() > 0 )
+        lastTime[ci] = c->value<qint32> ( MdChannel::Time, c->rowCount() - 1 );
+}
+
+void MdSessionStore::updateFirstRows ( const QVector<int>& counts ) {
+    firstRow.resize ( counts.size() );
+    uniform = true;
+    qint64 r = 0;
+    for ( int i = 0 ; i < counts.size() ; i++ ) {
+        firstRow[i] = r;
+        r += counts[i];
+        if ( i < counts.size() - 1 && counts[i] != CHUNK_ROWS )
+            uniform = false;
+    }
+}
+
+void MdSessionStore::dropRecord ( qint64 row ) {
+    int slot = row % RECORD_SLOTS;
+    if ( recordSlotRow[slot] == row )
+        recordSlotRow[slot] = -1;
+}
+
+void MdSessionStore::setReadWindow ( qint64 windowRows ) {
+    //the window starts anywhere in a chunk and the last chunk is still growing
+    int n = windowRows / CHUNK_ROWS + 2;
+    maxDecoded = qMax ( (int) MATERIALIZED_CHUNKS, n );
+    maxPaged = qMax ( (int) PAGED_CHUNKS, n );
+}
+
+int MdSessionStore::residentChunks () const {
+    int n = 0;
+    foreach ( const MdSessionColumns* c, chunks )
+        if ( c )
+            n++;
+    return n;
+}
+
+qint64 MdSessionStore::byteSize () const {
+    qint64 b = 0;
+    foreach ( const MdSessionColumns* c, chunks )
+        if ( c )
+            b += c->byteSize();
+    foreach ( const MdSessionColumns* c, writing )
+        b += c->byteSize();
+    foreach ( const MdSessionColumns* c, paged )
+        b += c->byteSize();
+    return b;
+}
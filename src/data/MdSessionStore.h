@@ -0,0 +1,178 @@
+#ifndef MDSESSIONSTORE_H
+#define MDSESSIONSTORE_H
+
+#include "data/MdChunkSource.h"
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+class MdDataRecord;
+class MdMd2Decoder;
+class MdSpillFile;
+class MdSessionSnapshot;
+
+/**
+  * in memory rows of the recorded or loaded data, one typed array per channel
+  * in chunks of CHUNK_ROWS rows (struct of arrays, same layout as a mdv3 chunk).
+  *
+  * appending a row transposes it into the last chunk, nothing is allocated per row.
+  * a scan over a channel only touches that channel's arrays. all chunks but the last
+  * are full until rows get removed, then the chunks are searched by their first row.
+  * up to SPARE_CHUNKS cleared or emptied chunks are kept for the next rows, a new
+  * log after clear() starts without allocating.
+  *
+  * with a spill file only the chunks of the last window are held in memory, older
+  * ones are written to the file and paged back (PAGED_CHUNKS at a time) when a row
+  * of them is read. changing a paged chunk makes it resident again until it is spilled
+  * anew. the memory use is flat however long the log gets.
+  *
+  * rows appended by appendFrame() are kept as the received MD2 frames (see MdSessionColumns),
+  * other chunks are packed once they are complete (Digifant values once per K-line frame,
+  * EGTs of the fitted thermocouples only). a chunk is decoded / expanded when it is read and
+  * only the MATERIALIZED_CHUNKS read last stay that way, or as many as setReadWindow() asks
+  * for: the plot curves read the window one after another and must not decode it anew for
+  * every curve. a chunk loses its frames or runs when it is changed or spilled.
+  *
+  * the store belongs to the GUI thread. other threads read a snapshot() of it.
+  */
+class MdSessionStore : public MdChunkSource {
+public:
+    enum { CHUNK_ROWS = 4096, RECORD_SLOTS = 512, SPARE_CHUNKS = 4, PAGED_CHUNKS = 2, MATERIALIZED_CHUNKS = 4 };
+
+    MdSessionStore ();
+    virtual ~MdSessionStore ();
+
+    qint64 rowCount () const { return rows; }
+    bool isEmpty () const { return rows == 0; }
+    int chunkCount () const { return chunks.size(); }
+    int chunkForRow ( qint64 row ) const;
+    qint64 chunkFirstRow ( int chunk ) const { return firstRow[chunk]; }
+    qint32 chunkLastTime ( int chunk ) const { return lastTime[chunk]; }
+    const MdSessionColumns* chunk ( int i );
+    quint32 generation () const { return gen; }
+
+    /**
+      * row as record. the record is owned by the store and stays valid
+      * until RECORD_SLOTS other rows were requested or the rows change.
+      */
+    MdDataRecord* record ( qint64 row );
+    //! assign all channels of row to the record fields
+    void assignRecord ( qint64 row, MdDataRecord* r ) const;
+
+    void append ( const MdDataRecord* r );
+    //! r has to be decoded from frame by a MdMd2Decoder of frameVersion, the frame is stored instead of its channels
+    void appendFrame ( const quint8* frame, int frameVersion, const MdDataRecord* r );
+    //! append count rows (all if < 0) of a chunk starting at first, all channels must be enabled
+    void append ( const MdSessionColumns& cols, int first = 0, int count = -1 );
+    //! append all rows of other
+    void append ( MdSessionStore& other );
+    void removeRows ( qint64 first, qint64 count );
+    //! also sets the fitted thermocouples back to all
+    void clear ();
+
+    //! EGT channels of the fitted thermocouples, chunks packed from now on keep only these
+    void setTypeK ( int n ) { typeK = n; }
+
+    /**
+      * the current rows as an immutable source for another thread, the caller takes ownership!
+      * costs a reference per chunk, the last chunk is detached here instead of by the next append.
+      */
+    MdSessionSnapshot* snapshot ();
+    //! changes with every append / change of the rows, a snapshot of the same version is up to date
+    quint32 version () const { return ver; }
+
+    template <typename T> T value ( int id, qint64 row ) const {
+        int ci = chunkForRow (row);
+        return columns(ci)->value<T> (id, row - firstRow[ci]);
+    }
+    double toDouble ( int id, qint64 row ) const;
+    //! T has to match the channel type
+    template <typename T> void setValue ( int id, qint64 row, T v ) {
+        int ci = chunkForRow (row);
+        reinterpret_cast<T*> ( resident(ci)->raw(id).data() )[row - firstRow[ci]] = v;
+        if ( id == MdChannel::Time )
+            updateLastTime (ci);
+        dropRecord (row);
+        ver++;
+    }
+
+    /**
+      * keep only the chunks of the last windowMillis (time channel, up to the newest row)
+      * in memory, older full chunks go to spill. the store does not own spill, it has to
+      * run (start()) as long as it is set. NULL keeps all rows in memory again.
+      */
+    void setSpill ( MdSpillFile* spill, qint64 windowMillis );
+    MdSpillFile* spillFile () const { return spill; }
+    //! chunks held in memory
+    int residentChunks () const;
+    /**
+      * rows read again and again (the plot window): the chunks they span stay decoded and
+      * paged in, at least MATERIALIZED_CHUNKS / PAGED_CHUNKS
+      */
+    void setReadWindow ( qint64 windowRows );
+
+    //! approximate heap usage of the column data
+    qint64 byteSize () const;
+
+private:
+    Q_DISABLE_COPY (MdSessionStore)
+
+    //! last chunk with room for another row in frame form of frameVersion (0: column form)
+    MdSessionColumns* tail ( int frameVersion = 0 );
+    void dropRecord ( qint64 row );
+    //! keeps c as spare or deletes it
+    void recycle ( MdSessionColumns* c );
+    int chunkRows ( int ci ) const;
+    //! lastTime of the resident chunk ci from its time column
+    void updateLastTime ( int ci );
+    void updateFirstRows ( const QVector<int>& counts );
+
+    //! chunk ci for reading, paged in if it was spilled
+    const MdSessionColumns* columns ( int ci ) const;
+    //! chunk ci for changes, in memory, no longer spilled and without frames
+    MdSessionColumns* resident ( int ci );
+    //! decodes the frame channels of c, the least recently read chunks beyond maxDecoded are dematerialized
+    void materialize ( MdSessionColumns* c ) const;
+    //! c in column form again
+    void unpack ( MdSessionColumns* c );
+    MdMd2Decoder* decoder ( int version ) const;
+    //! drops the written chunks and hands the chunks older than the window to the spill file
+    void spillOld ();
+
+    //! NULL while a chunk is only in the spill file
+    QVector<MdSessionColumns*> chunks;
+    QVector<MdSessionColumns*> spare;
+    QVector<qint64> firstRow;
+    //! time of the last row of every chunk, kept for spilled chunks too
+    QVector<qint32> lastTime;
+    qint64 rows;
+    //! every chunk but the last holds CHUNK_ROWS rows
+    bool uniform;
+    int typeK;
+
+    QVector<MdDataRecord*> recordSlot;
+    QVector<qint64> recordSlotRow;
+
+    MdSpillFile* spill;
+    qint64 windowMillis;
+    //! spill id of every chunk, -1 if it is not in the spill file
+    QVector<int> spillId;
+    int nextSpillId;
+    //! spill id -> chunk the spill file is writing, readable until it is written
+    QHash<int, MdSessionColumns*> writing;
+    //! chunks read back from the spill file, least recently used first
+    mutable QList<int> pagedId;
+    mutable QList<MdSessionColumns*> paged;
+    //! resident frame / packed chunks that are materialized, least recently used first
+    mutable QList<MdSessionColumns*> decoded;
+    //! size of decoded / paged, see setReadWindow()
+    int maxDecoded;
+    int maxPaged;
+    mutable MdMd2Decoder* dec;
+    //! see MdChunkSource::generation
+    mutable quint32 gen;
+    quint32 ver;
+};
+
+#endif // MDSESSIONSTORE_H
@@ -0,0 +1,148 @@
+#include "data/MdSpillFile.h"
+#include "data/MdSessionColumns.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QMutexLocker>
+#include <QDebug>
+
+MdSpillFile::MdSpillFile ( const QString& filename )
+    : filename(filename), bytes(0), ok(true) {
+}
+
+MdSpillFile::~MdSpillFile () {
+}
+
+QString MdSpillFile::newFileName ( const QString& directory ) {
+    QDir().mkpath (directory);
+    return directory + QDir::separator() + QDateTime::currentDateTime().toString("yyyy-MM-ddThhmmss") + ".spill";
+}
+
+void MdSpillFile::removeStale ( const QString& directory ) {
+    QDir jd (directory);
+    foreach ( QString s, jd.entryList ( QStringList() << "*.spill", QDir::Files ) )
+        QFile::remove ( jd.filePath (s) );
+}
+
+void MdSpillFile::start () {
+    out.setFileName (filename);
+    if ( !out.open ( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        QMutexLocker l (&mutex);
+        ok = false;
+        error = out.errorString();
+        qDebug() << "MdSpillFile: can not open " << filename << ": " << error;
+    }
+}
+
+void MdSpillFile::stop () {
+    {
+        QMutexLocker l (&mutex);
+        pending.clear();
+    }
+    out.close();
+    QFile::remove (filename);
+    emit jobFinished();
+}
+
+void MdSpillFile::write ( int id, const MdSessionColumns* c ) {
+    {
+        QMutexLocker l (&mutex);
+        pending.append ( qMakePair (id, c) );
+    }
+    QMetaObject::invokeMethod ( this, "writePending", Qt::QueuedConnection );
+}
+
+void MdSpillFile::writePending () {
+    QList< QPair<int, const MdSessionColumns*> > todo;
+    {
+        QMutexLocker l (&mutex);
+        if ( !ok )
+            return;
+        todo = pending;
+        pending.clear();
+    }
+
+    QDataStream ds (&out);
+    ds.setVersion (QDataStream::Qt_4_6);
+    for ( int i = 0 ; i < todo.size() ; i++ ) {
+        const MdSessionColumns* c = todo[i].second;
+        qint64 offset = out.pos();
+        ds << (qint32) c->rowCount();
+        for ( int id = 0 ; id < MdChannel::Count ; id++ ) {
+            if ( MdChannel::typeSize ( MdChannel::descriptor(id).type ) > 0 )
+                ds << c->raw (id);
+            else
+                ds << c->strings (id);
+        }
+        bool done = ds.status() == QDataStream::Ok && out.flush();
+
+        QMutexLocker l (&mutex);
+        if ( !done ) {
+            ok = false;
+            error = out.errorString();
+            qDebug() << "MdSpillFile: writing " << filename << " failed: " << error;
+            return;
+        }
+        offsets.insert ( todo[i].first, offset );
+        written.append ( todo[i].first );
+        bytes = out.pos();
+    }
+}
+
+QList<int> MdSpillFile::takeWritten () {
+    QMutexLocker l (&mutex);
+    QList<int> w = written;
+    written.clear();
+    return w;
+}
+
+bool MdSpillFile::read ( int id, MdSessionColumns& cols ) {
+    qint64 o = offset (id);
+    if ( o < 0 )
+        return false;
+    if ( !in.isOpen() ) {
+        in.setFileName (filename);
+        if ( !in.open (QIODevice::ReadOnly) )
+            return false;
+    }
+    return readChunk ( in, o, cols );
+}
+
+qint64 MdSpillFile::offset ( int id ) const {
+    QMutexLocker l (&mutex);
+    return offsets.value ( id, -1 );
+}
+
+bool MdSpillFile::readChunk ( QIODevice& in, qint64 offset, MdSessionColumns& cols ) {
+    if ( offset < 0 || !in.seek (offset) )
+        return false;
+
+    QDataStream ds (&in);
+    ds.setVersion (QDataStream::Qt_4_6);
+    qint32 rows;
+    ds >> rows;
+    for ( int i = 0 ; i < MdChannel::Count ; i++ ) {
+        if ( MdChannel::typeSize ( MdChannel::descriptor(i).type ) > 0 )
+            ds >> cols.raw (i);
+        else
+            ds >> cols.strings (i);
+    }
+    cols.setRowCount (rows);
+    return ds.status() == QDataStream::Ok;
+}
+
+qint64 MdSpillFile::bytesWritten () const {
+    QMutexLocker l (&mutex);
+    return bytes;
+}
+
+bool MdSpillFile::isOk () const {
+    QMutexLocker l (&mutex);
+    return ok;
+}
+
+QString MdSpillFile::errorString () const {
+    QMutexLocker l (&mutex);
+    return error;
+}
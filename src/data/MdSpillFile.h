@@ -0,0 +1,83 @@
+#ifndef MDSPILLFILE_H
+#define MDSPILLFILE_H
+
+#include "thread/workerjob.h"
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+class MdSessionColumns;
+
+/**
+  * swap file of the chunks MdSessionStore dropped from memory (see MdSessionStore::setSpill).
+  *
+  * the GUI thread queues chunks with write(), the job thread appends them to the file
+  * and reports them back by takeWritten(). a written chunk is read back on the GUI
+  * thread with its own handle, snapshots of the store open another one (readChunk()).
+  * the file is only a cache of the current log, it is removed by stop() and never recovered.
+  *
+  * chunk: qint32 rows, per channel (MdChannel order) the raw values or the strings (QDataStream)
+  */
+class MdSpillFile : public WorkerJob {
+    Q_OBJECT
+public:
+    MdSpillFile ( const QString& filename );
+    ~MdSpillFile ();
+
+    /**
+      * GUI thread: queues chunk c under id. c is read by the job thread, it must
+      * not change or go away until id was returned by takeWritten().
+      */
+    void write ( int id, const MdSessionColumns* c );
+    //! GUI thread: ids of the chunks written since the last call
+    QList<int> takeWritten ();
+    //! GUI thread: reads a written chunk, false on read errors
+    bool read ( int id, MdSessionColumns& cols );
+    //! any thread: file offset of a written chunk, -1 if it is not written (yet)
+    qint64 offset ( int id ) const;
+
+    QString fileName () const { return filename; }
+    qint64 bytesWritten () const;
+    //! false after a write error, the queued chunks are never reported as written
+    bool isOk () const;
+    QString errorString () const;
+
+    //! new spill file name in directory
+    static QString newFileName ( const QString& directory );
+    //! removes the spill files a crash left in directory
+    static void removeStale ( const QString& directory );
+    //! reads the chunk at offset of a spill file, with its own handle any thread may read (MdSessionSnapshot)
+    static bool readChunk ( QIODevice& in, qint64 offset, MdSessionColumns& cols );
+
+public slots:
+    //! opens the file, runs in the job thread
+    void start ();
+    //! drops the queued chunks and removes the file
+    void stop ();
+
+protected slots:
+    void writePending ();
+
+protected:
+    QString filename;
+    //! job thread
+    QFile out;
+    //! GUI thread
+    QFile in;
+
+    //! guards everything below
+    mutable QMutex mutex;
+    QList< QPair<int, const MdSessionColumns*> > pending;
+    QList<int> written;
+    //! id -> offset of the written chunks
+    QHash<int, qint64> offsets;
+    qint64 bytes;
+    bool ok;
+    QString error;
+};
+
+#endif // MDSPILLFILE_H
@@ -0,0 +1,70 @@
+#include "data/MdTimeIndex.h"
+
+#include <algorithm>
+
+qint64 MdTimeIndex::bound ( double millis, bool upper ) {
+    //first chunk with a last time >= millis (> millis for upper)
+    int lb = 0;
+    int rb = src->chunkCount();
+    while ( lb < rb ) {
+        int mi = lb + (rb - lb) / 2;
+        qint32 t = src->chunkLastTime (mi);
+        if ( upper ? t <= millis : t < millis )
+            lb = mi + 1;
+        else
+            rb = mi;
+    }
+    if ( lb >= src->chunkCount() )
+        return src->rowCount();
+
+    const MdSessionColumns* c = src->chunk (lb);
+    if ( !c )
+        return src->chunkFirstRow (lb);
+    const qint32* t = reinterpret_cast<const qint32*> ( c->raw(MdChannel::Time).constData() );
+    const qint32* e = t + c->rowCount();
+    const qint32* p = upper ? std::upper_bound (t, e, millis) : std::lower_bound (t, e, millis);
+    return src->chunkFirstRow (lb) + (p - t);
+}
+
+qint64 MdTimeIndex::lowerBound ( double millis ) {
+    return bound (millis, false);
+}
+
+qint64 MdTimeIndex::upperBound ( double millis ) {
+    return bound (millis, true);
+}
+
+qint64 MdTimeIndex::nearest ( double millis ) {
+    qint64 n = src->rowCount();
+    if ( n == 0 )
+        return -1;
+    qint64 r = lowerBound (millis);
+    if ( r >= n )
+        return n - 1;
+    if ( r > 0 && millis - timeAt (r - 1) <= timeAt (r) - millis )
+        return r - 1;
+    return r;
+}
+
+void MdTimeIndex::rowRange ( double from, double to, qint64& first, qint64& end ) {
+    first = lowerBound (from);
+    end = qMax ( first, upperBound (to) );
+}
+
+double MdTimeIndex::valueAt ( int channel, double millis ) {
+    qint64 n = src->rowCount();
+    if ( n == 0 )
+        return 0;
+    qint64 r = lowerBound (millis);
+    if ( r >= n )
+        return cursor.toDouble ( channel, n - 1 );
+    qint32 t1 = timeAt (r);
+    if ( r == 0 || t1 == millis )
+        return cursor.toDouble ( channel, r );
+    qint32 t0 = timeAt (r - 1);
+    double y0 = cursor.toDouble ( channel, r - 1 );
+    double y1 = cursor.toDouble ( channel, r );
+    if ( t1 == t0 )
+        return y1;
+    return y0 + (millis - t0) * (y1 - y0) / (t1 - t0);
+}
@@ -0,0 +1,38 @@
+#ifndef MDTIMEINDEX_H
+#define MDTIMEINDEX_H
+
+#include "data/MdChunkSource.h"
+
+/**
+  * time lookups on the rows of a chunk source, the time channel has to be ascending.
+  *
+  * the last time of every chunk (MdChunkSource::chunkLastTime) is the coarse skip table,
+  * a binary search over it picks the chunk, a second one runs over the contiguous time
+  * array of that chunk. nothing is copied or allocated, only the one chunk is read
+  * (decoded on a session cache miss) -> cheap enough to construct per lookup.
+  */
+class MdTimeIndex {
+public:
+    MdTimeIndex ( MdChunkSource* src ) : src(src), cursor(src) {}
+
+    //! first row with a time >= millis, rowCount() if there is none
+    qint64 lowerBound ( double millis );
+    //! first row with a time > millis, rowCount() if there is none
+    qint64 upperBound ( double millis );
+    //! row with the time closest to millis (the earlier one on a tie), -1 without rows
+    qint64 nearest ( double millis );
+    //! rows with from <= time <= to are first .. end - 1
+    void rowRange ( double from, double to, qint64& first, qint64& end );
+
+    qint32 timeAt ( qint64 row ) { return cursor.value<qint32> ( MdChannel::Time, row ); }
+    //! channel at millis, linear between the rows around it. the first / last row outside of the rows
+    double valueAt ( int channel, double millis );
+
+private:
+    qint64 bound ( double millis, bool upper );
+
+    MdChunkSource* src;
+    MdRowCursor cursor;
+};
+
+#endif // MDTIMEINDEX_H
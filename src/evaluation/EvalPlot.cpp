@@ -24,6 +24,7 @@
 
 #include "EvalPlot.h"
 #include "MdData.h"
+#include "data/MdChunkSource.h"
 
 
 EvalPlot::EvalPlot( QMainWindow* mw, QWidget *parent ) : MdPlot(mw, parent) {
@@ -76,14 +77,18 @@ EvalPlotBoostLambda::~EvalPlotBoostLambda() {
 }
 
 void EvalPlotBoostLambda::compute ( MdData *md ) {
-	QList<MdDataRecord*> dl = md->getData ();
-
-	if ( dl.size() > 0 ) {
-		foreach ( MdDataRecord* r , dl ) {
-                    if ( r->getSensorR() != NULL ) {
-			if ( r->getSensorR()->getThrottle() >= 90 )
-				d.add (r->getSensorR()->getBoost(), r->getSensorR()->getLambda() );
-                    }
+	MdChunkSource* src = md->source ();
+
+	if ( src->rowCount() > 0 ) {
+		//only the three columns are read
+		for ( int ci = 0 ; ci < src->chunkCount() ; ci++ ) {
+			const MdSessionColumns* c = src->chunk (ci);
+			if ( !c )
+				break;
+			for ( int r = 0 ; r < c->rowCount() ; r++ ) {
+				if ( c->value<qint32> (MdChannel::Throttle, r) >= 90 )
+					d.add ( c->value<double> (MdChannel::Boost, r), c->value<double> (MdChannel::Lambda, r) );
+			}
 		}
         ec->setSamples ( d.x(), d.y() );
 //        ec->setSamples (&d);
@@ -110,14 +115,17 @@ EvalPlotRPMBoost::~EvalPlotRPMBoost() {
 }
 
 void EvalPlotRPMBoost::compute ( MdData *md ) {
-	QList<MdDataRecord*> dl = md->getData ();
-
-	if ( dl.size() > 0 ) {
-		foreach ( MdDataRecord* r , dl ) {
-                    if ( r->getSensorR() != NULL ) {
-			if ( r->getSensorR()->getThrottle() >= 90 )
-				d.add (r->getSensorR()->getRpm(), r->getSensorR()->getBoost() );
-                    }
+	MdChunkSource* src = md->source ();
+
+	if ( src->rowCount() > 0 ) {
+		for ( int ci = 0 ; ci < src->chunkCount() ; ci++ ) {
+			const MdSessionColumns* c = src->chunk (ci);
+			if ( !c )
+				break;
+			for ( int r = 0 ; r < c->rowCount() ; r++ ) {
+				if ( c->value<qint32> (MdChannel::Throttle, r) >= 90 )
+					d.add ( c->value<qint32> (MdChannel::Rpm, r), c->value<double> (MdChannel::Boost, r) );
+			}
 		}
         ec->setSamples( d.x(), d.y() );
 	}
@@ -20,6 +20,7 @@
 
 #include "EvalSpectrogramPlot.h"
 #include "MdSpectrogramData.h"
+#include "data/MdChunkSource.h"
 #include <qwt_color_map.h>
 #include <qwt_scale_widget.h>
 #include <qwt_plot_layout.h>
@@ -121,7 +122,7 @@ EvalSpectrogramPlot::~EvalSpectrogramPlot() {
 
 
 void EvalSpectrogramPlot::compute ( MdData *md ) {
-	QList<MdDataRecord*> dl = md->getData ();
+	MdChunkSource* src = md->source ();
 
     data = (MdSpectrogramData*) ( es->data() );
 	data->clear();
@@ -130,19 +131,21 @@ void EvalSpectrogramPlot::compute ( MdData *md ) {
 	long time = 0;
         qint32 samples = 0;
 
-	if ( dl.size() > 0 ) {
-		foreach ( MdDataRecord* r , dl ) {
-                    if ( r->getSensorR() != NULL ) {
-			if ( r->getSensorR()->getThrottle() >= 90 ) {
-//				double rpm = round_nplaces( r->getSensorR()->getRpm(), 2);
-				time += r->getSensorR()->getTime();
-				double boost = round_nplaces( r->getSensorR()->getBoost(), 2) ;
-				double lambda = round_nplaces( r->getSensorR()->getLambda(), 2);
-				data->increment(boost, lambda);
-//				qDebug() << boost << " " << lambda << " value=" << data->value(boost,lambda);
-                                samples++;
+	if ( src->rowCount() > 0 ) {
+		for ( int ci = 0 ; ci < src->chunkCount() ; ci++ ) {
+			const MdSessionColumns* c = src->chunk (ci);
+			if ( !c )
+				break;
+			for ( int r = 0 ; r < c->rowCount() ; r++ ) {
+				if ( c->value<qint32> (MdChannel::Throttle, r) >= 90 ) {
+					time += c->value<qint32> (MdChannel::Time, r);
+					double boost = round_nplaces( c->value<double> (MdChannel::Boost, r), 2) ;
+					double lambda = round_nplaces( c->value<double> (MdChannel::Lambda, r), 2);
+					data->increment(boost, lambda);
+//					qDebug() << boost << " " << lambda << " value=" << data->value(boost,lambda);
+					samples++;
+				}
 			}
-                    }
 		}
                 sampleIntervall = time / samples; //msecs
                 qDebug() << "EvalSpectrogramPlot::compute finished: sampleIntervall=" << sampleIntervall  << " msecs" << " samples=" << samples;
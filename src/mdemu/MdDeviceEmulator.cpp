@@ -0,0 +1,448 @@
+#include "mdemu/MdDeviceEmulator.h"
+#include "com/MdMd2Decoder.h"
+#include "data/MdChannel.h"
+#include "data/MdRawCapture.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+//! writes raw into the field of a frame channel (the inverse of the reads of MdMd2Decoder)
+static void putRaw ( quint8* frame, int version, int channel, quint32 raw ) {
+    const MdMd2Decoder::Field* f = MdMd2Decoder::field (channel);
+    int o = f ? MdMd2Decoder::offset ( version, *f ) : -1;
+    if ( o < 0 )
+        return;
+    for ( int i = 0 ; i < f->width ; i++ ) {
+        int shift = ( f->flags & MdMd2Decoder::BigEndian ) ? 8 * (f->width - 1 - i) : 8 * i;
+        frame[o + i] = (quint8) ( raw >> shift );
+    }
+}
+
+//! the raw bytes MdMd2Decoder decodes into value
+static void putValue ( quint8* frame, int channel, double value ) {
+    const MdMd2Decoder::Field* f = MdMd2Decoder::field (channel);
+    if ( f )
+        putRaw ( frame, MdMd2Decoder::VERSION_CURRENT, channel, (quint32) (qint32) floor ( (value - f->add) * f->divisor + 0.5 ) );
+}
+
+static void put16 ( quint8* d, quint16 v ) {
+    d[0] = v & 0xFF;
+    d[1] = v >> 8;
+}
+
+static quint16 get16 ( const quint8* d ) {
+    return d[0] | (d[1] << 8);
+}
+
+static bool chance ( double percent ) {
+    return percent > 0 && rand() < percent / 100.0 * RAND_MAX;
+}
+
+//! an empty frame of tag, its length is the tag
+static QByteArray emptyFrame ( quint8 tag ) {
+    QByteArray f ( tag, 0 );
+    f[0] = MD_FRAMEBEGIN;
+    f[1] = tag;
+    f[tag - 1] = MD_FRAMEEND;
+    return f;
+}
+
+
+MdDeviceEmulator::MdDeviceEmulator ( QObject* parent )
+    : QObject(parent), master(-1), slaveFd(-1), notifier(NULL),
+      rate(50), baud(115200), latency(0), loss(0), corruption(0), streaming(true),
+      capture(NULL), captureNext(0), nextFrameNs(0), lineFreeNs(0), klineFramenum(0),
+      pidFlags(1), maxBoost(150),
+      framesSent(0), repliesSent(0), commands(0), unknownBytes(0), framesSkipped(0),
+      framesLost(0), framesCorrupted(0), overrunBytes(0), reportFrames(0), reportNs(0) {
+    //flat duty maps and setpoints rising with the gear
+    for ( int g = 0 ; g < GEARS ; g++ )
+        for ( int m = 0 ; m < MODES ; m++ )
+            for ( int i = 0 ; i < 16 ; i++ ) {
+                dutyMaps[g][m][i] = 60 + 8 * i;
+                setpointMaps[g][m][i] = 30 + 10 * g + 5 * i;
+            }
+    const quint16 defaultPid[8] = { 200, 50, 10, 150, 30, 5, 20, 10 };
+    const quint16 defaultRatios[6] = { 3780, 2120, 1360, 970, 760, 0 };
+    memcpy ( pid, defaultPid, sizeof(pid) );
+    memcpy ( gearRatios, defaultRatios, sizeof(gearRatios) );
+
+    tickTimer = new QTimer (this);
+    tickTimer->setInterval (TICK_MILLIS);
+    connect ( tickTimer, SIGNAL(timeout()), this, SLOT(tick()) );
+    reportTimer = new QTimer (this);
+    reportTimer->setInterval (REPORT_MILLIS);
+    connect ( reportTimer, SIGNAL(timeout()), this, SLOT(report()) );
+}
+
+MdDeviceEmulator::~MdDeviceEmulator () {
+    close();
+    delete capture;
+}
+
+bool MdDeviceEmulator::open ( const QString& linkName ) {
+    master = posix_openpt ( O_RDWR | O_NOCTTY );
+    if ( master < 0 || grantpt (master) != 0 || unlockpt (master) != 0 ) {
+        error = QString ("pty: %1").arg ( strerror (errno) );
+        close();
+        return false;
+    }
+    slave = ptsname (master);
+    //the slave stays open: raw like a serial port before the app configures it, and the
+    //master does not see a hangup while the app is not connected
+    slaveFd = ::open ( slave.toLocal8Bit().constData(), O_RDWR | O_NOCTTY );
+    struct termios t;
+    if ( slaveFd < 0 || tcgetattr ( slaveFd, &t ) != 0 ) {
+        error = QString ("%1: %2").arg ( slave ).arg ( strerror (errno) );
+        close();
+        return false;
+    }
+    cfmakeraw (&t);
+    tcsetattr ( slaveFd, TCSANOW, &t );
+    fcntl ( master, F_SETFL, fcntl ( master, F_GETFL ) | O_NONBLOCK );
+
+    if ( !linkName.isEmpty() ) {
+        if ( QFileInfo (linkName).isSymLink() )
+            QFile::remove (linkName);
+        if ( !QFile::link ( slave, linkName ) ) {
+            error = "can't create the link " + linkName;
+            close();
+            return false;
+        }
+        link = linkName;
+    }
+
+    notifier = new QSocketNotifier ( master, QSocketNotifier::Read, this );
+    connect ( notifier, SIGNAL(activated(int)), this, SLOT(readCommands()) );
+    return true;
+}
+
+void MdDeviceEmulator::close () {
+    tickTimer->stop();
+    reportTimer->stop();
+    delete notifier;
+    notifier = NULL;
+    if ( master >= 0 )
+        ::close (master);
+    if ( slaveFd >= 0 )
+        ::close (slaveFd);
+    master = slaveFd = -1;
+    if ( !link.isEmpty() )
+        QFile::remove (link);
+    link.clear();
+}
+
+bool MdDeviceEmulator::loadCapture ( const QString& filename ) {
+    MdRawCaptureReader* reader = new MdRawCaptureReader (filename);
+    if ( !reader->open() ) {
+        error = filename + ": " + reader->errorString();
+        delete reader;
+        return false;
+    }
+    QList<int> frames;
+    for ( int i = 0 ; i < reader->frameCount() ; i++ )
+        if ( reader->frameLength (i) == MD_SERIALOUT_BINARY_TAG && reader->frame (i)[1] == MD_SERIALOUT_BINARY_TAG )
+            frames.append (i);
+    if ( frames.isEmpty() ) {
+        error = filename + ": no measurement frames";
+        delete reader;
+        return false;
+    }
+    delete capture;
+    capture = reader;
+    captureFrames = frames;
+    captureNext = 0;
+    return true;
+}
+
+void MdDeviceEmulator::start () {
+    clock.start();
+    nextFrameNs = lineFreeNs = reportNs = 0;
+    tickTimer->start();
+    reportTimer->start();
+}
+
+void MdDeviceEmulator::report () {
+    qint64 now = clock.nsecsElapsed();
+    double seconds = qMax ( ( now - reportNs ) / 1e9, 0.001 );
+    qDebug() << "mdemu:" << qRound ( ( framesSent - reportFrames ) / seconds ) << "frames/s," << framesSent << "frames,"
+             << repliesSent << "replies to" << commands << "commands," << framesSkipped << "skipped,"
+             << framesLost << "lost," << framesCorrupted << "corrupted," << overrunBytes << "bytes not read in time,"
+             << unknownBytes << "unknown command bytes";
+    reportFrames = framesSent;
+    reportNs = now;
+}
+
+void MdDeviceEmulator::readCommands () {
+    char buffer[256];
+    ssize_t n;
+    while ( ( n = ::read ( master, buffer, sizeof(buffer) ) ) > 0 )
+        rx.append ( buffer, n );
+
+    while ( !rx.isEmpty() ) {
+        int length = commandLength (rx);
+        if ( length < 0 )
+            break;
+        if ( length == 0 ) {
+            unknownBytes++;
+            rx.remove ( 0, 1 );
+            continue;
+        }
+        command ( (const quint8*) rx.constData() );
+        rx.remove ( 0, length );
+    }
+}
+
+int MdDeviceEmulator::commandLength ( const QByteArray& rx ) {
+    int length = 0;
+    switch ( (quint8) rx[0] ) {
+    case 2:
+    case 3:
+    case 4:
+        length = 2;
+        break;
+    case 6:
+        if ( rx.size() < 2 )
+            return -1;
+        switch ( (quint8) rx[1] ) {
+        case 5: case 6: case 7: case 8: case 10: case 13:
+            length = 3;
+            break;
+        case 1: case 2: case 11:
+            length = 5;
+            break;
+        case 14:
+            length = 16;
+            break;
+        case 3:
+            length = 21;
+            break;
+        case 9:
+            length = 22;
+            break;
+        case 4:
+            length = 37;
+            break;
+        default:
+            return 0;
+        }
+        break;
+    default:
+        return 0;
+    }
+    return rx.size() >= length ? length : -1;
+}
+
+void MdDeviceEmulator::command ( const quint8* c ) {
+    commands++;
+    switch ( c[0] ) {
+    case 2:
+        //boost buttons, nothing to answer
+        return;
+    case 3:
+        if ( c[1] == 2 )
+            qDebug() << "mdemu: string output is not emulated, output off";
+        streaming = c[1] == 4;
+        return;
+    case 4:
+        //eeprom and boost calibration of the MD1 commands
+        return;
+    }
+
+    //the map commands (1-4): gear, mode, serial
+    int g = c[1] <= 4 ? c[2] % GEARS : 0;
+    int m = c[1] <= 4 ? c[3] % MODES : 0;
+    quint8* duty = dutyMaps[g][m];
+    quint16* setpoints = setpointMaps[g][m];
+    QByteArray f;
+    switch ( c[1] ) {
+    case 1:
+        //STX tag gear mode serial 16 bytes map ETX
+        f = emptyFrame (MD_SERIALOUT_BINARY_TAG_N75_DUTY_MAP);
+        memcpy ( f.data() + 2, c + 2, 3 );
+        memcpy ( f.data() + 5, duty, 16 );
+        reply (f);
+        break;
+    case 2:
+        f = emptyFrame (MD_SERIALOUT_BINARY_TAG_N75_SETPOINT_MAP);
+        memcpy ( f.data() + 2, c + 2, 3 );
+        for ( int i = 0 ; i < 16 ; i++ )
+            put16 ( (quint8*) f.data() + 5 + 2 * i, setpoints[i] );
+        reply (f);
+        break;
+    case 3:
+        memcpy ( duty, c + 5, 16 );
+        ack (c[4]);
+        break;
+    case 4:
+        for ( int i = 0 ; i < 16 ; i++ )
+            setpoints[i] = get16 ( c + 5 + 2 * i );
+        ack (c[4]);
+        break;
+    case 5:
+    case 6:
+    case 7:
+    case 8:
+        //eeprom load / save of the maps and settings
+        ack (c[2]);
+        break;
+    case 9:
+        for ( int i = 0 ; i < 8 ; i++ )
+            pid[i] = get16 ( c + 3 + 2 * i );
+        pidFlags = c[19];
+        maxBoost = get16 ( c + 20 );
+        ack (c[2]);
+        break;
+    case 10:
+        //STX tag serial 8 * uint16 flags max boost ETX
+        f = emptyFrame (MD_SERIALOUT_BINARY_TAG_N75_PARAMS);
+        f[2] = c[2];
+        for ( int i = 0 ; i < 8 ; i++ )
+            put16 ( (quint8*) f.data() + 3 + 2 * i, pid[i] );
+        f[19] = pidFlags;
+        put16 ( (quint8*) f.data() + 20, maxBoost );
+        reply (f);
+        break;
+    case 11:
+        //serial output period in msecs
+        if ( get16 ( c + 3 ) > 0 )
+            rate = 1000.0 / get16 ( c + 3 );
+        ack (c[2]);
+        break;
+    case 13:
+        //STX tag serial gears 6 * uint16 ETX
+        f = emptyFrame (MD_SERIALOUT_BINARY_TAG_GEAR_RATIO_6G);
+        f[2] = c[2];
+        f[3] = 6;
+        for ( int i = 0 ; i < 6 ; i++ )
+            put16 ( (quint8*) f.data() + 4 + 2 * i, gearRatios[i] );
+        reply (f);
+        break;
+    case 14:
+        for ( int i = 0 ; i < 6 ; i++ )
+            gearRatios[i] = get16 ( c + 4 + 2 * i );
+        ack (c[2]);
+        break;
+    }
+}
+
+void MdDeviceEmulator::reply ( QByteArray frame ) {
+    replies.append (frame);
+    replyDue.append ( clock.nsecsElapsed() + latency * 1000000LL );
+}
+
+void MdDeviceEmulator::ack ( quint8 serial ) {
+    QByteArray f = emptyFrame (MD_SERIALOUT_BINARY_TAG_ACK);
+    f[2] = serial;
+    reply (f);
+}
+
+void MdDeviceEmulator::tick () {
+    qint64 now = clock.nsecsElapsed();
+
+    //replies go out between two measurement frames
+    while ( !replies.isEmpty() && replyDue.first() <= now && lineFreeNs <= now ) {
+        send ( replies.takeFirst() );
+        replyDue.removeFirst();
+        repliesSent++;
+    }
+    if ( !streaming ) {
+        nextFrameNs = now;
+        return;
+    }
+
+    qint64 period = rate > 0 ? (qint64) ( 1e9 / rate ) : 0;
+    //with baud 0 and rate 0 only a full pty stops the loop, a tick still has to end
+    for ( int budget = 1000 ; budget > 0 && nextFrameNs <= now && lineFreeNs <= now ; budget-- ) {
+        framesSent++;
+        nextFrameNs += period;
+        if ( !send ( nextFrame ( now / 1000000 ) ) )
+            break;
+    }
+    if ( period > 0 && now - nextFrameNs >= period ) {
+        qint64 late = ( now - nextFrameNs ) / period;
+        framesSkipped += late;
+        nextFrameNs += late * period;
+    } else if ( period == 0 )
+        nextFrameNs = now;
+}
+
+QByteArray MdDeviceEmulator::nextFrame ( quint32 millis ) {
+    QByteArray f;
+    if ( capture ) {
+        int i = captureFrames[captureNext];
+        captureNext = ( captureNext + 1 ) % captureFrames.size();
+        f = QByteArray ( (const char*) capture->frame (i), MD_SERIALOUT_BINARY_TAG );
+        putRaw ( (quint8*) f.data(), capture->decoderVersion(), MdChannel::Time, millis );
+    } else {
+        f = emptyFrame (MD_SERIALOUT_BINARY_TAG);
+        synthesize ( (quint8*) f.data(), millis );
+    }
+    return f;
+}
+
+void MdDeviceEmulator::synthesize ( quint8* frame, quint32 millis ) {
+    //a pull every 20 s: idle, full load at 6500 rpm in the middle, back to idle
+    double load = 0.5 - 0.5 * cos ( 2 * M_PI * ( millis % 20000 ) / 20000.0 );
+    double rpm = 900 + 5600 * load + rand() % 20 - 10;
+
+    putRaw ( frame, MdMd2Decoder::VERSION_CURRENT, MdChannel::Time, millis );
+    putValue ( frame, MdChannel::Rpm, rpm );
+    putValue ( frame, MdChannel::Throttle, 100 * load );
+    putValue ( frame, MdChannel::Boost, 1.4 * load * load - 0.1 );
+    putValue ( frame, MdChannel::Lambda, 1.0 - 0.2 * load );
+    putValue ( frame, MdChannel::Lmm, 1 + 3 * load );
+    putValue ( frame, MdChannel::Casetemp, 35 );
+    for ( int egt = MdChannel::Egt0 ; egt <= MdChannel::Egt3 ; egt++ )
+        putValue ( frame, egt, 350 + 500 * load + 10 * (egt - MdChannel::Egt0) );
+    putValue ( frame, MdChannel::Batcur, 13.8 );
+    putValue ( frame, MdChannel::Speed, rpm / 45 );
+    putValue ( frame, MdChannel::Gear, 3 );
+    putValue ( frame, MdChannel::N75, 40 + 150 * load );
+    putValue ( frame, MdChannel::N75ReqBoost, 1.3 );
+    putValue ( frame, MdChannel::Knock, rand() % 40 );
+
+    putValue ( frame, MdChannel::DfBoostRaw, 60 + 120 * load );
+    putValue ( frame, MdChannel::DfEctRaw, 60 );
+    putValue ( frame, MdChannel::DfIatRaw, 90 );
+    putValue ( frame, MdChannel::DfIgn, 100 - 40 * load );
+    putValue ( frame, MdChannel::DfVoltageRaw, 180 );
+    putValue ( frame, MdChannel::DfInjTime, 2000 + 8000 * load );
+    putValue ( frame, MdChannel::DfRpmDeltaHall, 30000000 / rpm );
+    putValue ( frame, MdChannel::DfKlineFreq, 10 );
+    //255 means no connection to the Digifant
+    putValue ( frame, MdChannel::DfKlineFramenum, klineFramenum );
+    klineFramenum = ( klineFramenum + 1 ) % 255;
+}
+
+bool MdDeviceEmulator::send ( const QByteArray& frame ) {
+    if ( chance (loss) ) {
+        framesLost++;
+        return true;
+    }
+    QByteArray f = frame;
+    if ( chance (corruption) ) {
+        f[ rand() % f.size() ] = (char) ( rand() & 0xFF );
+        framesCorrupted++;
+    }
+
+    ssize_t n = ::write ( master, f.constData(), f.size() );
+    if ( n < 0 )
+        n = 0;
+    //the app does not read fast enough, the rest is lost like on an overrun UART
+    overrunBytes += f.size() - n;
+    if ( baud > 0 )
+        lineFreeNs = qMax ( lineFreeNs, clock.nsecsElapsed() ) + f.size() * 10000000000LL / baud;
+    return n > 0;
+}
@@ -0,0 +1,136 @@
+#ifndef MDDEVICEEMULATOR_H
+#define MDDEVICEEMULATOR_H
+
+#include "com/MdBinaryProtocol.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+
+class MdRawCaptureReader;
+class QSocketNotifier;
+class QTimer;
+
+/**
+  * a MultiDisplay board on a Linux pseudo terminal: the app opens the slave side like the
+  * serial port of a real board (MdQSerialPortCom), the emulator streams MD2 measurement
+  * frames on the master side and answers the commands of MdBinaryProtocol.
+  *
+  * the frames are synthetic (an endless pull through the rev range, see synthesize()) or
+  * the measurement frames of a raw capture in a loop, with the Time field restamped.
+  * the line is paced at baud / 10 bytes per second like the real UART: a frame waits while
+  * the line is busy, frames a whole period late are skipped. baud 0 streams as fast as
+  * the pty takes the bytes.
+  *
+  * every frame, replies included, can be lost or get a random byte changed (percent),
+  * replies leave after the configured latency. bytes the app did not read in time (pty
+  * buffer full) are counted as overrun.
+  */
+class MdDeviceEmulator : public QObject {
+    Q_OBJECT
+public:
+    enum { TICK_MILLIS = 2, REPORT_MILLIS = 10000, GEARS = 8, MODES = 2 };
+
+    explicit MdDeviceEmulator ( QObject* parent = 0 );
+    ~MdDeviceEmulator ();
+
+    /**
+      * opens the pty, link (if not empty) becomes a symlink to the slave, e.g. a stable
+      * port name for the serial options of the app
+      */
+    bool open ( const QString& link = QString() );
+    void close ();
+    //! path of the slave side, the port the app opens
+    QString portName () const { return slave; }
+
+    //! streams the measurement frames of a raw capture instead of synthetic frames
+    bool loadCapture ( const QString& filename );
+
+    //! frames per second, 0: as many as the line takes. the set serial frequency command changes it too
+    void setRate ( double hz ) { rate = hz; }
+    void setBaud ( int b ) { baud = b; }
+    void setLatency ( int millis ) { latency = millis; }
+    void setLoss ( double percent ) { loss = percent; }
+    void setCorruption ( double percent ) { corruption = percent; }
+    //! measurement output on (like binary output activated) or off until the app activates it
+    void setStreaming ( bool on ) { streaming = on; }
+
+    QString errorString () const { return error; }
+
+public slots:
+    void start ();
+    void report ();
+
+protected slots:
+    void readCommands ();
+    void tick ();
+
+protected:
+    //! bytes of the command at the begin of rx, 0 for an unknown command, -1 if incomplete
+    static int commandLength ( const QByteArray& rx );
+    void command ( const quint8* c );
+    //! a reply frame: STX, tag, the tag - 3 payload bytes, ETX
+    void reply ( QByteArray frame );
+    void ack ( quint8 serial );
+
+    //! the next measurement frame, from the capture or synthesize()
+    QByteArray nextFrame ( quint32 millis );
+    void synthesize ( quint8* frame, quint32 millis );
+    //! applies loss and corruption, writes the frame and occupies the line. false if the pty was full
+    bool send ( const QByteArray& frame );
+
+    int master;
+    int slaveFd;
+    QString slave;
+    QString link;
+    QSocketNotifier* notifier;
+    QTimer* tickTimer;
+    QTimer* reportTimer;
+    QElapsedTimer clock;
+    QString error;
+
+    double rate;
+    int baud;
+    int latency;
+    double loss;
+    double corruption;
+    bool streaming;
+
+    MdRawCaptureReader* capture;
+    QList<int> captureFrames;
+    int captureNext;
+
+    //! received command bytes not handled yet
+    QByteArray rx;
+    //! replies and the clock nsecs they are due
+    QList<QByteArray> replies;
+    QList<qint64> replyDue;
+    qint64 nextFrameNs;
+    qint64 lineFreeNs;
+    quint8 klineFramenum;
+
+    //! device state the commands read and write
+    quint8 dutyMaps[GEARS][MODES][16];
+    quint16 setpointMaps[GEARS][MODES][16];
+    //! aKp aKi aKd cKp cKi cKd aAT cAT (fixed point base 100), flags, max boost
+    quint16 pid[8];
+    quint8 pidFlags;
+    quint16 maxBoost;
+    //! ratios of gear 1-6, fixed point base 1000
+    quint16 gearRatios[6];
+
+    quint32 framesSent;
+    quint32 repliesSent;
+    quint32 commands;
+    quint32 unknownBytes;
+    quint32 framesSkipped;
+    quint32 framesLost;
+    quint32 framesCorrupted;
+    quint32 overrunBytes;
+    quint32 reportFrames;
+    qint64 reportNs;
+};
+
+#endif // MDDEVICEEMULATOR_H
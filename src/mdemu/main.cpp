@@ -0,0 +1,113 @@
+/**
+  * mdemu: a MultiDisplay board on a pseudo terminal for testing the app without hardware.
+  * select the printed port (or --link) in the serial options of the app and connect.
+  */
+
+#include "mdemu/MdDeviceEmulator.h"
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+
+#include <signal.h>
+#include <stdlib.h>
+
+static QTextStream out (stdout);
+static QTextStream err (stderr);
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop ( int ) {
+    stopRequested = 1;
+}
+
+//! quits the event loop after SIGINT / SIGTERM, the emulator removes its link on the way out
+class StopWatcher : public QObject {
+public:
+    StopWatcher ( QObject* parent ) : QObject(parent) {
+        startTimer (100);
+    }
+protected:
+    void timerEvent ( QTimerEvent* ) {
+        if ( stopRequested )
+            QCoreApplication::quit();
+    }
+};
+
+static int usage () {
+    err << "usage: mdemu [options]" << endl
+        << "  --link path        symlink to the pty, a stable port name for the app" << endl
+        << "  --capture file     stream the measurement frames of a mdraw capture instead of synthetic ones" << endl
+        << "  --rate hz|max      measurement frames per second (default 50), max: as many as the line takes" << endl
+        << "  --baud n           line speed the frames are paced at (default 115200), 0: unlimited" << endl
+        << "  --latency ms       delay of the replies to commands" << endl
+        << "  --loss percent     frames and replies never sent" << endl
+        << "  --corrupt percent  frames and replies with a random byte changed" << endl
+        << "  --seed n           random seed of loss, corruption and the synthetic frames" << endl
+        << "  --idle             no measurement frames until the app activates the binary output" << endl;
+    return 2;
+}
+
+int main ( int argc, char *argv[] ) {
+    QCoreApplication a (argc, argv);
+    QStringList args = a.arguments();
+    args.removeFirst();
+
+    MdDeviceEmulator emu;
+    QString link;
+    QString capture;
+    for ( int i = 0 ; i < args.size() ; i++ ) {
+        QString o = args[i];
+        if ( o == "--idle" ) {
+            emu.setStreaming (false);
+            continue;
+        }
+        if ( i + 1 >= args.size() )
+            return usage();
+        QString v = args[++i];
+        bool ok = true;
+        if ( o == "--link" )
+            link = v;
+        else if ( o == "--capture" )
+            capture = v;
+        else if ( o == "--rate" )
+            emu.setRate ( v == "max" ? 0 : v.toDouble (&ok) );
+        else if ( o == "--baud" )
+            emu.setBaud ( v.toInt (&ok) );
+        else if ( o == "--latency" )
+            emu.setLatency ( v.toInt (&ok) );
+        else if ( o == "--loss" )
+            emu.setLoss ( v.toDouble (&ok) );
+        else if ( o == "--corrupt" )
+            emu.setCorruption ( v.toDouble (&ok) );
+        else if ( o == "--seed" )
+            srand ( v.toUInt (&ok) );
+        else
+            return usage();
+        if ( !ok ) {
+            err << "bad value for " << o << ": " << v << endl;
+            return 2;
+        }
+    }
+
+    if ( !capture.isEmpty() && !emu.loadCapture (capture) ) {
+        err << emu.errorString() << endl;
+        return 1;
+    }
+    if ( !emu.open (link) ) {
+        err << emu.errorString() << endl;
+        return 1;
+    }
+    out << "MultiDisplay emulator on " << emu.portName();
+    if ( !link.isEmpty() )
+        out << " (" << link << ")";
+    out << endl;
+
+    signal ( SIGINT, requestStop );
+    signal ( SIGTERM, requestStop );
+    new StopWatcher (&a);
+    emu.start();
+    int res = a.exec();
+    emu.close();
+    return res;
+}
@@ -0,0 +1,985 @@
+/*
+    Copyright 2010 Stephan Martin, Dominik Gummel
+
+    This file is part of Multidisplay.
+
+    Multidisplay is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Multidisplay is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Multidisplay.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+  * mdtool: headless log conversion without the GUI.
+  * every command streams the records, memory does not grow with the log size.
+  */
+
+#include "MdDataRecord.h"
+#include "data/MdChannel.h"
+#include "data/MdChannelCodec.h"
+#include "data/MdSessionColumns.h"
+#include "data/MdSessionFile.h"
+#include "data/MdRawCapture.h"
+#include "data/MdCsvExporter.h"
+#include "com/MdMd2Decoder.h"
+#include "com/MdBinaryProtocol.h"
+#include "com/MdFrameSplitter.h"
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QFile>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <limits>
+#include <stdlib.h>
+
+static QTextStream out (stdout);
+static QTextStream err (stderr);
+
+enum FileKind { Unknown, Legacy, Session, RawCapture, Csv };
+
+static FileKind probe ( const QString& filename ) {
+    quint32 v = MdSessionFile::probeVersion (filename);
+    if ( v == MdFile::VERSION5 )
+        return Session;
+    if ( v == MdFile::VERSION4 || v == MdFile::CVERSION3 || v == MdFile::CVERSION1 )
+        return Legacy;
+    QFile f (filename);
+    if ( f.open (QIODevice::ReadOnly) ) {
+        QDataStream ds (&f);
+        ds.setVersion(QDataStream::Qt_4_6);
+        quint32 magic = 0;
+        ds >> magic;
+        if ( magic == (quint32) MdRawCapture::MAGICNUMBER )
+            return RawCapture;
+    }
+    return Unknown;
+}
+
+//! output format by file extension
+static FileKind target ( const QString& filename ) {
+    QString s = QFileInfo(filename).suffix().toLower();
+    if ( s == "mdv3" )
+        return Session;
+    if ( s == "mdv2" )
+        return Legacy;
+    if ( s == "csv" )
+        return Csv;
+    return Unknown;
+}
+
+
+//! records of a log one by one, the caller takes ownership
+class RecordSource {
+public:
+    virtual ~RecordSource () {}
+    virtual bool open () = 0;
+    virtual MdDataRecord* next () = 0;
+    QString errorString () const { return error; }
+protected:
+    QString error;
+};
+
+class LegacySource : public RecordSource {
+public:
+    LegacySource ( const QString& filename ) : in(filename) {}
+    bool open () {
+        if ( !in.open() ) {
+            error = in.errorString();
+            return false;
+        }
+        return true;
+    }
+    MdDataRecord* next () { return in.next(); }
+protected:
+    MdLegacyImporter in;
+};
+
+//! decodes one chunk at a time
+class SessionSource : public RecordSource {
+public:
+    SessionSource ( const QString& filename ) : reader(filename), chunk(-1), row(0) {}
+    bool open () {
+        if ( !reader.open() ) {
+            error = reader.errorString();
+            return false;
+        }
+        return true;
+    }
+    MdDataRecord* next () {
+        while ( row >= cols.rowCount() ) {
+            if ( ++chunk >= reader.chunkCount() )
+                return NULL;
+            if ( !reader.readChunk (chunk, cols) ) {
+                error = reader.errorString();
+                return NULL;
+            }
+            row = 0;
+        }
+        MdDataRecord* r = new MdDataRecord();
+        cols.assignRecord ( row++, r );
+        return r;
+    }
+protected:
+    MdSessionReader reader;
+    MdSessionColumns cols;
+    int chunk;
+    int row;
+};
+
+class RawCaptureSource : public RecordSource {
+public:
+    RawCaptureSource ( const QString& filename ) : reader(filename), decoder(NULL), frame(0) {}
+    ~RawCaptureSource () { delete decoder; }
+    bool open () {
+        if ( !reader.open() ) {
+            error = reader.errorString();
+            return false;
+        }
+        decoder = new MdMd2Decoder ( reader.decoderVersion() );
+        return true;
+    }
+    MdDataRecord* next () {
+        while ( frame < reader.frameCount() ) {
+            const quint8* f = reader.frame (frame);
+            int len = reader.frameLength (frame);
+            frame++;
+            if ( len < 2 || f[1] != MD_SERIALOUT_BINARY_TAG )
+                continue;
+            MdSensorRecord* sr = decoder->decode ( f, len );
+            if ( !sr )
+                continue;
+            MdDataRecord* r = new MdDataRecord();
+            *r->getSensorR() = *sr;
+            delete sr;
+            return r;
+        }
+        return NULL;
+    }
+protected:
+    MdRawCaptureReader reader;
+    MdMd2Decoder* decoder;
+    int frame;
+};
+
+static RecordSource* openSource ( const QString& filename ) {
+    RecordSource* s = NULL;
+    switch ( probe (filename) ) {
+    case Legacy: s = new LegacySource (filename); break;
+    case Session: s = new SessionSource (filename); break;
+    case RawCapture: s = new RawCaptureSource (filename); break;
+    default:
+        err << filename << ": unknown file format" << endl;
+        return NULL;
+    }
+    if ( !s->open() ) {
+        err << filename << ": " << s->errorString() << endl;
+        delete s;
+        return NULL;
+    }
+    return s;
+}
+
+
+class RecordSink {
+public:
+    RecordSink () : rows(0) {}
+    virtual ~RecordSink () {}
+    virtual bool open () = 0;
+    virtual bool append ( const MdDataRecord* r ) = 0;
+    virtual bool close () = 0;
+    qint64 rowCount () const { return rows; }
+    QString errorString () const { return error; }
+protected:
+    qint64 rows;
+    QString error;
+};
+
+class SessionSink : public RecordSink {
+public:
+    SessionSink ( const QString& filename ) : w(filename) {}
+    bool open () { return check ( w.open() ); }
+    bool append ( const MdDataRecord* r ) { rows++; return check ( w.append (r) ); }
+    bool close () { return check ( w.close() ); }
+protected:
+    bool check ( bool ok ) {
+        if ( !ok )
+            error = w.errorString();
+        return ok;
+    }
+    MdSessionWriter w;
+};
+
+//! VERSION4 file as written by MdData before mdv3
+class LegacySink : public RecordSink {
+public:
+    LegacySink ( const QString& filename ) : f(filename) {}
+    bool open () {
+        if ( !f.open (QIODevice::WriteOnly | QIODevice::Truncate) ) {
+            error = f.errorString();
+            return false;
+        }
+        ds.setDevice (&f);
+        ds.setVersion(QDataStream::Qt_4_6);
+        ds << (quint32) MdFile::MAGICNUMBER;
+        ds << (quint32) MdFile::VERSION4;
+        return true;
+    }
+    bool append ( const MdDataRecord* r ) {
+        ds << const_cast<MdDataRecord*> (r);
+        rows++;
+        return ds.status() == QDataStream::Ok;
+    }
+    bool close () {
+        bool ok = ds.status() == QDataStream::Ok;
+        f.close();
+        if ( !ok )
+            error = "write error";
+        return ok;
+    }
+protected:
+    QFile f;
+    QDataStream ds;
+};
+
+//! formats blocks of MdCsvExporter::BLOCK_ROWS rows
+class CsvSink : public RecordSink {
+public:
+    CsvSink ( const QString& filename, const MdCsvExporter& exporter ) : f(filename), exporter(exporter) {
+        block.setChannels ( exporter.blockChannels() );
+    }
+    bool open () {
+        if ( !f.open (QIODevice::WriteOnly | QIODevice::Truncate) ) {
+            error = f.errorString();
+            return false;
+        }
+        return write ( exporter.header() );
+    }
+    bool append ( const MdDataRecord* r ) {
+        block.appendRecord (r);
+        if ( block.rowCount() >= MdCsvExporter::BLOCK_ROWS )
+            return flush();
+        return true;
+    }
+    bool close () {
+        bool ok = flush();
+        f.close();
+        return ok;
+    }
+protected:
+    bool flush () {
+        text.resize (0);
+        rows += exporter.format ( block, text );
+        block.clear();
+        return write (text);
+    }
+    bool write ( const QByteArray& a ) {
+        if ( f.write (a) != a.size() ) {
+            error = f.errorString();
+            return false;
+        }
+        return true;
+    }
+    QFile f;
+    const MdCsvExporter& exporter;
+    MdSessionColumns block;
+    QByteArray text;
+};
+
+static RecordSink* createSink ( const QString& filename, const MdCsvExporter& exporter ) {
+    switch ( target (filename) ) {
+    case Session: return new SessionSink (filename);
+    case Legacy: return new LegacySink (filename);
+    case Csv: return new CsvSink (filename, exporter);
+    default:
+        err << filename << ": unknown target format, use .mdv3, .mdv2 or .csv" << endl;
+        return NULL;
+    }
+}
+
+
+//! command line options shared by the commands
+class Options {
+public:
+    Options () : from(0), to(-1), continuous(false), corrupt(0), block(64) {}
+
+    //! removes the known options from args, false on a bad value
+    bool parse ( QStringList& args ) {
+        for ( int i = 0 ; i < args.size() ; ) {
+            QString a = args[i];
+            bool value = i + 1 < args.size();
+            bool ok = true;
+            if ( a == "--from" && value ) {
+                from = args[i+1].toInt (&ok);
+            } else if ( a == "--to" && value ) {
+                to = args[i+1].toInt (&ok);
+            } else if ( a == "--channels" && value ) {
+                foreach ( QString name, args[i+1].split (',', QString::SkipEmptyParts) ) {
+                    int id = channelId (name.trimmed());
+                    if ( id < 0 ) {
+                        err << "unknown channel " << name << endl;
+                        return false;
+                    }
+                    channels.append (id);
+                }
+            } else if ( a == "--separator" && value ) {
+                QString s = args[i+1] == "\\t" ? QString("\t") : args[i+1];
+                exporter.setSeparator ( s.isEmpty() ? '\t' : s.at(0).toLatin1() );
+            } else if ( a == "--decimals" && value ) {
+                exporter.setDecimals ( args[i+1].toInt (&ok) );
+            } else if ( a == "--corrupt" && value ) {
+                corrupt = args[i+1].toInt (&ok);
+            } else if ( a == "--block" && value ) {
+                block = args[i+1].toInt (&ok);
+                ok = ok && block > 0;
+            } else if ( a == "--continuous" ) {
+                continuous = true;
+                args.removeAt (i);
+                continue;
+            } else {
+                i++;
+                continue;
+            }
+            if ( !ok ) {
+                err << "bad value for " << a << ": " << args[i+1] << endl;
+                return false;
+            }
+            args.removeAt (i);
+            args.removeAt (i);
+        }
+        exporter.setChannels (channels);
+        exporter.setTimeRange (from, to);
+        return true;
+    }
+
+    bool inRange ( const MdDataRecord* r ) const {
+        int t = r->getSensorR()->getTime();
+        return t >= from && (to < 0 || t <= to);
+    }
+
+    static int channelId ( const QString& name ) {
+        for ( int id = 0 ; id < MdChannel::Count ; id++ )
+            if ( name == MdChannel::descriptor(id).name )
+                return id;
+        return -1;
+    }
+
+    qint32 from;
+    qint32 to;
+    QList<int> channels;
+    bool continuous;
+    //! split: about every corrupt-th byte is replaced, 0: none
+    int corrupt;
+    //! split: bytes per read of the port
+    int block;
+    MdCsvExporter exporter;
+};
+
+
+/**
+  * streams the records of the sources in the time range into target.
+  * continuous: the times of each further source continue after the previous one
+  */
+static int copy ( const QStringList& sources, const QString& targetFile, const Options& opt ) {
+    RecordSink* sink = createSink ( targetFile, opt.exporter );
+    if ( !sink )
+        return 1;
+    if ( !sink->open() ) {
+        err << targetFile << ": " << sink->errorString() << endl;
+        delete sink;
+        return 1;
+    }
+    bool ok = true;
+    qint64 shift = 0;
+    qint64 lastTime = -1;
+    foreach ( QString src, sources ) {
+        RecordSource* in = openSource (src);
+        if ( !in ) {
+            ok = false;
+            break;
+        }
+        bool first = true;
+        MdDataRecord* r;
+        while ( ok && (r = in->next()) != NULL ) {
+            if ( opt.continuous ) {
+                if ( first && lastTime >= 0 )
+                    shift = lastTime + 1 - r->getSensorR()->getTime();
+                r->getSensorR()->setTime ( r->getSensorR()->getTime() + shift );
+            }
+            first = false;
+            if ( opt.inRange (r) ) {
+                ok = sink->append (r);
+                lastTime = r->getSensorR()->getTime();
+            }
+            delete r;
+        }
+        if ( ok && !in->errorString().isEmpty() ) {
+            err << src << ": " << in->errorString() << endl;
+            ok = false;
+        }
+        delete in;
+    }
+    if ( !sink->close() )
+        ok = false;
+    if ( !ok && !sink->errorString().isEmpty() )
+        err << targetFile << ": " << sink->errorString() << endl;
+    if ( ok )
+        out << targetFile << ": " << sink->rowCount() << " rows" << endl;
+    delete sink;
+    return ok ? 0 : 1;
+}
+
+/**
+  * mdv3 -> mdv3 in a time range by chunk: the chunk directory tells which chunks miss the
+  * range (not read at all) and which lie inside it (copied as a whole chunk, no records).
+  * only the rows of the chunks at the borders go through a record.
+  */
+static int sliceSession ( const QString& in, const QString& outFile, const Options& opt ) {
+    MdSessionReader reader (in);
+    if ( !reader.open() ) {
+        err << in << ": " << reader.errorString() << endl;
+        return 1;
+    }
+    MdSessionWriter w (outFile);
+    if ( !w.open() ) {
+        err << outFile << ": " << w.errorString() << endl;
+        return 1;
+    }
+    bool ok = true;
+    MdSessionColumns cols;
+    MdDataRecord r;
+    for ( int c = 0 ; ok && c < reader.chunkCount() ; c++ ) {
+        const MdSessionChunkInfo& ci = reader.chunkInfo (c);
+        if ( ci.timeEnd < opt.from || (opt.to >= 0 && ci.timeBegin > opt.to) )
+            continue;
+        if ( !reader.readChunk (c, cols) ) {
+            err << in << ": " << reader.errorString() << endl;
+            return 1;
+        }
+        //begin and end are the first and the last row, the times between are not sorted after a reset of the MD
+        int inside = 0;
+        for ( int row = 0 ; row < cols.rowCount() ; row++ ) {
+            qint32 t = cols.value<qint32> (MdChannel::Time, row);
+            if ( t >= opt.from && (opt.to < 0 || t <= opt.to) )
+                inside++;
+        }
+        if ( inside == cols.rowCount() ) {
+            ok = w.appendChunk (cols);
+            continue;
+        }
+        for ( int row = 0 ; ok && inside > 0 && row < cols.rowCount() ; row++ ) {
+            cols.assignRecord ( row, &r );
+            if ( opt.inRange (&r) )
+                ok = w.append (&r);
+        }
+    }
+    if ( !w.close() )
+        ok = false;
+    if ( !ok ) {
+        err << outFile << ": " << w.errorString() << endl;
+        return 1;
+    }
+    out << outFile << ": " << w.rowCount() << " rows" << endl;
+    return 0;
+}
+
+static int convert ( const QString& in, const QString& outFile, const Options& opt ) {
+    //whole chunks are copied without decoding them into records
+    if ( probe (in) == Session && target (outFile) == Session && (opt.from != 0 || opt.to >= 0) )
+        return sliceSession ( in, outFile, opt );
+    //captures are decoded in parallel chunks
+    if ( probe (in) == RawCapture && target (outFile) == Session && opt.from == 0 && opt.to < 0 ) {
+        QString e;
+        if ( !MdRawCapture::decodeToSession ( in, outFile, 0, &e ) ) {
+            err << in << ": " << e << endl;
+            return 1;
+        }
+        out << outFile << ": done" << endl;
+        return 0;
+    }
+    return copy ( QStringList() << in, outFile, opt );
+}
+
+static int csv ( const QString& in, const QString& outFile, Options& opt ) {
+    if ( probe (in) == Session ) {
+        //only the exported channels are decoded, blocks are formatted in parallel
+        if ( !opt.exporter.exportSession ( in, outFile ) ) {
+            err << outFile << ": " << opt.exporter.errorString() << endl;
+            return 1;
+        }
+        out << outFile << ": " << opt.exporter.rowsWritten() << " rows" << endl;
+        return 0;
+    }
+    return copy ( QStringList() << in, outFile, opt );
+}
+
+static int stats ( const QString& filename ) {
+    FileKind kind = probe (filename);
+    out << filename << endl;
+    switch ( kind ) {
+    case Legacy:
+        out << "  format:   mdv2 (version " << MdSessionFile::probeVersion (filename) << ")" << endl;
+        break;
+    case Session: {
+        MdSessionReader reader (filename);
+        if ( reader.open() )
+            out << "  format:   mdv3, " << reader.chunkCount() << " chunks" << endl;
+        break;
+    }
+    case RawCapture: {
+        MdRawCaptureReader reader (filename);
+        if ( reader.open() ) {
+            out << "  format:   mdraw, MD2 decoder version " << reader.decoderVersion()
+                << ", " << reader.frameCount() << " frames" << (reader.isTruncated() ? " (truncated)" : "") << endl;
+            out << "  captured: " << QDateTime::fromMSecsSinceEpoch (reader.startTime()).toString (Qt::ISODate) << endl;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    out << "  size:     " << QFileInfo(filename).size() << " bytes" << endl;
+
+    RecordSource* in = openSource (filename);
+    if ( !in )
+        return 1;
+
+    //min / max of the physical values, one block at a time
+    QVector<double> lo ( MdChannel::Count, std::numeric_limits<double>::max() );
+    QVector<double> hi ( MdChannel::Count, -std::numeric_limits<double>::max() );
+    MdSessionColumns block;
+    qint64 rows = 0;
+    bool more = true;
+    while ( more ) {
+        MdDataRecord* r = in->next();
+        if ( r ) {
+            block.appendRecord (r);
+            delete r;
+        } else
+            more = false;
+        if ( block.rowCount() >= MdCsvExporter::BLOCK_ROWS || (!more && block.rowCount() > 0) ) {
+            for ( int id = 0 ; id < MdChannel::Count ; id++ ) {
+                const MdChannel::Descriptor& d = MdChannel::descriptor(id);
+                if ( !(d.usage & MdChannel::Plot) )
+                    continue;
+                for ( int row = 0 ; row < block.rowCount() ; row++ ) {
+                    double v = block.toDouble (id, row) * d.scale;
+                    lo[id] = qMin (lo[id], v);
+                    hi[id] = qMax (hi[id], v);
+                }
+            }
+            rows += block.rowCount();
+            block.clear();
+        }
+    }
+    bool ok = in->errorString().isEmpty();
+    if ( !ok )
+        err << filename << ": " << in->errorString() << endl;
+    delete in;
+
+    out << "  rows:     " << rows << endl;
+    if ( rows > 0 ) {
+        out << "  time:     " << lo[MdChannel::Time] << " - " << hi[MdChannel::Time] << " ms ("
+            << (hi[MdChannel::Time] - lo[MdChannel::Time]) / 1000.0 << " s)" << endl;
+        for ( int id = 0 ; id < MdChannel::Count ; id++ ) {
+            const MdChannel::Descriptor& d = MdChannel::descriptor(id);
+            if ( id == MdChannel::Time || !(d.usage & MdChannel::Plot) )
+                continue;
+            //channels which never changed are not interesting
+            if ( lo[id] == hi[id] )
+                continue;
+            out << "  " << QString(d.name).leftJustified (28) << " " << lo[id] << " .. " << hi[id] << " " << d.unit << endl;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+/**
+  * runs the frame splitter over a recorded byte stream, the frames of a raw capture back to
+  * back or any dump of the port, in reads of opt.block bytes. --corrupt n replaces about
+  * every n-th byte with a random one (same bytes every run) to measure the resync.
+  */
+static int split ( const QString& filename, const Options& opt ) {
+    QByteArray stream;
+    if ( probe (filename) == RawCapture ) {
+        MdRawCaptureReader reader (filename);
+        if ( !reader.open() ) {
+            err << filename << ": " << reader.errorString() << endl;
+            return 1;
+        }
+        for ( int i = 0 ; i < reader.frameCount() ; i++ )
+            stream.append ( (const char*) reader.frame (i), reader.frameLength (i) );
+    } else {
+        QFile f (filename);
+        if ( !f.open (QIODevice::ReadOnly) ) {
+            err << filename << ": " << f.errorString() << endl;
+            return 1;
+        }
+        stream = f.readAll();
+    }
+    if ( stream.isEmpty() ) {
+        err << filename << ": no bytes" << endl;
+        return 1;
+    }
+    if ( opt.corrupt > 0 ) {
+        srand (1);
+        for ( int i = rand() % opt.corrupt ; i < stream.size() ; i += 1 + rand() % (2 * opt.corrupt) )
+            stream[i] = (char) (rand() & 0xFF);
+    }
+
+    //whole passes until a second is measured
+    const quint8* d = (const quint8*) stream.constData();
+    MdFrameSplitter splitter;
+    quint32 check = 0;
+    int passes = 0;
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        splitter.resetCounters();
+        for ( int p = 0 ; p < stream.size() ; p += opt.block ) {
+            splitter.feed ( d + p, qMin ( opt.block, stream.size() - p ) );
+            int length;
+            while ( const quint8* frame = splitter.next (length) )
+                check += frame[length - 2];
+        }
+        splitter.reset();
+        passes++;
+    } while ( timer.elapsed() < 1000 );
+    double seconds = timer.nsecsElapsed() / 1e9;
+
+    out << filename << ": " << stream.size() << " bytes in reads of " << opt.block << endl;
+    out << "  frames:     " << splitter.frameCount() << endl;
+    out << "  lost sync:  " << splitter.badFrameCount() << " without ETX, " << splitter.badTagCount() << " without tag" << endl;
+    out << "  skipped:    " << splitter.noiseBytes() << " bytes" << endl;
+    out << "  throughput: " << qRound ( passes * stream.size() / seconds / 1e6 ) << " MB/s, "
+        << qRound ( passes * (double) splitter.frameCount() / seconds ) << " frames/s (" << passes << " passes, check " << check << ")" << endl;
+    return 0;
+}
+
+/**
+  * decode cost of the MD2 frames: decode() into one record per frame against
+  * decodeColumns() over all frames at once, each repeated until a second is measured.
+  * without a capture 4096 random frames (same bytes every run) of every frame version.
+  */
+static void decodeSpeed ( const QByteArray& frames, int version, const QString& what ) {
+    MdMd2Decoder dec (version);
+    int length = MdMd2Decoder::frameLength (version);
+    int count = frames.size() / length;
+    const quint8* d = (const quint8*) frames.constData();
+
+    MdSensorRecord r;
+    double check = 0;
+    qint64 decoded = 0;
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        for ( int i = 0 ; i < count ; i++ ) {
+            dec.decode ( d + i * length, length, &r );
+            check += r.getRpm();
+        }
+        decoded += count;
+    } while ( timer.elapsed() < 1000 );
+    double record = timer.nsecsElapsed() / (double) decoded;
+
+    QVector<QByteArray> cols ( MdChannel::Count );
+    QVector<QByteArray*> dest ( MdChannel::Count, (QByteArray*) NULL );
+    for ( int c = 0 ; c < MdChannel::Count ; c++ )
+        if ( MdMd2Decoder::field (c) )
+            dest[c] = &cols[c];
+    decoded = 0;
+    timer.restart();
+    do {
+        for ( int c = 0 ; c < MdChannel::Count ; c++ )
+            cols[c].resize (0);
+        dec.decodeColumns ( d, length, count, dest.constData() );
+        check += cols[MdChannel::Rpm].size();
+        decoded += count;
+    } while ( timer.elapsed() < 1000 );
+    double columns = timer.nsecsElapsed() / (double) decoded;
+
+    out << count << " frames of version " << version << " (" << what << ")" << endl;
+    out << "  decode():        " << QString::number ( record, 'f', 1 ) << " ns/frame" << endl;
+    out << "  decodeColumns(): " << QString::number ( columns, 'f', 1 ) << " ns/frame (check " << check << ")" << endl;
+}
+
+static int decode ( const QString& filename ) {
+    if ( filename.isEmpty() ) {
+        srand (1);
+        for ( int v = MdMd2Decoder::VERSION_2012 ; v <= MdMd2Decoder::VERSION_COUNT ; v++ ) {
+            QByteArray frames ( 4096 * MdMd2Decoder::frameLength (v), 0 );
+            for ( int i = 0 ; i < frames.size() ; i++ )
+                frames[i] = (char) (rand() & 0xFF);
+            decodeSpeed ( frames, v, "random" );
+        }
+        return 0;
+    }
+
+    MdRawCaptureReader reader (filename);
+    if ( !reader.open() ) {
+        err << filename << ": " << reader.errorString() << endl;
+        return 1;
+    }
+    //the measurement frames back to back
+    int length = MdMd2Decoder::frameLength ( reader.decoderVersion() );
+    QByteArray frames;
+    for ( int i = 0 ; i < reader.frameCount() ; i++ )
+        if ( reader.frameLength (i) == length && reader.frame (i)[1] == length )
+            frames.append ( (const char*) reader.frame (i), length );
+    if ( frames.isEmpty() ) {
+        err << filename << ": no measurement frames" << endl;
+        return 1;
+    }
+    decodeSpeed ( frames, reader.decoderVersion(), filename );
+    return 0;
+}
+
+//! a typed array as the block a codec gets
+template <typename T> static QByteArray block ( const QVector<T>& v ) {
+    return QByteArray ( reinterpret_cast<const char*> (v.constData()), v.size() * sizeof(T) );
+}
+
+template <typename T> static T randomValue () {
+    T v;
+    quint8* p = reinterpret_cast<quint8*> (&v);
+    for ( unsigned b = 0 ; b < sizeof(T) ; b++ )
+        p[b] = (quint8) rand();
+    return v;
+}
+
+/**
+  * blocks at the limits of an integer type: empty, a single value, jumps between min and
+  * max (differences that wrap), a ramp that wraps, a run longer than one varint byte, random values
+  */
+template <typename T> static QList<QByteArray> integerBlocks () {
+    const T lo = std::numeric_limits<T>::min();
+    const T hi = std::numeric_limits<T>::max();
+    QList<QByteArray> blocks;
+    QVector<T> v;
+    blocks << block (v);
+    v << hi;
+    blocks << block (v);
+    v.clear();
+    v << lo << hi << lo << hi << 0 << (T) 1 << (T) -1 << hi << hi << lo << lo;
+    blocks << block (v);
+    v.clear();
+    for ( int i = 0 ; i < 4096 ; i++ )
+        v << (T) (i * 20);
+    blocks << block (v);
+    v.fill ( (T) 42, 300 );
+    blocks << block (v);
+    v.clear();
+    for ( int i = 0 ; i < 4096 ; i++ )
+        v << randomValue<T>();
+    blocks << block (v);
+    return blocks;
+}
+
+//! the same for doubles plus the special values: signed zeros, limits, denormals, infinities, NaN
+static QList<QByteArray> doubleBlocks () {
+    typedef std::numeric_limits<double> L;
+    QList<QByteArray> blocks;
+    QVector<double> v;
+    blocks << block (v);
+    v << 1.5;
+    blocks << block (v);
+    v.clear();
+    v << 0.0 << -0.0 << 1.0 << -1.0 << L::max() << -L::max() << L::min() << L::denorm_min()
+      << L::infinity() << -L::infinity() << L::quiet_NaN() << 0.0;
+    blocks << block (v);
+    v.clear();
+    for ( int i = 0 ; i < 4096 ; i++ )
+        v << 1.0 + i * 0.01;
+    blocks << block (v);
+    v.fill ( 0.5, 300 );
+    blocks << block (v);
+    v.clear();
+    for ( int i = 0 ; i < 4096 ; i++ )
+        v << randomValue<double>();
+    blocks << block (v);
+    return blocks;
+}
+
+static QList<QByteArray> testBlocks ( int type ) {
+    switch ( type ) {
+    case MdChannel::TypeUInt8:
+        return integerBlocks<quint8>();
+    case MdChannel::TypeUInt16:
+        return integerBlocks<quint16>();
+    case MdChannel::TypeInt32:
+        return integerBlocks<qint32>();
+    case MdChannel::TypeInt64:
+        return integerBlocks<qint64>();
+    case MdChannel::TypeDouble:
+        return doubleBlocks();
+    }
+    return QList<QByteArray>();
+}
+
+/**
+  * every block has to come back bit for bit (NaNs included), a block cut by its last
+  * byte has to be rejected. raw and encoded count the bytes
+  */
+static bool roundTrip ( const MdChannelCodec* c, int type, qint64& raw, qint64& encoded ) {
+    int ts = MdChannel::typeSize (type);
+    QList<QByteArray> blocks = testBlocks (type);
+    bool ok = true;
+    for ( int i = 0 ; i < blocks.size() ; i++ ) {
+        const QByteArray& values = blocks[i];
+        int rows = values.size() / ts;
+        QByteArray enc;
+        c->encode ( type, values, rows, enc );
+        QByteArray dec;
+        if ( !c->decode ( type, enc.constData(), enc.size(), rows, dec ) || dec != values ) {
+            err << "  block " << i << " (" << rows << " rows) does not round trip" << endl;
+            ok = false;
+        } else if ( !enc.isEmpty() && c->decode ( type, enc.constData(), enc.size() - 1, rows, dec ) ) {
+            err << "  block " << i << " (" << rows << " rows) cut by a byte is accepted" << endl;
+            ok = false;
+        }
+        raw += values.size();
+        encoded += enc.size();
+    }
+    return ok;
+}
+
+//! decoded values per second of a block, repeated until a second is measured
+template <typename T> static double decodeRate ( const MdChannelCodec* c, int type, const QVector<T>& v, int& encodedBytes ) {
+    QByteArray enc;
+    c->encode ( type, block (v), v.size(), enc );
+    encodedBytes = enc.size();
+    QByteArray dec;
+    qint64 values = 0;
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        for ( int i = 0 ; i < 100 ; i++ )
+            c->decode ( type, enc.constData(), enc.size(), v.size(), dec );
+        values += 100 * v.size();
+    } while ( timer.elapsed() < 1000 );
+    return values / ( timer.nsecsElapsed() / 1e9 );
+}
+
+/**
+  * round trip of every channel codec with every type it supports (see roundTrip()), then the
+  * decode throughput on a chunk of log-like rows: steady timestamps, a rpm random walk,
+  * flag bytes and a boost double of the MD2 resolution (1/100)
+  */
+static int codecs () {
+    static const char* codecNames[] = { "raw", "delta-delta", "zigzag varint", "run length", "xor float" };
+    static const char* typeNames[] = { "", "uint8", "uint16", "int32", "int64", "double" };
+
+    srand (1);
+    bool ok = true;
+    for ( int id = MdChannelCodec::DeltaDelta ; id <= MdChannelCodec::XorFloat ; id++ ) {
+        const MdChannelCodec* c = MdChannelCodec::get (id);
+        for ( int type = MdChannel::TypeUInt8 ; type <= MdChannel::TypeDouble ; type++ ) {
+            if ( !c->supports (type) )
+                continue;
+            qint64 raw = 0;
+            qint64 encoded = 0;
+            bool res = roundTrip ( c, type, raw, encoded );
+            out << QString ( "%1 %2" ).arg ( codecNames[id], -14 ).arg ( typeNames[type], -7 )
+                << ( res ? "ok" : "FAILED" ) << " (" << raw << " -> " << encoded << " bytes)" << endl;
+            ok = ok && res;
+        }
+    }
+    //control bytes the xor float encoder never writes: a trail of 8 or more bytes
+    const char malformed[] = { 0x08, 0x0F };
+    for ( int i = 0 ; i < 2 ; i++ ) {
+        QByteArray dec;
+        if ( MdChannelCodec::get (MdChannelCodec::XorFloat)->decode ( MdChannel::TypeDouble, malformed + i, 1, 1, dec ) ) {
+            err << "xor float accepts the control byte " << QString::number ( (int) malformed[i], 16 ) << endl;
+            ok = false;
+        }
+    }
+
+    const int rows = MdSessionFile::DEFAULT_CHUNK_ROWS;
+    QVector<qint32> time;
+    QVector<qint32> rpm;
+    QVector<quint8> flags;
+    QVector<double> boost;
+    qint32 t = 0;
+    qint32 r = 2000;
+    int b = 100;
+    for ( int i = 0 ; i < rows ; i++ ) {
+        t += 19 + rand() % 3;
+        r += rand() % 41 - 20;
+        b += rand() % 5 - 2;
+        time << t;
+        rpm << r;
+        flags << (quint8) ( (i / 50) % 4 ? 0x10 : 0x11 );
+        boost << b / 100.0 - 1;
+    }
+    int bytes;
+    double rate = decodeRate ( MdChannelCodec::get (MdChannelCodec::DeltaDelta), MdChannel::TypeInt32, time, bytes );
+    out << "decode time (delta-delta):    " << qRound ( rate / 1e6 ) << " M values/s, " << QString::number ( bytes / (double) rows, 'f', 2 ) << " bytes/row" << endl;
+    rate = decodeRate ( MdChannelCodec::get (MdChannelCodec::ZigZagVarint), MdChannel::TypeInt32, rpm, bytes );
+    out << "decode rpm (zigzag varint):   " << qRound ( rate / 1e6 ) << " M values/s, " << QString::number ( bytes / (double) rows, 'f', 2 ) << " bytes/row" << endl;
+    rate = decodeRate ( MdChannelCodec::get (MdChannelCodec::RunLength), MdChannel::TypeUInt8, flags, bytes );
+    out << "decode flags (run length):    " << qRound ( rate / 1e6 ) << " M values/s, " << QString::number ( bytes / (double) rows, 'f', 2 ) << " bytes/row" << endl;
+    rate = decodeRate ( MdChannelCodec::get (MdChannelCodec::XorFloat), MdChannel::TypeDouble, boost, bytes );
+    out << "decode boost (xor float):     " << qRound ( rate / 1e6 ) << " M values/s, " << QString::number ( bytes / (double) rows, 'f', 2 ) << " bytes/row" << endl;
+    return ok ? 0 : 1;
+}
+
+static int usage () {
+    err << "usage: mdtool <command> [options]" << endl
+        << "  convert <in> <out>           mdv2 / mdv3 / mdraw -> mdv2 / mdv3 / csv (by extension)" << endl
+        << "  slice <in> <out> --from ms --to ms" << endl
+        << "  cat <out> <in>... [--continuous]   concatenate logs, --continuous shifts the times" << endl
+        << "  csv <in> <out> [--channels a,b,..] [--from ms] [--to ms] [--separator c] [--decimals n]" << endl
+        << "  stats <in>..." << endl
+        << "  split <in> [--block bytes] [--corrupt n]   frame splitter throughput on a capture / port dump" << endl
+        << "  decode [<in.mdraw>]          MD2 decode cost per frame, random frames without a capture" << endl
+        << "  codecs                       round trip check and decode throughput of the channel codecs" << endl
+        << "  --from / --to limit every command to a time range (msecs)" << endl;
+    return 2;
+}
+
+int main ( int argc, char *argv[] ) {
+    QCoreApplication a (argc, argv);
+    QStringList args = a.arguments();
+    args.removeFirst();
+
+    Options opt;
+    if ( !opt.parse (args) )
+        return 2;
+    if ( args.isEmpty() )
+        return usage();
+
+    QString cmd = args.takeFirst();
+    if ( (cmd == "convert" || cmd == "slice") && args.size() == 2 )
+        return convert ( args[0], args[1], opt );
+    if ( cmd == "cat" && args.size() >= 2 ) {
+        QString target = args.takeFirst();
+        return copy ( args, target, opt );
+    }
+    if ( cmd == "csv" && args.size() == 2 )
+        return csv ( args[0], args[1], opt );
+    if ( cmd == "stats" && !args.isEmpty() ) {
+        int res = 0;
+        foreach ( QString f, args )
+            res = qMax ( res, stats (f) );
+        return res;
+    }
+    if ( cmd == "split" && args.size() == 1 )
+        return split ( args[0], opt );
+    if ( cmd == "codecs" && args.isEmpty() )
+        return codecs();
+    if ( cmd == "decode" && args.size() <= 1 )
+        return decode ( args.value (0) );
+    return usage();
+}
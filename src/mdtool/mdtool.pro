@@ -0,0 +1,55 @@
+#headless log tool, only the data and file format layer of the app
+TEMPLATE = app
+TARGET = mdtool
+QT = core
+CONFIG += console
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+MOC_DIR=./moc
+OBJECTS_DIR=./obj
+
+HEADERS += ../MdDataRecord.h \
+    ../MdDataRecordV1.h \
+    ../MdDataRecordV2.h \
+    ../Map16x1.h \
+    ../mobile/MobileSensorRecord.h \
+    ../data/MdChannel.h \
+    ../data/MdChannelCodec.h \
+    ../data/MdSessionColumns.h \
+    ../data/MdSessionFile.h \
+    ../data/MdRawCapture.h \
+    ../data/MdCsvExporter.h \
+    ../data/MdLodPyramid.h \
+    ../data/MdChunkSource.h \
+    ../data/MdSessionStore.h \
+    ../data/MdSpillFile.h \
+    ../data/MdTimeIndex.h \
+    ../data/MdSessionSnapshot.h \
+    ../data/MdGpsFix.h \
+    ../thread/workerjob.h \
+    ../com/MdMd2Decoder.h \
+    ../com/MdFrameSplitter.h
+
+SOURCES += main.cpp \
+    ../MdDataRecord.cpp \
+    ../MdDataRecordV1.cpp \
+    ../MdDataRecordV2.cpp \
+    ../Map16x1.cpp \
+    ../mobile/MobileSensorRecord.cpp \
+    ../data/MdChannel.cpp \
+    ../data/MdChannelCodec.cpp \
+    ../data/MdSessionColumns.cpp \
+    ../data/MdSessionFile.cpp \
+    ../data/MdRawCapture.cpp \
+    ../data/MdCsvExporter.cpp \
+    ../data/MdLodPyramid.cpp \
+    ../data/MdSessionStore.cpp \
+    ../data/MdSpillFile.cpp \
+    ../data/MdTimeIndex.cpp \
+    ../data/MdSessionSnapshot.cpp \
+    ../data/MdGpsFix.cpp \
+    ../thread/workerjob.cpp \
+    ../com/MdMd2Decoder.cpp \
+    ../com/MdFrameSplitter.cpp
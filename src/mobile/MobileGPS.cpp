@@ -72,6 +72,16 @@ void MobileGPS::positionUpdated(const QGeoPositionInfo &info) {
     lastPositionInfo = info;
     gpsUpdateCount++;
     QGeoCoordinate newCoord = info.coordinate();
+    if ( info.isValid() ) {
+        fix.timestamp = info.timestamp().toMSecsSinceEpoch();
+        fix.latitude = newCoord.latitude();
+        fix.longitude = newCoord.longitude();
+        fix.altitude = newCoord.altitude();
+        fix.groundSpeed = info.attribute(QGeoPositionInfo::GroundSpeed);
+        fix.direction = info.attribute(QGeoPositionInfo::Direction);
+        fix.horizontalAccuracy = info.attribute(QGeoPositionInfo::HorizontalAccuracy);
+        fix.verticalAccuracy = info.attribute(QGeoPositionInfo::VerticalAccuracy);
+    }
     if ( lastCoord != newCoord ) {
 //        qDebug() << "Position updated:" << newCoord.toString();
         MdPos* e =  new MdPos();
@@ -186,6 +196,7 @@ bool MobileGPS::loadTrackBinary(QString fn)
 
 void MobileGPS::clearData()
 {
+    fix = MdGpsFix();
     foreach (MdPos* p , track ) {
         if ( p )
             delete (p);
@@ -8,6 +8,7 @@
 
 
 #include "MdGpsSerial.h"
+#include "data/MdGpsFix.h"
 
 #if defined Q_WS_MAEMO_5
 QTM_USE_NAMESPACE
@@ -39,6 +40,8 @@ public:
 
     QGeoPositionInfo& lastPos() { return lastPositionInfo; };
     quint32 updateCount () { return gpsUpdateCount; };
+    //! the MD records copy its numbers
+    const MdGpsFix& lastFix () const { return fix; }
 
     int millisSinceLastGpsUpdate;
     int elapsedSinceLastMdFrame;
@@ -56,6 +59,7 @@ private:
     QGeoPositionInfo lastPositionInfo;
     QGeoCoordinate lastCoord;
     QList<MdPos*> track;
+    MdGpsFix fix;
     quint32 gpsUpdateCount;
     QTime freqMeasure;
     QTime deltaMdFrame;
@@ -1,44 +1,32 @@
 #include "MobileSensorRecord.h"
+#include "data/MdGpsFix.h"
 
-#include <QVariant>
+#include <QDateTime>
 
 MobileSensorRecord::MobileSensorRecord()
-    : accX(0), accY(0), accZ(0), mdTimestamp(0), gpsAltitude(0), gpsGroundSpeed(0),
+    : accX(0), accY(0), accZ(0), mdTimestamp(0), gpsTimestamp(-1), gpsLatitude(0), gpsLongitude(0),
+      gpsAltitude(0), gpsGroundSpeed(0),
       gpsDirection(0), gpsHorizontalAccuracy(0), gpsVerticalAccuracy(0), gpsValid(false)
 {
 }
 
 MobileSensorRecord::MobileSensorRecord(qreal &accX, qreal &accY, qreal &accZ, int &mdTimestamp,
-                                       QDateTime &gpsTimestamp, QString &gpsCoordinateString,
+                                       qint64 gpsTimestamp, double gpsLatitude, double gpsLongitude,
                                        qreal &gpsAltitude, qreal &gpsGroundSpeed, qreal &gpsDirection,
                                        qreal &gpsHorizontalAccuracy, qreal &gpsVerticalAccuracy,
                                        bool &gpsValid, quint32 gpsUpdateCount)
     : accX(accX), accY(accY), accZ(accZ), mdTimestamp(mdTimestamp), gpsTimestamp(gpsTimestamp),
-      gpsCoordinateString(gpsCoordinateString), gpsAltitude(gpsAltitude), gpsGroundSpeed(gpsGroundSpeed),
+      gpsLatitude(gpsLatitude), gpsLongitude(gpsLongitude), gpsAltitude(gpsAltitude), gpsGroundSpeed(gpsGroundSpeed),
       gpsDirection(gpsDirection), gpsHorizontalAccuracy(gpsHorizontalAccuracy),
       gpsVerticalAccuracy(gpsVerticalAccuracy),
       gpsValid(gpsValid), gpsUpdateCount(gpsUpdateCount)
 {
 }
 
-QVariant MobileSensorRecord::getColumn ( const int & column ) {
-    switch ( column ) {
-    case 48:
-        return gpsCoordinateString;
-        break;
-    case 49:
-        return gpsGroundSpeed;
-        break;
-    case 50:
-        return gpsAltitude;
-        break;
-    case 51:
-        return QString ( QString::number(accX, 'f', 2) + " | "
-                         + QString::number(accY,'f',2) + " | "
-                         + QString::number(accZ, 'f',2) );
-        break;
-    }
-    return QVariant();
+QString MobileSensorRecord::gpsCoordinateString () const {
+    if ( gpsTimestamp < 0 )
+        return QString();
+    return MdGpsFix::coordinateString ( gpsLatitude, gpsLongitude );
 }
 
 QDataStream& operator<< (QDataStream& s, MobileSensorRecord* b) {
@@ -46,8 +34,9 @@ QDataStream& operator<< (QDataStream& s, MobileSensorRecord* b) {
     s << b->accY;
     s << b->accZ;
     s << b->mdTimestamp;
-    s << b->gpsTimestamp;
-    s << b->gpsCoordinateString;
+    //the mdv2 layout: a QDateTime and the coordinate text
+    s << ( b->gpsTimestamp < 0 ? QDateTime() : QDateTime::fromMSecsSinceEpoch (b->gpsTimestamp) );
+    s << b->gpsCoordinateString();
     s << b->gpsAltitude;
     s << b->gpsGroundSpeed;
     s << b->gpsDirection;
@@ -64,8 +53,15 @@ QDataStream& operator>> (QDataStream& s, MobileSensorRecord* b) {
     s >> b->accY;
     s >> b->accZ;
     s >> b->mdTimestamp;
-    s >> b->gpsTimestamp;
-    s >> b->gpsCoordinateString;
+    QDateTime t;
+    QString coordinate;
+    s >> t;
+    s >> coordinate;
+    b->gpsTimestamp = t.isValid() ? t.toMSecsSinceEpoch() : -1;
+    if ( !MdGpsFix::parseCoordinate ( coordinate, b->gpsLatitude, b->gpsLongitude ) ) {
+        b->gpsLatitude = 0;
+        b->gpsLongitude = 0;
+    }
     s >> b->gpsAltitude;
     s >> b->gpsGroundSpeed;
     s >> b->gpsDirection;
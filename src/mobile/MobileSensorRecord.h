@@ -1,7 +1,7 @@
 #ifndef MOBILESENSORRECORD_H
 #define MOBILESENSORRECORD_H
 
-#include <QDateTime>
+#include <QString>
 #include <QtGlobal>
 #include <QDataStream>
 
@@ -11,11 +11,12 @@ class MobileSensorRecord
     friend QDataStream& operator>>(QDataStream&, MobileSensorRecord*);
 public:
     MobileSensorRecord();
-    MobileSensorRecord(qreal &accX, qreal &accY, qreal &accZ, int &mdTimestamp, QDateTime &gpsTimestamp,
-                       QString &gpsCoordinateString, qreal &gpsAltitude, qreal &gpsGroundSpeed, qreal &gpsDirection,
+    MobileSensorRecord(qreal &accX, qreal &accY, qreal &accZ, int &mdTimestamp, qint64 gpsTimestamp,
+                       double gpsLatitude, double gpsLongitude, qreal &gpsAltitude, qreal &gpsGroundSpeed, qreal &gpsDirection,
                        qreal &gpsHorizontalAccuracy, qreal &gpsVerticalAccuracy, bool &gpsValid, quint32 gpsUpdateCount);
 
-    QVariant getColumn ( const int & column );
+    //! formatted when asked for, the record only holds the numbers (see MdGpsFix)
+    QString gpsCoordinateString () const;
 
 
     double accX;
@@ -23,8 +24,10 @@ public:
     double accZ;
 
     int mdTimestamp;
-    QDateTime	gpsTimestamp;
-    QString gpsCoordinateString;
+    //! msecs since epoch, -1 without fix
+    qint64 gpsTimestamp;
+    double gpsLatitude;
+    double gpsLongitude;
     double gpsAltitude;
     double gpsGroundSpeed;
     double gpsDirection;
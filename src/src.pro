@@ -57,10 +57,12 @@ HEADERS += evaluation/EvalSpectrogramPlot.h \
     MdPlotPicker.h \
     MdPlotZoomer.h \
     MdPlotData.h \
+    MdChannelSeries.h \
     MdPlot.h \
     VisualizationPlot.h \
     BoostPlot.h \
     MdData.h \
+    MdDataRecord.h \
     serialoptions.h \
     multidisplayuimainwindow.h \
     mdutil.h \
@@ -93,13 +95,38 @@ HEADERS += evaluation/EvalSpectrogramPlot.h \
     V2PowerDialog.h \
     MdGpsSerial.h \
     WotEventsDialog.h \
+    MdAcqStatsDialog.h \
     widgets/Overlay.h \
     com/MdAbstractCom.h \    
+    com/MdAcqStats.h \
+    com/MdAcquisition.h \
     com/MdBinaryProtocol.h \
+    com/MdFrameSplitter.h \
+    com/MdMd2Decoder.h \
     mobile/AndroidMainWindow.h \
     mobile/SwipeGestureRecognizer.h \
     mobile/AndroidN75Dialog.h \
-    widgets/VR6Widget.h
+    widgets/VR6Widget.h \
+    data/MdChannel.h \
+    data/MdSessionColumns.h \
+    data/MdSessionFile.h \
+    data/MdSessionCache.h \
+    data/MdChannelCodec.h \
+    data/MdRawCapture.h \
+    data/MdJournal.h \
+    data/MdLoadJob.h \
+    data/MdLegacyIndex.h \
+    data/MdCsvExporter.h \
+    data/MdLodPyramid.h \
+    data/MdChunkSource.h \
+    data/MdSessionStore.h \
+    data/MdRecordPool.h \
+    data/MdSpillFile.h \
+    data/MdTimeIndex.h \
+    data/MdSessionSnapshot.h \
+    data/MdEventScan.h \
+    data/MdCheckJob.h \
+    data/MdGpsFix.h
 
 lessThan(QT_MAJOR_VERSION, 5) {
     win32|unix:HEADERS+=com/MdQextSerialCom.h
@@ -128,10 +155,12 @@ SOURCES += evaluation/EvalSpectrogramPlot.cpp \
     MdPlotPicker.cpp \
     MdPlotZoomer.cpp \
     MdPlotData.cpp \
+    MdChannelSeries.cpp \
     MdPlot.cpp \
     VisualizationPlot.cpp \
     BoostPlot.cpp \
     MdData.cpp \
+    MdDataRecord.cpp \
     serialoptions.cpp \
     multidisplayuimainwindow.cpp \
     main.cpp \
@@ -165,13 +194,37 @@ SOURCES += evaluation/EvalSpectrogramPlot.cpp \
     V2PowerDialog.cpp \
     MdGpsSerial.cpp \
     WotEventsDialog.cpp \
+    MdAcqStatsDialog.cpp \
     widgets/Overlay.cpp \
     com/MdAbstractCom.cpp \
+    com/MdAcqStats.cpp \
+    com/MdAcquisition.cpp \
     com/MdBinaryProtocol.cpp \
+    com/MdFrameSplitter.cpp \
+    com/MdMd2Decoder.cpp \
     mobile/AndroidMainWindow.cpp \
     mobile/SwipeGestureRecognizer.cpp \
     mobile/AndroidN75Dialog.cpp \
-    widgets/VR6Widget.cpp
+    widgets/VR6Widget.cpp \
+    data/MdChannel.cpp \
+    data/MdSessionColumns.cpp \
+    data/MdSessionFile.cpp \
+    data/MdSessionCache.cpp \
+    data/MdChannelCodec.cpp \
+    data/MdRawCapture.cpp \
+    data/MdJournal.cpp \
+    data/MdLoadJob.cpp \
+    data/MdLegacyIndex.cpp \
+    data/MdCsvExporter.cpp \
+    data/MdLodPyramid.cpp \
+    data/MdSessionStore.cpp \
+    data/MdRecordPool.cpp \
+    data/MdSpillFile.cpp \
+    data/MdTimeIndex.cpp \
+    data/MdSessionSnapshot.cpp \
+    data/MdEventScan.cpp \
+    data/MdCheckJob.cpp \
+    data/MdGpsFix.cpp
 
 lessThan(QT_MAJOR_VERSION, 5) {
     win32|unix:SOURCES+=com/MdQextSerialCom.cpp
@@ -205,6 +258,7 @@ FORMS += evaluation/evaluationwindow.ui \
     DataTableConfigDialog.ui \
     V2PowerDialog.ui \
     WotEventsDialog.ui \
+    MdAcqStatsDialog.ui \
     mobile/AndroidMainWindow.ui \
     mobile/AndroidDashboardDialog.ui \
     mobile/AndroidN75Dialog.ui
@@ -40,6 +40,11 @@ JobRunnerThread::JobRunnerThread(QObject *parent, WorkerJob *job) :
     }
 }
 
+JobRunnerThread::~JobRunnerThread() {
+    if ( !t->isRunning() )
+        delete t;
+}
+
 void JobRunnerThread::start() {
     emit startWork();
 }
@@ -51,6 +56,11 @@ bool JobRunnerThread::isRunning () const {
     return t->isRunning();
 }
 
+void JobRunnerThread::quit () {
+    t->quit();
+    t->wait();
+}
+
 void JobRunnerThread::threadFinished () {
     emit finished();
 }
@@ -32,11 +32,14 @@ class JobRunnerThread : public QObject
     Q_OBJECT
 public:
     explicit JobRunnerThread(QObject *parent = 0, WorkerJob* job = 0 );
+    ~JobRunnerThread();
 
     WorkerJob* getWorkerJob() { return job; };
 
     bool isFinished () const;
     bool isRunning () const;
+    //! ends the event loop of the thread and waits until it is finished
+    void quit ();
 
 signals:
     void startWork();
@@ -22,11 +22,14 @@
 #include <qtimer.h>
 #include <qdebug.h>
 #include <qthread.h>
+#include <QMutexLocker>
 #include "AppEngine.h"
 #include "MdData.h"
 #include "VisualizationPlot.h"
+#include "data/MdChunkSource.h"
+#include "data/MdTimeIndex.h"
 
-ReplayWorker::ReplayWorker(AppEngine* a) : controller(a), replayDone(false), t(new QTimer(this)), replayIsPaused(false), running(false), replayedItemCount(0) {
+ReplayWorker::ReplayWorker(AppEngine* a) : controller(a), replayDone(false), t(new QTimer(this)), replayRow(0), src(NULL), nextSrc(NULL), replayIsPaused(false), running(false), replayedItemCount(0) {
     connect (t, SIGNAL(timeout()), this, SLOT(update()));
     qDebug() << "ReplayWorker created in Thread " << QThread::currentThreadId() ;
 }
@@ -36,6 +39,8 @@ ReplayWorker::~ReplayWorker () {
         delete (t);
         t = 0;
     }
+    delete src;
+    delete nextSrc;
 }
 
 void ReplayWorker::start() {
@@ -51,17 +56,22 @@ void ReplayWorker::start() {
 
     int startAtPos = controller->getReplayStartAtPos();
 
-    QList<MdDataRecord*> *dataList = &(controller->getData()->getData());
+    {
+        QMutexLocker locker (&srcLock);
+        if ( nextSrc ) {
+            delete src;
+            src = nextSrc;
+            nextSrc = NULL;
+        }
+    }
 
-    if (dataList->isEmpty())
+    if ( !src || src->rowCount() == 0 )
         return;
 
     //clear Plots
     emit clearPlots();
 
-    replayIt = dataList->begin();
-
-    replayIt = dataList->begin();
+    replayRow = 0;
     replayIsPaused = false;
     running = true;
 
@@ -70,10 +80,10 @@ void ReplayWorker::start() {
 
 
     if ( startAtPos ) {
-        if ( startAtPos < dataList->size() ) {
+        if ( startAtPos < src->rowCount() ) {
             for ( int i = 0 ; i < startAtPos ; i++ ) {
-                emit visualizeDataRecord( *replayIt, false );
-                replayIt++;
+                emit visualizeRow( replayRow, false );
+                replayRow++;
                 replayedItemCount++;
             }
         }
@@ -82,26 +92,29 @@ void ReplayWorker::start() {
     update();
 }
 
+void ReplayWorker::setSource ( MdChunkSource* source ) {
+    QMutexLocker locker (&srcLock);
+    delete nextSrc;
+    nextSrc = source;
+}
+
 void ReplayWorker::update() {
     if (replayIsPaused)
         return;
 
-    MdDataRecord* dr = *replayIt;
-    emit visualizeDataRecord( dr, true );
-
-    QList<MdDataRecord*> *dataList = &(controller->getData()->getData());
+    emit visualizeRow( replayRow, true );
 
-    replayIt++;
+    replayRow++;
     replayedItemCount++;
-    if ( replayIt != dataList->end() ) {
-        if ( (*replayIt)->getSensorR() != NULL ) {
-            int next = ( (*replayIt)->getSensorR()->getTime() - dr->getSensorR()->getTime() ) / controller->getReplaySpeedUpFactor();
+    if ( replayRow < src->rowCount() ) {
+        //the rows are shown in the GUI thread, only their times are read here
+        MdTimeIndex times (src);
+        int next = ( times.timeAt (replayRow) - times.timeAt (replayRow - 1) ) / controller->getReplaySpeedUpFactor();
 
 #ifndef Q_WS_MAEMO_5
-            emit showStatusMessage( QString ("replay mode (") + QString::number(replayedItemCount) + QString (" / ") + QString::number(dataList->count()) + QString(")") );
+        emit showStatusMessage( QString ("replay mode (") + QString::number(replayedItemCount) + QString (" / ") + QString::number(src->rowCount()) + QString(")") );
 #endif
-            t->start (next);
-        }
+        t->start (next);
     } else {
         emit showStatusMessage("replay finished");
         emit jobFinished();
@@ -129,17 +142,16 @@ void ReplayWorker::stop () {
     replayIsPaused = false;
     replayedItemCount = 0;
 
-    QList<MdDataRecord*> *dataList = &(controller->getData()->getData());
-    if ( dataList->isEmpty()  )
+    if ( !src || src->rowCount() == 0 )
         return;
 
-    for ( QList<MdDataRecord*>::iterator it = replayIt ; it != dataList->end() ; it++ ) {
-        if ( *it == dataList->last() )
-            visualizeDataRecord( *it, true );
+    for ( int i = replayRow ; i < src->rowCount() ; i++ ) {
+        if ( i == src->rowCount() - 1 )
+            visualizeRow( i, true );
         else
-            visualizeDataRecord( *it, false );
+            visualizeRow( i, false );
     }
-    replayIt = dataList->end();
+    replayRow = src->rowCount();
     t->stop();
     running = false;
 }
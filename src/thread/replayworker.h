@@ -23,9 +23,10 @@
 #include "thread/workerjob.h"
 #include <qstring.h>
 #include <qlist.h>
+#include <QMutex>
 
 class AppEngine;
-class MdDataRecord;
+class MdChunkSource;
 class QTimer;
 
 //! job which replays the captured data
@@ -36,9 +37,16 @@ public:
     ~ReplayWorker();
 
     void start();
+    /**
+      * gui thread: the rows to replay, a source of this worker alone (a store snapshot or a
+      * MdSessionCache of its own). the next start() takes it over and deletes it.
+      * the worker never reads the sources of the gui thread.
+      */
+    void setSource ( MdChunkSource* source );
 
 signals:
-    void visualizeDataRecord( MdDataRecord*, bool );
+    //! row of the source, MdData::source() in the gui thread
+    void visualizeRow( int, bool );
     void clearPlots ();
     void showStatusMessage (QString);
 
@@ -52,7 +60,13 @@ private:
     AppEngine *controller;
     bool replayDone;
     QTimer* t;
-    QList<MdDataRecord*>::iterator replayIt;
+    //! next row to replay
+    int replayRow;
+    //! rows being replayed, only their times are read
+    MdChunkSource* src;
+    //! set by setSource(), NULL once start() took it
+    MdChunkSource* nextSrc;
+    QMutex srcLock;
     bool replayIsPaused;
     bool running;
     int replayedItemCount;
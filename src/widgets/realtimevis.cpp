@@ -153,7 +153,7 @@ void RealTimeVis::visualize (MdDataRecord *d) {
 
             boostW->setValue(  d->getSensorR()->getBoost() );
             lambdaW->setValue(  d->getSensorR()->getLambda() );
-            QMap<QString, double> e = d->getSensorR()->getHighestEgt();
+            QMap<QString, double> e = d->getSensorR()->getHighestEgt ( AppEngine::getInstance()->numConnectedTypeK );
             egtW->setValue( e["temp"], (quint8) e["idx"]  );
 
             bexW->setValue( d );